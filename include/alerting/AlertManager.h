@@ -3,9 +3,16 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <mutex>
 #include <functional>
 #include <chrono>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+
+#include "../core/MetricsRegistry.h"
+#include "../core/MpscQueue.h"
 
 namespace hls_to_dvb {
 
@@ -19,20 +26,49 @@ struct Alert {
     AlertLevel level;
     std::string message;
     std::string component;
-    std::chrono::system_clock::time_point timestamp;
+    std::chrono::system_clock::time_point timestamp;    ///< Dernière occurrence
     bool persistent;
     std::string id;
+    std::chrono::system_clock::time_point firstSeen;    ///< Première occurrence
+    uint64_t count = 1;                                 ///< Nombre d'occurrences regroupées
     
     Alert() = default;
     Alert(AlertLevel lvl, const std::string& comp, const std::string& msg, bool persist = false);
 };
 
+/**
+ * @class AlertManager
+ * @brief Collecte, regroupe et conserve les alertes de l'application
+ *
+ * addAlert ne fait que déposer l'alerte dans une file bornée sans verrou : les threads
+ * du pipeline ne se bloquent jamais sur le gestionnaire. Un thread de fond regroupe les
+ * alertes identiques (niveau, composant, message, comparés en entier) en une seule entrée
+ * avec son nombre d'occurrences, journalise, appelle les fonctions de rappel et applique
+ * la rétention.
+ */
 class AlertManager {
 public:
     static AlertManager& getInstance();
     
-    std::string addAlert(AlertLevel level, const std::string& component, 
-                      const std::string& message, bool persistent = false);
+    /**
+     * @brief Signale une alerte, sans attendre son traitement
+     *
+     * Une alerte identique à une alerte active incrémente son compteur d'occurrences.
+     * Si la file est pleine (rafale d'alertes), l'alerte est comptée comme rejetée.
+     *
+     * @param level Niveau de l'alerte
+     * @param component Composant à l'origine de l'alerte
+     * @param message Message de l'alerte
+     * @param persistent L'alerte n'expire pas et doit être résolue explicitement
+     * @return false si l'alerte a été rejetée
+     */
+    bool addAlert(AlertLevel level, const std::string& component, 
+                  const std::string& message, bool persistent = false);
+    
+    /**
+     * @brief Traite immédiatement les alertes en attente
+     */
+    void flush();
     
     bool resolveAlert(const std::string& alertId);
     
@@ -70,17 +106,51 @@ private:
     AlertManager(const AlertManager&) = delete;
     AlertManager& operator=(const AlertManager&) = delete;
     
+    /**
+     * @brief Alerte déposée par un producteur, en attente de traitement
+     */
+    struct PendingAlert {
+        AlertLevel level = AlertLevel::INFO;
+        std::string component;
+        std::string message;
+        bool persistent = false;
+        std::chrono::system_clock::time_point timestamp;
+    };
+    
+    static constexpr size_t QUEUE_CAPACITY = 4096; ///< Alertes en attente au maximum
+    
+    MpscQueue<PendingAlert> pending_;           ///< Alertes déposées par les producteurs
+    
+    std::mutex processMutex_;                   ///< Un seul thread traite la file à la fois
     mutable std::mutex alertsMutex_;
-    std::vector<Alert> alerts_;
+    std::map<std::string, Alert> alerts_;
     std::map<std::string, Alert> persistentAlerts_;
+    std::unordered_map<std::string, std::string> activeKeys_; ///< Clé de regroupement -> ID de l'alerte active
     
     std::map<AlertLevel, int> retention_; // Durée de rétention par niveau (en secondes)
+    std::map<AlertLevel, std::shared_ptr<Counter>> alertCounters_; // Alertes émises par niveau (mesures exportées)
+    std::shared_ptr<Counter> droppedCounter_;   ///< Alertes rejetées faute de place dans la file
     
     std::map<int, std::function<void(const Alert&)>> callbacks_;
     int nextCallbackId_ = 0;
     
+    std::thread workerThread_;                  ///< Thread de traitement des alertes
+    std::mutex workerMutex_;                    ///< Protège l'attente du thread de traitement
+    std::condition_variable workerCond_;        ///< Réveille le thread de traitement à l'arrêt
+    bool stopping_ = false;                     ///< Arrêt demandé (protégé par workerMutex_)
+    
+    /**
+     * @brief Boucle du thread de traitement
+     */
+    void workerLoop();
+    
+    /**
+     * @brief Regroupe les alertes en attente, journalise et appelle les fonctions de rappel
+     */
+    void processPending();
+    
     /**
-     * @brief Nettoie les alertes expirées
+     * @brief Nettoie les alertes expirées (alertsMutex_ déjà verrouillé)
      */
     void cleanupExpiredAlerts();
 };
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace hls_to_dvb {
+
+/**
+ * @brief Étapes du pipeline dans lesquelles des données sont mises en tampon
+ */
+enum class BufferStage {
+    HLS_QUEUE = 0,      ///< File d'attente des segments récupérés par le HLSClient
+    SEGMENT_BUFFER,     ///< Tampon de gigue (SegmentBuffer)
+    MULTICAST_QUEUE,    ///< File d'attente d'émission du MulticastSender
+    COUNT               ///< Nombre d'étapes (doit rester en dernier)
+};
+
+/**
+ * @brief Nombre d'étapes comptabilisées
+ */
+constexpr size_t BUFFER_STAGE_COUNT = static_cast<size_t>(BufferStage::COUNT);
+
+/**
+ * @brief Retourne le nom d'une étape du pipeline
+ * @param stage Étape
+ * @return Nom de l'étape (utilisé dans l'API de statistiques)
+ */
+const char* bufferStageName(BufferStage stage);
+
+class BufferAccountant;
+
+/**
+ * @class StreamBufferAccount
+ * @brief Compte des octets mis en tampon par un flux, étape par étape
+ *
+ * Les composants d'un flux partagent ce compte et y déclarent les octets qu'ils
+ * conservent. Les mises à jour n'utilisent que des opérations atomiques.
+ */
+class StreamBufferAccount {
+public:
+    /**
+     * @brief Constructeur
+     * @param streamId Identifiant du flux
+     * @param owner Comptable global auquel les mouvements sont reportés
+     */
+    StreamBufferAccount(const std::string& streamId, BufferAccountant& owner);
+
+    /**
+     * @brief Destructeur, restitue au comptable global les octets encore déclarés
+     */
+    ~StreamBufferAccount();
+
+    StreamBufferAccount(const StreamBufferAccount&) = delete;
+    StreamBufferAccount& operator=(const StreamBufferAccount&) = delete;
+
+    /**
+     * @brief Déclare des octets mis en tampon
+     * @param stage Étape concernée
+     * @param bytes Nombre d'octets
+     */
+    void add(BufferStage stage, size_t bytes);
+
+    /**
+     * @brief Déclare des octets libérés
+     * @param stage Étape concernée
+     * @param bytes Nombre d'octets
+     */
+    void release(BufferStage stage, size_t bytes);
+
+    /**
+     * @brief Récupère les octets mis en tampon à une étape
+     * @param stage Étape concernée
+     * @return Nombre d'octets
+     */
+    size_t getBytes(BufferStage stage) const;
+
+    /**
+     * @brief Récupère le total des octets mis en tampon par le flux
+     * @return Nombre d'octets
+     */
+    size_t getTotalBytes() const;
+
+    /**
+     * @brief Récupère l'identifiant du flux
+     * @return Identifiant du flux
+     */
+    const std::string& getStreamId() const;
+
+private:
+    std::string streamId_;                                          ///< Identifiant du flux
+    BufferAccountant& owner_;                                       ///< Comptable global
+    std::array<std::atomic<int64_t>, BUFFER_STAGE_COUNT> bytes_;    ///< Octets par étape
+};
+
+/**
+ * @class BufferAccountant
+ * @brief Comptabilité globale de la mémoire tampon de tous les flux
+ *
+ * Suit les octets conservés par chaque flux et chaque étape, et signale quand la
+ * consommation dépasse le seuil haut du budget mémoire configuré. Les récupérations
+ * HLS sont alors suspendues jusqu'à ce que la consommation repasse sous le seuil bas.
+ */
+class BufferAccountant {
+public:
+    /**
+     * @brief Instantané de la consommation mémoire
+     */
+    struct Snapshot {
+        size_t budgetBytes = 0;                 ///< Budget configuré (0 = illimité)
+        size_t totalBytes = 0;                  ///< Octets actuellement en tampon
+        size_t peakBytes = 0;                   ///< Pic d'octets en tampon
+        bool throttled = false;                 ///< Récupérations suspendues
+        uint64_t throttleEvents = 0;            ///< Nombre de suspensions déclenchées
+        std::map<std::string, std::array<size_t, BUFFER_STAGE_COUNT>> streams; ///< Octets par flux et par étape
+    };
+
+    /**
+     * @brief Récupère l'instance unique du comptable
+     * @return Référence vers l'instance
+     */
+    static BufferAccountant& getInstance();
+
+    /**
+     * @brief Configure le budget mémoire
+     * @param budgetBytes Budget total en octets (0 = illimité)
+     * @param highWatermarkPercent Seuil de suspension des récupérations (% du budget)
+     * @param lowWatermarkPercent Seuil de reprise des récupérations (% du budget)
+     */
+    void setBudget(size_t budgetBytes, int highWatermarkPercent, int lowWatermarkPercent);
+
+    /**
+     * @brief Enregistre un flux et retourne son compte
+     *
+     * Si un compte est encore utilisé pour ce flux, il est partagé plutôt que remplacé.
+     *
+     * @param streamId Identifiant du flux
+     * @return Compte partagé par les composants du flux
+     */
+    std::shared_ptr<StreamBufferAccount> registerStream(const std::string& streamId);
+
+    /**
+     * @brief Retire un flux de la comptabilité
+     * @param streamId Identifiant du flux
+     */
+    void unregisterStream(const std::string& streamId);
+
+    /**
+     * @brief Indique si les récupérations doivent être suspendues
+     * @return true si la consommation a dépassé le seuil haut et n'est pas repassée sous le seuil bas
+     */
+    bool isThrottled() const;
+
+    /**
+     * @brief Attend que la consommation repasse sous le seuil bas
+     * @param timeout Durée maximale d'attente
+     * @return true si les récupérations peuvent reprendre
+     */
+    bool waitForCapacity(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Récupère le total des octets en tampon
+     * @return Nombre d'octets
+     */
+    size_t getTotalBytes() const;
+
+    /**
+     * @brief Récupère un instantané de la consommation
+     * @return Instantané
+     */
+    Snapshot getSnapshot() const;
+
+private:
+    friend class StreamBufferAccount;
+
+    BufferAccountant();
+
+    /**
+     * @brief Reporte une variation de la consommation totale
+     * @param delta Variation en octets
+     */
+    void onDelta(int64_t delta);
+
+    /**
+     * @brief Émet l'alerte et les journaux des franchissements de seuil en attente
+     *
+     * onDelta() est appelé sous les verrous des files et tampons des flux: il ne fait que
+     * noter le franchissement, signalé ensuite par un appelant qui ne tient aucun verrou.
+     */
+    void reportThresholdEvents() const;
+
+    std::atomic<int64_t> totalBytes_;       ///< Octets en tampon, tous flux confondus
+    std::atomic<int64_t> peakBytes_;        ///< Pic d'octets en tampon
+    std::atomic<int64_t> highWatermark_;    ///< Seuil de suspension (0 = illimité)
+    std::atomic<int64_t> lowWatermark_;     ///< Seuil de reprise
+    std::atomic<size_t> budgetBytes_;       ///< Budget configuré
+    std::atomic<bool> throttled_;           ///< Récupérations suspendues
+    std::atomic<uint64_t> throttleEvents_;  ///< Nombre de suspensions
+    mutable std::atomic<bool> suspendPending_;  ///< Suspension à signaler
+    mutable std::atomic<bool> resumePending_;   ///< Reprise à signaler
+    std::atomic<int64_t> eventBytes_;       ///< Octets en tampon au dernier franchissement
+
+    mutable std::mutex mutex_;              ///< Protège la table des flux et l'attente
+    std::condition_variable capacityCond_;  ///< Signalée lorsque les récupérations peuvent reprendre
+    std::map<std::string, std::weak_ptr<StreamBufferAccount>> streams_; ///< Comptes des flux enregistrés
+};
+
+} // namespace hls_to_dvb
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hls_to_dvb {
+
+/**
+ * @class BufferPool
+ * @brief Réserve de tampons d'octets recyclés entre les étapes du pipeline d'un flux
+ *
+ * Les segments d'un même flux ont des tailles voisines : plutôt que d'allouer puis de
+ * libérer plusieurs vecteurs de plusieurs mégaoctets par segment, chaque étape emprunte
+ * un tampon à la réserve et le restitue une fois les données consommées. Les tampons
+ * sont rangés par classes de taille (puissances de deux de 64 Kio à 64 Mio), ce qui
+ * limite la fragmentation du tas sur de longues durées de fonctionnement.
+ */
+class BufferPool {
+public:
+    /**
+     * @brief Statistiques de la réserve
+     */
+    struct Stats {
+        uint64_t acquires = 0;              ///< Nombre d'emprunts
+        uint64_t reuses = 0;                ///< Emprunts servis par un tampon recyclé
+        uint64_t heapAllocations = 0;       ///< Emprunts ayant nécessité une allocation
+        uint64_t discarded = 0;             ///< Tampons restitués mais libérés (réserve pleine)
+        uint64_t segments = 0;              ///< Nombre de segments traités
+        double allocationsPerSegment = 0.0; ///< Allocations moyennes par segment
+        size_t pooledBytes = 0;             ///< Octets actuellement disponibles dans la réserve
+        size_t peakPooledBytes = 0;         ///< Pic d'octets disponibles dans la réserve
+    };
+
+    /**
+     * @brief Constructeur
+     * @param maxPooledBytes Capacité totale maximale conservée dans la réserve
+     * @param maxBuffersPerClass Nombre maximal de tampons conservés par classe de taille
+     */
+    explicit BufferPool(size_t maxPooledBytes = 32 * 1024 * 1024, size_t maxBuffersPerClass = 4);
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * @brief Emprunte un tampon vide d'une capacité au moins égale à celle demandée
+     * @param capacity Capacité minimale souhaitée en octets
+     * @return Tampon vide (size() == 0) dont la capacité couvre la demande
+     */
+    std::vector<uint8_t> acquire(size_t capacity);
+
+    /**
+     * @brief Restitue un tampon à la réserve
+     * @param buffer Tampon dont les données ne sont plus utilisées
+     */
+    void release(std::vector<uint8_t>&& buffer);
+
+    /**
+     * @brief Partage un tampon entre plusieurs consommateurs
+     *
+     * Le tampon est rendu à la réserve lorsque le dernier consommateur l'abandonne.
+     *
+     * @param pool Réserve à laquelle rendre le tampon (peut être nulle)
+     * @param buffer Tampon à partager
+     * @return Tampon partagé, en lecture seule
+     */
+    static std::shared_ptr<const std::vector<uint8_t>> share(std::shared_ptr<BufferPool> pool,
+                                                             std::vector<uint8_t>&& buffer);
+
+    /**
+     * @brief Comptabilise un segment traité (pour le calcul des allocations par segment)
+     */
+    void markSegment();
+
+    /**
+     * @brief Libère tous les tampons conservés
+     */
+    void trim();
+
+    /**
+     * @brief Récupère les statistiques de la réserve
+     * @return Statistiques
+     */
+    Stats getStats() const;
+
+private:
+    static constexpr size_t MIN_CLASS_SHIFT = 16;   ///< Plus petite classe : 64 Kio
+    static constexpr size_t CLASS_COUNT = 11;       ///< Classes de 64 Kio à 64 Mio
+
+    /**
+     * @brief Détermine la classe qui peut servir une demande (arrondi supérieur)
+     * @param capacity Capacité demandée
+     * @return Indice de classe, ou CLASS_COUNT si la demande dépasse la plus grande classe
+     */
+    static size_t classForRequest(size_t capacity);
+
+    /**
+     * @brief Détermine la classe dans laquelle ranger un tampon (arrondi inférieur)
+     * @param capacity Capacité du tampon
+     * @return Indice de classe, ou CLASS_COUNT si le tampon est trop petit ou trop grand
+     */
+    static size_t classForBuffer(size_t capacity);
+
+    /**
+     * @brief Taille d'une classe
+     * @param index Indice de classe
+     * @return Taille en octets
+     */
+    static size_t classSize(size_t index);
+
+    size_t maxPooledBytes_;                                     ///< Capacité maximale conservée
+    size_t maxBuffersPerClass_;                                 ///< Tampons conservés par classe
+    mutable std::mutex mutex_;                                  ///< Protège les listes libres
+    std::array<std::vector<std::vector<uint8_t>>, CLASS_COUNT> freeLists_; ///< Tampons libres par classe
+    size_t pooledBytes_;                                        ///< Octets conservés
+
+    std::atomic<uint64_t> acquires_;                            ///< Nombre d'emprunts
+    std::atomic<uint64_t> reuses_;                              ///< Emprunts recyclés
+    std::atomic<uint64_t> heapAllocations_;                     ///< Emprunts alloués
+    std::atomic<uint64_t> discarded_;                           ///< Tampons libérés à la restitution
+    std::atomic<uint64_t> segments_;                            ///< Segments traités
+    std::atomic<size_t> peakPooledBytes_;                       ///< Pic d'octets conservés
+};
+
+} // namespace hls_to_dvb
@@ -7,6 +7,26 @@
 
 namespace hls_to_dvb {
 
+/**
+ * @brief Destination supplémentaire d'un flux
+ */
+struct OutputConfig {
+    std::string address;          ///< Adresse IP de destination (groupe multicast ou unicast)
+    int port;                     ///< Port UDP de destination
+    std::string interface;        ///< Interface réseau de sortie (multicast uniquement, vide = interface par défaut)
+    std::string protocol;         ///< Encapsulation: "udp" (MPEG-TS brut) ou "rtp" (RFC 2250)
+    int fecColumns;               ///< Colonnes L de la FEC SMPTE 2022-1 en RTP (0 = sans FEC)
+    int fecRows;                  ///< Lignes D de la FEC SMPTE 2022-1 en RTP (0 = sans FEC)
+    
+    OutputConfig() : port(1234), protocol("udp"), fecColumns(0), fecRows(0) {}
+};
+
+/**
+ * @brief Conversions JSON d'une destination, utilisées par nlohmann::json
+ */
+void to_json(nlohmann::json& json, const OutputConfig& output);
+void from_json(const nlohmann::json& json, OutputConfig& output);
+
 /**
  * @brief Structure représentant la configuration d'un flux HLS vers MPEG-TS
  */
@@ -14,13 +34,26 @@ struct StreamConfig {
     std::string id;               ///< Identifiant unique du flux
     std::string name;             ///< Nom lisible du flux
     std::string hlsInput;         ///< URL d'entrée du flux HLS
+    std::vector<std::string> hlsInputs; ///< URL d'entrée équivalentes (origines redondantes, hlsInput compris)
     std::string mcastOutput;      ///< Adresse IP multicast de sortie
     int mcastPort;                ///< Port multicast de sortie
     std::string mcastInterface;   ///< Interface réseau pour la sortie multicast
-    size_t bufferSize;            ///< Taille du buffer en nombre de segments
+    std::string mcastProtocol;    ///< Encapsulation de la sortie multicast: "udp" (MPEG-TS brut) ou "rtp" (RFC 2250)
+    int fecColumns;               ///< Colonnes L de la FEC SMPTE 2022-1 en RTP (0 = sans FEC)
+    int fecRows;                  ///< Lignes D de la FEC SMPTE 2022-1 en RTP (0 = sans FEC)
+    size_t bufferSize;            ///< Nombre maximal de segments dans le buffer
+    int bufferMinMs;              ///< Profondeur minimale du tampon de gigue en millisecondes
+    int bufferMaxMs;              ///< Profondeur maximale du tampon de gigue en millisecondes
+    bool passthrough;             ///< Transmettre la source sans réécriture tant qu'elle reste conforme
+    int latencyTargetMs;          ///< Latence cible par rapport au direct en millisecondes (0 = pas de rattrapage)
+    std::string catchUpPolicy;    ///< Rattrapage du direct: "skip" (sauter des segments) ou "speedup" (accélérer)
+    std::vector<OutputConfig> outputs; ///< Destinations supplémentaires alimentées par la même conversion
+    OutputConfig redundantOutput; ///< Second chemin SMPTE 2022-7 de la sortie multicast (adresse vide = aucun)
     bool enabled;                 ///< Si le flux est activé
     
-    StreamConfig() : mcastPort(1234), bufferSize(3), enabled(true) {}
+    StreamConfig() : mcastPort(1234), mcastProtocol("udp"), fecColumns(0), fecRows(0),
+                     bufferSize(3), bufferMinMs(2000), bufferMaxMs(12000),
+                     passthrough(false), latencyTargetMs(0), catchUpPolicy("skip"), enabled(true) {}
 };
 
 /**
@@ -48,7 +81,13 @@ struct LoggingConfig {
         int maxFiles;                 ///< Nombre maximum de fichiers de log
     } file;
     
-    LoggingConfig() : level("info"), console(true) {
+    size_t asyncQueueSize;            ///< Capacité de la file des messages en attente d'écriture
+    std::string overflowPolicy;       ///< Politique si la file est pleine (drop_oldest, block)
+    int flushIntervalSec;             ///< Période de vidage des sinks en secondes
+    std::map<std::string, std::string> components; ///< Niveau propre à certains composants
+    
+    LoggingConfig() : level("info"), console(true), asyncQueueSize(8192),
+                      overflowPolicy("drop_oldest"), flushIntervalSec(1) {
         file.enabled = true;
         file.path = "logs/hls-to-dvb.log";
         file.rotationSize = 10 * 1024 * 1024; // 10 MB
@@ -100,6 +139,73 @@ struct AlertsConfig {
     }
 };
 
+/**
+ * @brief Configuration du budget mémoire des tampons
+ */
+struct MemoryConfig {
+    size_t budgetBytes;               ///< Budget total des tampons, tous flux confondus (0 = illimité)
+    int highWatermarkPercent;         ///< Seuil de suspension des récupérations HLS (% du budget)
+    int lowWatermarkPercent;          ///< Seuil de reprise des récupérations HLS (% du budget)
+    
+    MemoryConfig() : budgetBytes(1024ULL * 1024 * 1024), highWatermarkPercent(90), lowWatermarkPercent(75) {}
+};
+
+/**
+ * @brief Configuration du démarrage des flux
+ */
+struct StartupConfig {
+    bool diagnostics;                 ///< Sondages et tests de bout en bout au démarrage de chaque flux
+    int parallelStarts;               ///< Nombre de flux démarrés simultanément
+    
+    StartupConfig() : diagnostics(false), parallelStarts(16) {}
+};
+
+/**
+ * @brief Configuration des points de reprise de l'état de sortie des flux
+ */
+struct CheckpointConfig {
+    bool enabled;                     ///< Sauvegarde et reprise de l'état de sortie (CC, PCR, versions des tables)
+    std::string directory;            ///< Dossier des fichiers d'état (un par flux)
+    int intervalMs;                   ///< Intervalle minimal entre deux sauvegardes
+    
+    CheckpointConfig() : enabled(true), directory("state"), intervalMs(1000) {}
+};
+
+/**
+ * @brief Configuration de la reprise des étapes en échec
+ */
+struct RecoveryConfig {
+    int initialDelayMs;               ///< Délai avant la première relance d'une étape
+    int maxDelayMs;                   ///< Délai maximal entre deux relances
+    double jitter;                    ///< Part aléatoire des délais (0.0 à 1.0)
+    
+    RecoveryConfig() : initialDelayMs(100), maxDelayMs(5000), jitter(0.2) {}
+};
+
+/**
+ * @brief Configuration de l'émission des datagrammes multicast
+ */
+struct TransmitConfig {
+    std::string backend;              ///< Émission: "socket" (UDP), "packet_ring" (anneau AF_PACKET partagé par interface) ou "io_uring" (lots io_uring)
+    int ringFrames;                   ///< Nombre de trames de chaque anneau d'émission
+    int uringEntries;                 ///< Nombre de datagrammes par lot io_uring
+    
+    TransmitConfig() : backend("socket"), ringFrames(4096), uringEntries(256) {}
+};
+
+/**
+ * @brief Configuration de la récupération HLS
+ */
+struct FetchConfig {
+    std::string engine;               ///< Récupération: "thread" (un thread FFmpeg par flux) ou "coroutine" (runtime d'E/S partagé)
+    int ioThreads;                    ///< Nombre de boucles d'E/S du runtime partagé
+    int maxRequestsPerOrigin;         ///< Requêtes simultanées par origine (moteur "coroutine")
+    int idleConnectionsPerOrigin;     ///< Connexions persistantes gardées par origine (0 = aucune)
+    int hedgeAfterMs;                 ///< Délai sans premier octet avant de doubler un segment vers une autre origine (0 = jamais)
+    
+    FetchConfig() : engine("thread"), ioThreads(2), maxRequestsPerOrigin(6), idleConnectionsPerOrigin(8), hedgeAfterMs(0) {}
+};
+
 /**
  * @brief Classe gérant la configuration globale de l'application
  */
@@ -189,6 +295,42 @@ public:
      */
     const AlertsConfig::Retention& getAlertRetention() const;
     
+    /**
+     * @brief Récupère la configuration du budget mémoire
+     * @return Configuration du budget mémoire
+     */
+    const MemoryConfig& getMemoryConfig() const;
+    
+    /**
+     * @brief Récupère la configuration du démarrage des flux
+     * @return Configuration du démarrage
+     */
+    const StartupConfig& getStartupConfig() const;
+    
+    /**
+     * @brief Récupère la configuration des points de reprise
+     * @return Configuration des points de reprise
+     */
+    const CheckpointConfig& getCheckpointConfig() const;
+    
+    /**
+     * @brief Récupère la configuration de la reprise des étapes en échec
+     * @return Configuration de la reprise
+     */
+    const RecoveryConfig& getRecoveryConfig() const;
+    
+    /**
+     * @brief Récupère la configuration de l'émission multicast
+     * @return Configuration de l'émission
+     */
+    const TransmitConfig& getTransmitConfig() const;
+    
+    /**
+     * @brief Récupère la configuration de la récupération HLS
+     * @return Configuration de la récupération
+     */
+    const FetchConfig& getFetchConfig() const;
+    
     /**
      * @brief Met à jour la configuration du serveur
      * @param config Nouvelle configuration du serveur
@@ -230,6 +372,12 @@ private:
     ServerConfig server_;
     LoggingConfig logging_;
     AlertsConfig alerts_;
+    MemoryConfig memory_;
+    StartupConfig startup_;
+    CheckpointConfig checkpoint_;
+    RecoveryConfig recovery_;
+    TransmitConfig transmit_;
+    FetchConfig fetch_;
     
     // Maps pour accès rapide par ID
     std::map<std::string, size_t> streamIndexMap_;
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hls_to_dvb {
+
+/**
+ * @class Task
+ * @brief Coroutine C++20 paresseuse exécutée sur une boucle d'E/S
+ *
+ * La coroutine ne démarre qu'au premier co_await. À sa fin, elle reprend directement
+ * la coroutine qui l'attendait (transfert symétrique), sans repasser par la boucle.
+ * Les exceptions sont propagées à l'appelant.
+ *
+ * @tparam T Type du résultat (void pour aucun résultat)
+ */
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief Partie commune des promesses de Task
+ */
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;   ///< Coroutine à reprendre à la fin
+    std::exception_ptr error;               ///< Exception levée par la coroutine
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;   ///< Résultat de la coroutine
+
+    Task<T> get_return_object() noexcept;
+    void return_value(T result) { value = std::move(result); }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+};
+
+} // namespace detail
+
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() {
+        if (handle_.promise().error) {
+            std::rethrow_exception(handle_.promise().error);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*handle_.promise().value);
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/**
+ * @brief Issue d'une attente sur une boucle d'E/S
+ */
+enum class WaitResult {
+    READY,      ///< Descripteur prêt (ou délai d'une temporisation écoulé)
+    TIMEOUT,    ///< Délai écoulé avant que le descripteur soit prêt
+    CANCELLED,  ///< Attente annulée par IoLoop::cancel()
+    ERROR       ///< Descripteur inutilisable
+};
+
+/**
+ * @brief Jeton d'annulation partagé entre une coroutine et celui qui l'arrête
+ *
+ * Une fois annulé, l'attente en cours se termine aussitôt et toutes les attentes
+ * suivantes se terminent sans suspendre la coroutine.
+ */
+struct CancelToken {
+    std::atomic<bool> cancelled{false};   ///< Annulation demandée
+    uint64_t waiterId = 0;                ///< Attente en cours (thread de la boucle uniquement)
+};
+
+/**
+ * @class IoLoop
+ * @brief Boucle d'événements epoll à un thread, avec temporisations
+ *
+ * Les coroutines confiées à une boucle y restent : elles ne sont reprises que par son
+ * thread. Une coroutine en attente d'un descripteur ou d'une temporisation n'occupe
+ * aucun thread. Les temporisations sont ordonnées dans la boucle elle-même, qui règle
+ * le délai d'epoll_wait sur la plus proche échéance.
+ *
+ * spawn(), post(), cancel() et notify() peuvent être appelées depuis n'importe quel thread.
+ * Les attentes (sleepFor(), wait(), suspend()) ne s'utilisent que dans une coroutine
+ * de la boucle.
+ */
+class IoLoop {
+public:
+    /**
+     * @brief Attente d'une coroutine sur la boucle
+     */
+    class Awaiter {
+    public:
+        Awaiter(IoLoop& loop, int fd, uint32_t events, std::chrono::milliseconds timeout,
+                std::shared_ptr<CancelToken> cancel)
+            : loop_(loop), fd_(fd), events_(events), timeout_(timeout), cancel_(std::move(cancel)) {}
+
+        bool await_ready() const noexcept;
+        bool await_suspend(std::coroutine_handle<> handle);
+        WaitResult await_resume() const noexcept { return result_; }
+
+    private:
+        friend class IoLoop;
+
+        IoLoop& loop_;
+        int fd_;                                    ///< Descripteur attendu (-1 = temporisation seule)
+        uint32_t events_;                           ///< Événements epoll attendus
+        std::chrono::milliseconds timeout_;         ///< Délai maximal (négatif = aucun)
+        std::shared_ptr<CancelToken> cancel_;       ///< Jeton d'annulation (peut être nullptr)
+        std::coroutine_handle<> handle_;            ///< Coroutine suspendue
+        WaitResult result_ = WaitResult::CANCELLED; ///< Issue de l'attente
+        std::multimap<std::chrono::steady_clock::time_point, uint64_t>::iterator timer_; ///< Échéance
+        bool hasTimer_ = false;                     ///< Échéance enregistrée
+    };
+
+    /**
+     * @brief Crée la boucle et démarre son thread
+     * @param index Numéro de la boucle (pour les journaux)
+     */
+    explicit IoLoop(int index);
+
+    /**
+     * @brief Arrête la boucle et attend son thread
+     *
+     * Les coroutines encore suspendues ne sont pas reprises : elles doivent avoir été
+     * annulées et attendues par leurs propriétaires.
+     */
+    ~IoLoop();
+
+    IoLoop(const IoLoop&) = delete;
+    IoLoop& operator=(const IoLoop&) = delete;
+
+    /**
+     * @brief Démarre une coroutine sur la boucle
+     * @param task Coroutine à exécuter
+     * @param onDone Fonction appelée sur le thread de la boucle à la fin de la coroutine
+     */
+    void spawn(Task<void> task, std::function<void()> onDone = nullptr);
+
+    /**
+     * @brief Exécute une fonction sur le thread de la boucle
+     * @param function Fonction à exécuter
+     */
+    void post(std::function<void()> function);
+
+    /**
+     * @brief Annule l'attente en cours et les attentes suivantes d'une coroutine
+     * @param token Jeton passé aux attentes de la coroutine
+     */
+    void cancel(const std::shared_ptr<CancelToken>& token);
+
+    /**
+     * @brief Suspend la coroutine pendant un délai
+     * @param delay Délai
+     * @param cancel Jeton d'annulation (peut être nullptr)
+     * @return Attente (READY à l'échéance, CANCELLED si annulée)
+     */
+    Awaiter sleepFor(std::chrono::milliseconds delay, std::shared_ptr<CancelToken> cancel = nullptr);
+
+    /**
+     * @brief Suspend la coroutine jusqu'à ce qu'un descripteur soit prêt
+     * @param fd Descripteur non bloquant
+     * @param events Événements epoll attendus (EPOLLIN, EPOLLOUT)
+     * @param timeout Délai maximal
+     * @param cancel Jeton d'annulation (peut être nullptr)
+     * @return Attente (READY, TIMEOUT, CANCELLED ou ERROR)
+     */
+    Awaiter wait(int fd, uint32_t events, std::chrono::milliseconds timeout,
+                 std::shared_ptr<CancelToken> cancel = nullptr);
+    
+    /**
+     * @brief Suspend la coroutine jusqu'à ce qu'un autre composant la reprenne
+     * @param token Jeton de l'attente, passé ensuite à notify() ou cancel()
+     * @return Attente (READY après notify(), CANCELLED si annulée)
+     */
+    Awaiter suspend(std::shared_ptr<CancelToken> token);
+    
+    /**
+     * @brief Reprend une coroutine suspendue par suspend()
+     *
+     * La reprise est exécutée par le thread de la boucle : une notification émise
+     * pendant que la coroutine s'apprête à se suspendre sur ce thread la trouve suspendue.
+     * Émise depuis le thread de la boucle, elle ne reprend que l'attente en cours au
+     * moment de l'appel, jamais une attente ultérieure avec le même jeton.
+     *
+     * @param token Jeton passé à suspend()
+     */
+    void notify(const std::shared_ptr<CancelToken>& token);
+
+private:
+    /**
+     * @brief Enregistre une attente (thread de la boucle)
+     * @return false si l'attente se termine immédiatement
+     */
+    bool arm(Awaiter& awaiter);
+
+    /**
+     * @brief Termine une attente et reprend sa coroutine (thread de la boucle)
+     */
+    void complete(uint64_t id, WaitResult result);
+
+    /**
+     * @brief Corps du thread de la boucle
+     */
+    void run();
+
+    const int index_;                       ///< Numéro de la boucle
+    int epollFd_ = -1;                      ///< Instance epoll
+    int wakeFd_ = -1;                       ///< eventfd de réveil (post, arrêt)
+    std::atomic<bool> stopping_{false};     ///< Arrêt demandé
+
+    std::mutex postedMutex_;                ///< Protège les fonctions en attente d'exécution
+    std::vector<std::function<void()>> posted_; ///< Fonctions à exécuter sur la boucle
+
+    // État propre au thread de la boucle
+    uint64_t nextId_ = 1;                   ///< Identifiant de la prochaine attente (0 = réveil)
+    std::unordered_map<uint64_t, Awaiter*> waiters_; ///< Attentes en cours
+    std::multimap<std::chrono::steady_clock::time_point, uint64_t> timers_; ///< Échéances des attentes
+
+    std::thread thread_;                    ///< Thread de la boucle
+};
+
+/**
+ * @class IoRuntime
+ * @brief Quelques boucles d'E/S partagées par tous les flux
+ *
+ * Chaque client confie sa coroutine à une boucle choisie à tour de rôle : quelques
+ * threads servent ainsi les rechargements de playlist, téléchargements et relances
+ * de milliers de chaînes.
+ */
+class IoRuntime {
+public:
+    /**
+     * @brief Crée les boucles
+     * @param threads Nombre de boucles (au moins 1)
+     */
+    explicit IoRuntime(int threads);
+
+    /**
+     * @brief Indique si la plateforme dispose des boucles d'E/S (epoll, Linux)
+     * @return true si un IoRuntime peut être créé
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Choisit la boucle de la prochaine coroutine (tour de rôle)
+     * @return Boucle
+     */
+    IoLoop& nextLoop();
+
+    /**
+     * @brief Récupère le nombre de boucles
+     * @return Nombre de threads d'E/S
+     */
+    size_t getLoopCount() const;
+
+private:
+    std::vector<std::unique_ptr<IoLoop>> loops_;    ///< Boucles d'E/S
+    std::atomic<size_t> next_{0};                   ///< Prochaine boucle attribuée
+};
+
+} // namespace hls_to_dvb
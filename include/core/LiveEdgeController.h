@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "MetricsRegistry.h"
+#include "SegmentTrace.h"
+
+namespace hls_to_dvb {
+
+/**
+ * @class LiveEdgeController
+ * @brief Mesure l'écart au direct d'un flux et le ramène vers une latence cible
+ *
+ * Chaque segment reçu est daté sur l'horloge du direct : l'instant de son apparition à
+ * l'origine est estimé à partir du premier segment reçu et de la durée de média reçue
+ * depuis, en suivant l'origine lorsqu'elle prend du retard. La latence mesurée à la
+ * diffusion est l'écart entre cet instant et la sortie du segment du tampon de gigue.
+ *
+ * Au-delà de la cible, deux politiques de rattrapage sont possibles :
+ * - SKIP : la récupération avance jusqu'au direct moins la cible avant de télécharger
+ *   (fetchExcessUs(), skipBeforeFetch()) ; les segments déjà reçus sont écartés avant
+ *   conversion, jusqu'à résorber le reste de l'excès. Le premier segment conservé est
+ *   converti comme une discontinuité HLS, ce qui signale correctement la rupture de PCR
+ *   et de compteurs de continuité ;
+ * - SPEEDUP : les segments sont diffusés légèrement plus vite que leur durée.
+ *
+ * fetchExcessUs() et skipBeforeFetch() sont appelées par la récupération des segments ;
+ * les autres méthodes, sauf les accesseurs, par le thread de traitement du flux.
+ */
+class LiveEdgeController {
+public:
+    /**
+     * @brief Politique de rattrapage du direct
+     */
+    enum class Policy {
+        SKIP,       ///< Sauter des segments (avec discontinuité)
+        SPEEDUP     ///< Diffuser plus vite que le temps réel
+    };
+
+    /**
+     * @brief Convertit une politique de la configuration
+     * @param policy Politique textuelle ("skip" ou "speedup")
+     * @return Politique (SKIP si le texte n'est pas reconnu)
+     */
+    static Policy parsePolicy(const std::string& policy);
+
+    /**
+     * @brief Constructeur
+     * @param targetMs Latence cible en millisecondes (0 = mesure seule, sans rattrapage)
+     * @param policy Politique de rattrapage
+     */
+    LiveEdgeController(int targetMs, Policy policy);
+
+    /**
+     * @brief Définit les mesures du flux alimentées par le contrôleur
+     * @param metrics Mesures du flux (nullptr pour ne rien exporter)
+     */
+    void setMetrics(std::shared_ptr<StreamMetrics> metrics);
+
+    /**
+     * @brief Mesure l'avance à prendre avant téléchargement pour revenir à la cible
+     * @return Excès de latence pas encore rattrapé (µs, 0 hors politique SKIP)
+     */
+    int64_t fetchExcessUs() const;
+
+    /**
+     * @brief Enregistre des segments sautés par la récupération, avant leur téléchargement
+     * @param skippedUs Durée de média sautée (µs)
+     * @param segments Nombre de segments sautés
+     */
+    void skipBeforeFetch(int64_t skippedUs, uint64_t segments);
+
+    /**
+     * @brief Date un segment reçu et décide s'il doit être diffusé
+     *
+     * @param trace Trace du segment (liveEdgeUs y est renseigné)
+     * @param durationSec Durée du segment en secondes
+     * @param discontinuity Indicateur de discontinuité du segment, forcé après un saut
+     * @param skippedBeforeSec Durée sautée par la récupération juste avant ce segment
+     *                         (secondes, négative si inconnue : l'horloge repart de ce segment)
+     * @return false si le segment doit être écarté avant conversion
+     */
+    bool admit(SegmentTrace& trace, double durationSec, bool& discontinuity, double skippedBeforeSec = 0.0);
+
+    /**
+     * @brief Mesure la latence d'un segment qui sort du tampon de gigue
+     * @param trace Trace du segment
+     * @return Vitesse de diffusion à appliquer au segment (1.0 = temps réel)
+     */
+    double onPlayout(const SegmentTrace& trace);
+
+    /**
+     * @brief Récupère la latence cible
+     * @return Latence cible en millisecondes (0 = pas de rattrapage)
+     */
+    int getTargetMs() const;
+
+    /**
+     * @brief Récupère la dernière latence mesurée
+     * @return Écart au direct en millisecondes (0 si aucune mesure)
+     */
+    int getLatencyMs() const;
+
+    /**
+     * @brief Récupère le nombre de segments sautés pour rattraper le direct
+     * @return Nombre de segments
+     */
+    uint64_t getSkippedSegments() const;
+
+    /**
+     * @brief Indique si un rattrapage est en cours
+     * @return true si des segments sont sautés ou diffusés en accéléré
+     */
+    bool isCatchingUp() const;
+
+private:
+    const int64_t targetUs_;                    ///< Latence cible (µs, 0 = pas de rattrapage)
+    const Policy policy_;                       ///< Politique de rattrapage
+    std::shared_ptr<StreamMetrics> metrics_;    ///< Mesures du flux
+
+    bool anchored_ = false;                     ///< Une référence d'horloge est disponible
+    int64_t anchorUs_ = 0;                      ///< Apparition estimée du premier segment
+    int64_t mediaUs_ = 0;                       ///< Durée de média reçue depuis la référence
+    std::atomic<int64_t> skippedPendingUs_{0};  ///< Média sauté pas encore visible à la diffusion
+    int64_t resumeEdgeUs_ = 0;                  ///< Premier segment conservé après un saut (0 = aucun)
+    bool skipping_ = false;                     ///< Le segment précédent a été sauté
+
+    std::atomic<int64_t> latencyUs_{0};         ///< Dernière latence mesurée
+    std::atomic<uint64_t> skippedSegments_{0};  ///< Segments sautés
+    std::atomic<bool> catchingUp_{false};       ///< Rattrapage en cours
+};
+
+} // namespace hls_to_dvb
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#include "Config.h"
+
+namespace hls_to_dvb {
+
+/**
+ * @class Logging
+ * @brief Journalisation asynchrone partagée par toute l'application
+ *
+ * Les threads du pipeline ne font que déposer leurs messages dans une file bornée ;
+ * le formatage et les écritures sur la console et dans le fichier ont lieu sur un
+ * thread dédié. Lorsque la file est pleine, la politique configurée écarte les plus
+ * anciens messages ou fait attendre l'appelant.
+ *
+ * Chaque composant dispose de son propre logger, dont le niveau peut être réglé
+ * séparément. Les appels SPDLOG_LOGGER_DEBUG et SPDLOG_LOGGER_TRACE des chemins
+ * critiques sont retirés à la compilation hors des builds Debug (SPDLOG_ACTIVE_LEVEL).
+ */
+class Logging {
+public:
+    /**
+     * @brief Crée le logger asynchrone par défaut à partir de la configuration
+     *
+     * Les loggers de composants déjà créés reçoivent les nouveaux sinks et leur niveau.
+     *
+     * @param config Configuration de la journalisation
+     * @return true si l'initialisation a réussi
+     */
+    static bool initialize(const LoggingConfig& config);
+
+    /**
+     * @brief Récupère (ou crée) le logger d'un composant
+     *
+     * Le pointeur renvoyé reste valide pendant toute l'exécution : les composants le
+     * conservent plutôt que de le rechercher à chaque message.
+     *
+     * @param component Nom du composant (affiché dans chaque message)
+     * @return Logger du composant
+     */
+    static std::shared_ptr<spdlog::logger> get(const std::string& component);
+
+    /**
+     * @brief Convertit un niveau de la configuration
+     * @param level Niveau textuel (trace, debug, info, warning, error, critical, off)
+     * @param fallback Niveau renvoyé si le texte n'est pas reconnu
+     * @return Niveau spdlog
+     */
+    static spdlog::level::level_enum parseLevel(const std::string& level,
+                                                spdlog::level::level_enum fallback = spdlog::level::info);
+
+    /**
+     * @brief Reporte le nombre de messages écartés dans le registre des mesures
+     */
+    static void updateMetrics();
+
+private:
+    /**
+     * @brief Calcule le niveau d'un composant
+     * @param component Nom du composant
+     * @return Niveau propre au composant, ou niveau global
+     */
+    static spdlog::level::level_enum componentLevel(const std::string& component);
+
+    static std::mutex mutex_;                                               ///< Protège l'état ci-dessous
+    static std::map<std::string, std::shared_ptr<spdlog::logger>> components_; ///< Loggers des composants
+    static LoggingConfig config_;                                           ///< Configuration appliquée
+    static size_t reportedDrops_;                                           ///< Messages écartés déjà reportés
+};
+
+} // namespace hls_to_dvb
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SegmentTrace.h"
+
+namespace hls_to_dvb {
+
+/**
+ * @brief Étiquettes d'une série de mesures (nom, valeur), dans l'ordre d'affichage
+ */
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @class Counter
+ * @brief Compteur monotone, incrémenté sans verrou
+ */
+class Counter {
+public:
+    /**
+     * @brief Incrémente le compteur
+     * @param value Valeur à ajouter
+     */
+    void increment(uint64_t value = 1) {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Lit la valeur courante
+     * @return Valeur du compteur
+     */
+    uint64_t get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_{0}; ///< Valeur du compteur
+};
+
+/**
+ * @class Gauge
+ * @brief Valeur instantanée, modifiée sans verrou
+ */
+class Gauge {
+public:
+    /**
+     * @brief Fixe la valeur
+     * @param value Nouvelle valeur
+     */
+    void set(double value) {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Ajoute une quantité (éventuellement négative) à la valeur
+     * @param delta Quantité à ajouter
+     */
+    void add(double delta) {
+        value_.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Lit la valeur courante
+     * @return Valeur de la jauge
+     */
+    double get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> value_{0.0}; ///< Valeur de la jauge
+};
+
+/**
+ * @class Histogram
+ * @brief Histogramme à classes fixes, alimenté sans verrou
+ *
+ * Chaque observation incrémente une seule classe ; les cumuls attendus par le format
+ * Prometheus sont calculés à la lecture.
+ */
+class Histogram {
+public:
+    /**
+     * @brief Constructeur
+     * @param bounds Limites supérieures des classes, croissantes (la classe +Inf est implicite)
+     */
+    explicit Histogram(std::vector<double> bounds);
+
+    /**
+     * @brief Enregistre une observation
+     * @param value Valeur observée
+     */
+    void observe(double value);
+
+    /**
+     * @brief Contenu de l'histogramme à un instant donné
+     */
+    struct Snapshot {
+        std::vector<double> bounds;         ///< Limites supérieures des classes
+        std::vector<uint64_t> cumulative;   ///< Observations inférieures ou égales à chaque limite, puis total
+        uint64_t count = 0;                 ///< Nombre d'observations
+        double sum = 0.0;                   ///< Somme des observations
+    };
+
+    /**
+     * @brief Lit le contenu de l'histogramme
+     * @return Contenu cumulé
+     */
+    Snapshot snapshot() const;
+
+private:
+    std::vector<double> bounds_;                        ///< Limites supérieures des classes
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;  ///< Observations par classe (dernière = +Inf)
+    std::atomic<double> sum_{0.0};                      ///< Somme des observations
+};
+
+/**
+ * @brief Consommation du processus, relevée à la demande
+ */
+struct ProcessUsage {
+    double cpuSeconds = 0.0;        ///< Temps CPU cumulé (utilisateur + système)
+    double cpuUsage = 0.0;          ///< Part de cœurs utilisée entre les deux derniers relevés (1.0 = un cœur)
+    uint64_t residentBytes = 0;     ///< Mémoire résidente
+    uint64_t virtualBytes = 0;      ///< Mémoire virtuelle
+    int threads = 0;                ///< Nombre de threads
+};
+
+/**
+ * @struct StreamMetrics
+ * @brief Mesures d'un flux, partagées par les composants de son pipeline
+ *
+ * Les composants reçoivent ce jeu de mesures à leur création et l'alimentent depuis
+ * leurs propres threads, sans passer par le StreamManager ni par ses verrous.
+ */
+struct StreamMetrics {
+    std::string streamId;                           ///< Identifiant du flux (étiquette des mesures)
+
+    std::shared_ptr<Counter> fetchSegments;         ///< Segments récupérés
+    std::shared_ptr<Counter> fetchBytes;            ///< Octets récupérés
+    std::shared_ptr<Counter> fetchErrors;           ///< Erreurs de lecture HLS
+    std::shared_ptr<Histogram> fetchSeconds;        ///< Durée de récupération d'un segment
+    std::shared_ptr<Histogram> fetchQueueSeconds;   ///< Attente d'un créneau de requête auprès de l'origine
+
+    std::shared_ptr<Counter> convertSegments;       ///< Segments convertis
+    std::shared_ptr<Counter> convertErrors;         ///< Échecs de conversion
+    std::shared_ptr<Histogram> convertSeconds;      ///< Durée de conversion d'un segment
+
+    std::shared_ptr<Gauge> bufferDepthSeconds;      ///< Profondeur du tampon de gigue
+    std::shared_ptr<Gauge> bufferTargetSeconds;     ///< Profondeur cible du tampon de gigue
+    std::shared_ptr<Counter> bufferUnderruns;       ///< Sous-remplissages du tampon
+    std::shared_ptr<Counter> bufferOverruns;        ///< Débordements du tampon
+
+    std::shared_ptr<Counter> sendPackets;           ///< Datagrammes envoyés
+    std::shared_ptr<Counter> sendBytes;             ///< Octets envoyés
+    std::shared_ptr<Counter> sendErrors;            ///< Erreurs d'envoi
+    std::shared_ptr<Gauge> sendBitrate;             ///< Débit d'émission (bits/s)
+
+    std::shared_ptr<SegmentTracer> tracer;          ///< Latences par étape et dernières traces de segments
+
+    std::shared_ptr<Gauge> startupSeconds;          ///< Délai entre la demande de démarrage et le premier datagramme
+    std::atomic<int64_t> startRequestedUs{0};       ///< Demande de démarrage en attente du premier datagramme (µs, 0 = aucune)
+
+    std::shared_ptr<Gauge> liveLatencySeconds;      ///< Écart au direct à la sortie du tampon de gigue
+    std::shared_ptr<Counter> catchUpSkips;          ///< Segments sautés pour rattraper le direct
+
+    std::shared_ptr<Histogram> fetchRecoverySeconds;    ///< Durée des reprises de la récupération HLS
+    std::shared_ptr<Histogram> convertRecoverySeconds;  ///< Durée des reprises de la conversion
+    std::shared_ptr<Histogram> sendRecoverySeconds;     ///< Durée des reprises de l'émission multicast
+
+    /**
+     * @brief Crée (ou retrouve) les mesures d'un flux dans le registre global
+     * @param streamId Identifiant du flux
+     * @return Jeu de mesures
+     */
+    static std::shared_ptr<StreamMetrics> create(const std::string& streamId);
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Registre global des mesures, exporté au format texte Prometheus
+ *
+ * L'enregistrement d'une série prend le verrou du registre ; il n'a lieu qu'à la création
+ * des flux. Les mises à jour se font ensuite directement sur les compteurs atomiques et
+ * l'export ne lit que ces compteurs : aucune collecte ne bloque le pipeline.
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief Récupère l'instance unique du registre
+     * @return Référence vers le registre
+     */
+    static MetricsRegistry& getInstance();
+
+    /**
+     * @brief Crée ou retrouve un compteur
+     * @param name Nom de la mesure
+     * @param help Description
+     * @param labels Étiquettes de la série
+     * @return Compteur
+     */
+    std::shared_ptr<Counter> counter(const std::string& name, const std::string& help,
+                                     const MetricLabels& labels = {});
+
+    /**
+     * @brief Crée ou retrouve une jauge
+     * @param name Nom de la mesure
+     * @param help Description
+     * @param labels Étiquettes de la série
+     * @return Jauge
+     */
+    std::shared_ptr<Gauge> gauge(const std::string& name, const std::string& help,
+                                 const MetricLabels& labels = {});
+
+    /**
+     * @brief Crée ou retrouve un histogramme
+     * @param name Nom de la mesure
+     * @param help Description
+     * @param bounds Limites supérieures des classes (ignorées si la série existe déjà)
+     * @param labels Étiquettes de la série
+     * @return Histogramme
+     */
+    std::shared_ptr<Histogram> histogram(const std::string& name, const std::string& help,
+                                         const std::vector<double>& bounds,
+                                         const MetricLabels& labels = {});
+
+    /**
+     * @brief Supprime toutes les séries portant une étiquette donnée
+     * @param labelName Nom de l'étiquette
+     * @param labelValue Valeur de l'étiquette
+     */
+    void removeSeries(const std::string& labelName, const std::string& labelValue);
+
+    /**
+     * @brief Produit l'export au format texte Prometheus (version 0.0.4)
+     * @return Texte de l'export
+     */
+    std::string renderPrometheus();
+
+    /**
+     * @brief Relève la consommation CPU et mémoire du processus
+     * @return Consommation du processus
+     */
+    ProcessUsage sampleProcessUsage();
+
+private:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * @brief Type de mesure d'une famille
+     */
+    enum class MetricType {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    /**
+     * @brief Série d'une famille: étiquettes et mesure associée
+     */
+    struct Series {
+        MetricLabels labels;                    ///< Étiquettes
+        std::shared_ptr<Counter> counter;       ///< Compteur (famille COUNTER)
+        std::shared_ptr<Gauge> gauge;           ///< Jauge (famille GAUGE)
+        std::shared_ptr<Histogram> histogram;   ///< Histogramme (famille HISTOGRAM)
+    };
+
+    /**
+     * @brief Famille de séries partageant un nom
+     */
+    struct Family {
+        std::string help;                       ///< Description
+        MetricType type;                        ///< Type de mesure
+        std::vector<Series> series;             ///< Séries de la famille
+    };
+
+    /**
+     * @brief Trouve ou crée une série (registryMutex_ déjà verrouillé)
+     * @param name Nom de la famille
+     * @param help Description
+     * @param type Type de mesure
+     * @param labels Étiquettes de la série
+     * @return Série
+     */
+    Series& findOrCreateInternal(const std::string& name, const std::string& help, MetricType type,
+                                 const MetricLabels& labels);
+
+    std::mutex registryMutex_;                  ///< Protège la liste des familles
+    std::map<std::string, Family> families_;    ///< Familles par nom
+
+    std::mutex processMutex_;                   ///< Protège le relevé précédent du processus
+    double lastCpuSeconds_ = 0.0;               ///< Temps CPU au relevé précédent
+    double lastCpuUsage_ = 0.0;                 ///< Dernière part de cœurs calculée
+    std::chrono::steady_clock::time_point lastSample_; ///< Instant du relevé précédent
+    bool hasLastSample_ = false;                ///< Un relevé précédent existe
+};
+
+} // namespace hls_to_dvb
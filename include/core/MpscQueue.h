@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace hls_to_dvb {
+
+/**
+ * @class MpscQueue
+ * @brief File bornée sans verrou, plusieurs producteurs et un seul consommateur
+ *
+ * Chaque case porte un numéro de séquence qui indique si elle est libre pour le
+ * prochain producteur ou prête pour le consommateur. Un producteur ne bloque jamais :
+ * lorsque la file est pleine, tryPush échoue et l'élément est refusé.
+ *
+ * @tparam T Type des éléments (déplaçable, constructible par défaut)
+ */
+template <typename T>
+class MpscQueue {
+public:
+    /**
+     * @brief Constructeur
+     * @param capacity Capacité, arrondie à la puissance de deux supérieure
+     */
+    explicit MpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_ = std::make_unique<Slot[]>(size);
+        for (size_t i = 0; i < size; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Ajoute un élément (tout thread)
+     * @param value Élément, déplacé seulement en cas de succès
+     * @return false si la file est pleine
+     */
+    bool tryPush(T&& value) {
+        size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[position & mask_];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0) {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Retire le plus ancien élément (thread consommateur uniquement)
+     * @param value Élément retiré
+     * @return false si la file est vide
+     */
+    bool tryPop(T& value) {
+        Slot& slot = slots_[dequeuePosition_ & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition_ + 1) < 0) {
+            return false;
+        }
+
+        value = std::move(slot.value);
+        slot.value = T();
+        slot.sequence.store(dequeuePosition_ + mask_ + 1, std::memory_order_release);
+        dequeuePosition_++;
+        return true;
+    }
+
+private:
+    /**
+     * @brief Case de la file
+     */
+    struct Slot {
+        std::atomic<size_t> sequence{0};    ///< Position attendue par le prochain accès
+        T value{};                          ///< Élément stocké
+    };
+
+    std::unique_ptr<Slot[]> slots_;                 ///< Cases de la file
+    size_t mask_ = 0;                               ///< Capacité - 1
+    alignas(64) std::atomic<size_t> enqueuePosition_{0}; ///< Prochaine position d'écriture (producteurs)
+    alignas(64) size_t dequeuePosition_ = 0;        ///< Prochaine position de lecture (consommateur)
+};
+
+} // namespace hls_to_dvb
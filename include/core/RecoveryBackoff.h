@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace hls_to_dvb {
+
+/**
+ * @class RecoveryBackoff
+ * @brief Délais de reprise exponentiels avec gigue pour une étape du pipeline
+ *
+ * Une étape en échec est relancée presque immédiatement, puis à des intervalles qui
+ * doublent à chaque échec jusqu'à un plafond. Une part aléatoire du délai évite que
+ * toutes les chaînes d'une même origine ne la sollicitent au même instant après une
+ * coupure commune. Le premier échec d'une série date le début de l'incident, ce qui
+ * permet de mesurer la durée de la reprise une fois l'étape rétablie.
+ *
+ * Non synchronisée : chaque instance appartient au thread qui relance l'étape.
+ */
+class RecoveryBackoff {
+public:
+    /**
+     * @brief Constructeur
+     * @param initialDelayMs Délai avant la première relance
+     * @param maxDelayMs Délai maximal entre deux relances
+     * @param jitter Part aléatoire du délai (0.0 à 1.0)
+     */
+    RecoveryBackoff(int initialDelayMs = 100, int maxDelayMs = 5000, double jitter = 0.2);
+
+    /**
+     * @brief Enregistre un échec et calcule le délai avant la relance suivante
+     * @return Délai à attendre avant de relancer l'étape
+     */
+    std::chrono::milliseconds fail();
+
+    /**
+     * @brief Indique si la relance programmée peut avoir lieu
+     * @return true si aucun échec n'est en cours ou si le délai est écoulé
+     */
+    bool isDue() const;
+
+    /**
+     * @brief Enregistre le rétablissement de l'étape et termine la série d'échecs
+     * @return Durée de l'incident en secondes (0 si aucun échec n'était en cours)
+     */
+    double succeed();
+
+    /**
+     * @brief Indique si une série d'échecs est en cours
+     * @return true si l'étape n'est pas encore rétablie
+     */
+    bool isRecovering() const;
+
+    /**
+     * @brief Récupère le nombre d'échecs de la série en cours
+     * @return Nombre d'échecs consécutifs
+     */
+    int getAttempts() const;
+
+private:
+    int initialDelayMs_;                                    ///< Délai avant la première relance
+    int maxDelayMs_;                                        ///< Plafond des délais
+    double jitter_;                                         ///< Part aléatoire du délai
+    int attempts_ = 0;                                      ///< Échecs consécutifs
+    std::chrono::steady_clock::time_point failedSince_;     ///< Premier échec de la série
+    std::chrono::steady_clock::time_point nextAttempt_;     ///< Instant de la prochaine relance
+    std::minstd_rand random_;                               ///< Générateur de la gigue
+};
+
+} // namespace hls_to_dvb
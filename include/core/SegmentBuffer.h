@@ -1,35 +1,72 @@
 #pragma once
 
 #include "../mpegts/MPEGTSConverter.h"
+#include "BufferAccountant.h"
+#include "Logging.h"
+#include "MetricsRegistry.h"
 
 #include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
 
 /**
  * @class SegmentBuffer
- * @brief Buffer circulaire pour les segments MPEG-TS
- * 
+ * @brief Tampon de gigue pour les segments MPEG-TS
+ *
  * Gère un tampon de segments MPEG-TS avec synchronisation pour l'accès concurrent.
- * Permet de compenser les variations de latence du réseau et d'assurer une lecture fluide.
+ * La profondeur du tampon est exprimée en millisecondes de média : la profondeur cible
+ * s'adapte à la variance observée des temps d'arrivée des segments, entre les bornes
+ * minimale et maximale configurées. Le nombre de segments reste borné par bufferSize.
  */
 class SegmentBuffer {
 public:
     /**
      * @brief Constructeur
-     * @param bufferSize Taille maximale du buffer (nombre de segments)
+     * @param bufferSize Nombre maximal de segments conservés (limite de sécurité)
+     * @param minDepthMs Profondeur minimale du tampon de gigue en millisecondes
+     * @param maxDepthMs Profondeur maximale du tampon de gigue en millisecondes
      */
-    explicit SegmentBuffer(size_t bufferSize = 3);
-    
+    explicit SegmentBuffer(size_t bufferSize = 3, int minDepthMs = 2000, int maxDepthMs = 12000);
+
+    /**
+     * @brief Destructeur, restitue au budget mémoire les octets encore en tampon
+     */
+    ~SegmentBuffer();
+
+    /**
+     * @brief Associe le tampon au compte mémoire de son flux
+     * @param account Compte mémoire du flux (nullptr pour ne pas comptabiliser)
+     */
+    void setBufferAccount(std::shared_ptr<hls_to_dvb::StreamBufferAccount> account);
+
+    /**
+     * @brief Définit les mesures du flux alimentées par le tampon
+     * @param metrics Mesures du flux (nullptr pour ne rien exporter)
+     */
+    void setMetrics(std::shared_ptr<hls_to_dvb::StreamMetrics> metrics);
+
     /**
      * @brief Ajoute un segment au buffer
+     *
+     * Met à jour l'estimation de gigue à partir de l'heure d'arrivée du segment et
+     * supprime les segments les plus anciens si la profondeur maximale est dépassée.
+     *
      * @param segment Segment à ajouter
      * @return true si le segment a été ajouté avec succès
      */
     bool pushSegment(const MPEGTSSegment& segment);
-    
+
+    /**
+     * @brief Ajoute un segment au buffer sans copier ses données
+     * @param segment Segment à ajouter
+     * @return true si le segment a été ajouté avec succès
+     */
+    bool pushSegment(MPEGTSSegment&& segment);
+
     /**
      * @brief Récupère le segment suivant du buffer
      * @param segment Référence pour stocker le segment récupéré
@@ -37,33 +74,135 @@ public:
      * @return true si un segment a été récupéré
      */
     bool getSegment(MPEGTSSegment& segment, int timeout = 0);
-    
+
+    /**
+     * @brief Récupère le segment suivant pour la diffusion, selon l'état du tampon de gigue
+     *
+     * Aucun segment n'est délivré tant que la profondeur cible n'a pas été atteinte.
+     * Un tampon vide au moment de la diffusion est comptabilisé comme un sous-remplissage
+     * et déclenche un nouveau remplissage jusqu'à la profondeur cible.
+     *
+     * @param segment Référence pour stocker le segment récupéré
+     * @return true si un segment doit être diffusé
+     */
+    bool popForPlayout(MPEGTSSegment& segment);
+
     /**
      * @brief Définit la taille maximale du buffer
      * @param bufferSize Nouvelle taille du buffer
      */
     void setBufferSize(size_t bufferSize);
-    
+
     /**
      * @brief Récupère la taille maximale du buffer
      * @return Taille maximale du buffer
      */
     size_t getBufferSize() const;
-    
+
     /**
      * @brief Récupère le nombre actuel de segments dans le buffer
      * @return Nombre de segments dans le buffer
      */
     size_t getCurrentSize() const;
-    
+
+    /**
+     * @brief Définit les bornes de profondeur du tampon de gigue
+     * @param minDepthMs Profondeur minimale en millisecondes
+     * @param maxDepthMs Profondeur maximale en millisecondes
+     */
+    void setDepthBounds(int minDepthMs, int maxDepthMs);
+
+    /**
+     * @brief Récupère la profondeur actuelle du tampon
+     * @return Durée de média présente dans le tampon en millisecondes
+     */
+    int getCurrentDepthMs() const;
+
+    /**
+     * @brief Récupère la profondeur cible calculée à partir de la gigue observée
+     * @return Profondeur cible en millisecondes
+     */
+    int getTargetDepthMs() const;
+
+    /**
+     * @brief Récupère l'estimation courante de la gigue d'arrivée des segments
+     * @return Gigue estimée en millisecondes
+     */
+    double getJitterMs() const;
+
+    /**
+     * @brief Récupère le nombre de sous-remplissages (tampon vide lors de la diffusion)
+     * @return Nombre de sous-remplissages
+     */
+    uint64_t getUnderrunCount() const;
+
+    /**
+     * @brief Récupère le nombre de débordements (segments supprimés faute de place)
+     * @return Nombre de débordements
+     */
+    uint64_t getOverrunCount() const;
+
     /**
      * @brief Vide le buffer
      */
     void clear();
-    
+
 private:
+    /**
+     * @brief Met à jour l'estimation de gigue et la profondeur cible (mutex déjà verrouillé)
+     * @param arrival Heure d'arrivée du segment
+     * @param segment Segment reçu
+     */
+    void updateJitterEstimateInternal(std::chrono::steady_clock::time_point arrival,
+                                      const MPEGTSSegment& segment);
+
+    /**
+     * @brief Ramène une profondeur cible à ce que le tampon peut contenir (mutex déjà verrouillé)
+     *
+     * Le tampon ne garde que bufferSize segments, et pas plus de maxDepthMs segment
+     * entrant compris : une cible au-delà ne serait jamais atteinte et la diffusion
+     * ne s'amorcerait pas.
+     *
+     * @param targetMs Profondeur cible souhaitée
+     * @return Profondeur cible atteignable
+     */
+    int reachableTargetInternal(int targetMs) const;
+
+    /**
+     * @brief Retire le segment le plus ancien (mutex déjà verrouillé)
+     * @param segment Destination du segment retiré (nullptr pour le supprimer)
+     */
+    void dropOldestInternal(MPEGTSSegment* segment = nullptr);
+
+    /**
+     * @brief Reporte la profondeur courante et la cible dans les mesures du flux (mutex déjà verrouillé)
+     */
+    void publishDepthInternal();
+
     std::deque<MPEGTSSegment> buffer_;         ///< Buffer de segments
-    std::atomic<size_t> bufferSize_;            ///< Taille maximale du buffer
+    std::atomic<size_t> bufferSize_;            ///< Nombre maximal de segments
     mutable std::mutex mutex_;                   ///< Mutex pour l'accès concurrent
     std::condition_variable conditionVar_;      ///< Variable de condition pour l'attente
+
+    int minDepthMs_;                            ///< Profondeur minimale configurée
+    int maxDepthMs_;                            ///< Profondeur maximale configurée
+    std::atomic<int> depthMs_;                  ///< Profondeur actuelle en millisecondes
+    std::atomic<int> targetDepthMs_;            ///< Profondeur cible adaptative
+    bool primed_;                               ///< Profondeur cible atteinte, diffusion autorisée
+    int segmentMs_;                             ///< Durée du dernier segment reçu
+
+    bool hasTransitReference_;                  ///< Une référence d'arrivée est disponible
+    std::chrono::steady_clock::time_point referenceArrival_; ///< Arrivée du premier segment de la référence
+    double mediaTimeMs_;                        ///< Temps média cumulé depuis la référence
+    double minTransitMs_;                       ///< Plus petit décalage arrivée/temps média observé
+    double latenessMeanMs_;                     ///< Moyenne glissante du retard d'arrivée
+    double latenessVarMs2_;                     ///< Variance glissante du retard d'arrivée
+
+    std::atomic<uint64_t> underrunCount_;       ///< Nombre de sous-remplissages
+    std::atomic<uint64_t> overrunCount_;        ///< Nombre de débordements
+
+    std::shared_ptr<hls_to_dvb::StreamBufferAccount> bufferAccount_; ///< Compte mémoire du flux
+    std::shared_ptr<hls_to_dvb::StreamMetrics> metrics_; ///< Mesures du flux
+    size_t bytesHeld_;                          ///< Octets de données en tampon
+    std::shared_ptr<spdlog::logger> log_;       ///< Logger du composant (chemins critiques)
 };
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hls_to_dvb {
+
+/**
+ * @struct SegmentTrace
+ * @brief Horodatages d'un segment à chaque étape de son parcours dans le pipeline
+ *
+ * Les instants sont exprimés en microsecondes sur l'horloge monotone (0 = non renseigné).
+ * La trace accompagne le segment de la playlist jusqu'au dernier datagramme émis.
+ */
+struct SegmentTrace {
+    int sequenceNumber = 0;         ///< Numéro de séquence du segment
+    size_t bytes = 0;               ///< Taille du segment émis
+    bool discontinuity = false;     ///< Le segment suit une discontinuité
+    int64_t playlistSeenUs = 0;     ///< Première apparition dans la playlist
+    int64_t downloadStartUs = 0;    ///< Début de la récupération
+    int64_t downloadEndUs = 0;      ///< Fin de la récupération
+    int64_t convertStartUs = 0;     ///< Début de la conversion
+    int64_t convertEndUs = 0;       ///< Fin de la conversion
+    int64_t bufferEnqueueUs = 0;    ///< Entrée dans le tampon de gigue
+    int64_t bufferDequeueUs = 0;    ///< Sortie du tampon de gigue
+    int64_t firstDatagramUs = 0;    ///< Émission du premier datagramme
+    int64_t lastDatagramUs = 0;     ///< Émission du dernier datagramme
+    int64_t liveEdgeUs = 0;         ///< Apparition estimée du segment au direct de l'origine
+
+    /**
+     * @brief Instant présent sur l'horloge des traces
+     * @return Microsecondes sur l'horloge monotone
+     */
+    static int64_t nowUs();
+};
+
+/**
+ * @brief Intervalles mesurés entre deux horodatages d'une trace
+ */
+enum class TraceStage {
+    PLAYLIST_WAIT = 0,  ///< Apparition dans la playlist -> début de récupération
+    DOWNLOAD,           ///< Récupération du segment
+    FETCH_QUEUE,        ///< Attente dans la file du client HLS
+    CONVERT,            ///< Conversion MPEG-TS
+    BUFFER,             ///< Séjour dans le tampon de gigue
+    SEND_QUEUE,         ///< Attente dans la file d'émission
+    SEND,               ///< Émission (premier -> dernier datagramme)
+    TOTAL,              ///< Première étape renseignée -> dernier datagramme
+    COUNT               ///< Nombre d'intervalles (doit rester en dernier)
+};
+
+/**
+ * @brief Nombre d'intervalles mesurés
+ */
+constexpr size_t TRACE_STAGE_COUNT = static_cast<size_t>(TraceStage::COUNT);
+
+/**
+ * @brief Retourne le nom d'un intervalle
+ * @param stage Intervalle
+ * @return Nom de l'intervalle (utilisé dans l'API)
+ */
+const char* traceStageName(TraceStage stage);
+
+/**
+ * @brief Résumé d'une distribution de latences
+ */
+struct LatencySummary {
+    uint64_t count = 0;     ///< Nombre de mesures
+    double meanMs = 0.0;    ///< Moyenne
+    double p50Ms = 0.0;     ///< Médiane
+    double p90Ms = 0.0;     ///< 90e centile
+    double p99Ms = 0.0;     ///< 99e centile
+    double p999Ms = 0.0;    ///< 99,9e centile
+    double maxMs = 0.0;     ///< Maximum
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Histogramme de latences à précision relative constante (type HDR)
+ *
+ * Chaque puissance de deux est divisée en 16 classes linéaires, soit une erreur relative
+ * inférieure à 6 % de la microseconde à plusieurs heures. L'enregistrement se fait sans
+ * verrou et la mémoire reste fixe quel que soit le nombre de mesures.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Enregistre une mesure
+     * @param valueUs Latence en microsecondes (les valeurs négatives sont ramenées à 0)
+     */
+    void record(int64_t valueUs);
+
+    /**
+     * @brief Calcule le résumé de la distribution
+     * @return Résumé
+     */
+    LatencySummary summarize() const;
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;                           ///< 16 classes par puissance de deux
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_MAGNITUDE = 35;                            ///< 2^35 µs, environ 9 heures
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /**
+     * @brief Indice de la classe d'une valeur
+     */
+    static size_t bucketIndex(uint64_t valueUs);
+
+    /**
+     * @brief Valeur représentative (milieu) d'une classe
+     */
+    static double bucketValue(size_t index);
+
+    std::array<std::atomic<uint32_t>, BUCKET_COUNT> buckets_;  ///< Mesures par classe
+    std::atomic<uint64_t> count_;                               ///< Nombre de mesures
+    std::atomic<uint64_t> sumUs_;                               ///< Somme des mesures
+    std::atomic<uint64_t> maxUs_;                               ///< Plus grande mesure
+};
+
+/**
+ * @class SegmentTracer
+ * @brief Agrège les traces des segments émis par un flux
+ *
+ * Le thread d'émission transmet la trace de chaque segment après son dernier datagramme.
+ * Chaque intervalle alimente un histogramme de latences ; les dernières traces sont
+ * conservées pour être exportées (format Chrome trace-event) lors d'un incident.
+ */
+class SegmentTracer {
+public:
+    /**
+     * @brief Constructeur
+     * @param streamId Identifiant du flux
+     * @param capacity Nombre de traces conservées
+     */
+    explicit SegmentTracer(const std::string& streamId, size_t capacity = 256);
+
+    /**
+     * @brief Enregistre la trace complète d'un segment
+     * @param trace Trace du segment
+     */
+    void record(const SegmentTrace& trace);
+
+    /**
+     * @brief Résume les latences de chaque intervalle
+     * @return Résumés indexés par TraceStage
+     */
+    std::array<LatencySummary, TRACE_STAGE_COUNT> getStageSummaries() const;
+
+    /**
+     * @brief Récupère les dernières traces, de la plus ancienne à la plus récente
+     * @param limit Nombre maximal de traces
+     * @return Traces
+     */
+    std::vector<SegmentTrace> getRecentTraces(size_t limit) const;
+
+    /**
+     * @brief Récupère l'identifiant du flux
+     * @return Identifiant du flux
+     */
+    const std::string& getStreamId() const;
+
+private:
+    std::string streamId_;                                      ///< Identifiant du flux
+    std::array<LatencyHistogram, TRACE_STAGE_COUNT> stages_;    ///< Histogramme par intervalle
+
+    mutable std::mutex ringMutex_;                              ///< Protège l'anneau des traces
+    std::vector<SegmentTrace> ring_;                            ///< Dernières traces
+    size_t ringNext_;                                           ///< Prochain emplacement à écrire
+    size_t ringSize_;                                           ///< Traces présentes dans l'anneau
+};
+
+} // namespace hls_to_dvb
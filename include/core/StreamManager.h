@@ -6,10 +6,16 @@
 #include "../mpegts/TSQualityMonitor.h"
 #include "../multicast/MulticastSender.h"
 #include "../core/SegmentBuffer.h"
+#include "Logging.h"
+#include "StreamStateFile.h"
+#include "LiveEdgeController.h"
+#include "RecoveryBackoff.h"
 
 // Ajouter ceci si MulticastSender est dans l'espace de noms hls_to_dvb
 using hls_to_dvb::MulticastSender;
 
+#include <functional>
+#include <map>
 #include <unordered_map>
 #include <memory>
 #include <thread>
@@ -19,6 +25,19 @@ using hls_to_dvb::MulticastSender;
 
 namespace hls_to_dvb {
 
+/**
+ * @struct FanOutGroup
+ * @brief Sorties alimentées par la récupération et la conversion d'un autre flux
+ *
+ * Les flux dont l'entrée HLS et les réglages de traitement sont identiques partagent
+ * un seul pipeline : le flux qui l'a démarré transmet chaque segment converti, sans
+ * copie, aux émetteurs multicast des flux abonnés.
+ */
+struct FanOutGroup {
+    std::mutex mutex;                                                    ///< Protège les sorties
+    std::map<std::string, std::shared_ptr<MulticastSender>> outputs;     ///< Sorties abonnées (ID du flux -> émetteur)
+};
+
 /**
  * @struct StreamInstance
  * @brief Représente une instance de flux en cours d'exécution
@@ -31,6 +50,16 @@ struct StreamInstance {
     std::shared_ptr<SegmentBuffer> segmentBuffer;    ///< Buffer de segments
     std::shared_ptr<MulticastSender> multicastSender; ///< Émetteur multicast
     std::shared_ptr<TSQualityMonitor> qualityMonitor;   
+    std::shared_ptr<StreamBufferAccount> bufferAccount; ///< Compte mémoire des tampons du flux
+    std::shared_ptr<BufferPool> bufferPool;          ///< Réserve de tampons recyclés entre les étapes du flux
+    std::shared_ptr<StreamMetrics> metrics;          ///< Mesures exportées du flux
+    std::shared_ptr<StreamStateFile> stateFile;      ///< Point de reprise de l'état de sortie du flux
+    std::shared_ptr<LiveEdgeController> liveEdge;    ///< Mesure et rattrapage de l'écart au direct
+    RecoveryBackoff fetchRecovery;                   ///< Relances de la récupération HLS
+    RecoveryBackoff convertRecovery;                 ///< Relances du convertisseur
+    RecoveryBackoff sendRecovery;                    ///< Relances de l'émetteur multicast
+    std::shared_ptr<FanOutGroup> fanOut;             ///< Sorties abonnées au pipeline de ce flux
+    std::string ingestSourceId;                      ///< Flux dont le pipeline alimente celui-ci (vide = pipeline propre)
     std::shared_ptr<std::atomic<bool>> running;      ///< État du flux (en cours d'exécution ou non)
     std::thread processingThread;                    ///< Thread de traitement du flux
 
@@ -106,12 +135,37 @@ public:
         size_t discontinuitiesDetected = 0; ///< Nombre de discontinuités détectées
         size_t bufferSize = 0;              ///< Taille actuelle du buffer
         size_t bufferCapacity = 0;          ///< Capacité maximale du buffer
+        int bufferDepthMs = 0;              ///< Profondeur actuelle du tampon de gigue (ms)
+        int bufferTargetMs = 0;             ///< Profondeur cible du tampon de gigue (ms)
+        double bufferJitterMs = 0.0;        ///< Gigue d'arrivée estimée (ms)
+        uint64_t bufferUnderruns = 0;       ///< Nombre de sous-remplissages du tampon
+        uint64_t bufferOverruns = 0;        ///< Nombre de débordements du tampon
+        size_t hlsQueueBytes = 0;           ///< Octets dans la file du client HLS
+        size_t segmentBufferBytes = 0;      ///< Octets dans le tampon de gigue
+        size_t multicastQueueBytes = 0;     ///< Octets dans la file d'émission multicast
+        size_t memoryBytes = 0;             ///< Total des octets en tampon pour le flux
+        uint64_t poolHeapAllocations = 0;   ///< Tampons alloués faute de tampon recyclé
+        uint64_t poolReuses = 0;            ///< Tampons servis par la réserve
+        double poolAllocationsPerSegment = 0.0; ///< Allocations moyennes par segment
+        size_t poolPooledBytes = 0;         ///< Octets disponibles dans la réserve
+        size_t poolPeakPooledBytes = 0;     ///< Pic d'octets disponibles dans la réserve
+        bool passthroughActive = false;     ///< Segments transmis sans réécriture PSI/SI
+        uint64_t passthroughSegments = 0;   ///< Nombre de segments transmis en passthrough
+        std::string passthroughFallbackReason; ///< Raison du repli sur la conversion complète
+        int liveLatencyMs = 0;              ///< Écart au direct des segments diffusés (ms)
+        uint64_t catchUpSkips = 0;          ///< Segments sautés pour rattraper le direct
+        bool catchingUp = false;            ///< Rattrapage du direct en cours
+        std::string ingestSourceId;         ///< Flux dont la récupération est partagée (vide = récupération propre)
+        size_t fanOutOutputs = 0;           ///< Autres flux alimentés par la récupération de ce flux
         size_t packetsTransmitted = 0;      ///< Nombre de paquets transmis
+        size_t outputs = 0;                 ///< Destinations alimentées (principale comprise)
+        uint64_t outputErrors = 0;          ///< Erreurs d'envoi vers les destinations supplémentaires
         double currentBitrate = 0.0;        ///< Débit actuel (bits/s)
         int width = 0;                      ///< Largeur de la vidéo
         int height = 0;                     ///< Hauteur de la vidéo
         int bandwidth = 0;                  ///< Bande passante en bits/s
         std::string codecs;                 ///< Codecs utilisés
+        std::vector<HLSOriginStats> origins; ///< Origines HLS du flux (principale en tête)
     };
 
     
@@ -123,6 +177,12 @@ public:
      */
     std::optional<StreamStats> getStreamStats(const std::string& streamId) const;
     
+    /**
+     * @brief Récupère les traceurs de segments des flux en cours
+     * @return Traceurs indexés par ID de flux
+     */
+    std::map<std::string, std::shared_ptr<SegmentTracer>> getSegmentTracers() const;
+    
     /**
      * @brief Ajuste la taille du buffer d'un flux
      * @param streamId ID du flux
@@ -149,6 +209,8 @@ private:
     mutable std::mutex streamsMutex_; ///< Mutex pour l'accès concurrent aux flux
     
     std::atomic<bool> running_; ///< État du gestionnaire
+    std::shared_ptr<IoRuntime> ioRuntime_; ///< Runtime d'E/S partagé de la récupération HLS (nullptr = un thread par flux)
+    std::shared_ptr<spdlog::logger> log_; ///< Logger du composant (boucles de traitement)
     
     /**
      * @brief Fonction exécutée dans le thread de traitement d'un flux
@@ -156,21 +218,95 @@ private:
      */
     void processStream(const std::string& streamId);
 
+    /**
+     * @brief Calcule la clé de partage du pipeline d'un flux
+     *
+     * Deux flux de même clé produisent exactement les mêmes segments convertis.
+     *
+     * @param config Configuration du flux
+     * @return Clé construite à partir de l'entrée et des réglages de traitement
+     */
+    static std::string ingestKey(const StreamConfig& config);
+    
+    /**
+     * @brief Abonne un flux au pipeline d'un flux en cours de même entrée
+     * @param streamId ID du flux à démarrer
+     * @param config Configuration du flux
+     * @return nullopt si aucun pipeline ne peut être partagé, sinon le succès du démarrage
+     */
+    std::optional<bool> attachToSharedIngest(const std::string& streamId, const StreamConfig& config);
+    
+    /**
+     * @brief Associe les composants d'un flux à son compte mémoire et à sa réserve de tampons
+     * @param stream Instance de flux dont les composants sont déjà créés
+     */
+    void attachStreamResources(StreamInstance& stream);
+
         /**
      * @brief Traite un segment HLS (conversion et envoi multicast)
      * @param stream Pointeur vers l'instance de flux
      * @param hlsSegment Segment HLS à traiter
      * @param segmentInProgress Référence vers l'indicateur de segment en cours
      * @param sendStartTime Référence vers l'horodatage de début d'envoi
+     * @param playoutDuration Référence vers la durée du segment en cours de diffusion (s)
      * @return true si le traitement a réussi
      */
-    bool processSegment(StreamInstance* stream, const HLSSegment& hlsSegment, 
-                       bool& segmentInProgress, std::chrono::steady_clock::time_point& sendStartTime);
+    bool processSegment(StreamInstance* stream, HLSSegment& hlsSegment, 
+                       bool& segmentInProgress, std::chrono::steady_clock::time_point& sendStartTime,
+                       double& playoutDuration);
+
+    /**
+     * @brief Convertit un segment HLS et l'ajoute au tampon de gigue
+     * @param stream Pointeur vers l'instance de flux
+     * @param hlsSegment Segment HLS à convertir (ses données sont rendues à la réserve après conversion)
+     * @return true si le segment a été ajouté au tampon
+     */
+    bool ingestSegment(StreamInstance* stream, HLSSegment& hlsSegment);
+
+    /**
+     * @brief Diffuse le segment suivant du tampon de gigue s'il est amorcé
+     * @param stream Pointeur vers l'instance de flux
+     * @param segmentInProgress Référence vers l'indicateur de segment en cours
+     * @param sendStartTime Référence vers l'horodatage de début d'envoi
+     * @param playoutDuration Référence vers la durée du segment diffusé (s)
+     * @return true si un segment a été envoyé
+     */
+    bool playoutSegment(StreamInstance* stream, bool& segmentInProgress,
+                        std::chrono::steady_clock::time_point& sendStartTime, double& playoutDuration);
+    
+    /**
+     * @brief Relance les étapes arrêtées d'un flux, chacune selon ses propres délais
+     *
+     * Une étape arrêtée est relancée après un court délai, puis à des intervalles
+     * croissants tant qu'elle ne redémarre pas. Les autres étapes ne sont pas touchées :
+     * le tampon de gigue continue d'être diffusé pendant la reprise.
+     *
+     * @param stream Instance du flux
+     * @return true si toutes les étapes sont en cours d'exécution
+     */
+    bool recoverStages(StreamInstance* stream);
+    
+    /**
+     * @brief Relance une étape arrêtée si son délai de reprise est écoulé
+     * @param streamId Identifiant du flux
+     * @param stage Nom de l'étape (journalisation)
+     * @param backoff Délais de reprise de l'étape
+     * @param running État actuel de l'étape
+     * @param restart Relance de l'étape (renvoie true si l'étape tourne)
+     * @param recoverySeconds Histogramme des durées de reprise (peut être nul)
+     * @return true si l'étape est en cours d'exécution
+     */
+    bool recoverStage(const std::string& streamId, const char* stage, RecoveryBackoff& backoff, bool running,
+                      const std::function<bool()>& restart, const std::shared_ptr<Histogram>& recoverySeconds);
     
     /**
-     * @brief Réinitialise complètement un flux en cas de problème
+     * @brief Relance la récupération HLS d'un flux sans toucher aux autres étapes
+     *
+     * Le client HLS est relancé sur place ; le convertisseur, son état de continuité,
+     * le socket multicast et le tampon de gigue sont conservés.
+     *
      * @param streamId Identifiant du flux à réinitialiser
-     * @return true si la réinitialisation a réussi
+     * @return true si la récupération a redémarré
      */
     bool resetStream(const std::string& streamId);
 
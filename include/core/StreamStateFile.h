@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace hls_to_dvb {
+
+/**
+ * @struct StreamOutputState
+ * @brief État de sortie d'un flux à conserver d'une exécution à l'autre
+ *
+ * Ce sont les valeurs que les récepteurs suivent : les reprendre après un redémarrage
+ * évite les erreurs de continuité et les remises à zéro des versions de tables.
+ */
+struct StreamOutputState {
+    std::map<uint16_t, uint8_t> continuityCounters; ///< Compteurs de continuité par PID
+    uint16_t pcrPid = 0x1FFF;                       ///< PID principal des PCR
+    uint64_t lastPcr = 0;                           ///< Dernière valeur PCR émise
+    uint8_t versionPAT = 0;                         ///< Version de la PAT
+    uint8_t versionSDT = 0;                         ///< Version de la SDT
+    uint8_t versionEIT = 0;                         ///< Version de la EIT
+    uint8_t versionNIT = 0;                         ///< Version de la NIT
+    std::map<uint16_t, uint8_t> versionPMT;         ///< Versions des PMT (serviceId -> version)
+    int64_t savedAtUs = 0;                          ///< Instant de la sauvegarde (µs depuis l'époque)
+};
+
+/**
+ * @class StreamStateFile
+ * @brief Petit fichier d'état d'un flux, projeté en mémoire
+ *
+ * Le fichier contient deux emplacements de taille fixe écrits en alternance, chacun
+ * avec un numéro de séquence et une somme de contrôle. Une sauvegarde n'est donc
+ * qu'une copie en mémoire : un arrêt brutal au milieu d'une écriture laisse intact
+ * l'emplacement précédent, qui est alors repris au redémarrage. Les pages modifiées
+ * sont écrites sur disque par le système, sans bloquer l'appelant.
+ */
+class StreamStateFile {
+public:
+    /**
+     * @brief Ouvre (ou crée) le fichier d'état d'un flux
+     * @param directory Dossier des fichiers d'état
+     * @param streamId Identifiant du flux
+     * @return Fichier d'état, ou nullptr si le fichier n'a pas pu être projeté en mémoire
+     */
+    static std::shared_ptr<StreamStateFile> open(const std::string& directory, const std::string& streamId);
+
+    /**
+     * @brief Destructeur (retire la projection et ferme le fichier)
+     */
+    ~StreamStateFile();
+
+    StreamStateFile(const StreamStateFile&) = delete;
+    StreamStateFile& operator=(const StreamStateFile&) = delete;
+
+    /**
+     * @brief Lit le dernier état valide
+     * @param state État lu
+     * @return false si le fichier ne contient aucun état valide
+     */
+    bool load(StreamOutputState& state) const;
+
+    /**
+     * @brief Enregistre un état dans l'emplacement le plus ancien
+     *
+     * Les compteurs et versions au-delà de la capacité d'un emplacement sont ignorés.
+     * Un seul thread à la fois doit appeler cette méthode pour un même fichier.
+     *
+     * @param state État à enregistrer
+     */
+    void save(const StreamOutputState& state);
+
+    /**
+     * @brief Récupère le chemin du fichier
+     * @return Chemin du fichier d'état
+     */
+    const std::string& getPath() const;
+
+private:
+    struct Layout;
+
+    /**
+     * @brief Constructeur (voir open())
+     * @param path Chemin du fichier
+     * @param fd Descripteur du fichier ouvert
+     * @param layout Contenu projeté en mémoire
+     */
+    StreamStateFile(const std::string& path, int fd, Layout* layout);
+
+    std::string path_;          ///< Chemin du fichier
+    int fd_;                    ///< Descripteur du fichier
+    Layout* layout_;            ///< Contenu projeté en mémoire
+    uint64_t sequence_ = 0;     ///< Numéro de la dernière sauvegarde
+};
+
+} // namespace hls_to_dvb
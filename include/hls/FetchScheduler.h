@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../core/IoRuntime.h"
+#include "HttpFetcher.h"
+
+namespace hls_to_dvb {
+
+/**
+ * @class FetchScheduler
+ * @brief Ordonnancement des requêtes HLS de tous les flux, par origine
+ *
+ * Le nombre de requêtes simultanées vers une même origine (hôte et port) est limité.
+ * Au-delà, les requêtes attendent un créneau sans occuper de thread, et le créneau
+ * libéré revient à la requête dont l'échéance est la plus proche : l'échéance d'un
+ * flux est l'instant où son tampon se videra. Une vague de rechargements de playlist
+ * ne peut ainsi pas retarder la chaîne qui est sur le point de manquer de segments.
+ *
+ * Les connexions elles-mêmes sont gardées ouvertes par HttpFetcher, par origine.
+ */
+class FetchScheduler {
+public:
+    /**
+     * @brief Activité d'une origine
+     */
+    struct OriginStats {
+        std::string origin;         ///< Origine "hôte:port"
+        int active = 0;             ///< Requêtes en cours
+        size_t queued = 0;          ///< Requêtes en attente d'un créneau
+        uint64_t requests = 0;      ///< Requêtes servies depuis le démarrage
+        uint64_t delayed = 0;       ///< Requêtes qui ont dû attendre un créneau
+    };
+
+    /**
+     * @brief Récupère l'instance unique de l'ordonnanceur
+     * @return Référence vers l'instance
+     */
+    static FetchScheduler& getInstance();
+
+    /**
+     * @brief Règle le nombre de requêtes simultanées par origine
+     * @param maxRequestsPerOrigin Requêtes simultanées (au moins 1)
+     */
+    void setMaxRequestsPerOrigin(int maxRequestsPerOrigin);
+
+    /**
+     * @brief Télécharge une ressource dès qu'un créneau de son origine est disponible
+     * @param loop Boucle d'E/S de la coroutine appelante
+     * @param url URL http:// de la ressource
+     * @param deadline Échéance du flux demandeur (vidage de son tampon)
+     * @param timeout Délai maximal de la requête, attente d'un créneau non comprise
+     * @param cancel Jeton d'annulation de la coroutine (peut être nullptr)
+     * @param buffer Tampon recyclé qui reçoit le corps
+     * @param progress Avancement de la requête (peut être nullptr)
+     * @return Réponse (queuedUs indique l'attente du créneau)
+     */
+    Task<HttpResponse> get(IoLoop& loop, std::string url, std::chrono::steady_clock::time_point deadline,
+                           std::chrono::milliseconds timeout, std::shared_ptr<CancelToken> cancel,
+                           std::vector<uint8_t> buffer = {}, std::shared_ptr<HttpProgress> progress = nullptr);
+
+    /**
+     * @brief Récupère l'activité des origines
+     * @return Activité par origine
+     */
+    std::vector<OriginStats> getOriginStats() const;
+
+private:
+    /**
+     * @brief Requête en attente d'un créneau
+     */
+    struct Waiter {
+        IoLoop* loop = nullptr;                 ///< Boucle de la coroutine en attente
+        std::shared_ptr<CancelToken> token;     ///< Jeton de l'attente (reprise ou annulation)
+        bool granted = false;                   ///< Créneau attribué
+        std::multimap<std::chrono::steady_clock::time_point, std::shared_ptr<Waiter>>::iterator position; ///< Place dans la file
+    };
+
+    /**
+     * @brief État d'une origine
+     */
+    struct Origin {
+        int active = 0;                         ///< Créneaux occupés
+        std::multimap<std::chrono::steady_clock::time_point, std::shared_ptr<Waiter>> waiting; ///< File, par échéance
+        uint64_t requests = 0;                  ///< Requêtes servies
+        uint64_t delayed = 0;                   ///< Requêtes mises en attente
+    };
+
+    /**
+     * @brief Créneau occupé, libéré à la fin de la requête
+     */
+    struct Slot {
+        FetchScheduler* scheduler = nullptr;
+        std::string origin;
+        ~Slot();
+    };
+
+    FetchScheduler() = default;
+
+    /**
+     * @brief Libère un créneau et le transmet à la requête en attente d'échéance la plus proche
+     * @param origin Origine du créneau
+     */
+    void release(const std::string& origin);
+
+    /**
+     * @brief Attribue les créneaux libres aux requêtes en attente (verrou tenu)
+     * @param origin État de l'origine
+     */
+    void grantLocked(Origin& origin);
+
+    mutable std::mutex mutex_;                  ///< Protège les origines
+    std::map<std::string, Origin> origins_;     ///< Origines connues
+    int maxRequestsPerOrigin_ = 6;              ///< Requêtes simultanées par origine
+};
+
+} // namespace hls_to_dvb
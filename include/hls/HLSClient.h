@@ -6,11 +6,25 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
+#include <future>
 #include <atomic>
 #include <thread>
 #include <optional>
 #include <regex>
 #include <map>  
+#include <set>
+
+#include "../core/BufferAccountant.h"
+#include "../core/BufferPool.h"
+#include "../core/IoRuntime.h"
+#include "../core/LiveEdgeController.h"
+#include "../core/Logging.h"
+#include "../core/MetricsRegistry.h"
+#include "../core/RecoveryBackoff.h"
+#include "../core/SegmentTrace.h"
+#include "HttpFetcher.h"
+#include "MediaPlaylist.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -42,6 +56,23 @@ struct HLSSegment {
     int sequenceNumber;         ///< Numéro de séquence du segment
     double duration;            ///< Durée du segment en secondes
     int64_t timestamp;          ///< Horodatage du segment
+    hls_to_dvb::SegmentTrace trace; ///< Horodatages du parcours du segment
+    double skippedBefore = 0.0; ///< Durée sautée juste avant ce segment pour rattraper le direct (s, négative si inconnue)
+};
+
+/**
+ * @struct HLSOriginStats
+ * @brief Statistiques d'une origine HLS d'un flux
+ */
+struct HLSOriginStats {
+    std::string url;            ///< URL de la playlist de média sur cette origine
+    bool active = false;        ///< Origine du dernier segment récupéré
+    bool healthy = true;        ///< Origine en service (sinon écartée jusqu'à sa prochaine tentative)
+    double firstByteMs = 0.0;   ///< Délai moyen avant le premier octet des réponses (ms)
+    uint64_t requests = 0;      ///< Requêtes envoyées
+    uint64_t errors = 0;        ///< Requêtes en échec
+    uint64_t hedges = 0;        ///< Requêtes doublant une origine trop lente
+    uint64_t wins = 0;          ///< Segments servis par cette origine
 };
 
 /**
@@ -58,6 +89,17 @@ public:
      */
     explicit HLSClient(const std::string& url);
     
+    /**
+     * @brief Active les diagnostics de démarrage
+     *
+     * Hors diagnostics, start() ne vérifie ni les protocoles FFmpeg ni les discontinuités
+     * et n'affiche pas le détail de la playlist : seules les requêtes nécessaires à la
+     * sélection de la variante et à l'ouverture du flux sont faites.
+     *
+     * @param enabled true pour effectuer les sondages détaillés
+     */
+    void setDiagnostics(bool enabled);
+    
     /**
      * @brief Démarre le client HLS
      */
@@ -68,6 +110,19 @@ public:
      */
     void stop();
     
+    /**
+     * @brief Relance la récupération sur la variante déjà sélectionnée
+     *
+     * Sans nouvelle lecture de la playlist principale ni sondage des variantes : la
+     * variante retenue au démarrage est relue, puis rouverte (FFmpeg) ou confiée de
+     * nouveau au runtime d'E/S. Les segments déjà en file sont conservés. Si la variante
+     * n'est plus servie, change de format ou, pour FFmpeg, de composition (nombre et
+     * codecs des flux élémentaires), le client repasse par un démarrage complet.
+     *
+     * @return true si la récupération a repris
+     */
+    bool restart();
+    
     /**
      * @brief Récupère le prochain segment disponible
      * @return Segment HLS ou nullopt si aucun segment disponible
@@ -119,18 +174,145 @@ public:
      * @return true si le client est en cours d'exécution, false sinon
      */
     bool isRunning() const;
+
+    /**
+     * @brief Associe la file d'attente des segments au compte mémoire du flux
+     * @param account Compte mémoire du flux (nullptr pour ne pas comptabiliser)
+     */
+    void setBufferAccount(std::shared_ptr<hls_to_dvb::StreamBufferAccount> account);
+
+    /**
+     * @brief Définit la réserve dans laquelle sont empruntés les tampons des segments
+     * @param pool Réserve de tampons du flux (nullptr pour allouer directement)
+     */
+    void setBufferPool(std::shared_ptr<hls_to_dvb::BufferPool> pool);
+
+    /**
+     * @brief Définit les mesures du flux alimentées par le thread de récupération
+     * @param metrics Mesures du flux (nullptr pour ne rien exporter)
+     */
+    void setMetrics(std::shared_ptr<hls_to_dvb::StreamMetrics> metrics);
+    
+    /**
+     * @brief Définit le contrôleur d'écart au direct du flux
+     *
+     * Au-delà de la latence cible (politique SKIP), la récupération avance vers le direct
+     * moins la cible avant de télécharger : la coroutine saute des entrées de la playlist,
+     * le thread FFmpeg rouvre la variante plus près du direct.
+     *
+     * @param liveEdge Contrôleur du flux (nullptr pour télécharger chaque segment)
+     */
+    void setLiveEdge(std::shared_ptr<hls_to_dvb::LiveEdgeController> liveEdge);
+    
+    /**
+     * @brief Définit les délais de reprise de la lecture après une erreur
+     *
+     * Une erreur de lecture (segment absent, coupure de l'origine) ne termine plus le
+     * thread de récupération : la variante sélectionnée est rouverte, sans nouvelle
+     * analyse de la playlist, à des intervalles croissants. À appeler avant start().
+     *
+     * @param initialDelayMs Délai avant la première réouverture
+     * @param maxDelayMs Délai maximal entre deux réouvertures
+     * @param jitter Part aléatoire des délais (0.0 à 1.0)
+     */
+    void setRecovery(int initialDelayMs, int maxDelayMs, double jitter);
+    
+    /**
+     * @brief Confie la récupération des segments au runtime d'E/S partagé
+     *
+     * Une variante http:// en clair et en MPEG-TS est alors récupérée par une coroutine
+     * (rechargement de la playlist, téléchargement des segments, relances) sur l'une des
+     * boucles du runtime, au lieu d'un thread FFmpeg par flux. À appeler avant start().
+     *
+     * @param runtime Runtime d'E/S (nullptr pour garder le thread de récupération)
+     */
+    void setRuntime(std::shared_ptr<hls_to_dvb::IoRuntime> runtime);
+    
+    /**
+     * @brief Fournit la profondeur du tampon en aval, pour ordonner les requêtes
+     *
+     * Avec le runtime d'E/S, chaque requête porte l'échéance du flux (instant où ses
+     * tampons seront vides) : la plus proche est servie en premier par son origine.
+     * À appeler avant start().
+     *
+     * @param depthMs Fonction qui retourne la profondeur du tampon de gigue en ms
+     */
+    void setBufferDepth(std::function<int()> depthMs);
+    
+    /**
+     * @brief Définit les origines équivalentes du flux
+     *
+     * La variante sélectionnée sur l'entrée principale est cherchée au même chemin
+     * relatif sur chaque origine. Avec le runtime d'E/S, chaque segment est demandé à
+     * l'origine en service la plus rapide parmi celles qui l'annoncent (même numéro de
+     * séquence média), puis aux suivantes en cas d'échec. Avec le thread FFmpeg, chaque
+     * réouverture après une erreur passe à l'origine suivante. À appeler avant start().
+     *
+     * @param inputs URL d'entrée équivalentes (l'entrée principale y est ignorée)
+     */
+    void setAlternateInputs(const std::vector<std::string>& inputs);
+    
+    /**
+     * @brief Règle le doublement des requêtes de segments (runtime d'E/S)
+     * @param hedgeAfter Délai sans premier octet après lequel le segment est aussi demandé
+     *                   à l'origine suivante (0 = jamais)
+     */
+    void setHedging(std::chrono::milliseconds hedgeAfter);
+    
+    /**
+     * @brief Récupère les statistiques des origines du flux
+     * @return Statistiques par origine, l'entrée principale en premier
+     */
+    std::vector<HLSOriginStats> getOriginStats() const;
     
 private:
+    /**
+     * @brief État d'une origine du flux
+     */
+    struct OriginState {
+        std::string url;                     ///< URL de la playlist de média sur cette origine
+        double firstByteMs = 0.0;            ///< Moyenne glissante du délai de premier octet (0 = inconnu)
+        int consecutiveErrors = 0;           ///< Échecs depuis la dernière réponse valide
+        std::chrono::steady_clock::time_point retryAfter; ///< Fin de la mise à l'écart
+        uint64_t requests = 0;               ///< Requêtes envoyées
+        uint64_t errors = 0;                 ///< Requêtes en échec
+        uint64_t hedges = 0;                 ///< Requêtes de doublement
+        uint64_t wins = 0;                   ///< Segments servis
+        std::shared_ptr<hls_to_dvb::Counter> requestsTotal;       ///< Mesure des requêtes
+        std::shared_ptr<hls_to_dvb::Counter> errorsTotal;         ///< Mesure des échecs
+        std::shared_ptr<hls_to_dvb::Counter> hedgesTotal;         ///< Mesure des doublements
+        std::shared_ptr<hls_to_dvb::Histogram> firstByteSeconds;  ///< Mesure du délai de premier octet
+    };
+    
+
     std::string url_;                    ///< URL du flux HLS
     AVFormatContext* formatContext_;     ///< Contexte FFmpeg pour le format
     HLSStreamInfo streamInfo_;           ///< Informations sur le flux sélectionné
     
     std::thread fetchThread_;            ///< Thread de récupération des segments
+    std::shared_ptr<hls_to_dvb::IoRuntime> runtime_; ///< Runtime d'E/S (nullptr = thread FFmpeg)
+    hls_to_dvb::IoLoop* fetchLoop_ = nullptr; ///< Boucle de la coroutine de récupération
+    std::shared_ptr<hls_to_dvb::CancelToken> fetchCancel_; ///< Annulation de la coroutine
+    std::future<void> fetchDone_;        ///< Fin de la coroutine de récupération
+    bool useRuntime_ = false;            ///< Récupération confiée au runtime d'E/S au dernier démarrage
+    std::vector<int> codecLayout_;       ///< Codecs des flux élémentaires ouverts par FFmpeg au démarrage
+    std::function<int()> bufferDepth_;   ///< Profondeur du tampon en aval (ms)
+    std::vector<std::string> alternateInputs_; ///< Entrées équivalentes configurées
+    std::chrono::milliseconds hedgeAfter_{0}; ///< Délai avant doublement d'une requête de segment
+    std::vector<OriginState> origins_;   ///< Origines du flux (l'entrée principale en premier)
+    size_t activeOrigin_ = 0;            ///< Origine du dernier segment (ou lue par FFmpeg)
+    mutable std::mutex originsMutex_;    ///< Protège les origines
     std::atomic<bool> running_;          ///< Indique si le client est en cours d'exécution
     
     std::queue<HLSSegment> segmentQueue_; ///< File d'attente des segments récupérés
     std::mutex queueMutex_;              ///< Mutex pour l'accès à la file d'attente
     std::condition_variable queueCondVar_; ///< Variable de condition pour la synchronisation
+    size_t queuedBytes_ = 0;             ///< Octets de données dans la file d'attente
+    std::shared_ptr<hls_to_dvb::StreamBufferAccount> bufferAccount_; ///< Compte mémoire du flux
+    std::shared_ptr<hls_to_dvb::BufferPool> bufferPool_; ///< Réserve de tampons du flux
+    std::shared_ptr<hls_to_dvb::StreamMetrics> metrics_; ///< Mesures du flux
+    std::shared_ptr<hls_to_dvb::LiveEdgeController> liveEdge_; ///< Écart au direct du flux
+    size_t lastSegmentBytes_ = 0;        ///< Taille du dernier segment (pour dimensionner l'emprunt)
     
     std::atomic<size_t> segmentsProcessed_;       ///< Compteur de segments traités
     std::atomic<size_t> discontinuitiesDetected_; ///< Compteur de discontinuités détectées
@@ -155,6 +337,64 @@ private:
      */
     void fetchThreadFunc();
     
+    /**
+     * @brief Coroutine de récupération (playlist, segments, relances) sur le runtime d'E/S
+     * @param loop Boucle qui exécute la coroutine
+     */
+    hls_to_dvb::Task<void> fetchCoroutine(hls_to_dvb::IoLoop& loop);
+    
+    /**
+     * @brief Ajoute un segment à la file, en supprimant le plus ancien si elle est pleine
+     * @param segment Segment récupéré
+     */
+    void enqueueSegment(HLSSegment&& segment);
+    
+    /**
+     * @brief Journalise une erreur de récupération et la signale (mesures, alerte)
+     * @param message Description de l'erreur
+     */
+    void reportFetchError(const std::string& message);
+    
+    /**
+     * @brief Récupère le nombre de segments en file
+     */
+    size_t queueSize();
+    
+    /**
+     * @brief Calcule l'échéance du flux: instant où la file et le tampon en aval seront vides
+     */
+    std::chrono::steady_clock::time_point bufferDeadline();
+    
+    /**
+     * @brief Construit les origines à partir de la variante sélectionnée et des entrées équivalentes
+     * @param httpOnly Ne garder que les origines servies par le client HTTP des coroutines
+     */
+    void setupOrigins(bool httpOnly);
+    
+    /**
+     * @brief Classe les origines: en service d'abord, puis par délai de premier octet
+     * @return Indices des origines
+     */
+    std::vector<size_t> rankOrigins();
+    
+    /**
+     * @brief Enregistre l'issue d'une requête auprès d'une origine
+     * @param origin Indice de l'origine
+     * @param response Réponse reçue
+     * @param startUs Envoi de la requête (µs)
+     * @param hedge Requête de doublement
+     * @param won Réponse retenue pour le segment
+     * @param abandoned Requête annulée au profit d'une autre origine
+     */
+    void recordOriginResult(size_t origin, const hls_to_dvb::HttpResponse& response, int64_t startUs,
+                            bool hedge, bool won, bool abandoned);
+    
+    /**
+     * @brief Écarte l'origine lue par FFmpeg et passe à la suivante (thread de récupération)
+     * @return URL de la variante à rouvrir
+     */
+    std::string switchOrigin();
+    
     /**
      * @brief Analyse la playlist HLS pour détecter les discontinuités
      * @param url URL de la playlist à analyser
@@ -224,9 +464,54 @@ private:
     */
     AVDictionary* createFFmpegOptions(bool longTimeout = false);
     
-    // Stockage des durées de segment
+    // Stockage des durées de segment (fenêtre courante de la playlist uniquement)
     std::map<int, double> segmentDurations_;
     double averageSegmentDuration_ = 0.0;
+    std::set<std::string> segmentUris_;  ///< URI des segments de la fenêtre courante
+    int64_t newestSegmentSeenUs_ = 0;    ///< Apparition du dernier segment nouveau dans la playlist
+    std::mutex durationsMutex_;          ///< Protège les durées, les URI et la date d'apparition
+    
+    std::shared_ptr<spdlog::logger> log_; ///< Logger du composant (chemins critiques)
+    bool diagnostics_ = false;            ///< Sondages détaillés au démarrage
+    hls_to_dvb::RecoveryBackoff readBackoff_; ///< Délais de réouverture après une erreur de lecture
+    
+    /**
+     * @brief Rouvre la variante sélectionnée après une erreur de lecture
+     *
+     * Réessaie avec des délais croissants jusqu'à la réussite ou l'arrêt du client.
+     * Appelée uniquement par le thread de récupération.
+     *
+     * @return false si le client a été arrêté avant la réouverture
+     */
+    bool reopenInputInternal();
+    
+    /**
+     * @brief Rouvre la variante à la latence cible quand la lecture FFmpeg est trop en retard
+     *
+     * FFmpeg choisit seul les segments lus : pour éviter de télécharger des segments
+     * aussitôt écartés, la variante est rouverte à la cible du direct (live_start_index).
+     * En deçà de quelques segments d'excès, le rattrapage reste fait après réception.
+     * Appelée uniquement par le thread de récupération.
+     *
+     * @return true si la variante a été rouverte (le segment suivant marque une discontinuité)
+     */
+    bool jumpToLiveEdgeInternal();
+    
+    /**
+     * @brief Lance la récupération des segments (thread FFmpeg ou coroutine)
+     * @param useRuntime true pour confier la récupération au runtime d'E/S
+     */
+    void startFetchingInternal(bool useRuntime);
+    
+    /**
+     * @brief Arrête la récupération des segments et ferme le flux FFmpeg, sans vider la file
+     */
+    void stopFetchingInternal();
+    
+    /**
+     * @brief Vide la file d'attente des segments et restitue les octets au budget mémoire
+     */
+    void clearSegmentQueue();
     
     // Méthode pour extraire les durées de segment
     void extractSegmentDurations(const std::string& playlistContent);
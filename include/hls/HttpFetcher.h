@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../core/IoRuntime.h"
+
+namespace hls_to_dvb {
+
+/**
+ * @brief Réponse d'une requête HTTP
+ */
+struct HttpResponse {
+    int status = 0;                 ///< Code de statut HTTP (0 = échec de transport)
+    std::vector<uint8_t> body;      ///< Corps de la réponse
+    std::string error;              ///< Cause de l'échec (vide si la requête a abouti)
+    int64_t firstByteUs = 0;        ///< Réception du premier octet de la réponse (µs)
+    int64_t queuedUs = 0;           ///< Attente d'un créneau de requête auprès de l'origine (µs)
+    bool reused = false;            ///< Réponse reçue sur une connexion persistante réutilisée
+
+    /**
+     * @brief Indique si la requête a abouti avec un statut 2xx
+     */
+    bool ok() const { return error.empty() && status >= 200 && status < 300; }
+};
+
+/**
+ * @brief Avancement d'une requête, consultable par les autres coroutines de la boucle
+ */
+struct HttpProgress {
+    int64_t firstByteUs = 0;        ///< Réception du premier octet de la réponse (µs, 0 = pas encore)
+};
+
+/**
+ * @class HttpFetcher
+ * @brief Client HTTP/1.1 non bloquant pour les coroutines d'une boucle d'E/S
+ *
+ * Les requêtes GET sont exprimées en coroutines : la connexion, l'envoi et la lecture
+ * attendent la disponibilité du socket sur la boucle au lieu de bloquer un thread.
+ * Les réponses de longueur connue, découpées (chunked) ou terminées par la fermeture
+ * de la connexion sont prises en charge, ainsi que les redirections.
+ *
+ * Les connexions sont persistantes (keep-alive) : après une réponse complète, le socket
+ * est rendu à la réserve de son origine et la requête suivante vers la même origine,
+ * quel que soit le flux ou la boucle, le réutilise sans nouvelle connexion TCP. Une
+ * connexion réutilisée que le serveur a fermée entre-temps est remplacée une fois.
+ *
+ * Seul http:// est pris en charge. Les adresses des origines sont résolues par des threads
+ * dédiés, que la coroutine attend sans bloquer sa boucle, puis gardées en cache.
+ */
+class HttpFetcher {
+public:
+    /**
+     * @brief Télécharge une ressource
+     * @param loop Boucle d'E/S de la coroutine appelante
+     * @param url URL http:// de la ressource
+     * @param timeout Délai maximal de la requête entière : résolution, connexion, en-têtes,
+     *                corps et redirections (négatif = aucun)
+     * @param cancel Jeton d'annulation (peut être nullptr)
+     * @param buffer Tampon recyclé qui reçoit le corps (vidé avant usage)
+     * @param progress Avancement de la requête, mis à jour au fil de la réception (peut être nullptr)
+     * @return Réponse
+     */
+    static Task<HttpResponse> get(IoLoop& loop, std::string url, std::chrono::milliseconds timeout,
+                                  std::shared_ptr<CancelToken> cancel, std::vector<uint8_t> buffer = {},
+                                  std::shared_ptr<HttpProgress> progress = nullptr);
+
+    /**
+     * @brief Indique si une URL peut être téléchargée par ce client
+     * @param url URL à tester
+     * @return true pour une URL http://
+     */
+    static bool supports(const std::string& url);
+    
+    /**
+     * @brief Extrait l'origine (hôte et port) d'une URL
+     * @param url URL http://
+     * @return Origine "hôte:port", ou chaîne vide si l'URL n'est pas prise en charge
+     */
+    static std::string origin(const std::string& url);
+    
+    /**
+     * @brief Règle le nombre de connexions persistantes gardées par origine
+     * @param maxIdle Connexions inactives gardées par origine (0 = une connexion par requête)
+     */
+    static void setIdleConnections(size_t maxIdle);
+};
+
+} // namespace hls_to_dvb
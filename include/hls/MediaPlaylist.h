@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hls_to_dvb {
+
+/**
+ * @struct MediaPlaylist
+ * @brief Playlist de média HLS (RFC 8216) réduite aux informations de récupération
+ */
+struct MediaPlaylist {
+    /**
+     * @brief Segment de la playlist
+     */
+    struct Segment {
+        std::string url;            ///< URL absolue du segment
+        double duration = 0.0;      ///< Durée annoncée (EXTINF) en secondes
+        int64_t sequence = 0;       ///< Numéro de séquence média
+        bool discontinuity = false; ///< Précédé de EXT-X-DISCONTINUITY
+    };
+
+    int64_t mediaSequence = 0;      ///< Séquence du premier segment (EXT-X-MEDIA-SEQUENCE)
+    double targetDuration = 0.0;    ///< Durée cible (EXT-X-TARGETDURATION) en secondes
+    bool endList = false;           ///< Playlist close (EXT-X-ENDLIST)
+    bool encrypted = false;         ///< Segments chiffrés (EXT-X-KEY autre que NONE)
+    bool fragmentedMp4 = false;     ///< Segments fMP4 (EXT-X-MAP)
+    bool byteRange = false;         ///< Segments en plages d'octets (EXT-X-BYTERANGE)
+    bool master = false;            ///< Playlist principale (EXT-X-STREAM-INF) et non de média
+    std::vector<Segment> segments;  ///< Segments de la fenêtre
+
+    /**
+     * @brief Analyse une playlist de média
+     * @param content Contenu de la playlist
+     * @param baseUrl URL de la playlist, pour résoudre les URL relatives
+     * @return Playlist analysée
+     */
+    static MediaPlaylist parse(const std::string& content, const std::string& baseUrl);
+
+    /**
+     * @brief Résout une URL relative par rapport à une URL de base
+     * @param baseUrl URL de base
+     * @param reference URL éventuellement relative
+     * @return URL absolue
+     */
+    static std::string resolve(const std::string& baseUrl, const std::string& reference);
+
+    /**
+     * @brief Séquence du dernier segment de la fenêtre
+     * @return Séquence, ou mediaSequence - 1 si la fenêtre est vide
+     */
+    int64_t lastSequence() const;
+};
+
+} // namespace hls_to_dvb
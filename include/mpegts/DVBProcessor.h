@@ -7,6 +7,8 @@
 #include <memory>
 #include <mutex>
 
+#include "../core/BufferPool.h"
+
 // Forward declarations
 namespace ts {
     class PAT;
@@ -31,6 +33,18 @@ struct DVBService {
     std::map<uint16_t, uint8_t> components; ///< Composants du service (PID -> type de flux)
 };
 
+/**
+ * @struct DVBTableVersions
+ * @brief Numéros de version des tables PSI/SI émises
+ */
+struct DVBTableVersions {
+    uint8_t pat = 0;                ///< Version de la PAT
+    uint8_t sdt = 0;                ///< Version de la SDT
+    uint8_t eit = 0;                ///< Version de la EIT
+    uint8_t nit = 0;                ///< Version de la NIT
+    std::map<uint16_t, uint8_t> pmt; ///< Versions des PMT (serviceId -> version)
+};
+
 /**
  * @class DVBProcessor
  * @brief Traite les flux MPEG-TS pour assurer leur conformité avec la norme DVB
@@ -80,6 +94,27 @@ public:
      * @return Liste des services DVB
      */
     std::vector<DVBService> getServices() const;
+
+    /**
+     * @brief Définit la réserve dans laquelle sont empruntés les tampons de sortie
+     * @param pool Réserve de tampons du flux (nullptr pour allouer directement)
+     */
+    void setBufferPool(std::shared_ptr<hls_to_dvb::BufferPool> pool);
+
+    /**
+     * @brief Récupère les versions courantes des tables
+     * @return Versions des tables PSI/SI
+     */
+    DVBTableVersions getTableVersions() const;
+
+    /**
+     * @brief Reprend les versions des tables d'une exécution précédente
+     *
+     * Les versions des PMT ne sont appliquées qu'aux services déjà configurés.
+     *
+     * @param versions Versions à reprendre
+     */
+    void setTableVersions(const DVBTableVersions& versions);
     
     /**
      * @brief Destructeur
@@ -99,6 +134,7 @@ private:
     uint8_t versionEIT_;                            ///< Version de la EIT
     uint8_t versionNIT_;                            ///< Version de la NIT
     std::map<uint16_t, uint8_t> versionPMT_;        ///< Versions des PMT (serviceId -> version)
+    std::shared_ptr<hls_to_dvb::BufferPool> bufferPool_; ///< Réserve de tampons du flux
     
     /**
      * @brief Génère une table PAT
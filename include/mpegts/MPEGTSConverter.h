@@ -1,6 +1,9 @@
 #pragma once
 
 #include "../hls/HLSClient.h"
+#include "../core/BufferPool.h"
+#include "../core/Logging.h"
+#include "../core/StreamStateFile.h"
 
 #include <string>
 #include <vector>
@@ -9,6 +12,7 @@
 #include <atomic>
 #include <mutex>
 #include <map>
+#include <chrono>
 
 // Forward declarations
 namespace ts {
@@ -30,6 +34,8 @@ struct MPEGTSSegment {
     int sequenceNumber;             ///< Numéro de séquence du segment
     double duration;                ///< Durée du segment en secondes
     int64_t timestamp;              ///< Horodatage du segment
+    hls_to_dvb::SegmentTrace trace; ///< Horodatages du parcours du segment
+    std::shared_ptr<const hls_to_dvb::StreamOutputState> outputState; ///< État de sortie après ce segment (nullptr sans fichier d'état)
 };
 
 /**
@@ -63,12 +69,81 @@ public:
      */
     std::optional<MPEGTSSegment> convert(const HLSSegment& hlsSegment);
     
+    /**
+     * @brief Convertit un segment HLS dont les données peuvent être reprises
+     *
+     * En mode passthrough, les données d'un segment conforme sont déplacées telles quelles
+     * dans le segment MPEG-TS, sans copie.
+     *
+     * @param hlsSegment Segment HLS à convertir (ses données peuvent être vidées)
+     * @return Segment MPEG-TS ou nullopt en cas d'erreur
+     */
+    std::optional<MPEGTSSegment> convert(HLSSegment&& hlsSegment);
+    
     /**
      * @brief Indique si le convertisseur est en cours d'exécution
      * @return true si le convertisseur est en cours d'exécution
      */
     bool isRunning() const;
     
+    /**
+     * @brief Définit la réserve dans laquelle sont empruntés les tampons de conversion
+     * @param pool Réserve de tampons du flux
+     */
+    void setBufferPool(std::shared_ptr<hls_to_dvb::BufferPool> pool);
+    
+    /**
+     * @brief Active ou désactive le mode passthrough
+     *
+     * En mode passthrough, les segments dont les paquets, les compteurs de continuité,
+     * les PCR et les tables PAT/PMT/SDT sont déjà conformes sont transmis sans réécriture.
+     * Un segment non conforme est converti entièrement, comme les suivants, jusqu'à ce
+     * que plusieurs segments consécutifs soient de nouveau conformes : le passthrough
+     * reprend alors, avec une discontinuité signalée sur chaque PID.
+     *
+     * @param enabled true pour activer le mode passthrough
+     */
+    void setPassthrough(bool enabled);
+    
+    /**
+     * @brief Indique si les segments sont actuellement transmis sans réécriture
+     * @return true si le mode passthrough est actif
+     */
+    bool isPassthroughActive() const;
+    
+    /**
+     * @brief Récupère le nombre de segments transmis sans réécriture
+     * @return Nombre de segments
+     */
+    uint64_t getPassthroughSegments() const;
+    
+    /**
+     * @brief Récupère la raison du dernier retour à la conversion complète
+     *
+     * Ne prend pas le verrou de conversion : les statistiques n'attendent pas la fin d'un
+     * segment en cours.
+     *
+     * @return Raison, ou chaîne vide si le mode passthrough n'a jamais été abandonné
+     */
+    std::string getPassthroughFallbackReason() const;
+    
+    /**
+     * @brief Définit le fichier d'où l'état de sortie est repris au démarrage
+     *
+     * Au démarrage, les compteurs de continuité, le PCR et les versions des tables
+     * enregistrés sont repris. Le premier segment émis ensuite commence, pour chaque PID,
+     * par un paquet sans charge utile qui porte l'indicateur de discontinuité : l'écart
+     * entre les compteurs enregistrés et ceux du segment est signalé aux récepteurs. Les
+     * tables changent aussi de version.
+     *
+     * Chaque segment converti porte ensuite l'état de sortie atteint à sa fin
+     * (MPEGTSSegment::outputState) : il est enregistré par l'émetteur une fois le
+     * segment envoyé, et non à la conversion.
+     *
+     * @param stateFile Fichier d'état du flux (nullptr pour ne rien reprendre)
+     */
+    void setStateFile(std::shared_ptr<hls_to_dvb::StreamStateFile> stateFile);
+    
     /**
      * @brief Destructeur
      */
@@ -86,6 +161,35 @@ private:
      */
     void processPackets(ts::TSPacketVector& packets, bool discontinuity);
     
+    /**
+     * @brief Convertit un segment (appel compatible mutex)
+     * @param hlsSegment Segment HLS à convertir
+     * @param movableData Données du segment pouvant être déplacées, ou nullptr pour les copier
+     * @return Segment MPEG-TS ou nullopt en cas d'erreur
+     */
+    std::optional<MPEGTSSegment> convertInternal(const HLSSegment& hlsSegment, std::vector<uint8_t>* movableData);
+    
+    /**
+     * @brief État d'un PID pendant la validation d'un segment (défini dans MPEGTSConverter.cpp)
+     */
+    struct PassthroughPidState;
+    
+    /**
+     * @brief Vérifie qu'un segment peut être transmis sans réécriture
+     *
+     * Contrôle la synchronisation et l'intégrité des paquets, la continuité des compteurs
+     * par PID (avec ceux de la source au segment précédent), la monotonie des PCR et la
+     * présence des tables PAT, PMT et SDT. En cas de succès, les compteurs de la source
+     * et l'état des PCR sont repris ; en cas d'échec, les compteurs de la source sont
+     * oubliés et le segment suivant n'est contrôlé que pour lui-même.
+     *
+     * @param data Données du segment
+     * @param discontinuity Indique si le segment marque une discontinuité HLS
+     * @param reason Description de l'anomalie détectée
+     * @return true si le segment est conforme
+     */
+    bool validatePassthroughInternal(const std::vector<uint8_t>& data, bool discontinuity, std::string& reason);
+    
     /**
      * @brief Réinitialise les compteurs de continuité
      */
@@ -96,7 +200,47 @@ private:
      */
     void resetContinuityCountersInternal();
     
+    /**
+     * @brief Reprend l'état de sortie sauvegardé (mutex déjà verrouillé)
+     */
+    void restoreStateInternal();
+    
+    /**
+     * @brief Capture l'état de sortie courant (mutex déjà verrouillé)
+     * @return État de sortie, ou nullptr sans fichier d'état
+     */
+    std::shared_ptr<const hls_to_dvb::StreamOutputState> snapshotStateInternal() const;
+    
+    /**
+     * @brief Place en tête du segment un paquet de discontinuité par PID (mutex déjà verrouillé)
+     *
+     * Chaque paquet ne contient qu'un champ d'adaptation avec l'indicateur de
+     * discontinuité, et le compteur de continuité qui précède celui du premier paquet du
+     * PID dans le segment.
+     *
+     * @param data Données du segment, remplacées par les données précédées des paquets
+     */
+    void prependResumeMarkersInternal(std::vector<uint8_t>& data);
+    
     std::map<uint16_t, uint8_t> continuityCounters_; ///< Compteurs de continuité par PID
     uint64_t lastPcrValue_;                        ///< Dernière valeur PCR traitée
     uint16_t pcrPid_;                              ///< PID principal des PCR
+    
+    std::shared_ptr<hls_to_dvb::BufferPool> bufferPool_; ///< Réserve de tampons du flux
+    ts::TSPacketVector packets_;                   ///< Paquets du segment en cours (réutilisé d'un segment à l'autre)
+    
+    bool passthroughEnabled_;                      ///< Mode passthrough demandé par la configuration
+    std::atomic<bool> passthroughActive_;          ///< Mode passthrough en vigueur (false après un repli)
+    std::atomic<uint64_t> passthroughSegments_;    ///< Segments transmis sans réécriture
+    int passthroughCleanSegments_ = 0;             ///< Segments conformes consécutifs depuis le dernier repli
+    std::map<uint16_t, uint8_t> sourceCounters_;   ///< Compteurs de la source à la fin du dernier segment validé
+    std::vector<PassthroughPidState> passthroughPids_; ///< État par PID de la validation (indexé par PID)
+    std::vector<uint16_t> passthroughTouched_;     ///< PID dont l'état de validation est à remettre à zéro
+    std::string passthroughFallbackReason_;        ///< Raison du dernier repli sur la conversion complète
+    mutable std::mutex reasonMutex_;               ///< Protège passthroughFallbackReason_ (hors verrou de conversion)
+    std::vector<uint16_t> pmtPids_;                ///< PID des PMT annoncés par le dernier PAT valide
+    std::shared_ptr<spdlog::logger> log_;          ///< Logger du composant (chemins critiques)
+    
+    std::shared_ptr<hls_to_dvb::StreamStateFile> stateFile_; ///< Fichier d'état du flux
+    bool resumePending_ = false;                   ///< État repris, premier segment pas encore émis
 };
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hls_to_dvb {
+
+/**
+ * @class FecEncoder
+ * @brief Correction d'erreurs SMPTE 2022-1 (XOR par colonnes et par lignes) d'un flux RTP
+ *
+ * Les paquets RTP sont rangés ligne par ligne dans une matrice de L colonnes et D lignes.
+ * Chaque colonne complète produit un paquet FEC, émis sur le port média + 2, qui protège
+ * contre la perte d'une rafale de L paquets. Chaque ligne complète produit un paquet FEC,
+ * émis sur le port média + 4, qui protège contre une perte isolée. Un paquet FEC est le
+ * OU exclusif des charges utiles protégées, précédé d'un en-tête RTP et de l'en-tête FEC
+ * de la RFC 2733 étendu par SMPTE 2022-1.
+ *
+ * Le OU exclusif des charges utiles est calculé par blocs de 16 octets (SSE2 ou NEON) :
+ * chaque paquet média est lu deux fois seulement, une par direction.
+ *
+ * Non synchronisée : chaque instance appartient au thread d'envoi de sa sortie.
+ */
+class FecEncoder {
+public:
+    static constexpr int COLUMN_PORT_OFFSET = 2;    ///< Port des paquets FEC de colonne
+    static constexpr int ROW_PORT_OFFSET = 4;       ///< Port des paquets FEC de ligne
+
+    /**
+     * @brief Direction d'un paquet FEC
+     */
+    enum class Direction {
+        COLUMN,     ///< XOR d'une colonne (D paquets espacés de L)
+        ROW         ///< XOR d'une ligne (L paquets consécutifs)
+    };
+
+    /**
+     * @brief Paquet FEC prêt à être envoyé
+     */
+    struct Packet {
+        Direction direction;    ///< Direction du paquet
+        const uint8_t* data;    ///< Paquet RTP complet (valide jusqu'à l'appel suivant de protect())
+        size_t size;            ///< Taille du paquet
+    };
+
+    /**
+     * @brief Vérifie des dimensions de matrice admises par SMPTE 2022-1
+     * @param columns Nombre de colonnes L (1 à 20)
+     * @param rows Nombre de lignes D (4 à 20)
+     * @return true si L×D ne dépasse pas 100 et que chaque dimension est admise
+     */
+    static bool isValid(int columns, int rows);
+
+    /**
+     * @brief Constructeur
+     * @param columns Nombre de colonnes L de la matrice
+     * @param rows Nombre de lignes D de la matrice
+     */
+    FecEncoder(int columns, int rows);
+
+    /**
+     * @brief Ajoute un paquet RTP média à la matrice
+     * @param rtpPacket Paquet RTP tel qu'envoyé (en-tête de 12 octets compris)
+     * @param size Taille du paquet
+     * @return Paquets FEC complétés par ce paquet (au plus un par direction)
+     */
+    const std::vector<Packet>& protect(const uint8_t* rtpPacket, size_t size);
+
+private:
+    /**
+     * @brief Paquet FEC en cours de calcul
+     */
+    struct Accumulator {
+        std::vector<uint8_t> buffer;    ///< En-têtes puis XOR des charges utiles
+        size_t payloadSize = 0;         ///< Plus grande charge utile protégée
+        uint16_t snBase = 0;            ///< Premier numéro de séquence protégé
+        uint16_t lengthRecovery = 0;    ///< XOR des longueurs des charges utiles
+        uint8_t ptRecovery = 0;         ///< XOR des types de charge utile
+        uint32_t tsRecovery = 0;        ///< XOR des horodatages
+    };
+
+    /**
+     * @brief Démarre une nouvelle colonne ou ligne
+     */
+    static void reset(Accumulator& accumulator, uint16_t snBase);
+
+    /**
+     * @brief Ajoute un paquet média à une colonne ou une ligne
+     */
+    static void accumulate(Accumulator& accumulator, const uint8_t* rtpPacket, size_t size);
+
+    /**
+     * @brief Écrit les en-têtes RTP et FEC d'une colonne ou ligne complète
+     * @return Paquet FEC prêt à être envoyé
+     */
+    Packet finish(Accumulator& accumulator, Direction direction, uint32_t timestamp);
+
+    const int columns_;                     ///< Nombre de colonnes L
+    const int rows_;                        ///< Nombre de lignes D
+    int position_ = 0;                      ///< Position du prochain paquet dans la matrice
+    std::vector<Accumulator> columnFec_;    ///< Un paquet FEC par colonne
+    Accumulator rowFec_;                    ///< Paquet FEC de la ligne courante
+    uint16_t columnSequence_;               ///< Séquence RTP des paquets FEC de colonne
+    uint16_t rowSequence_;                  ///< Séquence RTP des paquets FEC de ligne
+    std::vector<Packet> ready_;             ///< Paquets complétés par le dernier paquet média
+};
+
+} // namespace hls_to_dvb
@@ -11,6 +11,18 @@
 #include <chrono>
 #include <utility> // Pour std::pair
 
+#include "../core/BufferAccountant.h"
+#include "../core/BufferPool.h"
+#include "../core/Config.h"
+#include "../core/Logging.h"
+#include "../core/MetricsRegistry.h"
+#include "../core/SegmentTrace.h"
+#include "../core/StreamStateFile.h"
+#include "FecEncoder.h"
+#include "PacketTxRing.h"
+#include "RtpPacketizer.h"
+#include "UringTransmitter.h"
+
 namespace hls_to_dvb {
 
 /**
@@ -27,6 +39,9 @@ struct MulticastStats {
     
     uint64_t errors = 0;          ///< Nombre d'erreurs d'envoi
     
+    size_t outputs = 1;           ///< Nombre de destinations (principale comprise)
+    uint64_t outputErrors = 0;    ///< Erreurs d'envoi vers les destinations supplémentaires
+    
     // Réinitialise les statistiques
     void reset() {
         packetsSent = 0;
@@ -35,6 +50,7 @@ struct MulticastStats {
         instantBitrate = 0.0;
         lastSendTime = std::chrono::system_clock::now();
         errors = 0;
+        outputErrors = 0;
     }
 };
 
@@ -89,6 +105,118 @@ public:
      */
     bool send(const std::vector<uint8_t>& data, bool discontinuity = false);
     
+    /**
+     * @brief Envoie des données sur le groupe multicast sans les copier
+     * 
+     * Une fois envoyé, le tampon est rendu à la réserve de tampons si elle est définie.
+     * 
+     * @param data Données à envoyer
+     * @param discontinuity Indique si ces données contiennent une discontinuité
+     * @return true si l'envoi a réussi, false sinon
+     */
+    bool send(std::vector<uint8_t>&& data, bool discontinuity = false);
+    
+    /**
+     * @brief Envoie un segment sans le copier en complétant sa trace
+     * 
+     * Les instants du premier et du dernier datagramme sont ajoutés à la trace, qui est
+     * ensuite transmise au traceur de segments du flux.
+     * 
+     * @param data Données à envoyer
+     * @param discontinuity Indique si ces données contiennent une discontinuité
+     * @param trace Trace du segment jusqu'à sa sortie du tampon de gigue
+     * @param outputState État de sortie à enregistrer une fois le segment envoyé (peut être nullptr)
+     * @return true si l'envoi a réussi, false sinon
+     */
+    bool send(std::vector<uint8_t>&& data, bool discontinuity, const SegmentTrace& trace,
+              std::shared_ptr<const StreamOutputState> outputState = nullptr);
+    
+    /**
+     * @brief Envoie un segment partagé avec d'autres émetteurs
+     * 
+     * Le segment n'est pas copié : plusieurs sorties alimentées par la même conversion
+     * reçoivent le même tampon, libéré après l'envoi par la dernière d'entre elles.
+     * Chaque émetteur n'en impute au budget mémoire que sa part : le tampon n'est
+     * compté qu'une fois, tous émetteurs confondus.
+     * 
+     * @param data Données partagées à envoyer
+     * @param discontinuity Indique si ces données contiennent une discontinuité
+     * @param trace Trace du segment jusqu'à sa sortie du tampon de gigue
+     * @param sharers Nombre d'émetteurs qui reçoivent ce tampon
+     * @param outputState État de sortie à enregistrer une fois le segment envoyé (peut être nullptr)
+     * @return true si l'envoi a réussi, false sinon
+     */
+    bool send(std::shared_ptr<const std::vector<uint8_t>> data, bool discontinuity, const SegmentTrace& trace,
+              size_t sharers = 1, std::shared_ptr<const StreamOutputState> outputState = nullptr);
+    
+    /**
+     * @brief Ajoute une destination alimentée par la même boucle d'envoi
+     * 
+     * Chaque datagramme d'un segment est émis vers la destination principale puis vers
+     * toutes les destinations supplémentaires : les sorties lisent le même tampon et
+     * partagent l'horloge d'envoi, sans copie ni thread par sortie. Une destination
+     * peut être un autre groupe multicast (éventuellement sur une autre interface),
+     * une adresse unicast, et encapsuler les datagrammes dans RTP.
+     * 
+     * Doit être appelée avant start().
+     * 
+     * @param output Configuration de la destination
+     * @return true si le socket de la destination a été ouvert, false sinon
+     */
+    bool addOutput(const OutputConfig& output);
+    
+    /**
+     * @brief Encapsule la sortie principale dans RTP (RFC 2250)
+     * 
+     * Les horodatages RTP sont dérivés des PCR du flux. Avec des dimensions de matrice
+     * non nulles, les paquets FEC SMPTE 2022-1 de colonne et de ligne sont émis vers le
+     * même groupe, sur les ports média + 2 et + 4. Doit être appelée avant start().
+     * 
+     * @param enabled true pour RTP, false pour des datagrammes MPEG-TS bruts
+     * @param fecColumns Nombre de colonnes L de la matrice FEC (0 = sans FEC)
+     * @param fecRows Nombre de lignes D de la matrice FEC (0 = sans FEC)
+     */
+    void setRtp(bool enabled, int fecColumns = 0, int fecRows = 0);
+    
+    /**
+     * @brief Émet une copie SMPTE 2022-7 de la sortie principale sur un second chemin
+     * 
+     * Chaque datagramme de la sortie principale, paquets FEC compris, est renvoyé à
+     * l'identique (même séquence et même horodatage RTP) vers un second groupe, en général
+     * sur une autre interface, dans la même itération de la boucle d'envoi : les deux
+     * copies partent à quelques microsecondes d'intervalle et un récepteur 2022-7 peut les
+     * fusionner sans coupure. Le protocole et la FEC de la configuration sont ignorés : la
+     * copie reprend ceux de la sortie principale. Doit être appelée après setRtp() et
+     * avant start().
+     * 
+     * @param output Groupe, port et interface du second chemin
+     * @return true si le socket du second chemin a été ouvert, false sinon
+     */
+    bool setRedundantOutput(const OutputConfig& output);
+    
+    /**
+     * @brief Émet la sortie principale par un anneau AF_PACKET partagé
+     * 
+     * Les datagrammes sont écrits dans l'anneau de l'interface, remis au noyau une fois
+     * par segment (ou à chaque pas du lissage de débit). Si l'anneau est plein, le
+     * datagramme part par le socket UDP. Doit être appelée avant start().
+     * 
+     * @param ring Anneau de l'interface de sortie (nullptr = socket UDP seul)
+     */
+    void setPacketRing(std::shared_ptr<PacketTxRing> ring);
+    
+    /**
+     * @brief Émet la sortie principale et sa copie redondante par lots io_uring
+     * 
+     * Le thread d'envoi ouvre son propre anneau io_uring : les datagrammes d'un segment
+     * sont soumis par lots d'un seul appel système (à chaque pas du lissage de débit si
+     * celui-ci est actif). Si io_uring est indisponible, l'émission reste sur sendto().
+     * Doit être appelée avant start().
+     * 
+     * @param entries Nombre de datagrammes par lot (0 = sendto() seul)
+     */
+    void setUring(unsigned entries);
+    
     /**
      * @brief Configure le débit du flux
      * @param bitrateKbps Débit en kilobits par seconde (0 = pas de limitation)
@@ -97,9 +225,12 @@ public:
     
     /**
      * @brief Récupère les statistiques du sender
-     * @return Structure contenant les statistiques
+     * 
+     * Les compteurs sont lus sans verrou pendant que le thread d'envoi les met à jour.
+     * 
+     * @return Copie des statistiques
      */
-    const MulticastStats& getStats() const;
+    MulticastStats getStats() const;
     
     /**
      * @brief Récupère l'adresse du groupe multicast
@@ -118,8 +249,61 @@ public:
      * @return true si le paquet a été envoyé avec succès, false sinon
      */
     bool sendTestPacket();
+
+    /**
+     * @brief Associe la file d'émission au compte mémoire du flux
+     * @param account Compte mémoire du flux (nullptr pour ne pas comptabiliser)
+     */
+    void setBufferAccount(std::shared_ptr<StreamBufferAccount> account);
+
+    /**
+     * @brief Définit la réserve à laquelle sont rendus les tampons envoyés
+     * @param pool Réserve de tampons du flux
+     */
+    void setBufferPool(std::shared_ptr<BufferPool> pool);
+
+    /**
+     * @brief Définit les mesures du flux alimentées par le thread d'envoi
+     * @param metrics Mesures du flux (nullptr pour ne rien exporter)
+     */
+    void setMetrics(std::shared_ptr<StreamMetrics> metrics);
+    
+    /**
+     * @brief Définit le fichier où est enregistré l'état de sortie des segments envoyés
+     *
+     * L'état porté par un segment n'est enregistré qu'une fois son dernier datagramme
+     * émis, au plus une fois par intervalle, puis à l'arrêt du thread d'envoi : un
+     * segment encore en file n'y figure jamais.
+     *
+     * @param stateFile Fichier d'état du flux (nullptr pour ne rien enregistrer)
+     * @param intervalMs Intervalle minimal entre deux enregistrements
+     */
+    void setStateFile(std::shared_ptr<StreamStateFile> stateFile, int intervalMs);
+
+    /**
+     * @brief Active les vérifications de démarrage (paquet de test envoyé par start())
+     * @param enabled true pour envoyer le paquet de test au démarrage
+     */
+    void setDiagnostics(bool enabled);
     
 private:
+    /**
+     * @brief Statistiques écrites par le thread d'envoi et lues par les autres threads
+     */
+    struct AtomicStats {
+        std::atomic<uint64_t> packetsSent{0};       ///< Paquets UDP envoyés
+        std::atomic<uint64_t> bytesSent{0};         ///< Octets envoyés
+        std::atomic<uint64_t> errors{0};            ///< Erreurs d'envoi
+        std::atomic<double> bitrate{0.0};           ///< Débit moyen (bits/s)
+        std::atomic<double> instantBitrate{0.0};    ///< Débit instantané (bits/s)
+        std::atomic<int64_t> lastSendTimeUs{0};     ///< Dernier envoi (µs depuis l'époque)
+    };
+
+    /**
+     * @brief Destination supplémentaire (définie dans MulticastSender.cpp)
+     */
+    struct Output;
+    
     std::string groupAddress_;
     int port_;
     std::string interface_;
@@ -133,9 +317,47 @@ private:
     
     std::mutex queueMutex_;
     std::condition_variable queueCond_;
-    std::queue<std::pair<std::vector<uint8_t>, bool>> dataQueue_; // Données + indicateur de discontinuité
+    /**
+     * @brief Segment en attente d'envoi
+     */
+    struct QueuedSegment {
+        std::vector<uint8_t> data;  ///< Données du segment
+        bool discontinuity;         ///< Indicateur de discontinuité
+        SegmentTrace trace;         ///< Trace du segment
+        std::shared_ptr<const std::vector<uint8_t>> shared; ///< Données partagées (remplacent data)
+        size_t charge = 0;          ///< Octets imputés au budget mémoire (part d'un tampon partagé)
+        std::shared_ptr<const StreamOutputState> outputState; ///< État de sortie après ce segment
+        
+        const std::vector<uint8_t>& payload() const { return shared ? *shared : data; }
+    };
     
-    MulticastStats stats_;
+    /**
+     * @brief Ajoute un segment à la file d'envoi
+     * @param segment Segment à envoyer
+     * @return true si le segment a été ajouté
+     */
+    bool enqueue(QueuedSegment&& segment);
+    std::queue<QueuedSegment> dataQueue_;
+    size_t queuedBytes_ = 0;                              ///< Octets en file ou en cours d'envoi
+    std::shared_ptr<StreamBufferAccount> bufferAccount_;  ///< Compte mémoire du flux
+    std::shared_ptr<BufferPool> bufferPool_;              ///< Réserve de tampons du flux
+    std::shared_ptr<StreamMetrics> metrics_;              ///< Mesures du flux
+    std::shared_ptr<StreamStateFile> stateFile_;          ///< Fichier d'état du flux (nullptr = aucun)
+    std::chrono::milliseconds stateInterval_{1000};       ///< Intervalle minimal entre deux enregistrements
+    std::shared_ptr<spdlog::logger> log_;                 ///< Logger du composant (chemins critiques)
+    bool diagnostics_ = false;                            ///< Envoi du paquet de test au démarrage
+    
+    AtomicStats stats_;
+    std::unique_ptr<RtpPacketizer> rtp_;                  ///< Encapsulation RTP de la sortie principale
+    std::unique_ptr<FecEncoder> fec_;                     ///< FEC de la sortie principale
+    std::shared_ptr<PacketTxRing> ring_;                  ///< Anneau d'émission partagé (nullptr = socket seul)
+    unsigned uringEntries_ = 0;                           ///< Taille des lots io_uring (0 = sendto() seul)
+    std::vector<std::unique_ptr<Output>> outputs_;        ///< Destinations supplémentaires (fixées avant start())
+    std::unique_ptr<Output> redundant_;                   ///< Second chemin SMPTE 2022-7 (fixé avant start())
+    std::atomic<uint64_t> outputErrors_{0};               ///< Erreurs d'envoi vers les destinations supplémentaires
+    bool primaryFailing_ = false;                         ///< Sortie principale en échec (thread d'envoi)
+    uint64_t primaryFailureCount_ = 0;                    ///< Datagrammes perdus depuis l'entrée en échec (thread d'envoi)
+    std::chrono::steady_clock::time_point lastSegmentSent_; ///< Fin d'envoi du segment précédent (thread d'envoi)
     
     // Variables pour le contrôle de débit
     std::chrono::steady_clock::time_point lastSendTime_;
@@ -143,6 +365,50 @@ private:
     
     void senderLoop();
     bool createSocket();
+
+    /**
+     * @brief Émet un datagramme vers toutes les destinations supplémentaires
+     * @param payload Paquets MPEG-TS du datagramme
+     * @param size Taille des paquets en octets
+     */
+    void sendToOutputs(const uint8_t* payload, size_t size);
+
+    /**
+     * @brief Émet un datagramme prêt à partir vers une destination
+     * @param output Destination
+     * @param datagram Datagramme (déjà encapsulé si la destination est en RTP)
+     * @param size Taille du datagramme en octets
+     */
+    void sendToOutput(Output& output, const uint8_t* datagram, size_t size);
+
+    /**
+     * @brief Soumet le lot io_uring en attente et reporte ses échecs dans les statistiques
+     * @param uring Anneau du thread d'envoi
+     * @param metrics Mesures du flux (peut être nullptr)
+     */
+    void flushUring(UringTransmitter& uring, const std::shared_ptr<StreamMetrics>& metrics);
+
+    /**
+     * @brief Suit l'état d'échec de la sortie principale
+     *
+     * Seules l'entrée en échec et le rétablissement sont journalisés et signalés, ce
+     * dernier avec le nombre de datagrammes perdus entre les deux.
+     *
+     * @param failures Datagrammes non envoyés (0 = envoi réussi)
+     * @param error Code d'erreur du dernier échec
+     */
+    void updatePrimaryState(uint64_t failures, int error);
+
+    /**
+     * @brief Restitue des octets au budget mémoire (queueMutex_ déjà verrouillé)
+     * @param bytes Nombre d'octets libérés
+     */
+    void releaseQueuedBytesInternal(size_t bytes);
+
+    /**
+     * @brief Remet les statistiques à zéro
+     */
+    void resetStats();
     void closeSocket();
 
     /**
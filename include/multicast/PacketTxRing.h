@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace hls_to_dvb {
+
+/**
+ * @class PacketTxRing
+ * @brief Anneau d'émission AF_PACKET (PACKET_TX_RING) partagé par les flux d'une interface
+ *
+ * Les trames Ethernet/IPv4/UDP complètes sont écrites directement dans un anneau projeté
+ * en mémoire et partagé avec le noyau, puis remises à la carte par un seul appel système
+ * pour toutes les trames en attente. Le datagramme ne traverse plus la pile de sockets :
+ * pas d'appel système ni de copie par datagramme côté noyau.
+ *
+ * Un anneau est ouvert par interface et partagé par tous les émetteurs qui l'utilisent.
+ * Seuls les groupes multicast IPv4 sont émis par l'anneau (l'adresse MAC de destination
+ * se déduit du groupe) ; l'appelant revient aux sockets UDP pour le reste, si l'anneau
+ * est plein, ou si l'anneau ne peut pas être ouvert (plateforme autre que Linux,
+ * absence de CAP_NET_RAW).
+ *
+ * Thread-safe : plusieurs threads d'envoi peuvent écrire dans le même anneau.
+ */
+class PacketTxRing {
+public:
+    /**
+     * @brief Ouvre l'anneau d'une interface, ou réutilise celui déjà ouvert
+     * @param interface Nom de l'interface (par exemple "eth1")
+     * @param frames Nombre de trames de l'anneau s'il doit être créé
+     * @return Anneau partagé, ou nullptr s'il ne peut pas être ouvert
+     */
+    static std::shared_ptr<PacketTxRing> acquire(const std::string& interface, int frames);
+
+    /**
+     * @brief Destructeur (attend l'émission des trames en attente puis libère l'anneau)
+     */
+    ~PacketTxRing();
+
+    PacketTxRing(const PacketTxRing&) = delete;
+    PacketTxRing& operator=(const PacketTxRing&) = delete;
+
+    /**
+     * @brief Écrit un datagramme UDP multicast dans l'anneau
+     *
+     * La trame est seulement mise en attente : elle part au prochain appel de flush().
+     *
+     * @param destinationIp Groupe multicast de destination (ordre réseau)
+     * @param destinationPort Port de destination (ordre réseau)
+     * @param sourcePort Port source (ordre réseau)
+     * @param ttl TTL du paquet IP
+     * @param payload Charge utile UDP
+     * @param size Taille de la charge utile
+     * @return false si la destination n'est pas multicast, si la charge ne tient pas dans
+     *         une trame ou si l'anneau est plein
+     */
+    bool send(uint32_t destinationIp, uint16_t destinationPort, uint16_t sourcePort, uint8_t ttl,
+              const uint8_t* payload, size_t size);
+
+    /**
+     * @brief Remet au noyau toutes les trames en attente, tous émetteurs confondus
+     */
+    void flush();
+
+    /**
+     * @brief Récupère le nom de l'interface de l'anneau
+     * @return Nom de l'interface
+     */
+    const std::string& getInterface() const;
+
+    /**
+     * @brief Récupère le nombre de trames émises par l'anneau
+     * @return Nombre de trames remises au noyau
+     */
+    uint64_t getFramesSent() const;
+
+private:
+    PacketTxRing(const std::string& interface, int fd, uint8_t* ring, size_t ringSize,
+                 size_t frameSize, size_t frameCount, const uint8_t* sourceMac, uint32_t sourceIp);
+
+    const std::string interface_;           ///< Interface de l'anneau
+    const int fd_;                          ///< Socket AF_PACKET
+    uint8_t* const ring_;                   ///< Anneau projeté en mémoire
+    const size_t ringSize_;                 ///< Taille de la projection
+    const size_t frameSize_;                ///< Taille d'une trame de l'anneau
+    const size_t frameCount_;               ///< Nombre de trames de l'anneau
+    uint8_t sourceMac_[6];                  ///< Adresse MAC de l'interface
+    const uint32_t sourceIp_;               ///< Adresse IPv4 de l'interface (ordre réseau)
+
+    std::mutex mutex_;                      ///< Protège l'écriture des trames
+    size_t next_ = 0;                       ///< Prochaine trame à écrire
+    uint16_t ipId_ = 0;                     ///< Identifiant du prochain paquet IP
+    std::atomic<uint64_t> framesSent_{0};   ///< Trames écrites dans l'anneau
+};
+
+} // namespace hls_to_dvb
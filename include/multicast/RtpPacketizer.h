@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hls_to_dvb {
+
+/**
+ * @class RtpPacketizer
+ * @brief Encapsulation RTP (RFC 2250) des datagrammes MPEG-TS d'une sortie
+ *
+ * Chaque datagramme de paquets MPEG-TS reçoit un en-tête RTP fixe : numéro de séquence
+ * consécutif, horodatage à 90 kHz et identifiant de source propre à la sortie.
+ *
+ * L'horodatage est dérivé des PCR du flux : le dernier PCR rencontré est prolongé au
+ * début du datagramme au débit mesuré entre les deux derniers PCR. Les récepteurs
+ * retrouvent ainsi l'horloge du programme même si l'envoi est irrégulier. Tant qu'aucun
+ * PCR n'a été vu, l'horloge locale est utilisée.
+ *
+ * Non synchronisée : chaque instance appartient au thread d'envoi de sa sortie.
+ */
+class RtpPacketizer {
+public:
+    static constexpr size_t HEADER_SIZE = 12;           ///< En-tête RTP sans CSRC ni extension
+    static constexpr uint8_t PAYLOAD_TYPE_MP2T = 33;    ///< Type de charge utile MPEG-TS (RFC 3551)
+
+    /**
+     * @brief Constructeur (séquence initiale et identifiant de source aléatoires)
+     */
+    RtpPacketizer();
+
+    /**
+     * @brief Encapsule un datagramme de paquets MPEG-TS
+     * @param payload Paquets MPEG-TS (multiple de 188 octets)
+     * @param size Taille des paquets en octets
+     * @param packet Paquet RTP produit (au moins HEADER_SIZE + size octets)
+     * @return Taille du paquet RTP
+     */
+    size_t packetize(const uint8_t* payload, size_t size, uint8_t* packet);
+
+private:
+    /**
+     * @brief Calcule l'horodatage 90 kHz du début d'un datagramme
+     * @param payload Paquets MPEG-TS du datagramme
+     * @param size Taille des paquets en octets
+     * @return Horodatage RTP
+     */
+    uint32_t timestampFor(const uint8_t* payload, size_t size);
+
+    uint16_t sequence_;                 ///< Numéro de séquence du prochain paquet
+    uint32_t ssrc_;                     ///< Identifiant de source
+    uint64_t bytes_ = 0;                ///< Octets MPEG-TS encapsulés depuis le début
+    bool hasPcr_ = false;               ///< Un PCR a été rencontré
+    uint16_t pcrPid_ = 0;               ///< PID dont les PCR servent de référence
+    uint64_t lastPcr_ = 0;              ///< Base du dernier PCR (90 kHz, 33 bits)
+    uint64_t lastPcrByte_ = 0;          ///< Position du dernier PCR dans le flux
+    double ticksPerByte_ = 0.0;         ///< Débit mesuré entre les deux derniers PCR
+};
+
+} // namespace hls_to_dvb
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct sockaddr_in;
+
+namespace hls_to_dvb {
+
+/**
+ * @class UringTransmitter
+ * @brief Émission groupée de datagrammes UDP par io_uring (Linux)
+ *
+ * Les datagrammes d'un segment sont déposés dans la file de soumission d'un anneau
+ * io_uring, puis soumis ensemble : un seul appel système émet tout un lot et attend
+ * ses complétions, au lieu d'un appel sendto() par datagramme. Les données ne sont pas
+ * copiées : elles doivent rester valides jusqu'à flush(). Les datagrammes construits à
+ * la volée (en-tête RTP) sont préparés dans des emplacements propres à l'anneau.
+ *
+ * Les entrées d'un lot sont chaînées (IOSQE_IO_LINK) : elles partent dans l'ordre de
+ * leur ajout. Un datagramme refusé temporairement (tampon du socket plein) est soumis
+ * de nouveau avec la suite du lot, que le noyau a annulée.
+ *
+ * L'anneau est manipulé directement par les appels système io_uring_setup et
+ * io_uring_enter, sans dépendance externe.
+ *
+ * Non synchronisée : chaque instance appartient au thread d'envoi d'un émetteur.
+ */
+class UringTransmitter {
+public:
+    static constexpr size_t SLOT_SIZE = 1500;  ///< Taille maximale d'un datagramme préparé
+
+    /**
+     * @brief Résultat des complétions d'un lot
+     */
+    struct Result {
+        uint64_t primaryFailures = 0;   ///< Datagrammes de la sortie principale non envoyés
+        uint64_t otherFailures = 0;     ///< Autres datagrammes non envoyés
+        int error = 0;                  ///< Code errno du premier échec
+    };
+
+    /**
+     * @brief Crée un anneau io_uring
+     * @param entries Nombre de datagrammes par lot (arrondi à une puissance de 2)
+     * @return Anneau, ou nullptr si io_uring n'est pas disponible
+     */
+    static std::unique_ptr<UringTransmitter> create(unsigned entries);
+
+    /**
+     * @brief Destructeur (libère l'anneau; les datagrammes non soumis sont abandonnés)
+     */
+    ~UringTransmitter();
+
+    UringTransmitter(const UringTransmitter&) = delete;
+    UringTransmitter& operator=(const UringTransmitter&) = delete;
+
+    /**
+     * @brief Indique si le lot peut encore recevoir des datagrammes
+     * @param datagrams Nombre de datagrammes à ajouter
+     * @return false si le lot doit d'abord être soumis
+     */
+    bool hasRoom(unsigned datagrams) const;
+
+    /**
+     * @brief Indique si des datagrammes attendent d'être soumis
+     * @return true si le lot n'est pas vide
+     */
+    bool hasPending() const;
+
+    /**
+     * @brief Réserve l'emplacement du prochain datagramme pour le construire sur place
+     * @return Emplacement de SLOT_SIZE octets, valide jusqu'à flush()
+     */
+    uint8_t* slot();
+
+    /**
+     * @brief Ajoute un datagramme au lot
+     * @param socket Socket UDP d'émission
+     * @param destination Adresse de destination (copiée)
+     * @param data Datagramme (valide jusqu'à flush(), ou emplacement obtenu par slot())
+     * @param size Taille du datagramme
+     * @param primary true pour un datagramme de la sortie principale
+     */
+    void queue(int socket, const struct sockaddr_in& destination, const uint8_t* data, size_t size, bool primary);
+
+    /**
+     * @brief Soumet le lot et attend que tous ses datagrammes soient émis
+     * @return Échecs du lot
+     */
+    Result flush();
+
+private:
+    UringTransmitter() = default;
+
+    /**
+     * @brief État d'un datagramme du lot (défini dans UringTransmitter.cpp)
+     */
+    struct Entry;
+
+    /**
+     * @brief Soumet en une chaîne les datagrammes du lot à partir d'un indice
+     * @param first Premier datagramme à soumettre
+     * @param result Échecs du lot, complétés
+     * @return Premier datagramme à soumettre de nouveau (pending_ si le lot est terminé)
+     */
+    unsigned submitChain(unsigned first, Result& result);
+
+    /**
+     * @brief Compte l'échec d'un datagramme
+     * @param result Échecs du lot
+     * @param entry Datagramme en échec
+     * @param error Code errno
+     */
+    static void countFailure(Result& result, const Entry& entry, int error);
+
+    int fd_ = -1;                           ///< Descripteur de l'anneau
+    void* sqRing_ = nullptr;                ///< Projection de la file de soumission
+    size_t sqRingSize_ = 0;                 ///< Taille de la projection de la file de soumission
+    void* cqRing_ = nullptr;                ///< Projection de la file de complétion
+    size_t cqRingSize_ = 0;                 ///< Taille de la projection de la file de complétion
+    void* sqes_ = nullptr;                  ///< Entrées de soumission
+    size_t sqesSize_ = 0;                   ///< Taille des entrées de soumission
+
+    unsigned* sqTail_ = nullptr;            ///< Queue de la file de soumission
+    unsigned* sqMask_ = nullptr;            ///< Masque de la file de soumission
+    unsigned* sqArray_ = nullptr;           ///< Indices des entrées soumises
+    unsigned* cqHead_ = nullptr;            ///< Tête de la file de complétion
+    unsigned* cqTail_ = nullptr;            ///< Queue de la file de complétion
+    unsigned* cqMask_ = nullptr;            ///< Masque de la file de complétion
+    void* cqes_ = nullptr;                  ///< Complétions
+
+    unsigned entries_ = 0;                  ///< Capacité d'un lot
+    unsigned pending_ = 0;                  ///< Datagrammes en attente de soumission
+    bool broken_ = false;                   ///< Anneau hors service: envoi par sendmsg()
+    std::vector<Entry> entryStates_;        ///< Message et adresse de chaque datagramme du lot
+    std::vector<uint8_t> slots_;            ///< Emplacements des datagrammes préparés
+};
+
+} // namespace hls_to_dvb
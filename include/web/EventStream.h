@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace hls_to_dvb {
+
+/**
+ * @class EventStream
+ * @brief Canal de diffusion Server-Sent Events partagé par tous les tableaux de bord
+ *
+ * Un seul producteur sérialise chaque événement une fois ; les connexions clientes
+ * relisent le même texte à partir de leur propre curseur. Un client qui arrive, ou
+ * qui a pris trop de retard sur l'historique, reçoit d'abord l'état complet.
+ */
+class EventStream {
+public:
+    /**
+     * @brief Constructeur
+     * @param historySize Nombre d'événements conservés pour les clients en retard
+     */
+    explicit EventStream(size_t historySize = 64);
+
+    /**
+     * @brief Publie un événement à tous les clients
+     * @param event Nom de l'événement (champ "event:")
+     * @param data Données JSON sur une seule ligne (champ "data:")
+     */
+    void publish(const std::string& event, const std::string& data);
+
+    /**
+     * @brief Remplace l'état complet envoyé aux nouveaux clients
+     *
+     * À appeler avant de publier les événements qui y mènent : un client qui reçoit cet
+     * état peut alors recevoir une seconde fois ces événements, qui doivent donc être
+     * idempotents, mais n'en manque aucun.
+     *
+     * @param data Données JSON sur une seule ligne
+     */
+    void setSnapshot(const std::string& data);
+
+    /**
+     * @brief Inscrit un client
+     * @return false si le nombre maximal de clients est atteint
+     */
+    bool subscribe(size_t maxSubscribers);
+
+    /**
+     * @brief Désinscrit un client
+     */
+    void unsubscribe();
+
+    /**
+     * @brief Indique le nombre de clients connectés
+     * @return Nombre de clients
+     */
+    size_t getSubscriberCount() const;
+
+    /**
+     * @brief Attend les événements postérieurs au curseur d'un client
+     *
+     * Au premier appel (curseur à 0) ou si des événements ont quitté l'historique,
+     * l'état complet est renvoyé à la place des événements manqués.
+     *
+     * @param cursor Identifiant du dernier événement reçu, mis à jour
+     * @param out Texte SSE à écrire sur la connexion (vide si le délai a expiré)
+     * @param timeout Délai d'attente maximal
+     * @return false si le canal est fermé
+     */
+    bool waitForEvents(uint64_t& cursor, std::string& out, std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Ferme le canal et réveille tous les clients
+     */
+    void close();
+
+    /**
+     * @brief Rouvre le canal après une fermeture
+     */
+    void reopen();
+
+private:
+    /**
+     * @brief Événement sérialisé
+     */
+    struct Event {
+        uint64_t id;        ///< Identifiant croissant
+        std::string text;   ///< Texte SSE complet
+    };
+
+    mutable std::mutex mutex_;          ///< Protège l'historique et l'état complet
+    std::condition_variable cond_;      ///< Réveille les clients à chaque publication
+    std::deque<Event> history_;         ///< Derniers événements publiés
+    size_t historySize_;                ///< Taille maximale de l'historique
+    uint64_t lastId_ = 0;               ///< Identifiant du dernier événement
+    std::string snapshot_;              ///< Données de l'état complet
+    size_t subscribers_ = 0;            ///< Clients connectés
+    bool closed_ = false;               ///< Canal fermé
+};
+
+} // namespace hls_to_dvb
@@ -4,8 +4,12 @@
 #include <thread>
 #include <memory>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <nlohmann/json_fwd.hpp>
 #include "core/config.h"
 #include "core/StreamManager.h"
+#include "EventStream.h"
 
 // Forward declarations pour éviter les inclusions circulaires
 namespace httplib {
@@ -68,6 +72,11 @@ private:
      */
     void handleGetStreams(const httplib::Request& req, httplib::Response& res);
     
+    /**
+     * @brief Gestionnaire pour la route GET /api/events (Server-Sent Events)
+     */
+    void handleGetEvents(const httplib::Request& req, httplib::Response& res);
+    
     /**
      * @brief Gestionnaire pour la route POST /api/streams
      */
@@ -103,6 +112,21 @@ private:
      */
     void handleGetStats(const httplib::Request& req, httplib::Response& res);
     
+    /**
+     * @brief Gestionnaire pour la route GET /api/streams/{id}/latency (latences par étape)
+     */
+    void handleGetStreamLatency(const httplib::Request& req, httplib::Response& res);
+    
+    /**
+     * @brief Gestionnaire pour la route GET /api/trace (traces de segments, format Chrome trace-event)
+     */
+    void handleGetTrace(const httplib::Request& req, httplib::Response& res);
+    
+    /**
+     * @brief Gestionnaire pour la route GET /metrics (format texte Prometheus)
+     */
+    void handleGetMetrics(const httplib::Request& req, httplib::Response& res);
+    
     /**
      * @brief Gestionnaire pour la route GET /api/alerts
      */
@@ -118,6 +142,32 @@ private:
      */
     void handleExportAlerts(const httplib::Request& req, httplib::Response& res);
     
+    /**
+     * @brief Construit la liste des flux avec leurs statistiques
+     * @return Tableau JSON (format de GET /api/streams)
+     */
+    nlohmann::json buildStreamsJson();
+    
+    /**
+     * @brief Construit la liste des alertes actives
+     * @return Tableau JSON (format de GET /api/alerts)
+     */
+    nlohmann::json buildAlertsJson();
+    
+    /**
+     * @brief Construit les statistiques globales
+     * @return Objet JSON (format de GET /api/stats)
+     */
+    nlohmann::json buildStatsJson();
+    
+    /**
+     * @brief Boucle du thread qui construit l'état partagé et publie les différences
+     *
+     * L'état n'est construit qu'une fois par période, quel que soit le nombre de
+     * tableaux de bord connectés, et pas du tout en l'absence de client.
+     */
+    void publisherLoop();
+    
     /**
      * @brief Génère un ID unique pour un nouveau flux
      * @param name Nom du flux
@@ -131,6 +181,11 @@ private:
     std::unique_ptr<httplib::Server> server_; ///< Serveur HTTP
     std::thread serverThread_;                ///< Thread du serveur
     std::atomic<bool> running_;               ///< Indicateur d'exécution
+    
+    EventStream events_;                      ///< Canal SSE partagé par les tableaux de bord
+    std::thread publisherThread_;             ///< Thread de publication des événements
+    std::mutex publisherMutex_;               ///< Protège l'attente du thread de publication
+    std::condition_variable publisherCond_;   ///< Réveille le thread de publication
 };
 
 } // namespace hls_to_dvb
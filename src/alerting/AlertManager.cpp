@@ -6,6 +6,7 @@
 #include <iomanip>      // Pour setw, setfill
 #include <chrono>       // Pour fonctionnalités de temps
 #include <algorithm>    // Pour std::find_if, std::remove_if
+#include <bit>          // Pour std::bit_width
 
 
 namespace hls_to_dvb {
@@ -27,9 +28,41 @@ std::string generateUniqueId() {
     return ss.str();
 }
 
+namespace {
+    // Délai maximal entre le dépôt d'une alerte et son traitement
+    constexpr auto PROCESS_PERIOD = std::chrono::milliseconds(50);
+    
+    // Clé de regroupement des alertes identiques
+    std::string alertKey(AlertLevel level, const std::string& component, const std::string& message) {
+        std::string key;
+        key.reserve(component.size() + message.size() + 4);
+        key += static_cast<char>('0' + static_cast<int>(level));
+        key += '\x1f';
+        key += component;
+        key += '\x1f';
+        key += message;
+        return key;
+    }
+    
+    // Journaliser une alerte au niveau correspondant
+    void logAlert(const Alert& alert) {
+        switch (alert.level) {
+            case AlertLevel::INFO:
+                spdlog::info("[{}] INFO: {}", alert.component, alert.message);
+                break;
+            case AlertLevel::WARNING:
+                spdlog::warn("[{}] WARNING: {}", alert.component, alert.message);
+                break;
+            case AlertLevel::ERROR:
+                spdlog::error("[{}] ERROR: {}", alert.component, alert.message);
+                break;
+        }
+    }
+}
+
 Alert::Alert(AlertLevel lvl, const std::string& comp, const std::string& msg, bool persist)
-    : level(lvl), component(comp), message(msg), timestamp(std::chrono::system_clock::now()),
-      persistent(persist), id(generateUniqueId())
+    : level(lvl), message(msg), component(comp), timestamp(std::chrono::system_clock::now()),
+      persistent(persist), id(generateUniqueId()), firstSeen(timestamp)
 {
 }
 
@@ -38,76 +71,176 @@ AlertManager& AlertManager::getInstance() {
     return instance;
 }
 
-AlertManager::AlertManager() {
+AlertManager::AlertManager()
+    : pending_(QUEUE_CAPACITY) {
     // Valeurs par défaut pour la rétention
     retention_[AlertLevel::INFO] = 7200;      // 2 heures
     retention_[AlertLevel::WARNING] = 86400;  // 24 heures
     retention_[AlertLevel::ERROR] = 604800;   // 7 jours
+    
+    // Compteurs exportés, créés une fois pour ne pas solliciter le registre à chaque alerte
+    auto& registry = MetricsRegistry::getInstance();
+    const std::string help = "Alertes émises";
+    alertCounters_[AlertLevel::INFO] = registry.counter("hls2dvb_alerts_total", help, {{"level", "info"}});
+    alertCounters_[AlertLevel::WARNING] = registry.counter("hls2dvb_alerts_total", help, {{"level", "warning"}});
+    alertCounters_[AlertLevel::ERROR] = registry.counter("hls2dvb_alerts_total", help, {{"level", "error"}});
+    droppedCounter_ = registry.counter("hls2dvb_alerts_dropped_total",
+        "Alertes rejetées faute de place dans la file de traitement");
+    
+    workerThread_ = std::thread(&AlertManager::workerLoop, this);
 }
 
 AlertManager::~AlertManager() {
-    // Vider les ressources
+    {
+        std::lock_guard<std::mutex> lock(workerMutex_);
+        stopping_ = true;
+    }
+    workerCond_.notify_all();
+    if (workerThread_.joinable()) {
+        workerThread_.join();
+    }
 }
 
-std::string AlertManager::addAlert(AlertLevel level, const std::string& component, 
-                               const std::string& message, bool persistent) {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
+bool AlertManager::addAlert(AlertLevel level, const std::string& component, 
+                            const std::string& message, bool persistent) {
+    // Chemin appelé depuis les threads du pipeline: aucun verrou, aucune attente
+    alertCounters_.at(level)->increment();
     
-    // Créer une nouvelle alerte
-    Alert alert(level, component, message, persistent);
-    
-    // Nettoyer les alertes expirées
-    cleanupExpiredAlerts();
+    // Le regroupement des alertes identiques est fait par le thread de traitement
+    PendingAlert alert;
+    alert.level = level;
+    alert.component = component;
+    alert.message = message;
+    alert.persistent = persistent;
+    alert.timestamp = std::chrono::system_clock::now();
     
-    // Ajouter l'alerte à la liste appropriée
-    if (persistent) {
-        persistentAlerts_[alert.id] = alert;
-    } else {
-        alerts_.push_back(alert);
+    if (!pending_.tryPush(std::move(alert))) {
+        droppedCounter_->increment();
+        return false;
     }
+    return true;
+}
+
+void AlertManager::flush() {
+    processPending();
+}
+
+void AlertManager::workerLoop() {
+    uint64_t reportedDrops = 0;
     
-    // Journaliser l'alerte
-    std::string levelStr;
-    switch (level) {
-        case AlertLevel::INFO:
-            levelStr = "INFO";
-            spdlog::info("[{}] {}: {}", component, levelStr, message);
-            break;
-        case AlertLevel::WARNING:
-            levelStr = "WARNING";
-            spdlog::warn("[{}] {}: {}", component, levelStr, message);
-            break;
-        case AlertLevel::ERROR:
-            levelStr = "ERROR";
-            spdlog::error("[{}] {}: {}", component, levelStr, message);
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(workerMutex_);
+            workerCond_.wait_for(lock, PROCESS_PERIOD, [this] { return stopping_; });
+            stopping = stopping_;
+        }
+        
+        processPending();
+        
+        uint64_t drops = droppedCounter_->get();
+        if (drops != reportedDrops) {
+            spdlog::warn("File des alertes saturée: {} alertes rejetées depuis le démarrage", drops);
+            reportedDrops = drops;
+        }
+        
+        if (stopping) {
             break;
+        }
     }
+}
+
+void AlertManager::processPending() {
+    std::lock_guard<std::mutex> processLock(processMutex_);
     
-    // Appeler les fonctions de rappel enregistrées
-    for (const auto& callback : callbacks_) {
-        callback.second(alert);
+    std::vector<Alert> created;
+    std::vector<Alert> repeated;
+    std::vector<std::function<void(const Alert&)>> callbacks;
+    
+    {
+        std::lock_guard<std::mutex> lock(alertsMutex_);
+        
+        PendingAlert pending;
+        while (pending_.tryPop(pending)) {
+            std::string key = alertKey(pending.level, pending.component, pending.message);
+            
+            // Alerte identique encore active: la regrouper
+            Alert* existing = nullptr;
+            auto keyIt = activeKeys_.find(key);
+            if (keyIt != activeKeys_.end()) {
+                auto it = alerts_.find(keyIt->second);
+                if (it != alerts_.end()) {
+                    existing = &it->second;
+                } else {
+                    auto persistentIt = persistentAlerts_.find(keyIt->second);
+                    if (persistentIt != persistentAlerts_.end()) {
+                        existing = &persistentIt->second;
+                    }
+                }
+            }
+            
+            if (existing) {
+                uint64_t previous = existing->count;
+                existing->count++;
+                existing->timestamp = std::max(existing->timestamp, pending.timestamp);
+                
+                // Journaliser les répétitions de façon espacée (à chaque puissance de deux franchie)
+                if (std::bit_width(previous) != std::bit_width(existing->count)) {
+                    repeated.push_back(*existing);
+                }
+                continue;
+            }
+            
+            Alert alert(pending.level, pending.component, pending.message, pending.persistent);
+            alert.timestamp = pending.timestamp;
+            alert.firstSeen = pending.timestamp;
+            
+            activeKeys_[key] = alert.id;
+            if (alert.persistent) {
+                persistentAlerts_[alert.id] = alert;
+            } else {
+                alerts_[alert.id] = alert;
+            }
+            created.push_back(std::move(alert));
+        }
+        
+        cleanupExpiredAlerts();
+        
+        if (!created.empty()) {
+            for (const auto& callback : callbacks_) {
+                callbacks.push_back(callback.second);
+            }
+        }
     }
     
-    return alert.id;
+    // Journaliser et appeler les fonctions de rappel hors du verrou des alertes
+    for (const auto& alert : created) {
+        logAlert(alert);
+        for (const auto& callback : callbacks) {
+            callback(alert);
+        }
+    }
+    for (const auto& alert : repeated) {
+        spdlog::info("[{}] Alerte répétée {} fois depuis {} s: {}", alert.component, alert.count,
+                     std::chrono::duration_cast<std::chrono::seconds>(alert.timestamp - alert.firstSeen).count(),
+                     alert.message);
+    }
 }
 
 bool AlertManager::resolveAlert(const std::string& alertId) {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
+    // Traiter d'abord les alertes en attente pour que l'ID soit connu
+    processPending();
     
-    // Chercher dans les alertes persistantes
-    auto it = persistentAlerts_.find(alertId);
-    if (it != persistentAlerts_.end()) {
-        persistentAlerts_.erase(it);
-        return true;
-    }
-    
-    // Chercher dans les alertes normales
-    auto alertIt = std::find_if(alerts_.begin(), alerts_.end(),
-                               [&alertId](const Alert& a) { return a.id == alertId; });
+    std::lock_guard<std::mutex> lock(alertsMutex_);
     
-    if (alertIt != alerts_.end()) {
-        alerts_.erase(alertIt);
-        return true;
+    // Chercher dans les alertes persistantes, puis dans les alertes normales
+    for (auto* store : {&persistentAlerts_, &alerts_}) {
+        auto it = store->find(alertId);
+        if (it != store->end()) {
+            activeKeys_.erase(alertKey(it->second.level, it->second.component, it->second.message));
+            store->erase(it);
+            return true;
+        }
     }
     
     return false;
@@ -125,9 +258,12 @@ std::vector<Alert> AlertManager::getActiveAlerts() const {
     std::lock_guard<std::mutex> lock(alertsMutex_);
     
     // Combiner les alertes normales et persistantes dans un seul vecteur
-    std::vector<Alert> activeAlerts = alerts_;
+    std::vector<Alert> activeAlerts;
+    activeAlerts.reserve(alerts_.size() + persistentAlerts_.size());
     
-    // Ajouter les alertes persistantes
+    for (const auto& pair : alerts_) {
+        activeAlerts.push_back(pair.second);
+    }
     for (const auto& pair : persistentAlerts_) {
         activeAlerts.push_back(pair.second);
     }
@@ -161,16 +297,17 @@ bool AlertManager::unregisterCallback(int callbackId) {
 void AlertManager::cleanupExpiredAlerts() {
     auto now = std::chrono::system_clock::now();
     
-    // Supprimer les alertes non persistantes expirées
-    alerts_.erase(
-        std::remove_if(alerts_.begin(), alerts_.end(),
-                      [this, now](const Alert& alert) {
-                          auto retention = retention_[alert.level];
-                          auto expirationTime = alert.timestamp + std::chrono::seconds(retention);
-                          return !alert.persistent && expirationTime < now;
-                      }),
-        alerts_.end()
-    );
+    // Supprimer les alertes non persistantes expirées (depuis leur dernière occurrence)
+    for (auto it = alerts_.begin(); it != alerts_.end();) {
+        const Alert& alert = it->second;
+        auto expirationTime = alert.timestamp + std::chrono::seconds(retention_[alert.level]);
+        if (expirationTime < now) {
+            activeKeys_.erase(alertKey(alert.level, alert.component, alert.message));
+            it = alerts_.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
-} // namespace hls_to_dvb
\ No newline at end of file
+} // namespace hls_to_dvb
@@ -1,16 +1,14 @@
 #include "core/Application.h"
 #include "core/config.h"
+#include "core/Logging.h"
 #include "core/StreamManager.h"
 #include "web/WebServer.h"
 #include "alerting/AlertManager.h"
 #include <iostream>
 
 #include <spdlog/spdlog.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
-#include <spdlog/sinks/rotating_file_sink.h>
 
 #include <thread>
-#include <filesystem>
 
 namespace hls_to_dvb {
 
@@ -165,58 +163,7 @@ StreamManager& Application::getStreamManager() {
 }
 
 bool Application::initializeLogging() {
-    try {
-        const auto& loggingConfig = config_->getLoggingConfig();
-        
-        // Créer les sinks
-        std::vector<spdlog::sink_ptr> sinks;
-        
-        // Console sink
-        if (loggingConfig.console) {
-            auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-            sinks.push_back(console_sink);
-        }
-        
-        // File sink
-        if (loggingConfig.file.enabled) {
-            // Créer le dossier des logs s'il n'existe pas
-            std::filesystem::path logPath(loggingConfig.file.path);
-            std::filesystem::create_directories(logPath.parent_path());
-            
-            auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-                loggingConfig.file.path,
-                loggingConfig.file.rotationSize,
-                loggingConfig.file.maxFiles
-            );
-            sinks.push_back(file_sink);
-        }
-        
-        // Créer le logger
-        auto logger = std::make_shared<spdlog::logger>("main", sinks.begin(), sinks.end());
-        
-        // Configurer le niveau de log
-        spdlog::level::level_enum level = spdlog::level::info;
-        if (loggingConfig.level == "debug") {
-            level = spdlog::level::debug;
-        } else if (loggingConfig.level == "info") {
-            level = spdlog::level::info;
-        } else if (loggingConfig.level == "warning") {
-            level = spdlog::level::warn;
-        } else if (loggingConfig.level == "error") {
-            level = spdlog::level::err;
-        }
-        
-        logger->set_level(level);
-        spdlog::set_default_logger(logger);
-        
-        spdlog::info("Logging initialized: level={}, console={}, file={}",
-                    loggingConfig.level, loggingConfig.console, loggingConfig.file.enabled);
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error initializing logging: " << e.what() << std::endl;
-        return false;
-    }
+    return Logging::initialize(config_->getLoggingConfig());
 }
 
 bool Application::initializeAlertManager() {
@@ -0,0 +1,241 @@
+#include "core/BufferAccountant.h"
+#include "alerting/AlertManager.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace hls_to_dvb {
+
+const char* bufferStageName(BufferStage stage) {
+    switch (stage) {
+        case BufferStage::HLS_QUEUE:
+            return "hlsQueue";
+        case BufferStage::SEGMENT_BUFFER:
+            return "segmentBuffer";
+        case BufferStage::MULTICAST_QUEUE:
+            return "multicastQueue";
+        default:
+            return "unknown";
+    }
+}
+
+// StreamBufferAccount
+
+StreamBufferAccount::StreamBufferAccount(const std::string& streamId, BufferAccountant& owner)
+    : streamId_(streamId), owner_(owner) {
+    for (auto& bytes : bytes_) {
+        bytes = 0;
+    }
+}
+
+StreamBufferAccount::~StreamBufferAccount() {
+    // Les composants qui survivent au compte ne doivent pas laisser d'octets fantômes
+    int64_t remaining = 0;
+    for (auto& bytes : bytes_) {
+        remaining += bytes.exchange(0);
+    }
+
+    if (remaining != 0) {
+        owner_.onDelta(-remaining);
+    }
+}
+
+void StreamBufferAccount::add(BufferStage stage, size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+
+    bytes_[static_cast<size_t>(stage)] += static_cast<int64_t>(bytes);
+    owner_.onDelta(static_cast<int64_t>(bytes));
+}
+
+void StreamBufferAccount::release(BufferStage stage, size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+
+    bytes_[static_cast<size_t>(stage)] -= static_cast<int64_t>(bytes);
+    owner_.onDelta(-static_cast<int64_t>(bytes));
+}
+
+size_t StreamBufferAccount::getBytes(BufferStage stage) const {
+    return static_cast<size_t>(std::max<int64_t>(0, bytes_[static_cast<size_t>(stage)].load()));
+}
+
+size_t StreamBufferAccount::getTotalBytes() const {
+    int64_t total = 0;
+    for (const auto& bytes : bytes_) {
+        total += bytes.load();
+    }
+    return static_cast<size_t>(std::max<int64_t>(0, total));
+}
+
+const std::string& StreamBufferAccount::getStreamId() const {
+    return streamId_;
+}
+
+// BufferAccountant
+
+BufferAccountant& BufferAccountant::getInstance() {
+    static BufferAccountant instance;
+    return instance;
+}
+
+BufferAccountant::BufferAccountant()
+    : totalBytes_(0),
+      peakBytes_(0),
+      highWatermark_(0),
+      lowWatermark_(0),
+      budgetBytes_(0),
+      throttled_(false),
+      throttleEvents_(0),
+      suspendPending_(false),
+      resumePending_(false),
+      eventBytes_(0) {
+}
+
+void BufferAccountant::setBudget(size_t budgetBytes, int highWatermarkPercent, int lowWatermarkPercent) {
+    int highPercent = std::clamp(highWatermarkPercent, 1, 100);
+    int lowPercent = std::clamp(lowWatermarkPercent, 0, highPercent);
+
+    budgetBytes_ = budgetBytes;
+    highWatermark_ = static_cast<int64_t>(budgetBytes / 100 * highPercent);
+    lowWatermark_ = static_cast<int64_t>(budgetBytes / 100 * lowPercent);
+
+    // Réévaluer l'état de suspension avec les nouveaux seuils
+    onDelta(0);
+    reportThresholdEvents();
+
+    if (budgetBytes == 0) {
+        spdlog::info("Budget mémoire des tampons: illimité");
+    } else {
+        spdlog::info("Budget mémoire des tampons: {} Mo (suspension à {}%, reprise à {}%)",
+                   budgetBytes / (1024 * 1024), highPercent, lowPercent);
+    }
+}
+
+std::shared_ptr<StreamBufferAccount> BufferAccountant::registerStream(const std::string& streamId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Réutiliser le compte d'une instance encore vivante du même flux
+    auto& entry = streams_[streamId];
+    if (auto existing = entry.lock()) {
+        return existing;
+    }
+
+    auto account = std::make_shared<StreamBufferAccount>(streamId, *this);
+    entry = account;
+
+    return account;
+}
+
+void BufferAccountant::unregisterStream(const std::string& streamId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    streams_.erase(streamId);
+}
+
+bool BufferAccountant::isThrottled() const {
+    reportThresholdEvents();
+    return throttled_;
+}
+
+bool BufferAccountant::waitForCapacity(std::chrono::milliseconds timeout) {
+    if (!throttled_) {
+        return true;
+    }
+
+    bool resumed;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        resumed = capacityCond_.wait_for(lock, timeout, [this] { return !throttled_.load(); });
+    }
+    reportThresholdEvents();
+    return resumed;
+}
+
+size_t BufferAccountant::getTotalBytes() const {
+    return static_cast<size_t>(std::max<int64_t>(0, totalBytes_.load()));
+}
+
+BufferAccountant::Snapshot BufferAccountant::getSnapshot() const {
+    Snapshot snapshot;
+    snapshot.budgetBytes = budgetBytes_;
+    snapshot.totalBytes = getTotalBytes();
+    snapshot.peakBytes = static_cast<size_t>(peakBytes_.load());
+    snapshot.throttled = throttled_;
+    snapshot.throttleEvents = throttleEvents_;
+    reportThresholdEvents();
+
+    // Copier les comptes hors verrou: la destruction du dernier propriétaire d'un compte
+    // rappelle onDelta(), qui peut lui-même verrouiller mutex_
+    std::vector<std::shared_ptr<StreamBufferAccount>> accounts;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : streams_) {
+            if (auto account = entry.second.lock()) {
+                accounts.push_back(std::move(account));
+            }
+        }
+    }
+
+    for (const auto& account : accounts) {
+        auto& stages = snapshot.streams[account->getStreamId()];
+        for (size_t i = 0; i < BUFFER_STAGE_COUNT; ++i) {
+            stages[i] = account->getBytes(static_cast<BufferStage>(i));
+        }
+    }
+
+    return snapshot;
+}
+
+void BufferAccountant::onDelta(int64_t delta) {
+    int64_t total = (totalBytes_ += delta);
+
+    int64_t peak = peakBytes_.load();
+    while (total > peak && !peakBytes_.compare_exchange_weak(peak, total)) {
+    }
+
+    int64_t high = highWatermark_.load();
+    if (high <= 0) {
+        // Budget illimité: ne jamais suspendre les récupérations
+        if (throttled_.exchange(false)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            capacityCond_.notify_all();
+        }
+        return;
+    }
+
+    if (!throttled_ && total >= high) {
+        bool expected = false;
+        if (throttled_.compare_exchange_strong(expected, true)) {
+            throttleEvents_++;
+            eventBytes_ = total;
+            suspendPending_ = true;
+        }
+    } else if (throttled_ && total <= lowWatermark_.load()) {
+        bool expected = true;
+        if (throttled_.compare_exchange_strong(expected, false)) {
+            eventBytes_ = total;
+            resumePending_ = true;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            capacityCond_.notify_all();
+        }
+    }
+}
+
+void BufferAccountant::reportThresholdEvents() const {
+    if (suspendPending_.exchange(false)) {
+        std::string message = "Budget mémoire atteint (" + std::to_string(eventBytes_.load() / (1024 * 1024)) +
+                              " Mo en tampon), récupérations HLS suspendues";
+        spdlog::warn(message);
+        AlertManager::getInstance().addAlert(AlertLevel::WARNING, "BufferAccountant", message, false);
+    }
+    if (resumePending_.exchange(false)) {
+        spdlog::info("Consommation mémoire redescendue à {} Mo, reprise des récupérations HLS",
+                   eventBytes_.load() / (1024 * 1024));
+    }
+}
+
+} // namespace hls_to_dvb
@@ -0,0 +1,147 @@
+#include "core/BufferPool.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+
+namespace hls_to_dvb {
+
+BufferPool::BufferPool(size_t maxPooledBytes, size_t maxBuffersPerClass)
+    : maxPooledBytes_(maxPooledBytes),
+      maxBuffersPerClass_(maxBuffersPerClass),
+      pooledBytes_(0),
+      acquires_(0),
+      reuses_(0),
+      heapAllocations_(0),
+      discarded_(0),
+      segments_(0),
+      peakPooledBytes_(0) {
+}
+
+std::vector<uint8_t> BufferPool::acquire(size_t capacity) {
+    acquires_++;
+
+    size_t index = classForRequest(capacity);
+    if (index < CLASS_COUNT) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Une classe supérieure convient aussi si la classe exacte est vide
+        for (size_t i = index; i < CLASS_COUNT && i <= index + 1; ++i) {
+            auto& freeList = freeLists_[i];
+            if (!freeList.empty()) {
+                std::vector<uint8_t> buffer = std::move(freeList.back());
+                freeList.pop_back();
+                pooledBytes_ -= buffer.capacity();
+                reuses_++;
+                return buffer;
+            }
+        }
+    }
+
+    // Aucun tampon disponible: allouer directement à la taille de la classe pour
+    // qu'il puisse être recyclé par les segments suivants
+    heapAllocations_++;
+    std::vector<uint8_t> buffer;
+    buffer.reserve(index < CLASS_COUNT ? classSize(index) : capacity);
+    return buffer;
+}
+
+void BufferPool::release(std::vector<uint8_t>&& buffer) {
+    size_t capacity = buffer.capacity();
+    size_t index = classForBuffer(capacity);
+    if (index >= CLASS_COUNT) {
+        // Trop petit pour mériter d'être conservé, ou hors classes
+        return;
+    }
+
+    buffer.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& freeList = freeLists_[index];
+    if (freeList.size() >= maxBuffersPerClass_ || pooledBytes_ + capacity > maxPooledBytes_) {
+        discarded_++;
+        return;
+    }
+
+    freeList.push_back(std::move(buffer));
+    pooledBytes_ += capacity;
+
+    if (pooledBytes_ > peakPooledBytes_) {
+        peakPooledBytes_ = pooledBytes_;
+    }
+}
+
+std::shared_ptr<const std::vector<uint8_t>> BufferPool::share(std::shared_ptr<BufferPool> pool,
+                                                              std::vector<uint8_t>&& buffer) {
+    return std::shared_ptr<const std::vector<uint8_t>>(
+        new std::vector<uint8_t>(std::move(buffer)),
+        [pool = std::move(pool)](const std::vector<uint8_t>* shared) {
+            auto* owned = const_cast<std::vector<uint8_t>*>(shared);
+            if (pool) {
+                pool->release(std::move(*owned));
+            }
+            delete owned;
+        });
+}
+
+void BufferPool::markSegment() {
+    segments_++;
+}
+
+void BufferPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& freeList : freeLists_) {
+        freeList.clear();
+        freeList.shrink_to_fit();
+    }
+    pooledBytes_ = 0;
+
+    spdlog::debug("Réserve de tampons vidée");
+}
+
+BufferPool::Stats BufferPool::getStats() const {
+    Stats stats;
+    stats.acquires = acquires_;
+    stats.reuses = reuses_;
+    stats.heapAllocations = heapAllocations_;
+    stats.discarded = discarded_;
+    stats.segments = segments_;
+    stats.allocationsPerSegment = stats.segments > 0 ?
+        static_cast<double>(stats.heapAllocations) / stats.segments : 0.0;
+    stats.peakPooledBytes = peakPooledBytes_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.pooledBytes = pooledBytes_;
+
+    return stats;
+}
+
+size_t BufferPool::classForRequest(size_t capacity) {
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        if (capacity <= classSize(i)) {
+            return i;
+        }
+    }
+    return CLASS_COUNT;
+}
+
+size_t BufferPool::classForBuffer(size_t capacity) {
+    if (capacity < classSize(0)) {
+        return CLASS_COUNT;
+    }
+
+    for (size_t i = CLASS_COUNT; i-- > 0;) {
+        if (capacity >= classSize(i)) {
+            // Un tampon bien plus grand que sa classe gaspillerait de la mémoire
+            return capacity < classSize(i) * 2 ? i : CLASS_COUNT;
+        }
+    }
+    return CLASS_COUNT;
+}
+
+size_t BufferPool::classSize(size_t index) {
+    return static_cast<size_t>(1) << (MIN_CLASS_SHIFT + index);
+}
+
+} // namespace hls_to_dvb
@@ -0,0 +1,295 @@
+#include "core/IoRuntime.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+  #include <sys/epoll.h>
+  #include <sys/eventfd.h>
+  #include <unistd.h>
+#endif
+
+namespace hls_to_dvb {
+
+namespace {
+    /**
+     * @brief Coroutine détachée qui conduit une Task jusqu'à sa fin
+     */
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() const noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept {}
+        };
+    };
+
+    Detached runDetached(Task<void> task, std::function<void()> onDone) {
+        try {
+            co_await task;
+        } catch (const std::exception& e) {
+            spdlog::error("Coroutine d'E/S terminée par une exception: {}", e.what());
+        }
+        if (onDone) {
+            onDone();
+        }
+    }
+}
+
+bool IoLoop::Awaiter::await_ready() const noexcept {
+    return cancel_ && cancel_->cancelled.load(std::memory_order_acquire);
+}
+
+bool IoLoop::Awaiter::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    return loop_.arm(*this);
+}
+
+IoLoop::Awaiter IoLoop::sleepFor(std::chrono::milliseconds delay, std::shared_ptr<CancelToken> cancel) {
+    return Awaiter(*this, -1, 0, std::max(delay, std::chrono::milliseconds(0)), std::move(cancel));
+}
+
+IoLoop::Awaiter IoLoop::wait(int fd, uint32_t events, std::chrono::milliseconds timeout,
+                             std::shared_ptr<CancelToken> cancel) {
+    return Awaiter(*this, fd, events, timeout, std::move(cancel));
+}
+
+IoLoop::Awaiter IoLoop::suspend(std::shared_ptr<CancelToken> token) {
+    return Awaiter(*this, -1, 0, std::chrono::milliseconds(-1), std::move(token));
+}
+
+#ifdef __linux__
+
+IoLoop::IoLoop(int index) : index_(index) {
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        throw std::runtime_error(std::string("Création de la boucle d'E/S impossible: ") + strerror(errno));
+    }
+
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = 0;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+
+    thread_ = std::thread(&IoLoop::run, this);
+}
+
+IoLoop::~IoLoop() {
+    stopping_ = true;
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = write(wakeFd_, &one, sizeof(one));
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(wakeFd_);
+    close(epollFd_);
+}
+
+void IoLoop::spawn(Task<void> task, std::function<void()> onDone) {
+    // std::function exige une capture copiable: la coroutine est passée par pointeur partagé
+    auto shared = std::make_shared<Task<void>>(std::move(task));
+    post([shared, onDone = std::move(onDone)]() mutable {
+        runDetached(std::move(*shared), std::move(onDone));
+    });
+}
+
+void IoLoop::post(std::function<void()> function) {
+    {
+        std::lock_guard<std::mutex> lock(postedMutex_);
+        posted_.push_back(std::move(function));
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = write(wakeFd_, &one, sizeof(one));
+}
+
+void IoLoop::cancel(const std::shared_ptr<CancelToken>& token) {
+    token->cancelled.store(true, std::memory_order_release);
+    post([this, token]() {
+        if (token->waiterId != 0) {
+            complete(token->waiterId, WaitResult::CANCELLED);
+        }
+    });
+}
+
+void IoLoop::notify(const std::shared_ptr<CancelToken>& token) {
+    // Sur le thread de la boucle, l'attente visée est connue dès maintenant
+    if (std::this_thread::get_id() == thread_.get_id()) {
+        uint64_t id = token->waiterId;
+        if (id != 0) {
+            post([this, id]() { complete(id, WaitResult::READY); });
+        }
+        return;
+    }
+    post([this, token]() {
+        if (token->waiterId != 0) {
+            complete(token->waiterId, WaitResult::READY);
+        }
+    });
+}
+
+bool IoLoop::arm(Awaiter& awaiter) {
+    uint64_t id = nextId_++;
+
+    if (awaiter.fd_ >= 0) {
+        struct epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = awaiter.events_ | EPOLLONESHOT;
+        event.data.u64 = id;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, awaiter.fd_, &event) < 0) {
+            awaiter.result_ = WaitResult::ERROR;
+            return false;
+        }
+    }
+
+    if (awaiter.timeout_.count() >= 0) {
+        awaiter.timer_ = timers_.emplace(std::chrono::steady_clock::now() + awaiter.timeout_, id);
+        awaiter.hasTimer_ = true;
+    }
+
+    waiters_[id] = &awaiter;
+    if (awaiter.cancel_) {
+        awaiter.cancel_->waiterId = id;
+    }
+    return true;
+}
+
+void IoLoop::complete(uint64_t id, WaitResult result) {
+    // Une attente déjà terminée par une autre voie (événement, échéance, annulation) est ignorée
+    auto it = waiters_.find(id);
+    if (it == waiters_.end()) {
+        return;
+    }
+    Awaiter& awaiter = *it->second;
+    waiters_.erase(it);
+
+    if (awaiter.fd_ >= 0) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, awaiter.fd_, nullptr);
+    }
+    if (awaiter.hasTimer_) {
+        timers_.erase(awaiter.timer_);
+        awaiter.hasTimer_ = false;
+    }
+    if (awaiter.cancel_ && awaiter.cancel_->waiterId == id) {
+        awaiter.cancel_->waiterId = 0;
+    }
+
+    // Une temporisation seule se termine normalement à son échéance
+    awaiter.result_ = result == WaitResult::TIMEOUT && awaiter.fd_ < 0 ? WaitResult::READY : result;
+    awaiter.handle_.resume();
+}
+
+void IoLoop::run() {
+    spdlog::info("Boucle d'E/S {} démarrée", index_);
+
+    constexpr int MAX_EVENTS = 64;
+    struct epoll_event events[MAX_EVENTS];
+
+    while (!stopping_) {
+        // Le délai d'attente suit la plus proche échéance
+        int timeoutMs = -1;
+        if (!timers_.empty()) {
+            auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+                timers_.begin()->first - std::chrono::steady_clock::now()).count();
+            timeoutMs = static_cast<int>(std::clamp<int64_t>(delay + 1, 0, 60000));
+        }
+
+        int count = epoll_wait(epollFd_, events, MAX_EVENTS, timeoutMs);
+        if (count < 0 && errno != EINTR) {
+            spdlog::error("Boucle d'E/S {}: epoll_wait en échec ({})", index_, strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == 0) {
+                uint64_t value;
+                [[maybe_unused]] ssize_t bytes = read(wakeFd_, &value, sizeof(value));
+
+                std::vector<std::function<void()>> functions;
+                {
+                    std::lock_guard<std::mutex> lock(postedMutex_);
+                    functions.swap(posted_);
+                }
+                for (auto& function : functions) {
+                    function();
+                }
+                continue;
+            }
+
+            bool failed = (events[i].events & EPOLLERR) && !(events[i].events & (EPOLLIN | EPOLLOUT));
+            complete(id, failed ? WaitResult::ERROR : WaitResult::READY);
+        }
+
+        // Échéances atteintes (une reprise peut en ajouter: relire le début à chaque tour)
+        auto now = std::chrono::steady_clock::now();
+        while (!timers_.empty() && timers_.begin()->first <= now) {
+            complete(timers_.begin()->second, WaitResult::TIMEOUT);
+        }
+    }
+
+    if (!waiters_.empty()) {
+        spdlog::warn("Boucle d'E/S {} arrêtée avec {} coroutine(s) en attente", index_, waiters_.size());
+    }
+    spdlog::info("Boucle d'E/S {} arrêtée", index_);
+}
+
+bool IoRuntime::isSupported() {
+    return true;
+}
+
+#else
+
+IoLoop::IoLoop(int index) : index_(index) {
+    throw std::runtime_error("Boucles d'E/S non prises en charge sur cette plateforme");
+}
+
+IoLoop::~IoLoop() = default;
+
+void IoLoop::spawn(Task<void>, std::function<void()>) {}
+
+void IoLoop::post(std::function<void()>) {}
+
+void IoLoop::cancel(const std::shared_ptr<CancelToken>& token) {
+    token->cancelled.store(true, std::memory_order_release);
+}
+
+void IoLoop::notify(const std::shared_ptr<CancelToken>&) {}
+
+bool IoLoop::arm(Awaiter& awaiter) {
+    awaiter.result_ = WaitResult::ERROR;
+    return false;
+}
+
+void IoLoop::complete(uint64_t, WaitResult) {}
+
+void IoLoop::run() {}
+
+bool IoRuntime::isSupported() {
+    return false;
+}
+
+#endif
+
+IoRuntime::IoRuntime(int threads) {
+    int count = std::max(threads, 1);
+    for (int i = 0; i < count; ++i) {
+        loops_.push_back(std::make_unique<IoLoop>(i));
+    }
+    spdlog::info("Runtime d'E/S démarré: {} boucle(s)", count);
+}
+
+IoLoop& IoRuntime::nextLoop() {
+    return *loops_[next_.fetch_add(1, std::memory_order_relaxed) % loops_.size()];
+}
+
+size_t IoRuntime::getLoopCount() const {
+    return loops_.size();
+}
+
+} // namespace hls_to_dvb
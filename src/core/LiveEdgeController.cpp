@@ -0,0 +1,168 @@
+#include "core/LiveEdgeController.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hls_to_dvb {
+
+namespace {
+    // Excès de latence toléré avant d'accélérer la diffusion
+    constexpr int64_t SPEEDUP_TOLERANCE_US = 1000000;
+
+    // Vitesse de diffusion pendant un rattrapage en accéléré (+5 %)
+    constexpr double SPEEDUP_RATE = 1.05;
+
+    // Durée utilisée lorsque le segment n'indique pas sa durée (même valeur que StreamManager)
+    constexpr double DEFAULT_SEGMENT_DURATION_SEC = 4.0;
+}
+
+LiveEdgeController::Policy LiveEdgeController::parsePolicy(const std::string& policy) {
+    return policy == "speedup" ? Policy::SPEEDUP : Policy::SKIP;
+}
+
+LiveEdgeController::LiveEdgeController(int targetMs, Policy policy)
+    : targetUs_(std::max(targetMs, 0) * int64_t(1000)), policy_(policy) {
+}
+
+void LiveEdgeController::setMetrics(std::shared_ptr<StreamMetrics> metrics) {
+    metrics_ = std::move(metrics);
+}
+
+int64_t LiveEdgeController::fetchExcessUs() const {
+    if (policy_ != Policy::SKIP || targetUs_ == 0) {
+        return 0;
+    }
+    int64_t excessUs = latencyUs_.load(std::memory_order_relaxed) - targetUs_ -
+                       skippedPendingUs_.load(std::memory_order_relaxed);
+    return std::max<int64_t>(excessUs, 0);
+}
+
+void LiveEdgeController::skipBeforeFetch(int64_t skippedUs, uint64_t segments) {
+    skippedPendingUs_.fetch_add(skippedUs, std::memory_order_relaxed);
+    skippedSegments_.fetch_add(segments, std::memory_order_relaxed);
+    catchingUp_ = true;
+    if (metrics_) {
+        metrics_->catchUpSkips->increment(segments);
+    }
+}
+
+bool LiveEdgeController::admit(SegmentTrace& trace, double durationSec, bool& discontinuity, double skippedBeforeSec) {
+    int64_t durationUs = std::llround((durationSec > 0.0 ? durationSec : DEFAULT_SEGMENT_DURATION_SEC) * 1e6);
+    
+    // Saut par la récupération: la durée sautée avance l'horloge du direct; inconnue
+    // (réouverture au direct), la référence repart de ce segment
+    if (skippedBeforeSec < 0.0) {
+        anchored_ = false;
+    }
+
+    // Apparition observée: au plus tard le début de la récupération
+    int64_t seenUs = trace.playlistSeenUs != 0 ? trace.playlistSeenUs :
+                     trace.downloadStartUs != 0 ? trace.downloadStartUs : SegmentTrace::nowUs();
+
+    if (!anchored_) {
+        anchored_ = true;
+        anchorUs_ = seenUs;
+        mediaUs_ = 0;
+    } else if (skippedBeforeSec > 0.0) {
+        mediaUs_ += std::llround(skippedBeforeSec * 1e6);
+    }
+    if (skippedBeforeSec != 0.0) {
+        skipping_ = true;
+    }
+
+    // Un segment ne peut pas être apparu avant d'avoir été vu: si l'origine produit plus
+    // lentement que le temps réel, l'horloge du direct la suit
+    int64_t liveEdgeUs = anchorUs_ + mediaUs_;
+    if (seenUs > liveEdgeUs) {
+        anchorUs_ += seenUs - liveEdgeUs;
+        liveEdgeUs = seenUs;
+    }
+    trace.liveEdgeUs = liveEdgeUs;
+    mediaUs_ += durationUs;
+
+    if (policy_ != Policy::SKIP || targetUs_ == 0) {
+        return true;
+    }
+
+    // Sauter le segment tant que l'excès mesuré, moins ce qui a déjà été sauté, le couvre
+    int64_t excessUs = latencyUs_.load(std::memory_order_relaxed) - targetUs_ -
+                       skippedPendingUs_.load(std::memory_order_relaxed);
+    if (excessUs >= durationUs) {
+        skippedPendingUs_.fetch_add(durationUs, std::memory_order_relaxed);
+        skippedSegments_.fetch_add(1, std::memory_order_relaxed);
+        skipping_ = true;
+        catchingUp_ = true;
+        if (metrics_) {
+            metrics_->catchUpSkips->increment();
+        }
+        return false;
+    }
+
+    // Premier segment conservé après un saut: la rupture est signalée comme une discontinuité
+    if (skipping_) {
+        skipping_ = false;
+        discontinuity = true;
+        trace.discontinuity = true;
+        resumeEdgeUs_ = liveEdgeUs;
+    }
+    return true;
+}
+
+double LiveEdgeController::onPlayout(const SegmentTrace& trace) {
+    if (trace.liveEdgeUs == 0) {
+        return 1.0;
+    }
+
+    int64_t latencyUs = SegmentTrace::nowUs() - trace.liveEdgeUs;
+    latencyUs_.store(latencyUs, std::memory_order_relaxed);
+    if (metrics_) {
+        metrics_->liveLatencySeconds->set(latencyUs / 1e6);
+    }
+
+    if (targetUs_ == 0) {
+        return 1.0;
+    }
+
+    if (policy_ == Policy::SKIP) {
+        // Le premier segment conservé après un saut atteint la diffusion: le saut est mesurable
+        if (resumeEdgeUs_ != 0 && trace.liveEdgeUs >= resumeEdgeUs_) {
+            spdlog::info("Direct rattrapé: {} segment(s) sauté(s) au total, latence {} ms (cible {} ms)",
+                         skippedSegments_.load(), latencyUs / 1000, targetUs_ / 1000);
+            resumeEdgeUs_ = 0;
+            skippedPendingUs_.store(0, std::memory_order_relaxed);
+            catchingUp_ = false;
+        }
+        return 1.0;
+    }
+
+    // Accélération avec hystérésis: au-delà de cible + tolérance, jusqu'au retour à la cible
+    if (!catchingUp_ && latencyUs > targetUs_ + SPEEDUP_TOLERANCE_US) {
+        catchingUp_ = true;
+        spdlog::info("Latence {} ms au-delà de la cible ({} ms), diffusion accélérée",
+                     latencyUs / 1000, targetUs_ / 1000);
+    } else if (catchingUp_ && latencyUs <= targetUs_) {
+        catchingUp_ = false;
+        spdlog::info("Latence revenue à {} ms, diffusion au temps réel", latencyUs / 1000);
+    }
+    return catchingUp_ ? SPEEDUP_RATE : 1.0;
+}
+
+int LiveEdgeController::getTargetMs() const {
+    return static_cast<int>(targetUs_ / 1000);
+}
+
+int LiveEdgeController::getLatencyMs() const {
+    return static_cast<int>(latencyUs_.load(std::memory_order_relaxed) / 1000);
+}
+
+uint64_t LiveEdgeController::getSkippedSegments() const {
+    return skippedSegments_.load(std::memory_order_relaxed);
+}
+
+bool LiveEdgeController::isCatchingUp() const {
+    return catchingUp_.load(std::memory_order_relaxed);
+}
+
+} // namespace hls_to_dvb
@@ -0,0 +1,140 @@
+#include "core/Logging.h"
+#include "core/MetricsRegistry.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace hls_to_dvb {
+
+std::mutex Logging::mutex_;
+std::map<std::string, std::shared_ptr<spdlog::logger>> Logging::components_;
+LoggingConfig Logging::config_;
+size_t Logging::reportedDrops_ = 0;
+
+bool Logging::initialize(const LoggingConfig& config) {
+    try {
+        std::vector<spdlog::sink_ptr> sinks;
+
+        if (config.console) {
+            sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+        }
+
+        if (config.file.enabled) {
+            // Créer le dossier des logs s'il n'existe pas
+            std::filesystem::path logPath(config.file.path);
+            if (logPath.has_parent_path()) {
+                std::filesystem::create_directories(logPath.parent_path());
+            }
+
+            sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+                config.file.path, config.file.rotationSize, config.file.maxFiles));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+
+        // Un seul thread d'écriture: l'ordre des messages est conservé
+        if (!spdlog::thread_pool()) {
+            spdlog::init_thread_pool(std::max<size_t>(config.asyncQueueSize, 64), 1);
+        }
+
+        auto policy = config.overflowPolicy == "block"
+            ? spdlog::async_overflow_policy::block
+            : spdlog::async_overflow_policy::overrun_oldest;
+
+        auto logger = std::make_shared<spdlog::async_logger>(
+            "main", sinks.begin(), sinks.end(), spdlog::thread_pool(), policy);
+        logger->set_level(parseLevel(config.level));
+        logger->flush_on(spdlog::level::err);
+        spdlog::set_default_logger(logger);
+
+        // Les composants qui conservent déjà leur logger suivent la nouvelle configuration
+        for (auto& [name, componentLogger] : components_) {
+            componentLogger->sinks() = sinks;
+            componentLogger->set_level(componentLevel(name));
+            componentLogger->flush_on(spdlog::level::err);
+        }
+
+        spdlog::flush_every(std::chrono::seconds(std::max(config.flushIntervalSec, 1)));
+
+        spdlog::info("Journalisation initialisée: niveau={}, console={}, fichier={}, file={} messages, débordement={}",
+                     config.level, config.console, config.file.enabled,
+                     config.asyncQueueSize, config.overflowPolicy);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Erreur lors de l'initialisation de la journalisation: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::shared_ptr<spdlog::logger> Logging::get(const std::string& component) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = components_.find(component);
+    if (it != components_.end()) {
+        return it->second;
+    }
+
+    // Le clone partage les sinks et la file asynchrone du logger par défaut
+    auto logger = spdlog::default_logger()->clone(component);
+    logger->set_level(componentLevel(component));
+    components_[component] = logger;
+    return logger;
+}
+
+spdlog::level::level_enum Logging::parseLevel(const std::string& level,
+                                              spdlog::level::level_enum fallback) {
+    if (level == "trace") {
+        return spdlog::level::trace;
+    } else if (level == "debug") {
+        return spdlog::level::debug;
+    } else if (level == "info") {
+        return spdlog::level::info;
+    } else if (level == "warning" || level == "warn") {
+        return spdlog::level::warn;
+    } else if (level == "error") {
+        return spdlog::level::err;
+    } else if (level == "critical") {
+        return spdlog::level::critical;
+    } else if (level == "off") {
+        return spdlog::level::off;
+    }
+    return fallback;
+}
+
+void Logging::updateMetrics() {
+    static auto droppedCounter = MetricsRegistry::getInstance().counter(
+        "hls2dvb_log_messages_dropped_total",
+        "Messages de journalisation écartés faute de place dans la file asynchrone");
+
+    auto pool = spdlog::thread_pool();
+    if (!pool) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t dropped = pool->overrun_counter();
+    if (dropped > reportedDrops_) {
+        droppedCounter->increment(dropped - reportedDrops_);
+        reportedDrops_ = dropped;
+    }
+}
+
+spdlog::level::level_enum Logging::componentLevel(const std::string& component) {
+    spdlog::level::level_enum globalLevel = parseLevel(config_.level);
+
+    auto it = config_.components.find(component);
+    if (it == config_.components.end()) {
+        return globalLevel;
+    }
+    return parseLevel(it->second, globalLevel);
+}
+
+} // namespace hls_to_dvb
@@ -0,0 +1,346 @@
+#include "core/MetricsRegistry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace hls_to_dvb {
+
+namespace {
+    // Classes des durées de récupération (s): un segment de quelques secondes doit arriver bien avant son échéance
+    const std::vector<double> FETCH_BOUNDS = {0.05, 0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0};
+
+    // Classes des durées de conversion (s)
+    const std::vector<double> CONVERT_BOUNDS = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25};
+
+    // Classes des durées de reprise d'une étape (s): l'objectif est de rester sous la seconde
+    const std::vector<double> RECOVERY_BOUNDS = {0.1, 0.25, 0.5, 1.0, 2.0, 5.0, 10.0, 30.0};
+
+    std::string escapeLabelValue(const std::string& value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (char c : value) {
+            switch (c) {
+                case '\\': escaped += "\\\\"; break;
+                case '"':  escaped += "\\\""; break;
+                case '\n': escaped += "\\n"; break;
+                default:   escaped += c; break;
+            }
+        }
+        return escaped;
+    }
+
+    std::string formatValue(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        return buffer;
+    }
+
+    /**
+     * @brief Formate les étiquettes d'une série, avec une étiquette supplémentaire éventuelle
+     */
+    std::string formatLabels(const MetricLabels& labels, const char* extraName = nullptr,
+                             const std::string& extraValue = std::string()) {
+        if (labels.empty() && !extraName) {
+            return std::string();
+        }
+
+        std::string text = "{";
+        bool first = true;
+        for (const auto& [name, value] : labels) {
+            if (!first) {
+                text += ",";
+            }
+            text += name + "=\"" + escapeLabelValue(value) + "\"";
+            first = false;
+        }
+        if (extraName) {
+            if (!first) {
+                text += ",";
+            }
+            text += std::string(extraName) + "=\"" + extraValue + "\"";
+        }
+        text += "}";
+        return text;
+    }
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      buckets_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double value) {
+    size_t index = static_cast<size_t>(std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.bounds = bounds_;
+    snapshot.cumulative.resize(bounds_.size() + 1);
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        cumulative += buckets_[i].load(std::memory_order_relaxed);
+        snapshot.cumulative[i] = cumulative;
+    }
+    snapshot.count = cumulative;
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+std::shared_ptr<StreamMetrics> StreamMetrics::create(const std::string& streamId) {
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+    const MetricLabels labels = {{"stream", streamId}};
+
+    auto metrics = std::make_shared<StreamMetrics>();
+    metrics->streamId = streamId;
+
+    metrics->fetchSegments = registry.counter("hls2dvb_fetch_segments_total",
+        "Segments HLS récupérés", labels);
+    metrics->fetchBytes = registry.counter("hls2dvb_fetch_bytes_total",
+        "Octets de segments HLS récupérés", labels);
+    metrics->fetchErrors = registry.counter("hls2dvb_fetch_errors_total",
+        "Erreurs de lecture du flux HLS", labels);
+    metrics->fetchSeconds = registry.histogram("hls2dvb_fetch_duration_seconds",
+        "Durée de récupération d'un segment HLS", FETCH_BOUNDS, labels);
+    metrics->fetchQueueSeconds = registry.histogram("hls2dvb_fetch_queue_seconds",
+        "Attente d'un créneau de requête auprès de l'origine (récupération par coroutines)", FETCH_BOUNDS, labels);
+
+    metrics->convertSegments = registry.counter("hls2dvb_convert_segments_total",
+        "Segments convertis en MPEG-TS", labels);
+    metrics->convertErrors = registry.counter("hls2dvb_convert_errors_total",
+        "Échecs de conversion", labels);
+    metrics->convertSeconds = registry.histogram("hls2dvb_convert_duration_seconds",
+        "Durée de conversion d'un segment", CONVERT_BOUNDS, labels);
+
+    metrics->bufferDepthSeconds = registry.gauge("hls2dvb_buffer_depth_seconds",
+        "Profondeur du tampon de gigue", labels);
+    metrics->bufferTargetSeconds = registry.gauge("hls2dvb_buffer_target_seconds",
+        "Profondeur cible du tampon de gigue", labels);
+    metrics->bufferUnderruns = registry.counter("hls2dvb_buffer_underruns_total",
+        "Sous-remplissages du tampon de gigue", labels);
+    metrics->bufferOverruns = registry.counter("hls2dvb_buffer_overruns_total",
+        "Débordements du tampon de gigue", labels);
+
+    metrics->sendPackets = registry.counter("hls2dvb_send_packets_total",
+        "Datagrammes multicast envoyés", labels);
+    metrics->sendBytes = registry.counter("hls2dvb_send_bytes_total",
+        "Octets multicast envoyés", labels);
+    metrics->sendErrors = registry.counter("hls2dvb_send_errors_total",
+        "Erreurs d'envoi multicast", labels);
+    metrics->sendBitrate = registry.gauge("hls2dvb_send_bitrate_bps",
+        "Débit d'émission multicast", labels);
+
+    metrics->startupSeconds = registry.gauge("hls2dvb_startup_seconds",
+        "Délai entre la demande de démarrage du flux et son premier paquet multicast", labels);
+
+    metrics->liveLatencySeconds = registry.gauge("hls2dvb_live_latency_seconds",
+        "Écart au direct de l'origine des segments diffusés", labels);
+    metrics->catchUpSkips = registry.counter("hls2dvb_catchup_skipped_segments_total",
+        "Segments sautés pour rattraper le direct", labels);
+
+    const char* recoveryHelp = "Durée entre l'échec d'une étape et son rétablissement";
+    metrics->fetchRecoverySeconds = registry.histogram("hls2dvb_recovery_seconds", recoveryHelp,
+        RECOVERY_BOUNDS, {{"stream", streamId}, {"stage", "fetch"}});
+    metrics->convertRecoverySeconds = registry.histogram("hls2dvb_recovery_seconds", recoveryHelp,
+        RECOVERY_BOUNDS, {{"stream", streamId}, {"stage", "convert"}});
+    metrics->sendRecoverySeconds = registry.histogram("hls2dvb_recovery_seconds", recoveryHelp,
+        RECOVERY_BOUNDS, {{"stream", streamId}, {"stage", "send"}});
+
+    metrics->tracer = std::make_shared<SegmentTracer>(streamId);
+
+    return metrics;
+}
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::Series& MetricsRegistry::findOrCreateInternal(const std::string& name, const std::string& help,
+                                                               MetricType type, const MetricLabels& labels) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        it = families_.emplace(name, Family{help, type, {}}).first;
+    }
+
+    for (auto& series : it->second.series) {
+        if (series.labels == labels) {
+            return series;
+        }
+    }
+
+    it->second.series.push_back(Series{labels, nullptr, nullptr, nullptr});
+    return it->second.series.back();
+}
+
+std::shared_ptr<Counter> MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                                  const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    Series& series = findOrCreateInternal(name, help, MetricType::COUNTER, labels);
+    if (!series.counter) {
+        series.counter = std::make_shared<Counter>();
+    }
+    return series.counter;
+}
+
+std::shared_ptr<Gauge> MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                                              const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    Series& series = findOrCreateInternal(name, help, MetricType::GAUGE, labels);
+    if (!series.gauge) {
+        series.gauge = std::make_shared<Gauge>();
+    }
+    return series.gauge;
+}
+
+std::shared_ptr<Histogram> MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                                      const std::vector<double>& bounds,
+                                                      const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    Series& series = findOrCreateInternal(name, help, MetricType::HISTOGRAM, labels);
+    if (!series.histogram) {
+        series.histogram = std::make_shared<Histogram>(bounds);
+    }
+    return series.histogram;
+}
+
+void MetricsRegistry::removeSeries(const std::string& labelName, const std::string& labelValue) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+
+    for (auto& [name, family] : families_) {
+        auto& series = family.series;
+        series.erase(std::remove_if(series.begin(), series.end(), [&](const Series& entry) {
+            return std::find(entry.labels.begin(), entry.labels.end(),
+                             std::make_pair(labelName, labelValue)) != entry.labels.end();
+        }), series.end());
+    }
+}
+
+std::string MetricsRegistry::renderPrometheus() {
+    ProcessUsage usage = sampleProcessUsage();
+
+    std::ostringstream out;
+
+    out << "# HELP process_cpu_seconds_total Temps CPU consommé par le processus\n"
+        << "# TYPE process_cpu_seconds_total counter\n"
+        << "process_cpu_seconds_total " << formatValue(usage.cpuSeconds) << "\n"
+        << "# HELP process_resident_memory_bytes Mémoire résidente du processus\n"
+        << "# TYPE process_resident_memory_bytes gauge\n"
+        << "process_resident_memory_bytes " << usage.residentBytes << "\n"
+        << "# HELP process_virtual_memory_bytes Mémoire virtuelle du processus\n"
+        << "# TYPE process_virtual_memory_bytes gauge\n"
+        << "process_virtual_memory_bytes " << usage.virtualBytes << "\n"
+        << "# HELP process_threads Threads du processus\n"
+        << "# TYPE process_threads gauge\n"
+        << "process_threads " << usage.threads << "\n";
+
+    std::lock_guard<std::mutex> lock(registryMutex_);
+
+    for (const auto& [name, family] : families_) {
+        if (family.series.empty()) {
+            continue;
+        }
+
+        static const char* typeNames[] = {"counter", "gauge", "histogram"};
+        out << "# HELP " << name << " " << family.help << "\n"
+            << "# TYPE " << name << " " << typeNames[static_cast<int>(family.type)] << "\n";
+
+        for (const auto& series : family.series) {
+            switch (family.type) {
+                case MetricType::COUNTER:
+                    out << name << formatLabels(series.labels) << " " << series.counter->get() << "\n";
+                    break;
+
+                case MetricType::GAUGE:
+                    out << name << formatLabels(series.labels) << " " << formatValue(series.gauge->get()) << "\n";
+                    break;
+
+                case MetricType::HISTOGRAM: {
+                    Histogram::Snapshot snapshot = series.histogram->snapshot();
+                    for (size_t i = 0; i < snapshot.bounds.size(); ++i) {
+                        out << name << "_bucket" << formatLabels(series.labels, "le", formatValue(snapshot.bounds[i]))
+                            << " " << snapshot.cumulative[i] << "\n";
+                    }
+                    out << name << "_bucket" << formatLabels(series.labels, "le", "+Inf")
+                        << " " << snapshot.count << "\n"
+                        << name << "_sum" << formatLabels(series.labels) << " " << formatValue(snapshot.sum) << "\n"
+                        << name << "_count" << formatLabels(series.labels) << " " << snapshot.count << "\n";
+                    break;
+                }
+            }
+        }
+    }
+
+    return out.str();
+}
+
+ProcessUsage MetricsRegistry::sampleProcessUsage() {
+    ProcessUsage usage;
+
+    rusage resources;
+    if (getrusage(RUSAGE_SELF, &resources) == 0) {
+        usage.cpuSeconds = resources.ru_utime.tv_sec + resources.ru_utime.tv_usec / 1e6 +
+                           resources.ru_stime.tv_sec + resources.ru_stime.tv_usec / 1e6;
+#ifdef __APPLE__
+        usage.residentBytes = static_cast<uint64_t>(resources.ru_maxrss);
+#else
+        usage.residentBytes = static_cast<uint64_t>(resources.ru_maxrss) * 1024;
+#endif
+    }
+
+#ifdef __linux__
+    // Valeurs courantes plutôt que le pic de getrusage
+    std::ifstream stat("/proc/self/stat");
+    std::string content((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+    size_t commEnd = content.rfind(')');
+    if (commEnd != std::string::npos) {
+        std::istringstream fields(content.substr(commEnd + 2));
+        std::string field;
+        // Champs à partir de l'état (3): threads = 20, vsize = 23, rss = 24
+        for (int index = 3; fields >> field; ++index) {
+            if (index == 20) {
+                usage.threads = std::atoi(field.c_str());
+            } else if (index == 23) {
+                usage.virtualBytes = std::strtoull(field.c_str(), nullptr, 10);
+            } else if (index == 24) {
+                usage.residentBytes = std::strtoull(field.c_str(), nullptr, 10) *
+                                      static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+                break;
+            }
+        }
+    }
+#endif
+
+    // Les relevés rapprochés (plusieurs collecteurs) réutilisent la dernière mesure
+    // plutôt que de calculer un taux sur une fenêtre trop courte pour être significative
+    std::lock_guard<std::mutex> lock(processMutex_);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastSample_).count();
+    if (!hasLastSample_ || elapsed >= 1.0) {
+        if (hasLastSample_) {
+            lastCpuUsage_ = (usage.cpuSeconds - lastCpuSeconds_) / elapsed;
+        }
+        lastCpuSeconds_ = usage.cpuSeconds;
+        lastSample_ = now;
+        hasLastSample_ = true;
+    }
+    usage.cpuUsage = lastCpuUsage_;
+
+    return usage;
+}
+
+} // namespace hls_to_dvb
@@ -0,0 +1,53 @@
+#include "core/RecoveryBackoff.h"
+
+#include <algorithm>
+
+namespace hls_to_dvb {
+
+RecoveryBackoff::RecoveryBackoff(int initialDelayMs, int maxDelayMs, double jitter)
+    : initialDelayMs_(std::max(initialDelayMs, 1)),
+      maxDelayMs_(std::max(maxDelayMs, std::max(initialDelayMs, 1))),
+      jitter_(std::clamp(jitter, 0.0, 1.0)),
+      random_(std::random_device{}()) {
+}
+
+std::chrono::milliseconds RecoveryBackoff::fail() {
+    auto now = std::chrono::steady_clock::now();
+    if (attempts_ == 0) {
+        failedSince_ = now;
+    }
+
+    // initial * 2^n, plafonné (l'exposant est borné pour éviter tout dépassement)
+    int64_t delayMs = static_cast<int64_t>(initialDelayMs_) << std::min(attempts_, 20);
+    delayMs = std::min<int64_t>(delayMs, maxDelayMs_);
+    attempts_++;
+
+    // Retirer une part aléatoire du délai: les relances des chaînes se dispersent
+    std::uniform_real_distribution<double> spread(1.0 - jitter_, 1.0);
+    auto delay = std::chrono::milliseconds(static_cast<int64_t>(delayMs * spread(random_)));
+
+    nextAttempt_ = now + delay;
+    return delay;
+}
+
+bool RecoveryBackoff::isDue() const {
+    return attempts_ == 0 || std::chrono::steady_clock::now() >= nextAttempt_;
+}
+
+double RecoveryBackoff::succeed() {
+    if (attempts_ == 0) {
+        return 0.0;
+    }
+    attempts_ = 0;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - failedSince_).count();
+}
+
+bool RecoveryBackoff::isRecovering() const {
+    return attempts_ > 0;
+}
+
+int RecoveryBackoff::getAttempts() const {
+    return attempts_;
+}
+
+} // namespace hls_to_dvb
@@ -1,77 +1,195 @@
 #include "core/SegmentBuffer.h"
 #include "spdlog/spdlog.h"
 
-SegmentBuffer::SegmentBuffer(size_t bufferSize)
-    : bufferSize_(bufferSize) {
-    
-    spdlog::debug("Buffer de segments créé avec une taille de {}", bufferSize);
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Durée utilisée lorsque le segment n'indique pas sa durée (même valeur que StreamManager)
+    constexpr int DEFAULT_SEGMENT_DURATION_MS = 4000;
+
+    // Gain des moyennes glissantes (1/16, comme l'estimateur de gigue de la RFC 3550)
+    constexpr double JITTER_GAIN = 1.0 / 16.0;
+
+    // Nombre d'écarts-types de retard couverts par la profondeur cible
+    constexpr double JITTER_DEVIATIONS = 3.0;
+
+    // Vitesse de rattrapage de la référence de transit (dérive d'horloge de la source)
+    constexpr double TRANSIT_DRIFT_GAIN = 1.0 / 256.0;
+
+    int segmentDurationMs(const MPEGTSSegment& segment) {
+        if (segment.duration <= 0.0) {
+            return DEFAULT_SEGMENT_DURATION_MS;
+        }
+        return static_cast<int>(std::lround(segment.duration * 1000.0));
+    }
+}
+
+SegmentBuffer::SegmentBuffer(size_t bufferSize, int minDepthMs, int maxDepthMs)
+    : bufferSize_(bufferSize),
+      minDepthMs_(std::max(0, minDepthMs)),
+      maxDepthMs_(std::max(std::max(0, minDepthMs), maxDepthMs)),
+      depthMs_(0),
+      targetDepthMs_(std::max(0, minDepthMs)),
+      primed_(false),
+      segmentMs_(DEFAULT_SEGMENT_DURATION_MS),
+      hasTransitReference_(false),
+      mediaTimeMs_(0.0),
+      minTransitMs_(0.0),
+      latenessMeanMs_(0.0),
+      latenessVarMs2_(0.0),
+      underrunCount_(0),
+      overrunCount_(0),
+      bytesHeld_(0),
+      log_(hls_to_dvb::Logging::get("SegmentBuffer")) {
+
+    SPDLOG_LOGGER_DEBUG(log_, "Buffer de segments créé avec une taille de {}, profondeur {}-{} ms",
+                        bufferSize, minDepthMs_, maxDepthMs_);
+}
+
+SegmentBuffer::~SegmentBuffer() {
+    clear();
+}
+
+void SegmentBuffer::setBufferAccount(std::shared_ptr<hls_to_dvb::StreamBufferAccount> account) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Transférer les octets déjà en tampon vers le nouveau compte
+    if (bufferAccount_) {
+        bufferAccount_->release(hls_to_dvb::BufferStage::SEGMENT_BUFFER, bytesHeld_);
+    }
+    bufferAccount_ = std::move(account);
+    if (bufferAccount_) {
+        bufferAccount_->add(hls_to_dvb::BufferStage::SEGMENT_BUFFER, bytesHeld_);
+    }
+}
+
+void SegmentBuffer::setMetrics(std::shared_ptr<hls_to_dvb::StreamMetrics> metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_ = std::move(metrics);
+    publishDepthInternal();
 }
 
 bool SegmentBuffer::pushSegment(const MPEGTSSegment& segment) {
+    return pushSegment(MPEGTSSegment(segment));
+}
+
+bool SegmentBuffer::pushSegment(MPEGTSSegment&& segment) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Vérifier si le buffer est plein
-    if (buffer_.size() >= bufferSize_) {
-        // Si le buffer est plein, supprimer le segment le plus ancien
-        buffer_.pop_front();
-        
-        spdlog::debug("Buffer plein, suppression du segment le plus ancien");
+
+    updateJitterEstimateInternal(std::chrono::steady_clock::now(), segment);
+
+    // Conserver au moins le nouveau segment, supprimer les plus anciens en cas de débordement
+    int incomingMs = segmentDurationMs(segment);
+    while (!buffer_.empty() &&
+           (buffer_.size() >= bufferSize_ || depthMs_ + incomingMs > maxDepthMs_)) {
+        dropOldestInternal();
+        overrunCount_++;
+        if (metrics_) {
+            metrics_->bufferOverruns->increment();
+        }
+
+        SPDLOG_LOGGER_DEBUG(log_, "Buffer plein, suppression du segment le plus ancien (profondeur: {} ms, max: {} ms)",
+                            depthMs_.load(), maxDepthMs_);
     }
-    
+
     // Ajouter le segment
-    buffer_.push_back(segment);
-    
+    size_t incomingBytes = segment.data.size();
+    buffer_.push_back(std::move(segment));
+    depthMs_ += incomingMs;
+    bytesHeld_ += incomingBytes;
+    if (bufferAccount_) {
+        bufferAccount_->add(hls_to_dvb::BufferStage::SEGMENT_BUFFER, incomingBytes);
+    }
+    publishDepthInternal();
+
     // Notifier les threads en attente
     conditionVar_.notify_one();
-    
-    spdlog::debug("Segment {} ajouté au buffer, taille actuelle: {}/{}", 
-                segment.sequenceNumber, buffer_.size(), bufferSize_.load());
-    
+
+    SPDLOG_LOGGER_TRACE(log_, "Segment {} ajouté au buffer, taille actuelle: {}/{}, profondeur: {}/{} ms",
+                        buffer_.back().sequenceNumber, buffer_.size(), bufferSize_.load(),
+                        depthMs_.load(), targetDepthMs_.load());
+
     return true;
 }
 
 bool SegmentBuffer::getSegment(MPEGTSSegment& segment, int timeout) {
     std::unique_lock<std::mutex> lock(mutex_);
-    
+
     // Si le buffer est vide et qu'un timeout est spécifié, attendre qu'un segment soit disponible
     if (buffer_.empty() && timeout > 0) {
         auto waitResult = conditionVar_.wait_for(lock, std::chrono::milliseconds(timeout),
                                                [this] { return !buffer_.empty(); });
-        
+
         if (!waitResult) {
             // Timeout atteint
-            spdlog::debug("Timeout atteint en attendant un segment, buffer vide");
+            SPDLOG_LOGGER_TRACE(log_, "Timeout atteint en attendant un segment, buffer vide");
             return false;
         }
     }
-    
+
     // Vérifier si le buffer est toujours vide
     if (buffer_.empty()) {
         return false;
     }
-    
+
     // Récupérer le segment le plus ancien
-    segment = buffer_.front();
-    buffer_.pop_front();
-    
-    spdlog::debug("Segment {} récupéré du buffer, taille actuelle: {}/{}", 
-                segment.sequenceNumber, buffer_.size(), bufferSize_.load());
-    
+    dropOldestInternal(&segment);
+
+    SPDLOG_LOGGER_TRACE(log_, "Segment {} récupéré du buffer, taille actuelle: {}/{}",
+                        segment.sequenceNumber, buffer_.size(), bufferSize_.load());
+
+    return true;
+}
+
+bool SegmentBuffer::popForPlayout(MPEGTSSegment& segment) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!primed_) {
+        // Attendre d'avoir accumulé la profondeur cible avant de diffuser
+        if (buffer_.empty() || depthMs_ < targetDepthMs_) {
+            return false;
+        }
+
+        primed_ = true;
+        SPDLOG_LOGGER_DEBUG(log_, "Tampon de gigue amorcé: profondeur {} ms, cible {} ms",
+                            depthMs_.load(), targetDepthMs_.load());
+    }
+
+    if (buffer_.empty()) {
+        // La diffusion réclame un segment mais le tampon est vide: sous-remplissage
+        underrunCount_++;
+        primed_ = false;
+        if (metrics_) {
+            metrics_->bufferUnderruns->increment();
+        }
+
+        log_->warn("Sous-remplissage du tampon de gigue (cible: {} ms, gigue: {:.0f} ms)",
+                   targetDepthMs_.load(), std::sqrt(latenessVarMs2_));
+        return false;
+    }
+
+    dropOldestInternal(&segment);
+
+    SPDLOG_LOGGER_TRACE(log_, "Segment {} délivré pour diffusion, profondeur restante: {} ms",
+                        segment.sequenceNumber, depthMs_.load());
+
     return true;
 }
 
 void SegmentBuffer::setBufferSize(size_t bufferSize) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+
     bufferSize_ = bufferSize;
-    
+
     // Si le buffer actuel est plus grand que la nouvelle taille, supprimer les segments les plus anciens
     while (buffer_.size() > bufferSize) {
-        buffer_.pop_front();
+        dropOldestInternal();
     }
-    
-    spdlog::debug("Taille du buffer ajustée à {}, taille actuelle: {}/{}", 
-                bufferSize, buffer_.size(), bufferSize_.load());
+    targetDepthMs_ = reachableTargetInternal(targetDepthMs_);
+
+    SPDLOG_LOGGER_DEBUG(log_, "Taille du buffer ajustée à {}, taille actuelle: {}/{}",
+                        bufferSize, buffer_.size(), bufferSize_.load());
 }
 
 size_t SegmentBuffer::getBufferSize() const {
@@ -83,10 +201,117 @@ size_t SegmentBuffer::getCurrentSize() const {
     return buffer_.size();
 }
 
+void SegmentBuffer::setDepthBounds(int minDepthMs, int maxDepthMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    minDepthMs_ = std::max(0, minDepthMs);
+    maxDepthMs_ = std::max(minDepthMs_, maxDepthMs);
+    targetDepthMs_ = reachableTargetInternal(std::max(targetDepthMs_.load(), minDepthMs_));
+
+    SPDLOG_LOGGER_DEBUG(log_, "Bornes du tampon de gigue ajustées: {}-{} ms, cible: {} ms",
+                        minDepthMs_, maxDepthMs_, targetDepthMs_.load());
+}
+
+int SegmentBuffer::getCurrentDepthMs() const {
+    return depthMs_;
+}
+
+int SegmentBuffer::getTargetDepthMs() const {
+    return targetDepthMs_;
+}
+
+double SegmentBuffer::getJitterMs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::sqrt(latenessVarMs2_);
+}
+
+uint64_t SegmentBuffer::getUnderrunCount() const {
+    return underrunCount_;
+}
+
+uint64_t SegmentBuffer::getOverrunCount() const {
+    return overrunCount_;
+}
+
 void SegmentBuffer::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+
     buffer_.clear();
+    if (bufferAccount_) {
+        bufferAccount_->release(hls_to_dvb::BufferStage::SEGMENT_BUFFER, bytesHeld_);
+    }
+    bytesHeld_ = 0;
+    depthMs_ = 0;
+    primed_ = false;
+    hasTransitReference_ = false;
+    publishDepthInternal();
+
+    SPDLOG_LOGGER_DEBUG(log_, "Buffer vidé");
+}
+
+void SegmentBuffer::updateJitterEstimateInternal(std::chrono::steady_clock::time_point arrival,
+                                                 const MPEGTSSegment& segment) {
+    segmentMs_ = segmentDurationMs(segment);
     
-    spdlog::debug("Buffer vidé");
+    // Une discontinuité remet à zéro la ligne de temps média: repartir d'une nouvelle référence
+    if (!hasTransitReference_ || segment.discontinuity) {
+        hasTransitReference_ = true;
+        referenceArrival_ = arrival;
+        mediaTimeMs_ = segmentDurationMs(segment);
+        minTransitMs_ = 0.0;
+        targetDepthMs_ = reachableTargetInternal(std::max(targetDepthMs_.load(), minDepthMs_));
+        return;
+    }
+
+    // Décalage entre l'heure d'arrivée et la position du segment sur la ligne de temps média.
+    // Le plus petit décalage observé correspond à un segment arrivé "à l'heure"; l'écart à
+    // ce minimum mesure le retard dû à la latence de récupération.
+    double arrivalMs = std::chrono::duration<double, std::milli>(arrival - referenceArrival_).count();
+    double transitMs = arrivalMs - mediaTimeMs_;
+    mediaTimeMs_ += segmentDurationMs(segment);
+
+    if (transitMs < minTransitMs_) {
+        minTransitMs_ = transitMs;
+    } else {
+        minTransitMs_ += (transitMs - minTransitMs_) * TRANSIT_DRIFT_GAIN;
+    }
+
+    double latenessMs = transitMs - minTransitMs_;
+    double diff = latenessMs - latenessMeanMs_;
+    latenessMeanMs_ += diff * JITTER_GAIN;
+    latenessVarMs2_ = (1.0 - JITTER_GAIN) * (latenessVarMs2_ + diff * diff * JITTER_GAIN);
+
+    double target = minDepthMs_ + latenessMeanMs_ + JITTER_DEVIATIONS * std::sqrt(latenessVarMs2_);
+    targetDepthMs_ = reachableTargetInternal(std::max(static_cast<int>(std::lround(target)), minDepthMs_));
+}
+
+int SegmentBuffer::reachableTargetInternal(int targetMs) const {
+    // Segments entiers qui tiennent sous la profondeur maximale, dans la limite du nombre de segments
+    size_t segments = std::min<size_t>(bufferSize_.load(), static_cast<size_t>(maxDepthMs_ / std::max(segmentMs_, 1)));
+    int reachableMs = std::max(static_cast<int>(segments) * segmentMs_, std::min(segmentMs_, maxDepthMs_));
+    return std::min(targetMs, reachableMs);
+}
+
+void SegmentBuffer::dropOldestInternal(MPEGTSSegment* segment) {
+    MPEGTSSegment& oldest = buffer_.front();
+    size_t bytes = oldest.data.size();
+
+    depthMs_ -= segmentDurationMs(oldest);
+    bytesHeld_ -= bytes;
+    if (bufferAccount_) {
+        bufferAccount_->release(hls_to_dvb::BufferStage::SEGMENT_BUFFER, bytes);
+    }
+
+    if (segment) {
+        *segment = std::move(oldest);
+    }
+    buffer_.pop_front();
+    publishDepthInternal();
+}
+
+void SegmentBuffer::publishDepthInternal() {
+    if (metrics_) {
+        metrics_->bufferDepthSeconds->set(depthMs_ / 1000.0);
+        metrics_->bufferTargetSeconds->set(targetDepthMs_ / 1000.0);
+    }
 }
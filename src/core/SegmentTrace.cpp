@@ -0,0 +1,194 @@
+#include "core/SegmentTrace.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace hls_to_dvb {
+
+namespace {
+    /**
+     * @brief Durée entre deux horodatages, si les deux sont renseignés
+     */
+    bool interval(int64_t fromUs, int64_t toUs, int64_t& durationUs) {
+        if (fromUs == 0 || toUs == 0) {
+            return false;
+        }
+        durationUs = toUs - fromUs;
+        return true;
+    }
+}
+
+int64_t SegmentTrace::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* traceStageName(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::PLAYLIST_WAIT: return "playlistWait";
+        case TraceStage::DOWNLOAD:      return "download";
+        case TraceStage::FETCH_QUEUE:   return "fetchQueue";
+        case TraceStage::CONVERT:       return "convert";
+        case TraceStage::BUFFER:        return "buffer";
+        case TraceStage::SEND_QUEUE:    return "sendQueue";
+        case TraceStage::SEND:          return "send";
+        case TraceStage::TOTAL:         return "total";
+        default:                        return "unknown";
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : count_(0),
+      sumUs_(0),
+      maxUs_(0) {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t valueUs) {
+    if (valueUs < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<size_t>(valueUs);
+    }
+
+    int magnitude = 63 - __builtin_clzll(valueUs);
+    if (magnitude > MAX_MAGNITUDE) {
+        return BUCKET_COUNT - 1;
+    }
+
+    int shift = magnitude - SUB_BUCKET_BITS;
+    size_t sub = static_cast<size_t>((valueUs >> shift) & (SUB_BUCKETS - 1));
+    return SUB_BUCKETS + static_cast<size_t>(shift) * SUB_BUCKETS + sub;
+}
+
+double LatencyHistogram::bucketValue(size_t index) {
+    if (index < static_cast<size_t>(SUB_BUCKETS)) {
+        return static_cast<double>(index);
+    }
+
+    size_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    size_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    double lower = static_cast<double>((SUB_BUCKETS + sub) << shift);
+    double width = static_cast<double>(1ULL << shift);
+    return lower + width / 2.0;
+}
+
+void LatencyHistogram::record(int64_t valueUs) {
+    uint64_t value = valueUs > 0 ? static_cast<uint64_t>(valueUs) : 0;
+
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sumUs_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t currentMax = maxUs_.load(std::memory_order_relaxed);
+    while (value > currentMax &&
+           !maxUs_.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySummary LatencyHistogram::summarize() const {
+    LatencySummary summary;
+
+    std::array<uint32_t, BUCKET_COUNT> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    if (total == 0) {
+        return summary;
+    }
+
+    summary.count = total;
+    summary.meanMs = static_cast<double>(sumUs_.load(std::memory_order_relaxed)) / total / 1000.0;
+    summary.maxMs = static_cast<double>(maxUs_.load(std::memory_order_relaxed)) / 1000.0;
+
+    const double ratios[] = {0.50, 0.90, 0.99, 0.999};
+    double* targets[] = {&summary.p50Ms, &summary.p90Ms, &summary.p99Ms, &summary.p999Ms};
+
+    uint64_t cumulative = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && next < 4; ++i) {
+        cumulative += counts[i];
+        while (next < 4 && cumulative >= static_cast<uint64_t>(ratios[next] * total + 0.5)) {
+            // La valeur représentative ne peut dépasser le maximum observé
+            *targets[next] = std::min(bucketValue(i) / 1000.0, summary.maxMs);
+            next++;
+        }
+    }
+
+    return summary;
+}
+
+SegmentTracer::SegmentTracer(const std::string& streamId, size_t capacity)
+    : streamId_(streamId),
+      ring_(std::max<size_t>(1, capacity)),
+      ringNext_(0),
+      ringSize_(0) {
+}
+
+void SegmentTracer::record(const SegmentTrace& trace) {
+    int64_t durationUs = 0;
+
+    if (interval(trace.playlistSeenUs, trace.downloadStartUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::PLAYLIST_WAIT)].record(durationUs);
+    }
+    if (interval(trace.downloadStartUs, trace.downloadEndUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::DOWNLOAD)].record(durationUs);
+    }
+    if (interval(trace.downloadEndUs, trace.convertStartUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::FETCH_QUEUE)].record(durationUs);
+    }
+    if (interval(trace.convertStartUs, trace.convertEndUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::CONVERT)].record(durationUs);
+    }
+    if (interval(trace.bufferEnqueueUs, trace.bufferDequeueUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::BUFFER)].record(durationUs);
+    }
+    if (interval(trace.bufferDequeueUs, trace.firstDatagramUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::SEND_QUEUE)].record(durationUs);
+    }
+    if (interval(trace.firstDatagramUs, trace.lastDatagramUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::SEND)].record(durationUs);
+    }
+
+    int64_t firstUs = trace.playlistSeenUs ? trace.playlistSeenUs :
+                      trace.downloadStartUs ? trace.downloadStartUs : trace.convertStartUs;
+    if (interval(firstUs, trace.lastDatagramUs, durationUs)) {
+        stages_[static_cast<size_t>(TraceStage::TOTAL)].record(durationUs);
+    }
+
+    std::lock_guard<std::mutex> lock(ringMutex_);
+    ring_[ringNext_] = trace;
+    ringNext_ = (ringNext_ + 1) % ring_.size();
+    ringSize_ = std::min(ringSize_ + 1, ring_.size());
+}
+
+std::array<LatencySummary, TRACE_STAGE_COUNT> SegmentTracer::getStageSummaries() const {
+    std::array<LatencySummary, TRACE_STAGE_COUNT> summaries;
+    for (size_t i = 0; i < TRACE_STAGE_COUNT; ++i) {
+        summaries[i] = stages_[i].summarize();
+    }
+    return summaries;
+}
+
+std::vector<SegmentTrace> SegmentTracer::getRecentTraces(size_t limit) const {
+    std::lock_guard<std::mutex> lock(ringMutex_);
+
+    size_t count = std::min(limit, ringSize_);
+    std::vector<SegmentTrace> traces;
+    traces.reserve(count);
+
+    size_t start = (ringNext_ + ring_.size() - count) % ring_.size();
+    for (size_t i = 0; i < count; ++i) {
+        traces.push_back(ring_[(start + i) % ring_.size()]);
+    }
+    return traces;
+}
+
+const std::string& SegmentTracer::getStreamId() const {
+    return streamId_;
+}
+
+} // namespace hls_to_dvb
@@ -1,8 +1,12 @@
 #include "core/StreamManager.h"
 #include "alerting/AlertManager.h"
+#include "core/MetricsRegistry.h"
+#include "hls/FetchScheduler.h"
 #include <spdlog/spdlog.h>
 #include <chrono>
-#include <set> 
+#include <set>
+#include <algorithm>
+#include <cctype>
 
 // Ajouter ces inclusions pour les fonctions réseau
 #ifdef _WIN32
@@ -21,25 +25,13 @@ namespace hls_to_dvb {
 
 
 StreamManager::StreamManager(Config* config)
-    : config_(config), running_(false) {
+    : config_(config), running_(false), log_(Logging::get("StreamManager")) {
 }
 
 void StreamManager::start() {
-    static int startCallCount = 0;
-    int currentStartCall = ++startCallCount;
-    spdlog::info("start() appelé (appel #{}) - début", currentStartCall);
-    
     // Récupérer les configurations des flux
     auto streamConfigs = config_->getStreamConfigs();
     
-    // Vérifier s'il y a des doublons et les journaliser
-    std::set<std::string> uniqueIds;
-    for (const auto& config : streamConfigs) {
-        if (!uniqueIds.insert(config.id).second) {
-            spdlog::warn("ID de flux en double détecté : {}", config.id);
-        }
-    }
-    
     // Définir l'état running_
     {
         std::lock_guard<std::mutex> lock(streamsMutex_);
@@ -53,80 +45,153 @@ void StreamManager::start() {
     }
     
     spdlog::info("Démarrage du gestionnaire de flux");
+    auto startTime = std::chrono::steady_clock::now();
+    
+    // Appliquer le budget mémoire global avant de créer les tampons des flux
+    const MemoryConfig& memoryConfig = config_->getMemoryConfig();
+    BufferAccountant::getInstance().setBudget(memoryConfig.budgetBytes,
+                                              memoryConfig.highWatermarkPercent,
+                                              memoryConfig.lowWatermarkPercent);
+    
+    // La récupération HLS de tous les flux peut partager quelques boucles d'E/S
+    const FetchConfig& fetchConfig = config_->getFetchConfig();
+    if (fetchConfig.engine == "coroutine" && !ioRuntime_) {
+        if (IoRuntime::isSupported()) {
+            ioRuntime_ = std::make_shared<IoRuntime>(fetchConfig.ioThreads);
+            FetchScheduler::getInstance().setMaxRequestsPerOrigin(fetchConfig.maxRequestsPerOrigin);
+            HttpFetcher::setIdleConnections(static_cast<size_t>(std::max(fetchConfig.idleConnectionsPerOrigin, 0)));
+        } else {
+            spdlog::warn("Runtime d'E/S non pris en charge sur cette plateforme, un thread de récupération par flux");
+        }
+    }
     
-    // Utiliser un ensemble pour suivre les flux déjà démarrés
-    std::set<std::string> startedStreams;
-    
-    // Démarrer les flux sans tenir le mutex principal
+    // Retenir les flux activés et complets, chacun une seule fois. Seul le premier flux
+    // de chaque entrée démarre un pipeline, les suivants s'y abonnent ensuite
+    std::set<std::string> uniqueIds;
+    std::set<std::string> ingestKeys;
+    std::vector<std::string> streamIds;
+    std::vector<std::string> sharedIds;
     for (const auto& streamConfig : streamConfigs) {
-        // Vérifier si ce flux a déjà été démarré
-        if (startedStreams.find(streamConfig.id) != startedStreams.end()) {
-            spdlog::warn("Tentative de démarrage multiple du flux {}, ignorée", streamConfig.id);
+        if (!uniqueIds.insert(streamConfig.id).second) {
+            spdlog::warn("ID de flux en double détecté : {}", streamConfig.id);
+            continue;
+        }
+        if (!streamConfig.enabled) {
+            spdlog::info("Flux {} désactivé, non démarré", streamConfig.id);
             continue;
         }
-        
         if (!streamConfig.hlsInput.empty() && !streamConfig.mcastOutput.empty() && streamConfig.mcastPort > 0) {
+            if (ingestKeys.insert(ingestKey(streamConfig)).second) {
+                streamIds.push_back(streamConfig.id);
+            } else {
+                sharedIds.push_back(streamConfig.id);
+            }
+        }
+    }
+    
+    // Démarrer les flux en parallèle: le démarrage d'un flux attend surtout le réseau
+    // (playlists, premier segment), un flux lent ne retarde donc pas les autres
+    size_t workerCount = std::min<size_t>(
+        std::max(config_->getStartupConfig().parallelStarts, 1), streamIds.size());
+    std::atomic<size_t> nextIndex{0};
+    std::mutex startedMutex;
+    std::set<std::string> startedStreams;
+    
+    auto startWorker = [&]() {
+        for (size_t i = nextIndex.fetch_add(1); i < streamIds.size(); i = nextIndex.fetch_add(1)) {
+            const std::string& streamId = streamIds[i];
             try {
-                spdlog::info("Tentative de démarrage du flux {}", streamConfig.id);
-                bool success = startStream(streamConfig.id);
-                
-                if (success) {
-                    startedStreams.insert(streamConfig.id);
-                    spdlog::info("Flux {} démarré avec succès", streamConfig.id);
+                if (startStream(streamId)) {
+                    std::lock_guard<std::mutex> lock(startedMutex);
+                    startedStreams.insert(streamId);
                 } else {
-                    spdlog::warn("Échec du démarrage du flux {}", streamConfig.id);
+                    spdlog::warn("Échec du démarrage du flux {}", streamId);
                 }
             }
             catch (const std::exception& e) {
-                spdlog::error("Exception lors du démarrage du flux {}: {}", streamConfig.id, e.what());
+                spdlog::error("Exception lors du démarrage du flux {}: {}", streamId, e.what());
                 
                 AlertManager::getInstance().addAlert(
                     AlertLevel::ERROR,
                     "StreamManager",
-                    "Erreur lors du démarrage du flux " + streamConfig.id + ": " + e.what(),
+                    "Erreur lors du démarrage du flux " + streamId + ": " + e.what(),
                     true
                 );
             }
         }
+    };
+    
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount; ++i) {
+        workers.emplace_back(startWorker);
+    }
+    startWorker();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    // S'abonner aux pipelines démarrés: seuls des émetteurs sont créés
+    for (const auto& streamId : sharedIds) {
+        if (startStream(streamId)) {
+            startedStreams.insert(streamId);
+        } else {
+            spdlog::warn("Échec du démarrage du flux {}", streamId);
+        }
     }
-    spdlog::info("start() appelé (appel #{}) - fin", currentStartCall);
-    spdlog::info("Tous les flux ont été traités, {} flux démarrés", startedStreams.size());
+    
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    spdlog::info("Tous les flux ont été traités en {} ms, {}/{} flux démarrés",
+                 elapsedMs, startedStreams.size(), streamIds.size() + sharedIds.size());
 }
 
 
 void StreamManager::stop() {
-    std::lock_guard<std::mutex> lock(streamsMutex_);
-    
-    if (!running_) {
-        spdlog::warn("Le gestionnaire de flux n'est pas en cours d'exécution");
-        return;
+    std::vector<std::string> runningStreams;
+    {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        
+        if (!running_) {
+            spdlog::warn("Le gestionnaire de flux n'est pas en cours d'exécution");
+            return;
+        }
+        
+        // Arrêter d'abord les flux abonnés, pour que l'arrêt d'un pipeline partagé ne
+        // les redémarre pas avec leur propre récupération
+        for (auto& pair : streams_) {
+            if (pair.second.isRunning() && !pair.second.ingestSourceId.empty()) {
+                runningStreams.push_back(pair.first);
+            }
+        }
+        for (auto& pair : streams_) {
+            if (pair.second.isRunning() && pair.second.ingestSourceId.empty()) {
+                runningStreams.push_back(pair.first);
+            }
+        }
     }
     
     spdlog::info("Arrêt du gestionnaire de flux");
     
-    // Arrêter tous les flux en cours d'exécution
-    for (auto& pair : streams_) {
+    // Arrêter tous les flux en cours d'exécution, hors verrou: stopStream() le reprend
+    for (const auto& streamId : runningStreams) {
         try {
-            if (pair.second.isRunning()) {
-                stopStream(pair.first);
-            }
+            stopStream(streamId);
         }
         catch (const std::exception& e) {
-            spdlog::error("Erreur lors de l'arrêt du flux {}: {}", pair.first, e.what());
+            spdlog::error("Erreur lors de l'arrêt du flux {}: {}", streamId, e.what());
         }
     }
     
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        running_ = false;
+    }
     
     spdlog::info("Tous les flux ont été arrêtés");
 }
 
 bool StreamManager::startStream(const std::string& streamId) {
     try {
-        static std::map<std::string, int> callCounts;
-        int currentCall = ++callCounts[streamId];
-        spdlog::info("********************************  startStream({}) appelé - appel #{} pour ce flux", streamId, currentCall);
-
         // Vérifier si la configuration existe
         const StreamConfig* config = config_->getStreamConfig(streamId);
         if (!config) {
@@ -140,8 +205,14 @@ bool StreamManager::startStream(const std::string& streamId) {
             return false;
         }
         
+        // Un flux en cours de même entrée fournit déjà les segments convertis
+        if (auto attached = attachToSharedIngest(streamId, *config)) {
+            return *attached;
+        }
+        
         // Créer tous les composants en dehors du mutex
         spdlog::info("Démarrage du flux: {}", streamId);
+        const bool diagnostics = config_->getStartupConfig().diagnostics;
         
         // Créer une nouvelle instance de flux temporaire
         StreamInstance tempStream;
@@ -153,13 +224,15 @@ bool StreamManager::startStream(const std::string& streamId) {
         try {
             // Création et initialisation des composants
             spdlog::info("Création du SegmentBuffer pour {}", streamId);
-            tempStream.segmentBuffer = std::make_shared<SegmentBuffer>(config->bufferSize);
+            tempStream.segmentBuffer = std::make_shared<SegmentBuffer>(
+                config->bufferSize, config->bufferMinMs, config->bufferMaxMs);
             
             spdlog::info("Création du HLSClient pour {} avec URL: {}", streamId, config->hlsInput);
             tempStream.hlsClient = std::make_shared<HLSClient>(config->hlsInput);
             
             spdlog::info("Création du MPEGTSConverter pour {}", streamId);
             tempStream.mpegtsConverter = std::make_shared<MPEGTSConverter>();
+            tempStream.mpegtsConverter->setPassthrough(config->passthrough);
             
             spdlog::info("Création du MulticastSender pour le flux {} avec adresse {} et port {}", 
                         streamId, config->mcastOutput, config->mcastPort);
@@ -184,6 +257,40 @@ bool StreamManager::startStream(const std::string& streamId) {
                 return false;
             }
             
+            // Comptabiliser les tampons du flux dans le budget mémoire global et
+            // recycler les tampons des segments entre les étapes du flux
+            tempStream.bufferAccount = BufferAccountant::getInstance().registerStream(streamId);
+            tempStream.bufferPool = std::make_shared<BufferPool>();
+            tempStream.metrics = StreamMetrics::create(streamId);
+            tempStream.metrics->startRequestedUs.store(SegmentTrace::nowUs(), std::memory_order_relaxed);
+            tempStream.fanOut = std::make_shared<FanOutGroup>();
+            
+            // Reprendre les compteurs de continuité et versions de tables d'une exécution précédente
+            const CheckpointConfig& checkpointConfig = config_->getCheckpointConfig();
+            if (checkpointConfig.enabled) {
+                tempStream.stateFile = StreamStateFile::open(checkpointConfig.directory, streamId);
+            }
+            attachStreamResources(tempStream);
+            
+            // Chaque étape est relancée seule, avec ses propres délais de reprise
+            const RecoveryConfig& recoveryConfig = config_->getRecoveryConfig();
+            RecoveryBackoff backoff(recoveryConfig.initialDelayMs, recoveryConfig.maxDelayMs, recoveryConfig.jitter);
+            tempStream.fetchRecovery = backoff;
+            tempStream.convertRecovery = backoff;
+            tempStream.sendRecovery = backoff;
+            tempStream.hlsClient->setRecovery(recoveryConfig.initialDelayMs, recoveryConfig.maxDelayMs,
+                                              recoveryConfig.jitter);
+            tempStream.hlsClient->setRuntime(ioRuntime_);
+            tempStream.hlsClient->setAlternateInputs(config->hlsInputs);
+            tempStream.hlsClient->setHedging(std::chrono::milliseconds(config_->getFetchConfig().hedgeAfterMs));
+            tempStream.hlsClient->setBufferDepth([buffer = tempStream.segmentBuffer]() {
+                return buffer->getCurrentDepthMs();
+            });
+            
+            // Les sondages et paquets de test ne sont faits qu'en mode diagnostic
+            tempStream.hlsClient->setDiagnostics(diagnostics);
+            tempStream.multicastSender->setDiagnostics(diagnostics);
+            
             // DÉMARRAGE: Démarrer tous les composants AVANT de créer le thread
             
             // 1. Initialiser le MulticastSender
@@ -258,45 +365,50 @@ bool StreamManager::startStream(const std::string& streamId) {
                 return false;
             }
             
-            // Test de validation direct: envoyer un paquet de test pour vérifier la chaîne complète
-            spdlog::info("Test direct d'envoi multicast pour le flux {}", streamId);
-            bool testSent = false;
+            // Test de validation de bout en bout (mode diagnostic): il consomme le premier
+            // segment et retarde d'autant le premier paquet réellement diffusé
+            if (diagnostics) {
+                spdlog::info("Test direct d'envoi multicast pour le flux {}", streamId);
+                bool testSent = false;
             
-            // Récupérer un segment de test pour vérifier la chaîne complète
-            auto testSegment = tempStream.hlsClient->getNextSegment();
-            if (testSegment) {
-                auto convertedSegment = tempStream.mpegtsConverter->convert(*testSegment);
-                if (convertedSegment) {
-                    // Analyser la qualité du segment
-                    tempStream.qualityMonitor->analyze(convertedSegment->data);
+                // Récupérer un segment de test pour vérifier la chaîne complète
+                auto testSegment = tempStream.hlsClient->getNextSegment();
+                if (testSegment) {
+                    auto convertedSegment = tempStream.mpegtsConverter->convert(*testSegment);
+                    if (convertedSegment) {
+                        // Analyser la qualité du segment
+                        tempStream.qualityMonitor->analyze(convertedSegment->data);
                     
-                    // Essayer d'envoyer le segment
-                    testSent = tempStream.multicastSender->send(convertedSegment->data, false);
-                    spdlog::info("Test d'envoi direct: {}", testSent ? "Réussi" : "Échoué");
+                        // Essayer d'envoyer le segment
+                        testSent = tempStream.multicastSender->send(convertedSegment->data, false);
+                        spdlog::info("Test d'envoi direct: {}", testSent ? "Réussi" : "Échoué");
+                    }
                 }
-            }
             
-            if (!testSent) {
-                // Fallback: envoyer un paquet de test synthétique
-                std::vector<uint8_t> testData(188, 0xFF);
-                std::memcpy(testData.data(), "TEST_DIRECT_MULTICAST", 21);
-                testSent = tempStream.multicastSender->send(testData, false);
-                spdlog::info("Test d'envoi de secours: {}", testSent ? "Réussi" : "Échoué");
-                
                 if (!testSent) {
-                    spdlog::error("Tous les tests d'envoi ont échoué, arrêt du démarrage du flux");
-                    tempStream.hlsClient->stop();
-                    tempStream.mpegtsConverter->stop();
-                    tempStream.multicastSender->stop();
-                    return false;
+                    // Fallback: envoyer un paquet de test synthétique
+                    std::vector<uint8_t> testData(188, 0xFF);
+                    std::memcpy(testData.data(), "TEST_DIRECT_MULTICAST", 21);
+                    testSent = tempStream.multicastSender->send(testData, false);
+                    spdlog::info("Test d'envoi de secours: {}", testSent ? "Réussi" : "Échoué");
+                
+                    if (!testSent) {
+                        spdlog::error("Tous les tests d'envoi ont échoué, arrêt du démarrage du flux");
+                        tempStream.hlsClient->stop();
+                        tempStream.mpegtsConverter->stop();
+                        tempStream.multicastSender->stop();
+                        return false;
+                    }
                 }
             }
             
+            // Récupérer les informations sur le flux avant que l'instance ne soit déplacée
+            HLSStreamInfo streamInfo = tempStream.hlsClient->getStreamInfo();
+            
             // Maintenant que tous les composants fonctionnent,
             // verrouiller le mutex pour ajouter le flux à la liste des streams_
             {
                 std::lock_guard<std::mutex> lock(streamsMutex_);
-                spdlog::info("Mutex verrouillé pour le flux {}", streamId);
                 
                 // Vérifier si le flux est déjà en cours d'exécution
                 auto it = streams_.find(streamId);
@@ -305,6 +417,11 @@ bool StreamManager::startStream(const std::string& streamId) {
                     return true;
                 }
                 
+                // Remplacer une instance arrêtée du même flux
+                if (it != streams_.end()) {
+                    streams_.erase(it);
+                }
+                
                 // Marquer la stream comme en cours d'exécution AVANT de lancer le thread
                 tempStream.setRunning(true);
                 
@@ -315,7 +432,6 @@ bool StreamManager::startStream(const std::string& streamId) {
                 auto& savedStream = result.first->second;
                 try {
                     savedStream.processingThread = std::thread(&StreamManager::processStream, this, streamId);
-                    spdlog::info("*** THREAD CRÉÉ AVEC SUCCÈS ***");
                 } catch (const std::exception& e) {
                     spdlog::error("Erreur lors de la création du thread de traitement pour le flux {}: {}", streamId, e.what());
                     // Mettre à jour l'état
@@ -325,13 +441,9 @@ bool StreamManager::startStream(const std::string& streamId) {
                     savedStream.multicastSender->stop();
                     return false;
                 }
-                
-                spdlog::info("Mutex déverrouillé pour le flux {}", streamId);
             }
             
-            // Récupérer les informations sur le flux et générer les alertes
-            HLSStreamInfo streamInfo = tempStream.hlsClient->getStreamInfo();
-            
+            // Générer les alertes
             AlertManager::getInstance().addAlert(
                 AlertLevel::INFO,
                 "StreamManager",
@@ -348,7 +460,7 @@ bool StreamManager::startStream(const std::string& streamId) {
                 false
             );
             
-            spdlog::info("startStream({}) terminé avec succès - appel #{} pour ce flux", streamId, currentCall);
+            spdlog::info("Flux {} démarré", streamId);
             return true;
         }
         catch (const std::exception& e) {
@@ -376,7 +488,7 @@ bool StreamManager::startStream(const std::string& streamId) {
 
 
 bool StreamManager::stopStream(const std::string& streamId) {
-    std::lock_guard<std::mutex> lock(streamsMutex_);
+    std::unique_lock<std::mutex> lock(streamsMutex_);
     
     auto it = streams_.find(streamId);
     if (it == streams_.end()) {
@@ -396,6 +508,25 @@ bool StreamManager::stopStream(const std::string& streamId) {
     // Arrêter le traitement du flux
     stream.setRunning(false);
     
+    // Flux abonné: se désabonner du pipeline partagé, qui continue pour les autres sorties
+    if (!stream.ingestSourceId.empty()) {
+        auto source = streams_.find(stream.ingestSourceId);
+        if (source != streams_.end() && source->second.fanOut) {
+            std::lock_guard<std::mutex> groupLock(source->second.fanOut->mutex);
+            source->second.fanOut->outputs.erase(streamId);
+        }
+    }
+    
+    // Sorties abonnées au pipeline de ce flux: elles seront redémarrées après l'arrêt
+    std::vector<std::string> orphanedStreams;
+    if (stream.fanOut) {
+        std::lock_guard<std::mutex> groupLock(stream.fanOut->mutex);
+        for (auto& [outputId, sender] : stream.fanOut->outputs) {
+            orphanedStreams.push_back(outputId);
+        }
+        stream.fanOut->outputs.clear();
+    }
+    
     // Attendre la fin du thread de traitement
     if (stream.processingThread.joinable()) {
         stream.processingThread.join();
@@ -414,6 +545,15 @@ bool StreamManager::stopStream(const std::string& streamId) {
         stream.hlsClient->stop();
     }
     
+    // Libérer les segments en attente: ils ne seront plus diffusés
+    if (stream.segmentBuffer) {
+        stream.segmentBuffer->clear();
+    }
+    BufferAccountant::getInstance().unregisterStream(streamId);
+    
+    // Les séries du flux (origines HLS comprises) quittent l'export; un redémarrage les recrée
+    MetricsRegistry::getInstance().removeSeries("stream", streamId);
+    
     AlertManager::getInstance().addAlert(
         AlertLevel::INFO,
         "StreamManager",
@@ -421,6 +561,28 @@ bool StreamManager::stopStream(const std::string& streamId) {
         false
     );
     
+    // Arrêter les sorties orphelines, puis les redémarrer hors verrou: la première
+    // reprend un pipeline complet, les suivantes s'y abonnent
+    for (const auto& outputId : orphanedStreams) {
+        auto output = streams_.find(outputId);
+        if (output != streams_.end()) {
+            output->second.setRunning(false);
+            if (output->second.multicastSender) {
+                output->second.multicastSender->stop();
+            }
+            BufferAccountant::getInstance().unregisterStream(outputId);
+            MetricsRegistry::getInstance().removeSeries("stream", outputId);
+        }
+    }
+    lock.unlock();
+    
+    for (const auto& outputId : orphanedStreams) {
+        spdlog::info("Redémarrage du flux {}, qui partageait la récupération du flux {}", outputId, streamId);
+        if (!startStream(outputId)) {
+            spdlog::error("Échec du redémarrage du flux {}", outputId);
+        }
+    }
+    
     return true;
 }
     
@@ -450,6 +612,7 @@ std::optional<StreamManager::StreamStats> StreamManager::getStreamStats(const st
     
     if (stream.hlsClient) {
         stats.segmentsProcessed = stream.hlsClient->getSegmentsProcessed();
+        stats.origins = stream.hlsClient->getOriginStats();
         stats.discontinuitiesDetected = stream.hlsClient->getDiscontinuitiesDetected();
         
         // Ajouter les informations sur le flux
@@ -463,17 +626,70 @@ std::optional<StreamManager::StreamStats> StreamManager::getStreamStats(const st
     if (stream.segmentBuffer) {
         stats.bufferSize = stream.segmentBuffer->getCurrentSize();
         stats.bufferCapacity = stream.segmentBuffer->getBufferSize();
+        stats.bufferDepthMs = stream.segmentBuffer->getCurrentDepthMs();
+        stats.bufferTargetMs = stream.segmentBuffer->getTargetDepthMs();
+        stats.bufferJitterMs = stream.segmentBuffer->getJitterMs();
+        stats.bufferUnderruns = stream.segmentBuffer->getUnderrunCount();
+        stats.bufferOverruns = stream.segmentBuffer->getOverrunCount();
+    }
+    
+    if (stream.bufferAccount) {
+        stats.hlsQueueBytes = stream.bufferAccount->getBytes(BufferStage::HLS_QUEUE);
+        stats.segmentBufferBytes = stream.bufferAccount->getBytes(BufferStage::SEGMENT_BUFFER);
+        stats.multicastQueueBytes = stream.bufferAccount->getBytes(BufferStage::MULTICAST_QUEUE);
+        stats.memoryBytes = stream.bufferAccount->getTotalBytes();
+    }
+    
+    if (stream.bufferPool) {
+        auto poolStats = stream.bufferPool->getStats();
+        stats.poolHeapAllocations = poolStats.heapAllocations;
+        stats.poolReuses = poolStats.reuses;
+        stats.poolAllocationsPerSegment = poolStats.allocationsPerSegment;
+        stats.poolPooledBytes = poolStats.pooledBytes;
+        stats.poolPeakPooledBytes = poolStats.peakPooledBytes;
+    }
+    
+    if (stream.mpegtsConverter) {
+        stats.passthroughActive = stream.mpegtsConverter->isPassthroughActive();
+        stats.passthroughSegments = stream.mpegtsConverter->getPassthroughSegments();
+        stats.passthroughFallbackReason = stream.mpegtsConverter->getPassthroughFallbackReason();
+    }
+    
+    stats.ingestSourceId = stream.ingestSourceId;
+    if (stream.fanOut) {
+        std::lock_guard<std::mutex> groupLock(stream.fanOut->mutex);
+        stats.fanOutOutputs = stream.fanOut->outputs.size();
+    }
+    
+    if (stream.liveEdge) {
+        stats.liveLatencyMs = stream.liveEdge->getLatencyMs();
+        stats.catchUpSkips = stream.liveEdge->getSkippedSegments();
+        stats.catchingUp = stream.liveEdge->isCatchingUp();
     }
     
     if (stream.multicastSender) {
         const MulticastStats& multicastStats = stream.multicastSender->getStats();
         stats.packetsTransmitted = multicastStats.packetsSent;
         stats.currentBitrate = multicastStats.instantBitrate;
+        stats.outputs = multicastStats.outputs;
+        stats.outputErrors = multicastStats.outputErrors;
     }
     
     return stats;
 }
 
+std::map<std::string, std::shared_ptr<SegmentTracer>> StreamManager::getSegmentTracers() const {
+    std::lock_guard<std::mutex> lock(streamsMutex_);
+    
+    std::map<std::string, std::shared_ptr<SegmentTracer>> tracers;
+    for (const auto& [streamId, stream] : streams_) {
+        if (stream.metrics && stream.metrics->tracer) {
+            tracers[streamId] = stream.metrics->tracer;
+        }
+    }
+    return tracers;
+}
+
 bool StreamManager::setStreamBufferSize(const std::string& streamId, size_t bufferSize) {
     std::lock_guard<std::mutex> lock(streamsMutex_);
     
@@ -523,6 +739,8 @@ void StreamManager::processStream(const std::string& streamId) {
     bool healthCheckPassed = true;
     int consecutiveErrorCount = 0;
     const int MAX_CONSECUTIVE_ERRORS = 5;
+    const RecoveryConfig& recoveryConfig = config_->getRecoveryConfig();
+    RecoveryBackoff errorBackoff(recoveryConfig.initialDelayMs, recoveryConfig.maxDelayMs, recoveryConfig.jitter);
     
     // Récupérer l'instance du flux
     StreamInstance* stream = nullptr;
@@ -581,6 +799,7 @@ void StreamManager::processStream(const std::string& streamId) {
         auto lastHealthCheckTime = std::chrono::steady_clock::now();
         
         double lastSegmentDuration = 0.0;
+        double playoutDuration = 0.0;
         int lastProcessedSequenceNumber = -1;
         int emptyCount = 0;
         int retryCount = 0;
@@ -594,6 +813,7 @@ void StreamManager::processStream(const std::string& streamId) {
         const int QUALITY_CHECK_INTERVAL_SEC = 30;
         const int FORCED_CHECK_INTERVAL_SEC = 5;
         const int HEALTH_CHECK_INTERVAL_SEC = 20;
+        const int MAX_PLAYOUT_POLL_MS = 250;
         
         spdlog::info("Démarrage de la boucle principale pour le flux {}", streamId);
         
@@ -602,42 +822,17 @@ void StreamManager::processStream(const std::string& streamId) {
             try {
                 auto currentTime = std::chrono::steady_clock::now();
                 
- // Vérification périodique de l'état de santé du flux
+                // Relancer les étapes arrêtées, chacune selon ses délais de reprise: pendant
+                // ce temps, le tampon de gigue continue d'être diffusé
+                recoverStages(stream);
+                
+                // Vérification périodique de l'état de santé du flux
                 auto elapsedSinceHealthCheck = std::chrono::duration_cast<std::chrono::seconds>(
                     currentTime - lastHealthCheckTime).count();
                 
                 if (elapsedSinceHealthCheck >= HEALTH_CHECK_INTERVAL_SEC) {
                     lastHealthCheckTime = currentTime;
                     
-                    // Vérifier si tous les composants sont toujours opérationnels
-                    bool allComponentsRunning = stream->hlsClient->isRunning() &&
-                                              stream->mpegtsConverter->isRunning() &&
-                                              stream->multicastSender->isRunning();
-                    
-                    if (!allComponentsRunning) {
-                        spdlog::warn("Un ou plusieurs composants ne sont plus en cours d'exécution pour le flux {}", streamId);
-                        spdlog::warn("État des composants - HLSClient: {}, MPEGTSConverter: {}, MulticastSender: {}",
-                                  stream->hlsClient->isRunning() ? "OK" : "Arrêté",
-                                  stream->mpegtsConverter->isRunning() ? "OK" : "Arrêté",
-                                  stream->multicastSender->isRunning() ? "OK" : "Arrêté");
-                        
-                        // Tentative de redémarrage des composants arrêtés
-                        if (!stream->hlsClient->isRunning()) {
-                            spdlog::info("Tentative de redémarrage du HLSClient pour le flux {}", streamId);
-                            stream->hlsClient->start();
-                        }
-                        
-                        if (!stream->mpegtsConverter->isRunning()) {
-                            spdlog::info("Tentative de redémarrage du MPEGTSConverter pour le flux {}", streamId);
-                            stream->mpegtsConverter->start();
-                        }
-                        
-                        if (!stream->multicastSender->isRunning()) {
-                            spdlog::info("Tentative de redémarrage du MulticastSender pour le flux {}", streamId);
-                            stream->multicastSender->start();
-                        }
-                    }
-                    
                     // Vérifier le temps écoulé depuis le dernier traitement réussi
                     auto timeSinceSuccess = std::chrono::duration_cast<std::chrono::seconds>(
                         currentTime - lastSuccessfulCycleTime).count();
@@ -682,44 +877,47 @@ void StreamManager::processStream(const std::string& streamId) {
                     }
                 }
                 
-                // Vérifier si le client HLS est toujours actif
-                if (!stream->hlsClient->isRunning()) {
-                    spdlog::error("HLSClient n'est plus en cours d'exécution, tentative de redémarrage");
-                    // Tenter de redémarrer le client HLS
-                    stream->hlsClient->start();
-                    std::this_thread::sleep_for(std::chrono::seconds(2));
-                    
-                    // Incrémenter le compteur d'erreurs consécutives
-                    consecutiveErrorCount++;
-                    
-                    if (consecutiveErrorCount > MAX_CONSECUTIVE_ERRORS) {
-                        spdlog::error("Trop d'erreurs consécutives ({}/{}), réinitialisation complète du flux",
-                                   consecutiveErrorCount, MAX_CONSECUTIVE_ERRORS);
-                        
-                        // Réinitialiser complètement le flux
-                        // (Cette logique sera implémentée dans la méthode resetStream)
-                        resetStream(streamId);
-                        consecutiveErrorCount = 0;
-                    }
-                    
-                    continue;
-                }
-                
                 // Si nous sommes en train de traiter un segment, attendre que sa durée soit écoulée
                 if (segmentInProgress) {
                     auto elapsedSinceStartSec = std::chrono::duration_cast<std::chrono::milliseconds>(
                         currentTime - sendStartTime).count() / 1000.0;
                     
-                    if (elapsedSinceStartSec < lastSegmentDuration) {
+                    if (elapsedSinceStartSec < playoutDuration) {
+                        // Continuer d'alimenter le tampon de gigue pendant la diffusion
+                        auto hlsSegment = stream->hlsClient->getNextSegment();
+                        if (hlsSegment && (hlsSegment->sequenceNumber != lastProcessedSequenceNumber || hlsSegment->discontinuity)) {
+                            waitingForNewSegment = false;
+                            retryCount = 0;
+                            emptyCount = 0;
+                            consecutiveErrorCount = 0;
+                            errorBackoff.succeed();
+                            
+                            lastSegmentTime = currentTime;
+                            lastSegmentDuration = hlsSegment->duration > 0.0 ? hlsSegment->duration : 4.0;
+                            lastProcessedSequenceNumber = hlsSegment->sequenceNumber;
+                            
+                            if (ingestSegment(stream, *hlsSegment)) {
+                                lastSuccessfulCycleTime = currentTime;
+                                healthCheckPassed = true;
+                            }
+                            continue;
+                        }
+                        
                         // Attendre un court moment pour être réactif tout en respectant le timing
-                        double remainingSec = lastSegmentDuration - elapsedSinceStartSec;
-                        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(remainingSec * 1000 * 0.2)));
+                        double remainingSec = playoutDuration - elapsedSinceStartSec;
+                        int sleepMs = std::min(static_cast<int>(remainingSec * 1000 * 0.2), MAX_PLAYOUT_POLL_MS);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
                         continue;
                     }
                     
                     // Le segment est terminé
                     segmentInProgress = false;
-                    spdlog::debug("Fin de la diffusion du segment {}", lastProcessedSequenceNumber);
+                    SPDLOG_LOGGER_DEBUG(log_, "Fin de la diffusion du segment en cours (dernier reçu: {})", lastProcessedSequenceNumber);
+                    
+                    // Enchaîner immédiatement avec le segment suivant du tampon de gigue
+                    if (playoutSegment(stream, segmentInProgress, sendStartTime, playoutDuration)) {
+                        continue;
+                    }
                 }
                 
                 // Calculer le temps écoulé depuis le dernier segment
@@ -734,15 +932,15 @@ void StreamManager::processStream(const std::string& streamId) {
                     currentTime - lastPlaylistRefreshTime).count();
 
                 if (elapsedSinceRefreshSec >= PLAYLIST_REFRESH_INTERVAL_SEC && waitingForNewSegment) {
-                    spdlog::info("Rafraîchissement de la playlist HLS après {}s sans nouveaux segments",
-                            elapsedSinceRefreshSec);
+                    SPDLOG_LOGGER_DEBUG(log_, "Rafraîchissement de la playlist HLS après {}s sans nouveaux segments",
+                                        elapsedSinceRefreshSec);
                     
                     try {
                         bool refreshed = stream->hlsClient->refreshPlaylist();
                         lastPlaylistRefreshTime = currentTime;
                         
                         if (refreshed) {
-                            spdlog::info("Playlist rafraîchie avec succès");
+                            SPDLOG_LOGGER_DEBUG(log_, "Playlist rafraîchie avec succès");
                             retryCount = 0;
                         }
                     } catch (const std::exception& e) {
@@ -757,21 +955,22 @@ void StreamManager::processStream(const std::string& streamId) {
                     currentTime - lastCheckTime).count();
                 
                 if (timeElapsedSinceLastCheck >= FORCED_CHECK_INTERVAL_SEC) {
-                    spdlog::debug("Vérification forcée après {} secondes", timeElapsedSinceLastCheck);
+                    SPDLOG_LOGGER_DEBUG(log_, "Vérification forcée après {} secondes", timeElapsedSinceLastCheck);
                     lastCheckTime = currentTime;
                     
                     // Forcer une récupération de segment
                     auto hlsSegment = stream->hlsClient->getNextSegment();
                     
                     if (hlsSegment) {
-                        spdlog::debug("VÉRIFICATION FORCÉE: Segment récupéré, seq: {}, taille: {} octets", 
-                                  hlsSegment->sequenceNumber, hlsSegment->data.size());
+                        SPDLOG_LOGGER_DEBUG(log_, "VÉRIFICATION FORCÉE: Segment récupéré, seq: {}, taille: {} octets",
+                                            hlsSegment->sequenceNumber, hlsSegment->data.size());
                         
                         // Réinitialiser les compteurs d'état
                         waitingForNewSegment = false;
                         retryCount = 0;
                         emptyCount = 0;
                         consecutiveErrorCount = 0;
+                        errorBackoff.succeed();
                         
                         // Mise à jour du temps et de la durée
                         lastSegmentTime = currentTime;
@@ -779,13 +978,13 @@ void StreamManager::processStream(const std::string& streamId) {
                         lastProcessedSequenceNumber = hlsSegment->sequenceNumber;
                         
                         // Convertir et traiter le segment
-                        processSegment(stream, *hlsSegment, segmentInProgress, sendStartTime);
+                        processSegment(stream, *hlsSegment, segmentInProgress, sendStartTime, playoutDuration);
                         
                         // Mettre à jour l'horodatage du dernier cycle réussi
                         lastSuccessfulCycleTime = currentTime;
                         healthCheckPassed = true;
                     } else {
-                        spdlog::debug("VÉRIFICATION FORCÉE: Aucun segment disponible");
+                        SPDLOG_LOGGER_DEBUG(log_, "VÉRIFICATION FORCÉE: Aucun segment disponible");
                     }
                     
                     continue;
@@ -798,8 +997,8 @@ void StreamManager::processStream(const std::string& streamId) {
                     elapsedSinceLastSegmentSec >= waitTimeSec);
                 
                 if (shouldCheckForSegment) {
-                    spdlog::debug("Tentative de récupération d'un segment, waitTime={}s, elapsed={}s", 
-                        waitTimeSec, elapsedSinceLastSegmentSec);
+                    SPDLOG_LOGGER_TRACE(log_, "Tentative de récupération d'un segment, waitTime={}s, elapsed={}s",
+                                        waitTimeSec, elapsedSinceLastSegmentSec);
                     
                     lastCheckTime = currentTime;
                     
@@ -812,10 +1011,11 @@ void StreamManager::processStream(const std::string& streamId) {
                         retryCount = 0;
                         emptyCount = 0;
                         consecutiveErrorCount = 0;
+                        errorBackoff.succeed();
                         
-                        spdlog::info("Segment récupéré: Flux: {}, Durée: {}s, Séquence: {}, Taille: {} octets, Discontinuité: {}", 
-                            streamId, hlsSegment->duration, hlsSegment->sequenceNumber, 
-                            hlsSegment->data.size(), hlsSegment->discontinuity ? "oui" : "non");
+                        SPDLOG_LOGGER_DEBUG(log_, "Segment récupéré: Flux: {}, Durée: {}s, Séquence: {}, Taille: {} octets, Discontinuité: {}",
+                                            streamId, hlsSegment->duration, hlsSegment->sequenceNumber,
+                                            hlsSegment->data.size(), hlsSegment->discontinuity ? "oui" : "non");
                         
                         // Vérifier que ce n'est pas un segment déjà traité
                         if (hlsSegment->sequenceNumber != lastProcessedSequenceNumber || hlsSegment->discontinuity) {
@@ -825,7 +1025,7 @@ void StreamManager::processStream(const std::string& streamId) {
                             lastProcessedSequenceNumber = hlsSegment->sequenceNumber;
                             
                             // Traiter le segment
-                            bool success = processSegment(stream, *hlsSegment, segmentInProgress, sendStartTime);
+                            bool success = processSegment(stream, *hlsSegment, segmentInProgress, sendStartTime, playoutDuration);
                             
                             // Mettre à jour l'état du flux
                             if (success) {
@@ -833,7 +1033,7 @@ void StreamManager::processStream(const std::string& streamId) {
                                 healthCheckPassed = true;
                             }
                         } else {
-                            spdlog::debug("Segment {} déjà traité, ignoré", hlsSegment->sequenceNumber);
+                            SPDLOG_LOGGER_DEBUG(log_, "Segment {} déjà traité, ignoré", hlsSegment->sequenceNumber);
                         }
                     }
                     else {
@@ -848,7 +1048,7 @@ void StreamManager::processStream(const std::string& streamId) {
                         }
                         
                         if (emptyCount % 50 == 0) {
-                            spdlog::info("Aucun segment HLS disponible (x{}), attente...", emptyCount);
+                            SPDLOG_LOGGER_DEBUG(log_, "Aucun segment HLS disponible (x{}), attente...", emptyCount);
                         }
                         
                         // Vérifier si nous sommes bloqués trop longtemps
@@ -860,27 +1060,14 @@ void StreamManager::processStream(const std::string& streamId) {
                         else if (retryCount >= MAX_RETRIES_BEFORE_RESTART) {
                             spdlog::warn("Trop de tentatives sans obtenir de segment ({}), redémarrage du client HLS", retryCount);
                             
-                            try {
-                                // Récupérer l'URL avant d'arrêter le client
-                                std::string currentUrl = stream->hlsClient->getStreamInfo().url;
-                                
-                                // Arrêter et redémarrer le client
-                                stream->hlsClient->stop();
-                                std::this_thread::sleep_for(std::chrono::seconds(2));
-                                
-                                stream->hlsClient = std::make_shared<HLSClient>(currentUrl);
-                                stream->hlsClient->start();
-                                
-                                // Réinitialiser les compteurs
-                                retryCount = 0;
-                                emptyCount = 0;
-                                waitingForNewSegment = false;
-                                
-                                spdlog::info("Client HLS redémarré avec succès");
-                            } catch (const std::exception& e) {
-                                spdlog::error("Échec du redémarrage du client HLS: {}", e.what());
-                                consecutiveErrorCount++;
-                            }
+                            // Seule la récupération est relancée; en cas d'échec, recoverStages
+                            // reprend la main avec des délais croissants
+                            resetStream(streamId);
+                            
+                            // Réinitialiser les compteurs
+                            retryCount = 0;
+                            emptyCount = 0;
+                            waitingForNewSegment = false;
                         }
                         
                         // Attente adaptée
@@ -905,17 +1092,17 @@ void StreamManager::processStream(const std::string& streamId) {
                 // Incrémenter le compteur d'erreurs consécutives
                 consecutiveErrorCount++;
                 
-                // Si trop d'erreurs consécutives, tenter une réinitialisation complète
+                // Si trop d'erreurs consécutives, relancer la récupération
                 if (consecutiveErrorCount > MAX_CONSECUTIVE_ERRORS) {
-                    spdlog::error("Trop d'erreurs consécutives ({}/{}), tentative de réinitialisation du flux",
+                    spdlog::error("Trop d'erreurs consécutives ({}/{}), relance de la récupération du flux",
                                consecutiveErrorCount, MAX_CONSECUTIVE_ERRORS);
                     
                     resetStream(streamId);
                     consecutiveErrorCount = 0;
                 }
                 
-                // Attendre avant de réessayer
-                std::this_thread::sleep_for(std::chrono::seconds(2));
+                // Attendre avant de réessayer, plus longtemps à chaque erreur consécutive
+                std::this_thread::sleep_for(errorBackoff.fail());
             }
         }
         
@@ -936,22 +1123,73 @@ void StreamManager::processStream(const std::string& streamId) {
 }                
 
 
-bool StreamManager::processSegment(StreamInstance* stream, const HLSSegment& hlsSegment, 
-                                 bool& segmentInProgress, std::chrono::steady_clock::time_point& sendStartTime) {
+bool StreamManager::processSegment(StreamInstance* stream, HLSSegment& hlsSegment, 
+                                 bool& segmentInProgress, std::chrono::steady_clock::time_point& sendStartTime,
+                                 double& playoutDuration) {
+    if (!ingestSegment(stream, hlsSegment)) {
+        return false;
+    }
+    
+    // Le segment courant est encore en diffusion: le nouveau segment attend dans le tampon
+    if (segmentInProgress) {
+        return true;
+    }
+    
+    if (!playoutSegment(stream, segmentInProgress, sendStartTime, playoutDuration)) {
+        // Tampon de gigue en cours de remplissage: le segment est conservé pour la suite
+        SPDLOG_LOGGER_DEBUG(log_, "Tampon de gigue en remplissage: {} ms / {} ms",
+                            stream->segmentBuffer->getCurrentDepthMs(),
+                            stream->segmentBuffer->getTargetDepthMs());
+    }
+    
+    return true;
+}
+
+bool StreamManager::ingestSegment(StreamInstance* stream, HLSSegment& hlsSegment) {
     if (!stream || !stream->mpegtsConverter || !stream->multicastSender || !stream->segmentBuffer) {
-        spdlog::error("Composants non initialisés pour le traitement du segment");
+        log_->error("Composants non initialisés pour le traitement du segment");
         return false;
     }
     
-    // Convertir le segment en MPEG-TS
-    auto mpegtsSegment = stream->mpegtsConverter->convert(hlsSegment);
+    // Dater le segment sur l'horloge du direct; au-delà de la latence cible, il peut être
+    // sauté avant conversion pour que le convertisseur signale la rupture au segment suivant
+    if (stream->liveEdge &&
+        !stream->liveEdge->admit(hlsSegment.trace, hlsSegment.duration, hlsSegment.discontinuity,
+                                 hlsSegment.skippedBefore)) {
+        SPDLOG_LOGGER_DEBUG(log_, "Segment {} sauté pour rattraper le direct (latence: {} ms)",
+                            hlsSegment.sequenceNumber, stream->liveEdge->getLatencyMs());
+        if (stream->bufferPool) {
+            stream->bufferPool->release(std::move(hlsSegment.data));
+        }
+        return true;
+    }
+    
+    // Convertir le segment en MPEG-TS (en passthrough, ses données sont reprises sans copie)
+    auto convertStart = std::chrono::steady_clock::now();
+    hlsSegment.trace.convertStartUs = hls_to_dvb::SegmentTrace::nowUs();
+    auto mpegtsSegment = stream->mpegtsConverter->convert(std::move(hlsSegment));
+    if (stream->metrics) {
+        stream->metrics->convertSeconds->observe(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - convertStart).count());
+        (mpegtsSegment ? stream->metrics->convertSegments : stream->metrics->convertErrors)->increment();
+    }
+    if (mpegtsSegment) {
+        mpegtsSegment->trace.convertEndUs = hls_to_dvb::SegmentTrace::nowUs();
+    }
+    
+    // Les données HLS ne servent plus: rendre leur tampon à la réserve du flux
+    if (stream->bufferPool) {
+        stream->bufferPool->release(std::move(hlsSegment.data));
+        stream->bufferPool->markSegment();
+    }
+    
     if (!mpegtsSegment) {
-        spdlog::error("Échec de conversion du segment HLS en MPEG-TS, séquence: {}", hlsSegment.sequenceNumber);
+        log_->error("Échec de conversion du segment HLS en MPEG-TS, séquence: {}", hlsSegment.sequenceNumber);
         return false;
     }
     
-    spdlog::info("Segment {} converti en MPEG-TS, taille: {} octets", 
-               mpegtsSegment->sequenceNumber, mpegtsSegment->data.size());
+    SPDLOG_LOGGER_DEBUG(log_, "Segment {} converti en MPEG-TS, taille: {} octets",
+                        mpegtsSegment->sequenceNumber, mpegtsSegment->data.size());
     
     // Analyser la qualité du segment
     if (stream->qualityMonitor) {
@@ -959,31 +1197,44 @@ bool StreamManager::processSegment(StreamInstance* stream, const HLSSegment& hls
         
         // Log seulement en cas de problème
         if (stats.pcrDiscontinuities > 0 || stats.continuityErrors > 0 || stats.pcrJitter > 0.5) {
-            spdlog::warn("Problèmes détectés dans le segment {}: PCR discontinuités={}, CC erreurs={}, PCR jitter={}ms",
+            log_->warn("Problèmes détectés dans le segment {}: PCR discontinuités={}, CC erreurs={}, PCR jitter={}ms",
                       mpegtsSegment->sequenceNumber, stats.pcrDiscontinuities, stats.continuityErrors, stats.pcrJitter);
         }
     }
     
-    // Ajouter le segment au buffer
-    stream->segmentBuffer->pushSegment(*mpegtsSegment);
-    spdlog::debug("Segment {} ajouté au buffer, taille du buffer: {}/{}", 
-                mpegtsSegment->sequenceNumber, 
-                stream->segmentBuffer->getCurrentSize(),
-                stream->segmentBuffer->getBufferSize());
+    // Ajouter le segment au tampon de gigue
+    mpegtsSegment->trace.bufferEnqueueUs = hls_to_dvb::SegmentTrace::nowUs();
+    stream->segmentBuffer->pushSegment(std::move(*mpegtsSegment));
+    SPDLOG_LOGGER_DEBUG(log_, "Segment {} ajouté au buffer, profondeur: {} ms (cible: {} ms, {} segments)",
+                        mpegtsSegment->sequenceNumber,
+                        stream->segmentBuffer->getCurrentDepthMs(),
+                        stream->segmentBuffer->getTargetDepthMs(),
+                        stream->segmentBuffer->getCurrentSize());
     
-    // Récupérer un segment du buffer pour l'envoi
+    return true;
+}
+
+bool StreamManager::playoutSegment(StreamInstance* stream, bool& segmentInProgress,
+                                   std::chrono::steady_clock::time_point& sendStartTime, double& playoutDuration) {
+    if (!stream || !stream->multicastSender || !stream->segmentBuffer) {
+        log_->error("Composants non initialisés pour la diffusion du segment");
+        return false;
+    }
+    
+    // Récupérer un segment du tampon de gigue pour l'envoi
     MPEGTSSegment segmentToSend;
-    if (!stream->segmentBuffer->getSegment(segmentToSend)) {
-        spdlog::warn("Impossible de récupérer un segment du buffer pour l'envoi");
+    if (!stream->segmentBuffer->popForPlayout(segmentToSend)) {
         return false;
     }
+    segmentToSend.trace.bufferDequeueUs = hls_to_dvb::SegmentTrace::nowUs();
+    double playoutRate = stream->liveEdge ? stream->liveEdge->onPlayout(segmentToSend.trace) : 1.0;
     
-    spdlog::info("Segment {} récupéré du buffer, taille: {} octets, prêt pour envoi multicast",
-               segmentToSend.sequenceNumber, segmentToSend.data.size());
+    SPDLOG_LOGGER_DEBUG(log_, "Segment {} récupéré du buffer, taille: {} octets, prêt pour envoi multicast",
+                        segmentToSend.sequenceNumber, segmentToSend.data.size());
     
     // Vérifier les données
     if (segmentToSend.data.empty()) {
-        spdlog::error("Segment {} vide, ignoré pour l'envoi multicast", segmentToSend.sequenceNumber);
+        log_->error("Segment {} vide, ignoré pour l'envoi multicast", segmentToSend.sequenceNumber);
         return false;
     }
     
@@ -996,34 +1247,54 @@ bool StreamManager::processSegment(StreamInstance* stream, const HLSSegment& hls
         }
     }
     
-    // Envoyer le segment en multicast
-    spdlog::info("Tentative d'envoi du segment {} en multicast ({} octets, discontinuité: {})",
-               segmentToSend.sequenceNumber, segmentToSend.data.size(), 
-               segmentToSend.discontinuity ? "oui" : "non");
+    // Sorties abonnées à ce pipeline: le segment leur est transmis sans copie
+    std::vector<std::shared_ptr<MulticastSender>> fanOutSenders;
+    if (stream->fanOut) {
+        std::lock_guard<std::mutex> lock(stream->fanOut->mutex);
+        for (const auto& [outputId, sender] : stream->fanOut->outputs) {
+            fanOutSenders.push_back(sender);
+        }
+    }
     
-    bool sendResult = stream->multicastSender->send(segmentToSend.data, segmentToSend.discontinuity);
+    // Envoyer le segment en multicast
+    bool sendResult = false;
+    if (fanOutSenders.empty()) {
+        sendResult = stream->multicastSender->send(std::move(segmentToSend.data), segmentToSend.discontinuity,
+                                                   segmentToSend.trace, std::move(segmentToSend.outputState));
+    } else {
+        // Le tampon partagé est imputé une seule fois au budget, réparti entre les émetteurs
+        auto sharedData = BufferPool::share(stream->bufferPool, std::move(segmentToSend.data));
+        size_t sharers = 1 + fanOutSenders.size();
+        sendResult = stream->multicastSender->send(sharedData, segmentToSend.discontinuity, segmentToSend.trace,
+                                                   sharers, std::move(segmentToSend.outputState));
+        for (const auto& sender : fanOutSenders) {
+            if (!sender->isRunning() && !sender->start()) {
+                continue;
+            }
+            if (!sender->send(sharedData, segmentToSend.discontinuity, segmentToSend.trace, sharers)) {
+                log_->error("Échec d'envoi du segment {} vers {}:{}", segmentToSend.sequenceNumber,
+                            sender->getGroupAddress(), sender->getPort());
+            }
+        }
+    }
     
     if (!sendResult) {
-        spdlog::error("Échec d'envoi du segment {} multicast", segmentToSend.sequenceNumber);
+        log_->error("Échec d'envoi du segment {} multicast", segmentToSend.sequenceNumber);
         return false;
     }
     
-    spdlog::info("Segment {} envoyé avec succès en multicast", segmentToSend.sequenceNumber);
+    SPDLOG_LOGGER_DEBUG(log_, "Segment {} envoyé en multicast (durée: {:.2f}s, discontinuité: {})",
+                        segmentToSend.sequenceNumber, segmentToSend.duration,
+                        segmentToSend.discontinuity ? "oui" : "non");
     sendStartTime = std::chrono::steady_clock::now();
+    playoutDuration = (segmentToSend.duration > 0.0 ? segmentToSend.duration : 4.0) / playoutRate;
     segmentInProgress = true;
     
     return true;
 }
 
 bool StreamManager::resetStream(const std::string& streamId) {
-    spdlog::info("Réinitialisation complète du flux {}", streamId);
-    
-    // Récupérer la configuration du flux
-    const StreamConfig* config = config_->getStreamConfig(streamId);
-    if (!config) {
-        spdlog::error("Configuration du flux non trouvée pour la réinitialisation: {}", streamId);
-        return false;
-    }
+    spdlog::info("Relance de la récupération HLS du flux {}", streamId);
     
     // Accéder au flux existant
     StreamInstance* stream = nullptr;
@@ -1037,107 +1308,264 @@ bool StreamManager::resetStream(const std::string& streamId) {
         stream = &it->second;
     }
     
-    // Arrêter les composants existants
+    if (!stream->hlsClient) {
+        return false;
+    }
+    
+    // Relancer le client sur place, sur la variante déjà retenue et sans nouveau sondage:
+    // le convertisseur, le socket multicast et le tampon de gigue sont conservés et la
+    // diffusion continue
+    auto restartStart = std::chrono::steady_clock::now();
     try {
-        spdlog::info("Arrêt des composants existants pour le flux {}", streamId);
+        stream->hlsClient->restart();
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Échec de la relance de la récupération du flux {}: {}", streamId, e.what());
         
-        if (stream->hlsClient) {
-            stream->hlsClient->stop();
+        // recoverStages reprend la relance avec des délais croissants
+        return false;
+    }
+    
+    // La relance peut échouer sans exception (entrée injoignable, format refusé)
+    if (!stream->hlsClient->isRunning()) {
+        spdlog::error("Échec de la relance de la récupération du flux {}: client HLS arrêté", streamId);
+        return false;
+    }
+    
+    double restartSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - restartStart).count();
+    if (stream->metrics) {
+        stream->metrics->fetchRecoverySeconds->observe(restartSeconds);
+    }
+    spdlog::info("Récupération HLS du flux {} relancée en {:.0f} ms", streamId, restartSeconds * 1000.0);
+    
+    return true;
+}
+
+bool StreamManager::recoverStages(StreamInstance* stream) {
+    const auto& metrics = stream->metrics;
+    
+    bool fetchRunning = recoverStage(stream->id, "récupération HLS", stream->fetchRecovery,
+        stream->hlsClient->isRunning(),
+        [stream] { return stream->hlsClient->restart(); },
+        metrics ? metrics->fetchRecoverySeconds : nullptr);
+    
+    bool convertRunning = recoverStage(stream->id, "conversion", stream->convertRecovery,
+        stream->mpegtsConverter->isRunning(),
+        [stream] { stream->mpegtsConverter->start(); return stream->mpegtsConverter->isRunning(); },
+        metrics ? metrics->convertRecoverySeconds : nullptr);
+    
+    bool sendRunning = recoverStage(stream->id, "émission multicast", stream->sendRecovery,
+        stream->multicastSender->isRunning(),
+        [stream] { return stream->multicastSender->start(); },
+        metrics ? metrics->sendRecoverySeconds : nullptr);
+    
+    return fetchRunning && convertRunning && sendRunning;
+}
+
+bool StreamManager::recoverStage(const std::string& streamId, const char* stage, RecoveryBackoff& backoff, bool running,
+                                 const std::function<bool()>& restart, const std::shared_ptr<Histogram>& recoverySeconds) {
+    if (running) {
+        if (backoff.isRecovering()) {
+            double seconds = backoff.succeed();
+            if (recoverySeconds) {
+                recoverySeconds->observe(seconds);
+            }
+            spdlog::info("Étape {} du flux {} rétablie en {:.0f} ms", stage, streamId, seconds * 1000.0);
         }
+        return true;
+    }
+    
+    // Première détection: relance après le délai initial
+    if (!backoff.isRecovering()) {
+        auto delay = backoff.fail();
+        spdlog::warn("Étape {} du flux {} arrêtée, relance dans {} ms", stage, streamId, delay.count());
+        return false;
+    }
+    
+    if (!backoff.isDue()) {
+        return false;
+    }
+    
+    bool restarted = false;
+    try {
+        restarted = restart();
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Exception lors de la relance de l'étape {} du flux {}: {}", stage, streamId, e.what());
+    }
+    
+    if (restarted) {
+        return recoverStage(streamId, stage, backoff, true, restart, recoverySeconds);
+    }
+    
+    auto delay = backoff.fail();
+    spdlog::warn("Échec de la relance de l'étape {} du flux {} (tentative {}), nouvel essai dans {} ms",
+                 stage, streamId, backoff.getAttempts(), delay.count());
+    return false;
+}
+
+std::string StreamManager::ingestKey(const StreamConfig& config) {
+    // Tout ce qui modifie les segments produits ou leur rythme de diffusion
+    std::string key = config.hlsInput + "|" + (config.passthrough ? "passthrough" : "full") + "|" +
+                      std::to_string(config.bufferSize) + "|" + std::to_string(config.bufferMinMs) + "|" +
+                      std::to_string(config.bufferMaxMs) + "|" + std::to_string(config.latencyTargetMs) + "|" +
+                      config.catchUpPolicy;
+    
+    // Origines équivalentes, dans un ordre indépendant de la configuration
+    std::vector<std::string> inputs = config.hlsInputs;
+    std::sort(inputs.begin(), inputs.end());
+    for (const auto& input : inputs) {
+        key += "|" + input;
+    }
+    return key;
+}
+
+std::optional<bool> StreamManager::attachToSharedIngest(const std::string& streamId, const StreamConfig& config) {
+    const std::string key = ingestKey(config);
+    
+    // Rechercher un pipeline en cours pour la même entrée
+    std::string sourceId;
+    {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
         
-        if (stream->mpegtsConverter) {
-            stream->mpegtsConverter->stop();
+        auto it = streams_.find(streamId);
+        if (it != streams_.end() && it->second.isRunning()) {
+            spdlog::warn("Le flux {} est déjà en cours d'exécution", streamId);
+            return true;
         }
         
-        if (stream->multicastSender) {
-            stream->multicastSender->stop();
+        for (const auto& [id, candidate] : streams_) {
+            if (id != streamId && candidate.isRunning() && candidate.ingestSourceId.empty() &&
+                candidate.fanOut && ingestKey(candidate.config) == key) {
+                sourceId = id;
+                break;
+            }
         }
+    }
+    if (sourceId.empty()) {
+        return std::nullopt;
+    }
+    
+    spdlog::info("Flux {}: entrée déjà récupérée par le flux {}, seul l'émetteur multicast est créé",
+                 streamId, sourceId);
+    
+    StreamInstance output;
+    output.id = streamId;
+    output.config = config;
+    output.ingestSourceId = sourceId;
+    output.bufferAccount = BufferAccountant::getInstance().registerStream(streamId);
+    output.bufferPool = std::make_shared<BufferPool>();
+    output.metrics = StreamMetrics::create(streamId);
+    output.metrics->startRequestedUs.store(SegmentTrace::nowUs(), std::memory_order_relaxed);
+    output.multicastSender = std::make_shared<MulticastSender>(
+        config.mcastOutput, config.mcastPort, config.mcastInterface, 4);
+    output.multicastSender->setDiagnostics(config_->getStartupConfig().diagnostics);
+    attachStreamResources(output);
+    
+    if (!output.multicastSender->initialize() || !output.multicastSender->start()) {
+        spdlog::error("Échec du démarrage du sender multicast pour le flux {}", streamId);
+        BufferAccountant::getInstance().unregisterStream(streamId);
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
         
-        // Attendre un peu pour s'assurer que tout est arrêté
-        std::this_thread::sleep_for(std::chrono::seconds(2));
-        
-        // Récréer et redémarrer les composants
-        spdlog::info("Recréation et redémarrage des composants pour le flux {}", streamId);
-        
-        // Conserver le buffer existant si possible
-        if (!stream->segmentBuffer) {
-            stream->segmentBuffer = std::make_shared<SegmentBuffer>(config->bufferSize);
-        } else {
-            stream->segmentBuffer->clear();
+        // Le pipeline a pu s'arrêter entre-temps: démarrer alors un pipeline propre
+        auto source = streams_.find(sourceId);
+        if (source == streams_.end() || !source->second.isRunning()) {
+            output.multicastSender->stop();
+            BufferAccountant::getInstance().unregisterStream(streamId);
+            return std::nullopt;
         }
         
-        // Créer un nouveau client HLS
-        stream->hlsClient = std::make_shared<HLSClient>(config->hlsInput);
-        stream->hlsClient->start();
-        
-        // Vérifier si c'est un flux live valide
-        if (!stream->hlsClient->isLiveStream() || !stream->hlsClient->isValidStream()) {
-            spdlog::error("Le flux HLS n'est pas valide après réinitialisation");
-            
-            AlertManager::getInstance().addAlert(
-                AlertLevel::ERROR,
-                "StreamManager",
-                "Échec de la réinitialisation du flux " + streamId + " : flux HLS non valide",
-                true
-            );
-            
-            return false;
+        auto it = streams_.find(streamId);
+        if (it != streams_.end()) {
+            streams_.erase(it);
         }
         
-        // Recréer le convertisseur
-        stream->mpegtsConverter = std::make_shared<MPEGTSConverter>();
-        stream->mpegtsConverter->start();
+        std::shared_ptr<FanOutGroup> group = source->second.fanOut;
+        std::shared_ptr<MulticastSender> sender = output.multicastSender;
+        output.setRunning(true);
+        streams_.emplace(streamId, std::move(output));
         
-        // Réinitialiser le MulticastSender
-        stream->multicastSender = std::make_shared<MulticastSender>(
-            config->mcastOutput, 
-            config->mcastPort,
-            config->mcastInterface,
-            4
-        );
-        
-        if (!stream->multicastSender->initialize() || !stream->multicastSender->start()) {
-            spdlog::error("Échec de l'initialisation du MulticastSender après réinitialisation");
-            
-            AlertManager::getInstance().addAlert(
-                AlertLevel::ERROR,
-                "StreamManager",
-                "Échec de la réinitialisation du flux " + streamId + " : problème avec le MulticastSender",
-                true
-            );
-            
-            return false;
-        }
+        std::lock_guard<std::mutex> groupLock(group->mutex);
+        group->outputs[streamId] = sender;
+    }
+    
+    AlertManager::getInstance().addAlert(
+        AlertLevel::INFO,
+        "StreamManager",
+        "Flux " + streamId + " (" + config.name + ") démarré, alimenté par la récupération du flux " + sourceId,
+        false
+    );
+    
+    spdlog::info("Flux {} démarré (récupération partagée avec {})", streamId, sourceId);
+    return true;
+}
+
+void StreamManager::attachStreamResources(StreamInstance& stream) {
+    // Nouvelle référence d'horloge du direct à chaque (re)démarrage du flux
+    stream.liveEdge = std::make_shared<LiveEdgeController>(
+        stream.config.latencyTargetMs, LiveEdgeController::parsePolicy(stream.config.catchUpPolicy));
+    stream.liveEdge->setMetrics(stream.metrics);
+    
+    if (stream.hlsClient) {
+        stream.hlsClient->setBufferAccount(stream.bufferAccount);
+        stream.hlsClient->setBufferPool(stream.bufferPool);
+        stream.hlsClient->setMetrics(stream.metrics);
+        stream.hlsClient->setLiveEdge(stream.liveEdge);
+    }
+    
+    if (stream.mpegtsConverter) {
+        stream.mpegtsConverter->setBufferPool(stream.bufferPool);
+        stream.mpegtsConverter->setStateFile(stream.stateFile);
+    }
+    
+    if (stream.segmentBuffer) {
+        stream.segmentBuffer->setBufferAccount(stream.bufferAccount);
+        stream.segmentBuffer->setMetrics(stream.metrics);
+    }
+    
+    if (stream.multicastSender) {
+        stream.multicastSender->setBufferAccount(stream.bufferAccount);
+        stream.multicastSender->setBufferPool(stream.bufferPool);
+        stream.multicastSender->setMetrics(stream.metrics);
+        stream.multicastSender->setStateFile(stream.stateFile, config_->getCheckpointConfig().intervalMs);
         
-        // Réinitialiser le moniteur de qualité
-        if (!stream->qualityMonitor) {
-            stream->qualityMonitor = std::make_shared<TSQualityMonitor>();
-        } else {
-            stream->qualityMonitor->reset();
+        // Anneau d'émission partagé par tous les flux de l'interface, si demandé
+        const TransmitConfig& transmitConfig = config_->getTransmitConfig();
+        if (transmitConfig.backend == "packet_ring") {
+            const std::string& interface = stream.config.mcastInterface;
+            std::shared_ptr<PacketTxRing> ring;
+            if (!interface.empty() && std::isalpha(static_cast<unsigned char>(interface[0]))) {
+                ring = PacketTxRing::acquire(interface, transmitConfig.ringFrames);
+            }
+            if (ring) {
+                stream.multicastSender->setPacketRing(ring);
+            } else {
+                spdlog::warn("Flux {}: anneau d'émission indisponible (interface '{}'), émission par socket UDP",
+                             stream.id, interface);
+            }
+        } else if (transmitConfig.backend == "io_uring") {
+            stream.multicastSender->setUring(static_cast<unsigned>(std::max(transmitConfig.uringEntries, 1)));
         }
         
-        spdlog::info("Flux {} réinitialisé avec succès", streamId);
-        
-        AlertManager::getInstance().addAlert(
-            AlertLevel::INFO,
-            "StreamManager",
-            "Flux " + streamId + " réinitialisé avec succès après détection de problèmes",
-            false
-        );
-        
-        return true;
-    }
-    catch (const std::exception& e) {
-        spdlog::error("Exception lors de la réinitialisation du flux {}: {}", streamId, e.what());
+        stream.multicastSender->setRtp(stream.config.mcastProtocol == "rtp",
+                                       stream.config.fecColumns, stream.config.fecRows);
         
-        AlertManager::getInstance().addAlert(
-            AlertLevel::ERROR,
-            "StreamManager",
-            "Exception lors de la réinitialisation du flux " + streamId + ": " + e.what(),
-            true
-        );
+        // Second chemin SMPTE 2022-7: mêmes datagrammes, même itération de la boucle d'envoi
+        const OutputConfig& redundant = stream.config.redundantOutput;
+        if (!redundant.address.empty() && !stream.multicastSender->setRedundantOutput(redundant)) {
+            spdlog::error("Flux {}: second chemin {}:{} non ouvert", stream.id, redundant.address, redundant.port);
+        }
         
-        return false;
+        // Destinations supplémentaires: même boucle d'envoi, même tampon de segment
+        for (const auto& output : stream.config.outputs) {
+            if (!stream.multicastSender->addOutput(output)) {
+                spdlog::error("Flux {}: sortie {}:{} non ouverte", stream.id, output.address, output.port);
+            }
+        }
     }
 }
 
@@ -0,0 +1,234 @@
+#include "core/StreamStateFile.h"
+
+#include <spdlog/spdlog.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace hls_to_dvb {
+
+namespace {
+
+constexpr uint32_t STATE_MAGIC = 0x48325453;   // "H2TS"
+constexpr uint32_t STATE_FORMAT = 1;
+constexpr size_t MAX_PIDS = 256;
+constexpr size_t MAX_SERVICES = 64;
+
+/**
+ * @brief Compteur de continuité d'un PID
+ */
+struct PidCounter {
+    uint16_t pid;
+    uint8_t cc;
+    uint8_t reserved;
+};
+
+/**
+ * @brief Version de la PMT d'un service
+ */
+struct ServiceVersion {
+    uint16_t serviceId;
+    uint8_t version;
+    uint8_t reserved;
+};
+
+/**
+ * @brief Emplacement de sauvegarde (taille fixe)
+ */
+struct Slot {
+    uint64_t sequence;              ///< 0 = emplacement jamais écrit
+    int64_t savedAtUs;
+    uint64_t lastPcr;
+    uint16_t pcrPid;
+    uint16_t pidCount;
+    uint16_t serviceCount;
+    uint8_t versions[4];            ///< PAT, SDT, EIT, NIT
+    uint8_t reserved[6];
+    PidCounter counters[MAX_PIDS];
+    ServiceVersion services[MAX_SERVICES];
+    uint32_t checksum;              ///< FNV-1a de tout ce qui précède
+    uint32_t reserved2;
+};
+
+uint32_t slotChecksum(const Slot& slot) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&slot);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(Slot, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool slotValid(const Slot& slot) {
+    return slot.sequence != 0 && slot.pidCount <= MAX_PIDS && slot.serviceCount <= MAX_SERVICES &&
+           slot.checksum == slotChecksum(slot);
+}
+
+std::string fileNameFor(const std::string& streamId) {
+    std::string name = streamId;
+    for (char& c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') {
+            c = '_';
+        }
+    }
+    return name + ".state";
+}
+
+} // namespace
+
+/**
+ * @brief Contenu du fichier d'état
+ */
+struct StreamStateFile::Layout {
+    uint32_t magic;
+    uint32_t format;
+    Slot slots[2];
+};
+
+static_assert(std::is_trivially_copyable_v<Slot>, "L'emplacement doit pouvoir être copié octet par octet");
+
+StreamStateFile::StreamStateFile(const std::string& path, int fd, Layout* layout)
+    : path_(path), fd_(fd), layout_(layout) {
+    for (const Slot& slot : layout_->slots) {
+        if (slotValid(slot) && slot.sequence > sequence_) {
+            sequence_ = slot.sequence;
+        }
+    }
+}
+
+StreamStateFile::~StreamStateFile() {
+#ifndef _WIN32
+    msync(layout_, sizeof(Layout), MS_ASYNC);
+    munmap(layout_, sizeof(Layout));
+    ::close(fd_);
+#endif
+}
+
+std::shared_ptr<StreamStateFile> StreamStateFile::open(const std::string& directory, const std::string& streamId) {
+#ifdef _WIN32
+    spdlog::warn("Points de reprise non pris en charge sur cette plateforme, flux {}", streamId);
+    return nullptr;
+#else
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        spdlog::error("Impossible de créer le dossier d'état {}: {}", directory, error.message());
+        return nullptr;
+    }
+
+    std::string path = (std::filesystem::path(directory) / fileNameFor(streamId)).string();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        spdlog::error("Impossible d'ouvrir le fichier d'état {}: {}", path, strerror(errno));
+        return nullptr;
+    }
+
+    // Un fichier d'une autre taille provient d'un autre format: il est réinitialisé
+    struct stat info;
+    bool reset = fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != sizeof(Layout);
+    if (reset && ftruncate(fd, sizeof(Layout)) != 0) {
+        spdlog::error("Impossible de dimensionner le fichier d'état {}: {}", path, strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Impossible de projeter le fichier d'état {}: {}", path, strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+
+    auto* layout = static_cast<Layout*>(mapping);
+    if (reset || layout->magic != STATE_MAGIC || layout->format != STATE_FORMAT) {
+        std::memset(layout, 0, sizeof(Layout));
+        layout->magic = STATE_MAGIC;
+        layout->format = STATE_FORMAT;
+    }
+
+    return std::shared_ptr<StreamStateFile>(new StreamStateFile(path, fd, layout));
+#endif
+}
+
+bool StreamStateFile::load(StreamOutputState& state) const {
+    const Slot* latest = nullptr;
+    for (const Slot& slot : layout_->slots) {
+        if (slotValid(slot) && (!latest || slot.sequence > latest->sequence)) {
+            latest = &slot;
+        }
+    }
+    if (!latest) {
+        return false;
+    }
+
+    state = StreamOutputState();
+    state.savedAtUs = latest->savedAtUs;
+    state.lastPcr = latest->lastPcr;
+    state.pcrPid = latest->pcrPid;
+    state.versionPAT = latest->versions[0];
+    state.versionSDT = latest->versions[1];
+    state.versionEIT = latest->versions[2];
+    state.versionNIT = latest->versions[3];
+    for (size_t i = 0; i < latest->pidCount; ++i) {
+        state.continuityCounters[latest->counters[i].pid] = latest->counters[i].cc & 0x0F;
+    }
+    for (size_t i = 0; i < latest->serviceCount; ++i) {
+        state.versionPMT[latest->services[i].serviceId] = latest->services[i].version;
+    }
+    return true;
+}
+
+void StreamStateFile::save(const StreamOutputState& state) {
+    // Écrire dans l'emplacement qui ne contient pas la dernière sauvegarde
+    uint64_t sequence = sequence_ + 1;
+    Slot& slot = layout_->slots[sequence % 2];
+
+    slot.sequence = 0;  // Invalide l'emplacement pendant l'écriture
+    slot.savedAtUs = state.savedAtUs;
+    slot.lastPcr = state.lastPcr;
+    slot.pcrPid = state.pcrPid;
+    slot.versions[0] = state.versionPAT;
+    slot.versions[1] = state.versionSDT;
+    slot.versions[2] = state.versionEIT;
+    slot.versions[3] = state.versionNIT;
+
+    size_t count = 0;
+    for (const auto& [pid, cc] : state.continuityCounters) {
+        if (count == MAX_PIDS) {
+            break;
+        }
+        slot.counters[count++] = PidCounter{pid, cc, 0};
+    }
+    slot.pidCount = static_cast<uint16_t>(count);
+
+    count = 0;
+    for (const auto& [serviceId, version] : state.versionPMT) {
+        if (count == MAX_SERVICES) {
+            break;
+        }
+        slot.services[count++] = ServiceVersion{serviceId, version, 0};
+    }
+    slot.serviceCount = static_cast<uint16_t>(count);
+
+    slot.sequence = sequence;
+    slot.checksum = slotChecksum(slot);
+    sequence_ = sequence;
+}
+
+const std::string& StreamStateFile::getPath() const {
+    return path_;
+}
+
+} // namespace hls_to_dvb
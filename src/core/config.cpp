@@ -6,6 +6,26 @@
 
 namespace hls_to_dvb {
 
+void to_json(nlohmann::json& json, const OutputConfig& output) {
+    json = {
+        {"address", output.address},
+        {"port", output.port},
+        {"interface", output.interface},
+        {"protocol", output.protocol},
+        {"fecColumns", output.fecColumns},
+        {"fecRows", output.fecRows}
+    };
+}
+
+void from_json(const nlohmann::json& json, OutputConfig& output) {
+    output.address = json.value("address", output.address);
+    output.port = json.value("port", output.port);
+    output.interface = json.value("interface", output.interface);
+    output.protocol = json.value("protocol", output.protocol);
+    output.fecColumns = json.value("fecColumns", output.fecColumns);
+    output.fecRows = json.value("fecRows", output.fecRows);
+}
+
 Config::Config(const std::string& configPath)
     : configPath_(configPath) {
     // Initialiser avec des valeurs par défaut
@@ -44,6 +64,42 @@ void Config::logConfiguration() const {
     spdlog::info("    - Warning: {} secondes", alerts_.retention.warning);
     spdlog::info("    - Error: {} secondes", alerts_.retention.error);
     
+    // Configuration du budget mémoire
+    spdlog::info("Mémoire:");
+    spdlog::info("  - Budget des tampons: {} octets", memory_.budgetBytes);
+    spdlog::info("  - Seuils: suspension à {}%, reprise à {}%",
+                 memory_.highWatermarkPercent, memory_.lowWatermarkPercent);
+    
+    // Configuration du démarrage des flux
+    spdlog::info("Démarrage:");
+    spdlog::info("  - Diagnostics: {}", startup_.diagnostics ? "Oui" : "Non");
+    spdlog::info("  - Flux démarrés simultanément: {}", startup_.parallelStarts);
+    
+    // Configuration des points de reprise
+    spdlog::info("Points de reprise:");
+    spdlog::info("  - Activés: {}", checkpoint_.enabled ? "Oui" : "Non");
+    spdlog::info("  - Dossier: {}", checkpoint_.directory);
+    spdlog::info("  - Intervalle: {} ms", checkpoint_.intervalMs);
+    
+    // Configuration de la reprise des étapes
+    spdlog::info("Reprise des étapes:");
+    spdlog::info("  - Délais: {} à {} ms (gigue {:.0f}%)",
+                 recovery_.initialDelayMs, recovery_.maxDelayMs, recovery_.jitter * 100.0);
+    
+    // Configuration de l'émission multicast
+    spdlog::info("Émission multicast:");
+    spdlog::info("  - Backend: {}", transmit_.backend);
+    spdlog::info("  - Trames par anneau: {}", transmit_.ringFrames);
+    spdlog::info("  - Datagrammes par lot io_uring: {}", transmit_.uringEntries);
+    
+    // Configuration de la récupération HLS
+    spdlog::info("Récupération HLS:");
+    spdlog::info("  - Moteur: {}", fetch_.engine);
+    spdlog::info("  - Boucles d'E/S: {}", fetch_.ioThreads);
+    spdlog::info("  - Requêtes simultanées par origine: {}", fetch_.maxRequestsPerOrigin);
+    spdlog::info("  - Connexions persistantes par origine: {}", fetch_.idleConnectionsPerOrigin);
+    spdlog::info("  - Doublement des segments après: {} ms", fetch_.hedgeAfterMs);
+    
     // Configuration des flux
     spdlog::info("Flux configurés: {}", streams_.size());
     for (size_t i = 0; i < streams_.size(); ++i) {
@@ -51,10 +107,30 @@ void Config::logConfiguration() const {
         spdlog::info("  Flux #{} - {}:", i+1, stream.id);
         spdlog::info("    - Nom: {}", stream.name);
         spdlog::info("    - HLS Input: {}", stream.hlsInput);
+        for (const auto& input : stream.hlsInputs) {
+            if (input != stream.hlsInput) {
+                spdlog::info("    - HLS Input (origine équivalente): {}", input);
+            }
+        }
         spdlog::info("    - Multicast Output: {}", stream.mcastOutput);
         spdlog::info("    - Multicast Port: {}", stream.mcastPort);
         spdlog::info("    - Multicast Interface: {}", stream.mcastInterface);
+        spdlog::info("    - Multicast Protocol: {}", stream.mcastProtocol);
+        if (stream.fecColumns > 0 || stream.fecRows > 0) {
+            spdlog::info("    - FEC: {}x{}", stream.fecColumns, stream.fecRows);
+        }
         spdlog::info("    - Buffer Size: {}", stream.bufferSize);
+        spdlog::info("    - Buffer Depth: {}-{} ms", stream.bufferMinMs, stream.bufferMaxMs);
+        spdlog::info("    - Passthrough: {}", stream.passthrough ? "Oui" : "Non");
+        spdlog::info("    - Latency Target: {} ms ({})", stream.latencyTargetMs, stream.catchUpPolicy);
+        if (!stream.redundantOutput.address.empty()) {
+            spdlog::info("    - Redundant Output (2022-7): {}:{}", stream.redundantOutput.address,
+                         stream.redundantOutput.port);
+        }
+        for (const auto& output : stream.outputs) {
+            spdlog::info("    - Output: {}:{} ({}{})", output.address, output.port, output.protocol,
+                         output.interface.empty() ? "" : ", " + output.interface);
+        }
         spdlog::info("    - Enabled: {}", stream.enabled ? "Oui" : "Non");
     }
     
@@ -111,6 +187,21 @@ bool Config::loadFromFile(const std::string& configPath) {
                     logging_.file.maxFiles = fileJson["maxFiles"].get<int>();
                 }
             }
+            if (loggingJson.contains("asyncQueueSize")) {
+                logging_.asyncQueueSize = loggingJson["asyncQueueSize"].get<size_t>();
+            }
+            if (loggingJson.contains("overflowPolicy")) {
+                logging_.overflowPolicy = loggingJson["overflowPolicy"].get<std::string>();
+            }
+            if (loggingJson.contains("flushIntervalSec")) {
+                logging_.flushIntervalSec = loggingJson["flushIntervalSec"].get<int>();
+            }
+            if (loggingJson.contains("components") && loggingJson["components"].is_object()) {
+                logging_.components.clear();
+                for (const auto& [component, level] : loggingJson["components"].items()) {
+                    logging_.components[component] = level.get<std::string>();
+                }
+            }
         }
         spdlog::info("Logging config loaded");
 
@@ -134,6 +225,99 @@ bool Config::loadFromFile(const std::string& configPath) {
         }
 
         spdlog::info("Alerts config loaded");
+
+        // Charger la configuration du budget mémoire
+        if (json.contains("memory")) {
+            const auto& memoryJson = json["memory"];
+            if (memoryJson.contains("budgetBytes")) {
+                memory_.budgetBytes = memoryJson["budgetBytes"].get<size_t>();
+            }
+            if (memoryJson.contains("highWatermarkPercent")) {
+                memory_.highWatermarkPercent = memoryJson["highWatermarkPercent"].get<int>();
+            }
+            if (memoryJson.contains("lowWatermarkPercent")) {
+                memory_.lowWatermarkPercent = memoryJson["lowWatermarkPercent"].get<int>();
+            }
+        }
+        spdlog::info("Memory config loaded");
+
+        // Charger la configuration du démarrage des flux
+        if (json.contains("startup")) {
+            const auto& startupJson = json["startup"];
+            if (startupJson.contains("diagnostics")) {
+                startup_.diagnostics = startupJson["diagnostics"].get<bool>();
+            }
+            if (startupJson.contains("parallelStarts")) {
+                startup_.parallelStarts = startupJson["parallelStarts"].get<int>();
+            }
+        }
+        spdlog::info("Startup config loaded");
+
+        // Charger la configuration des points de reprise
+        if (json.contains("checkpoint")) {
+            const auto& checkpointJson = json["checkpoint"];
+            if (checkpointJson.contains("enabled")) {
+                checkpoint_.enabled = checkpointJson["enabled"].get<bool>();
+            }
+            if (checkpointJson.contains("directory")) {
+                checkpoint_.directory = checkpointJson["directory"].get<std::string>();
+            }
+            if (checkpointJson.contains("intervalMs")) {
+                checkpoint_.intervalMs = checkpointJson["intervalMs"].get<int>();
+            }
+        }
+        spdlog::info("Checkpoint config loaded");
+
+        // Charger la configuration de la reprise des étapes
+        if (json.contains("recovery")) {
+            const auto& recoveryJson = json["recovery"];
+            if (recoveryJson.contains("initialDelayMs")) {
+                recovery_.initialDelayMs = recoveryJson["initialDelayMs"].get<int>();
+            }
+            if (recoveryJson.contains("maxDelayMs")) {
+                recovery_.maxDelayMs = recoveryJson["maxDelayMs"].get<int>();
+            }
+            if (recoveryJson.contains("jitter")) {
+                recovery_.jitter = recoveryJson["jitter"].get<double>();
+            }
+        }
+        spdlog::info("Recovery config loaded");
+
+        // Charger la configuration de l'émission multicast
+        if (json.contains("transmit")) {
+            const auto& transmitJson = json["transmit"];
+            if (transmitJson.contains("backend")) {
+                transmit_.backend = transmitJson["backend"].get<std::string>();
+            }
+            if (transmitJson.contains("ringFrames")) {
+                transmit_.ringFrames = transmitJson["ringFrames"].get<int>();
+            }
+            if (transmitJson.contains("uringEntries")) {
+                transmit_.uringEntries = transmitJson["uringEntries"].get<int>();
+            }
+        }
+        spdlog::info("Transmit config loaded");
+
+        // Charger la configuration de la récupération HLS
+        if (json.contains("fetch")) {
+            const auto& fetchJson = json["fetch"];
+            if (fetchJson.contains("engine")) {
+                fetch_.engine = fetchJson["engine"].get<std::string>();
+            }
+            if (fetchJson.contains("ioThreads")) {
+                fetch_.ioThreads = fetchJson["ioThreads"].get<int>();
+            }
+            if (fetchJson.contains("maxRequestsPerOrigin")) {
+                fetch_.maxRequestsPerOrigin = fetchJson["maxRequestsPerOrigin"].get<int>();
+            }
+            if (fetchJson.contains("idleConnectionsPerOrigin")) {
+                fetch_.idleConnectionsPerOrigin = fetchJson["idleConnectionsPerOrigin"].get<int>();
+            }
+            if (fetchJson.contains("hedgeAfterMs")) {
+                fetch_.hedgeAfterMs = fetchJson["hedgeAfterMs"].get<int>();
+            }
+        }
+        spdlog::info("Fetch config loaded");
         // Charger les configurations de flux
         if (json.contains("streams") && json["streams"].is_array()) {
             streams_.clear();
@@ -158,6 +342,14 @@ bool Config::loadFromFile(const std::string& configPath) {
                 if (streamJson.contains("hlsInput")) {
                     streamConfig.hlsInput = streamJson["hlsInput"].get<std::string>();
                 }
+
+                // Origines équivalentes: la première sert d'entrée principale si hlsInput est absent
+                if (streamJson.contains("hlsInputs")) {
+                    streamConfig.hlsInputs = streamJson["hlsInputs"].get<std::vector<std::string>>();
+                    if (streamConfig.hlsInput.empty() && !streamConfig.hlsInputs.empty()) {
+                        streamConfig.hlsInput = streamConfig.hlsInputs.front();
+                    }
+                }
                 
                 if (streamJson.contains("mcastOutput")) {
                     streamConfig.mcastOutput = streamJson["mcastOutput"].get<std::string>();
@@ -171,10 +363,50 @@ bool Config::loadFromFile(const std::string& configPath) {
                     streamConfig.mcastInterface = streamJson["mcastInterface"].get<std::string>();
                 }
                 
+                if (streamJson.contains("mcastProtocol")) {
+                    streamConfig.mcastProtocol = streamJson["mcastProtocol"].get<std::string>();
+                }
+                
+                if (streamJson.contains("fecColumns")) {
+                    streamConfig.fecColumns = streamJson["fecColumns"].get<int>();
+                }
+                
+                if (streamJson.contains("fecRows")) {
+                    streamConfig.fecRows = streamJson["fecRows"].get<int>();
+                }
+                
                 if (streamJson.contains("bufferSize")) {
                     streamConfig.bufferSize = streamJson["bufferSize"].get<size_t>();
                 }
                 
+                if (streamJson.contains("bufferMinMs")) {
+                    streamConfig.bufferMinMs = streamJson["bufferMinMs"].get<int>();
+                }
+                
+                if (streamJson.contains("bufferMaxMs")) {
+                    streamConfig.bufferMaxMs = streamJson["bufferMaxMs"].get<int>();
+                }
+                
+                if (streamJson.contains("passthrough")) {
+                    streamConfig.passthrough = streamJson["passthrough"].get<bool>();
+                }
+                
+                if (streamJson.contains("latencyTargetMs")) {
+                    streamConfig.latencyTargetMs = streamJson["latencyTargetMs"].get<int>();
+                }
+                
+                if (streamJson.contains("catchUpPolicy")) {
+                    streamConfig.catchUpPolicy = streamJson["catchUpPolicy"].get<std::string>();
+                }
+                
+                if (streamJson.contains("redundantOutput")) {
+                    streamConfig.redundantOutput = streamJson["redundantOutput"].get<OutputConfig>();
+                }
+                
+                if (streamJson.contains("outputs")) {
+                    streamConfig.outputs = streamJson["outputs"].get<std::vector<OutputConfig>>();
+                }
+                
                 if (streamJson.contains("enabled")) {
                     streamConfig.enabled = streamJson["enabled"].get<bool>();
                 }
@@ -300,6 +532,30 @@ const AlertsConfig::Retention& Config::getAlertRetention() const {
     return alerts_.retention;
 }
 
+const MemoryConfig& Config::getMemoryConfig() const {
+    return memory_;
+}
+
+const StartupConfig& Config::getStartupConfig() const {
+    return startup_;
+}
+
+const CheckpointConfig& Config::getCheckpointConfig() const {
+    return checkpoint_;
+}
+
+const RecoveryConfig& Config::getRecoveryConfig() const {
+    return recovery_;
+}
+
+const TransmitConfig& Config::getTransmitConfig() const {
+    return transmit_;
+}
+
+const FetchConfig& Config::getFetchConfig() const {
+    return fetch_;
+}
+
 nlohmann::json Config::toJson() const {
     nlohmann::json json;
     
@@ -319,7 +575,11 @@ nlohmann::json Config::toJson() const {
             {"path", logging_.file.path},
             {"rotationSize", logging_.file.rotationSize},
             {"maxFiles", logging_.file.maxFiles}
-        }}
+        }},
+        {"asyncQueueSize", logging_.asyncQueueSize},
+        {"overflowPolicy", logging_.overflowPolicy},
+        {"flushIntervalSec", logging_.flushIntervalSec},
+        {"components", logging_.components}
     };
     
     // Alertes
@@ -331,6 +591,49 @@ nlohmann::json Config::toJson() const {
         }}
     };
     
+    // Mémoire
+    json["memory"] = {
+        {"budgetBytes", memory_.budgetBytes},
+        {"highWatermarkPercent", memory_.highWatermarkPercent},
+        {"lowWatermarkPercent", memory_.lowWatermarkPercent}
+    };
+    
+    // Démarrage
+    json["startup"] = {
+        {"diagnostics", startup_.diagnostics},
+        {"parallelStarts", startup_.parallelStarts}
+    };
+    
+    // Points de reprise
+    json["checkpoint"] = {
+        {"enabled", checkpoint_.enabled},
+        {"directory", checkpoint_.directory},
+        {"intervalMs", checkpoint_.intervalMs}
+    };
+    
+    // Reprise des étapes
+    json["recovery"] = {
+        {"initialDelayMs", recovery_.initialDelayMs},
+        {"maxDelayMs", recovery_.maxDelayMs},
+        {"jitter", recovery_.jitter}
+    };
+    
+    // Émission multicast
+    json["transmit"] = {
+        {"backend", transmit_.backend},
+        {"ringFrames", transmit_.ringFrames},
+        {"uringEntries", transmit_.uringEntries}
+    };
+    
+    // Récupération HLS
+    json["fetch"] = {
+        {"engine", fetch_.engine},
+        {"ioThreads", fetch_.ioThreads},
+        {"maxRequestsPerOrigin", fetch_.maxRequestsPerOrigin},
+        {"idleConnectionsPerOrigin", fetch_.idleConnectionsPerOrigin},
+        {"hedgeAfterMs", fetch_.hedgeAfterMs}
+    };
+    
     // Flux
     nlohmann::json streamsJson = nlohmann::json::array();
     for (const auto& stream : streams_) {
@@ -338,9 +641,20 @@ nlohmann::json Config::toJson() const {
             {"id", stream.id},
             {"name", stream.name},
             {"hlsInput", stream.hlsInput},
+            {"hlsInputs", stream.hlsInputs},
             {"multicastOutput", stream.mcastOutput},
             {"multicastPort", stream.mcastPort},
+            {"mcastProtocol", stream.mcastProtocol},
+            {"fecColumns", stream.fecColumns},
+            {"fecRows", stream.fecRows},
             {"bufferSize", stream.bufferSize},
+            {"bufferMinMs", stream.bufferMinMs},
+            {"bufferMaxMs", stream.bufferMaxMs},
+            {"passthrough", stream.passthrough},
+            {"latencyTargetMs", stream.latencyTargetMs},
+            {"catchUpPolicy", stream.catchUpPolicy},
+            {"outputs", stream.outputs},
+            {"redundantOutput", stream.redundantOutput},
             {"enabled", stream.enabled}
         });
     }
@@ -0,0 +1,117 @@
+#include "hls/FetchScheduler.h"
+#include "core/SegmentTrace.h"
+
+#include <algorithm>
+
+namespace hls_to_dvb {
+
+FetchScheduler& FetchScheduler::getInstance() {
+    static FetchScheduler instance;
+    return instance;
+}
+
+FetchScheduler::Slot::~Slot() {
+    if (scheduler) {
+        scheduler->release(origin);
+    }
+}
+
+void FetchScheduler::setMaxRequestsPerOrigin(int maxRequestsPerOrigin) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxRequestsPerOrigin_ = std::max(maxRequestsPerOrigin, 1);
+    for (auto& [key, origin] : origins_) {
+        grantLocked(origin);
+    }
+}
+
+Task<HttpResponse> FetchScheduler::get(IoLoop& loop, std::string url, std::chrono::steady_clock::time_point deadline,
+                                       std::chrono::milliseconds timeout, std::shared_ptr<CancelToken> cancel,
+                                       std::vector<uint8_t> buffer, std::shared_ptr<HttpProgress> progress) {
+    std::string key = HttpFetcher::origin(url);
+    int64_t queuedStartUs = SegmentTrace::nowUs();
+
+    auto waiter = std::make_shared<Waiter>();
+    waiter->loop = &loop;
+    waiter->token = cancel ? cancel : std::make_shared<CancelToken>();
+
+    bool granted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Origin& origin = origins_[key];
+        origin.requests++;
+        granted = origin.active < maxRequestsPerOrigin_ && origin.waiting.empty();
+        if (granted) {
+            origin.active++;
+        } else {
+            origin.delayed++;
+            waiter->position = origin.waiting.emplace(deadline, waiter);
+        }
+    }
+
+    // Attente d'un créneau: la coroutine est reprise par release() sur sa propre boucle
+    if (!granted) {
+        WaitResult result = co_await loop.suspend(waiter->token);
+        if (result != WaitResult::READY) {
+            bool release = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Origin& origin = origins_[key];
+                if (waiter->granted) {
+                    release = true;
+                } else {
+                    origin.waiting.erase(waiter->position);
+                }
+            }
+            // Créneau attribué pendant l'annulation: il passe à la requête suivante
+            if (release) {
+                this->release(key);
+            }
+            HttpResponse response;
+            response.error = "requête annulée";
+            response.body = std::move(buffer);
+            co_return response;
+        }
+    }
+
+    Slot slot{this, key};
+    int64_t queuedUs = SegmentTrace::nowUs() - queuedStartUs;
+    HttpResponse response = co_await HttpFetcher::get(loop, std::move(url), timeout, cancel, std::move(buffer),
+                                                       std::move(progress));
+    response.queuedUs = queuedUs;
+    co_return response;
+}
+
+void FetchScheduler::release(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Origin& origin = origins_[key];
+    origin.active--;
+    grantLocked(origin);
+}
+
+void FetchScheduler::grantLocked(Origin& origin) {
+    while (origin.active < maxRequestsPerOrigin_ && !origin.waiting.empty()) {
+        std::shared_ptr<Waiter> next = origin.waiting.begin()->second;
+        origin.waiting.erase(origin.waiting.begin());
+        next->granted = true;
+        origin.active++;
+        next->loop->notify(next->token);
+    }
+}
+
+std::vector<FetchScheduler::OriginStats> FetchScheduler::getOriginStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<OriginStats> stats;
+    stats.reserve(origins_.size());
+    for (const auto& [key, origin] : origins_) {
+        OriginStats entry;
+        entry.origin = key;
+        entry.active = origin.active;
+        entry.queued = origin.waiting.size();
+        entry.requests = origin.requests;
+        entry.delayed = origin.delayed;
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+} // namespace hls_to_dvb
@@ -1,16 +1,165 @@
 #include "hls/HLSClient.h"
+#include "hls/FetchScheduler.h"
+#include "hls/MediaPlaylist.h"
 #include "hls/custom_formatters.h"
 #include "alerting/AlertManager.h"
 #include "spdlog/spdlog.h"
 
 #include <fstream>
 #include <sstream>
+#include <set>
 #include <regex>
 #include <chrono>
 #include <algorithm>
+#include <cmath>
+#include <deque>
+#include <future>
 
 using namespace hls_to_dvb;
 
+namespace {
+    // Taille maximale de la file d'attente des segments récupérés
+    constexpr size_t MAX_QUEUE_SIZE = 3;
+    
+    // Délai maximal d'une requête de la coroutine, du début de la résolution à la fin du corps
+    // (rw_timeout des options FFmpeg)
+    constexpr std::chrono::milliseconds REQUEST_TIMEOUT(15000);
+    
+    // Départ à 3 segments du direct, comme le démultiplexeur HLS de FFmpeg
+    constexpr int64_t LIVE_START_SEGMENTS = 3;
+    
+    // Excès de latence (en segments) au-delà duquel la lecture FFmpeg est rouverte près du direct
+    constexpr int64_t LIVE_JUMP_SEGMENTS = 2;
+    
+    // Mise à l'écart d'une origine en échec: 500 ms, doublée à chaque échec, 30 s au plus
+    constexpr std::chrono::milliseconds ORIGIN_RETRY_DELAY(500);
+    constexpr std::chrono::milliseconds ORIGIN_RETRY_MAX_DELAY(30000);
+    
+    // Attente des playlists des autres origines après la première reçue; au-delà, elles
+    // sont prises en compte à leur arrivée, au rechargement suivant
+    constexpr std::chrono::milliseconds RELOAD_GRACE(300);
+    
+    /**
+     * @brief Requête d'une course entre origines
+     */
+    struct FetchAttempt {
+        size_t origin = 0;                          ///< Indice de l'origine
+        bool hedge = false;                         ///< Requête de doublement
+        int64_t startUs = 0;                        ///< Envoi de la requête (µs)
+        std::shared_ptr<CancelToken> cancel = std::make_shared<CancelToken>(); ///< Annulation de cette requête seule
+        std::shared_ptr<HttpProgress> progress = std::make_shared<HttpProgress>(); ///< Réception du premier octet
+        bool done = false;                          ///< Requête terminée
+        bool abandoned = false;                     ///< Annulée au profit d'une autre origine
+        bool recorded = false;                      ///< Résultat déjà pris en compte
+        HttpResponse response;                      ///< Réponse
+    };
+    
+    /**
+     * @brief Requêtes simultanées d'une même ressource sur plusieurs origines
+     *
+     * Les requêtes s'exécutent sur la boucle de la coroutine de récupération, qui
+     * attend leur fin avant de poursuivre : l'état n'a pas besoin de verrou.
+     */
+    struct FetchRace {
+        IoLoop* loop = nullptr;                     ///< Boucle de la coroutine de récupération
+        bool firstWins = true;                      ///< La première réponse valide annule les autres
+        std::shared_ptr<CancelToken> wake;          ///< Attente en cours de la coroutine de récupération (nullptr: aucune)
+        std::deque<FetchAttempt> attempts;          ///< Requêtes (références stables à l'ajout)
+        int pending = 0;                            ///< Requêtes en cours
+        int winner = -1;                            ///< Requête retenue (-1 = aucune)
+    };
+    
+    Task<void> runAttempt(std::shared_ptr<FetchRace> race, size_t index, std::string url,
+                          std::chrono::steady_clock::time_point deadline, std::vector<uint8_t> buffer) {
+        FetchAttempt& attempt = race->attempts[index];
+        attempt.response = co_await FetchScheduler::getInstance().get(*race->loop, std::move(url), deadline,
+                                                                      REQUEST_TIMEOUT, attempt.cancel,
+                                                                      std::move(buffer), attempt.progress);
+        attempt.done = true;
+        race->pending--;
+        
+        if (race->firstWins && race->winner < 0 && attempt.response.ok() && !attempt.response.body.empty()) {
+            race->winner = static_cast<int>(index);
+            for (auto& other : race->attempts) {
+                if (!other.done) {
+                    other.abandoned = true;
+                    race->loop->cancel(other.cancel);
+                }
+            }
+        }
+        if (race->wake) {
+            race->loop->notify(race->wake);
+        }
+    }
+    
+    void startAttempt(const std::shared_ptr<FetchRace>& race, size_t origin, std::string url, bool hedge,
+                      std::chrono::steady_clock::time_point deadline, std::vector<uint8_t> buffer) {
+        FetchAttempt& attempt = race->attempts.emplace_back();
+        attempt.origin = origin;
+        attempt.hedge = hedge;
+        attempt.startUs = SegmentTrace::nowUs();
+        race->pending++;
+        race->loop->spawn(runAttempt(race, race->attempts.size() - 1, std::move(url), deadline, std::move(buffer)));
+    }
+    
+    /**
+     * @brief Annule les requêtes en cours d'une course et attend leur fin
+     */
+    Task<void> drainRace(std::shared_ptr<FetchRace> race) {
+        IoLoop& loop = *race->loop;
+        race->wake = std::make_shared<CancelToken>();
+        for (auto& attempt : race->attempts) {
+            if (!attempt.done) {
+                attempt.abandoned = true;
+                loop.cancel(attempt.cancel);
+            }
+        }
+        while (race->pending > 0) {
+            co_await loop.suspend(race->wake);
+        }
+    }
+    
+    /**
+     * @brief Attend la fin d'une requête de la course, ou le délai
+     *
+     * À l'arrêt du client, les requêtes en cours sont annulées et attendues avant de
+     * rendre la main : aucune ne survit à la coroutine de récupération.
+     *
+     * @return false si la coroutine de récupération a été annulée
+     */
+    Task<bool> waitRace(std::shared_ptr<FetchRace> race, std::shared_ptr<CancelToken> cancel,
+                        std::chrono::milliseconds timeout) {
+        IoLoop& loop = *race->loop;
+        race->wake = cancel;
+        if (timeout.count() >= 0) {
+            co_await loop.sleepFor(timeout, cancel);
+        } else {
+            co_await loop.suspend(cancel);
+        }
+        if (!cancel->cancelled.load(std::memory_order_acquire)) {
+            co_return true;
+        }
+        
+        co_await drainRace(race);
+        co_return false;
+    }
+    
+    std::string describeFailure(const HttpResponse& response) {
+        return response.error.empty() ? "statut HTTP " + std::to_string(response.status) : response.error;
+    }
+    
+    /**
+     * @brief Composition d'un flux ouvert par FFmpeg: codec de chaque flux élémentaire
+     */
+    std::vector<int> codecLayout(const AVFormatContext* context) {
+        std::vector<int> layout;
+        for (unsigned i = 0; context && i < context->nb_streams; ++i) {
+            layout.push_back(static_cast<int>(context->streams[i]->codecpar->codec_id));
+        }
+        return layout;
+    }
+}
+
 // Initialisation globale de FFmpeg (une seule fois)
 static struct FFmpegInit {
     FFmpegInit() {
@@ -24,7 +173,8 @@ static struct FFmpegInit {
 
 HLSClient::HLSClient(const std::string& url)
     : url_(url), formatContext_(nullptr), running_(false),
-      segmentsProcessed_(0), discontinuitiesDetected_(0) {
+      segmentsProcessed_(0), discontinuitiesDetected_(0),
+      log_(hls_to_dvb::Logging::get("HLSClient")) {
     
     // Initialiser les informations du flux
     streamInfo_.url = url;
@@ -291,9 +441,11 @@ void HLSClient::start() {
     spdlog::info("=== HLSClient::start() - DÉBUT ===");
     spdlog::info("Démarrage du client HLS pour l'URL: {}", url_);
     
-    // Vérifier la version de FFmpeg
-    spdlog::info("FFmpeg version: {}", av_version_info());
-    checkFFmpegSSLSupport();  // Vérifier le support SSL/TLS
+    if (diagnostics_) {
+        // Vérifier la version de FFmpeg
+        spdlog::info("FFmpeg version: {}", av_version_info());
+        checkFFmpegSSLSupport();  // Vérifier le support SSL/TLS
+    }
     
     // S'assurer que l'URL commence par https:// ou http://
     if (url_.find("https://") != 0 && url_.find("http://") != 0) {
@@ -302,46 +454,32 @@ void HLSClient::start() {
     }
 
     try {
-        // Afficher des informations détaillées pour déboguer le flux
-        dumpPlaylistInfo(url_);
-        spdlog::info("=== Étape 1: Analyse de la playlist terminée ===");
-        
-        // Ouverture du flux pour analyse des variantes
-        AVFormatContext* ctx = nullptr;
-        
-        AVDictionary* options = createFFmpegOptions();
-        
-        int ret = avformat_open_input(&ctx, url_.c_str(), nullptr, &options);
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            av_dict_free(&options);
-            throw std::runtime_error(std::string("Erreur lors de l'ouverture du flux HLS: ") + errbuf);
-        }
-        
-        // Récupérer les informations sur le flux
-        ret = avformat_find_stream_info(ctx, nullptr);
-        if (ret < 0) {
-            avformat_close_input(&ctx);
-            av_dict_free(&options);
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            throw std::runtime_error(std::string("Erreur lors de la récupération des informations sur le flux: ") + errbuf);
+        if (diagnostics_) {
+            // Afficher des informations détaillées pour déboguer le flux
+            dumpPlaylistInfo(url_);
+            spdlog::info("=== Étape 1: Analyse de la playlist terminée ===");
         }
         
-        av_dict_free(&options);
-        spdlog::info("=== Étape 2: Informations sur le flux récupérées ===");
-        
         // Récupérer explicitement le contenu de la playlist pour extraction des durées
         std::string playlistContent;
         if (fetchHLSManifestWithCurl(url_, playlistContent)) {
             spdlog::info("Contenu de la playlist récupéré avec curl, taille: {} octets", playlistContent.size());
             extractSegmentDurations(playlistContent);
-            spdlog::info("=== Étape 3: Durées des segments extraites ===");
         } else {
             spdlog::warn("Impossible de récupérer le contenu de la playlist avec curl, tentative alternative");
             
-            // Tentative alternative via FFmpeg
+            // Tentative alternative via FFmpeg: le flux n'est ouvert pour analyse que dans ce cas
+            AVFormatContext* ctx = nullptr;
+            AVDictionary* options = createFFmpegOptions();
+            
+            int ret = avformat_open_input(&ctx, url_.c_str(), nullptr, &options);
+            av_dict_free(&options);
+            if (ret < 0) {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                throw std::runtime_error(std::string("Erreur lors de l'ouverture du flux HLS: ") + errbuf);
+            }
+            
             AVIOContext* ioCtx = ctx->pb;
             if (ioCtx) {
                 int64_t pos = avio_tell(ioCtx);
@@ -356,22 +494,21 @@ void HLSClient::start() {
                         playlistContent = reinterpret_cast<char*>(buffer.data());
                         spdlog::info("Contenu de la playlist récupéré via FFmpeg, taille: {} octets", playlistContent.size());
                         extractSegmentDurations(playlistContent);
-                        spdlog::info("=== Étape 3: Durées des segments extraites (via FFmpeg) ===");
                     }
                 }
                 
                 // Restaurer la position
                 avio_seek(ioCtx, pos, SEEK_SET);
             }
+            
+            // Libérer le contexte d'analyse
+            avformat_close_input(&ctx);
         }
         
         // Sélectionner le flux avec le plus grand débit
         bool validStream = selectHighestBitrateStream();
         spdlog::info("=== Étape 4: Sélection du flux terminée (résultat: {}) ===", validStream ? "succès" : "échec");
         
-        // Libérer le contexte d'analyse
-        avformat_close_input(&ctx);
-        
         // Vérifier si le flux contient des segments MPEG-TS
         if (!validStream) {
             // Essayer l'acceptation forcée comme dernier recours
@@ -422,45 +559,74 @@ void HLSClient::start() {
         
         spdlog::info("=== Étape 5: Vérification des segments MPEG-TS terminée ===");
         
-        // Vérifier les discontinuités
-        bool hasDiscontinuities = checkForDiscontinuities(streamInfo_.url);
-        spdlog::info("Vérification des discontinuités terminée (résultat: {})", 
-                   hasDiscontinuities ? "discontinuités détectées" : "pas de discontinuité");
-        
-        spdlog::info("=== Étape 6: Vérification des discontinuités terminée ===");
+        if (diagnostics_) {
+            // Vérifier les discontinuités
+            bool hasDiscontinuities = checkForDiscontinuities(streamInfo_.url);
+            spdlog::info("Vérification des discontinuités terminée (résultat: {})", 
+                       hasDiscontinuities ? "discontinuités détectées" : "pas de discontinuité");
+            
+            spdlog::info("=== Étape 6: Vérification des discontinuités terminée ===");
+        }
         
-        // Ouvrir le flux pour le traitement des segments
-        formatContext_ = avformat_alloc_context();
-        if (!formatContext_) {
-            throw std::runtime_error("Impossible d'allouer le contexte de format AVFormat");
+        // Avec le runtime d'E/S, une variante http:// en clair et en MPEG-TS est récupérée
+        // par une coroutine; sinon (https, chiffrement, fMP4, plages d'octets) FFmpeg la lit sur son thread
+        bool useRuntime = false;
+        if (runtime_) {
+            std::string variantContent;
+            if (!HttpFetcher::supports(streamInfo_.url)) {
+                spdlog::info("Variante hors http://, récupération par FFmpeg: {}", streamInfo_.url);
+            } else if (!fetchHLSManifestWithCurl(streamInfo_.url, variantContent)) {
+                spdlog::warn("Variante illisible, récupération par FFmpeg: {}", streamInfo_.url);
+            } else {
+                MediaPlaylist variant = MediaPlaylist::parse(variantContent, streamInfo_.url);
+                if (variant.encrypted || variant.fragmentedMp4 || variant.master) {
+                    spdlog::info("Variante chiffrée ou non MPEG-TS, récupération par FFmpeg: {}", streamInfo_.url);
+                } else if (variant.byteRange) {
+                    spdlog::info("Variante en plages d'octets, récupération par FFmpeg: {}", streamInfo_.url);
+                } else {
+                    useRuntime = true;
+                }
+            }
         }
         
-        // Configurer les options pour le client HLS
-        options = createFFmpegOptions();
+        setupOrigins(useRuntime);
         
-        // Utiliser l'URL du flux de plus haut débit
-        spdlog::info("Ouverture du flux pour traitement: {}", streamInfo_.url);
-        ret = avformat_open_input(&formatContext_, streamInfo_.url.c_str(), nullptr, &options);
-        av_dict_free(&options);
+        if (!useRuntime) {
+            // Ouvrir le flux pour le traitement des segments
+            formatContext_ = avformat_alloc_context();
+            if (!formatContext_) {
+                throw std::runtime_error("Impossible d'allouer le contexte de format AVFormat");
+            }
         
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            throw std::runtime_error(std::string("Erreur lors de l'ouverture du flux HLS: ") + errbuf);
-        }
+            // Configurer les options pour le client HLS
+            AVDictionary* options = createFFmpegOptions();
         
-        // Récupérer les informations sur le flux
-        spdlog::info("Récupération des informations sur le flux pour traitement");
-        ret = avformat_find_stream_info(formatContext_, nullptr);
-        if (ret < 0) {
-            avformat_close_input(&formatContext_);
-            formatContext_ = nullptr;
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            throw std::runtime_error(std::string("Erreur lors de la récupération des informations sur le flux: ") + errbuf);
-        }
+            // Utiliser l'URL du flux de plus haut débit
+            spdlog::info("Ouverture du flux pour traitement: {}", streamInfo_.url);
+            int ret = avformat_open_input(&formatContext_, streamInfo_.url.c_str(), nullptr, &options);
+            av_dict_free(&options);
+        
+            if (ret < 0) {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                throw std::runtime_error(std::string("Erreur lors de l'ouverture du flux HLS: ") + errbuf);
+            }
         
-        spdlog::info("=== Étape 7: Ouverture du flux pour traitement terminée ===");
+            // Récupérer les informations sur le flux
+            spdlog::info("Récupération des informations sur le flux pour traitement");
+            ret = avformat_find_stream_info(formatContext_, nullptr);
+            if (ret < 0) {
+                avformat_close_input(&formatContext_);
+                formatContext_ = nullptr;
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                throw std::runtime_error(std::string("Erreur lors de la récupération des informations sur le flux: ") + errbuf);
+            }
+        
+            spdlog::info("=== Étape 7: Ouverture du flux pour traitement terminée ===");
+        }
+        useRuntime_ = useRuntime;
+        codecLayout_ = codecLayout(formatContext_);
 
         // Vérification finale des informations du flux
         if (streamInfo_.width == 0 || streamInfo_.height == 0 || streamInfo_.bandwidth == 0 || streamInfo_.codecs.empty()) {
@@ -483,9 +649,8 @@ void HLSClient::start() {
         spdlog::info("Client HLS configuré avec flux: {}x{}, {}kbps, codecs: {}",
                     streamInfo_.width, streamInfo_.height, streamInfo_.bandwidth / 1000, streamInfo_.codecs);
         
-        // Démarrer le thread de récupération des segments
-        running_ = true;
-        fetchThread_ = std::thread(&HLSClient::fetchThreadFunc, this);
+        // Démarrer la récupération des segments
+        startFetchingInternal(useRuntime);
         
         spdlog::info("Client HLS démarré avec succès. Flux sélectionné: {}x{}, {}kbps, codecs: {}",
                    streamInfo_.width, streamInfo_.height, streamInfo_.bandwidth / 1000, streamInfo_.codecs);
@@ -665,6 +830,13 @@ bool HLSClient::selectHighestBitrateStream() {
                 return false;
             }
             
+            // Trier par bande passante décroissante: la première variante conforme est
+            // celle qui sera retenue, inutile de sonder les suivantes
+            std::stable_sort(variants.begin(), variants.end(),
+                             [](const VariantInfo& a, const VariantInfo& b) {
+                                 return a.bandwidth > b.bandwidth;
+                             });
+            
             // Maintenant, vérifier si au moins une variante a des segments MPEG-TS
             for (auto& variant : variants) {
                 spdlog::info("Vérification des segments MPEG-TS pour la variante: {}", variant.url);
@@ -700,6 +872,10 @@ bool HLSClient::selectHighestBitrateStream() {
                         variant.hasMPEGTSSegments = true;
                     }
                 }
+                
+                if (variant.hasMPEGTSSegments) {
+                    break;
+                }
             }
             
             // Sélectionner les variantes valides
@@ -723,12 +899,6 @@ bool HLSClient::selectHighestBitrateStream() {
                 return false;
             }
             
-            // Trier par bande passante décroissante
-            std::sort(validVariants.begin(), validVariants.end(), 
-                     [](const VariantInfo& a, const VariantInfo& b) {
-                         return a.bandwidth > b.bandwidth;
-                     });
-            
             // Sélectionner la variante avec le plus grand débit
             const auto& bestVariant = validVariants[0];
             
@@ -989,7 +1159,7 @@ bool HLSClient::fetchHLSManifestWithCurl(const std::string& url, std::string& co
                           " -H \"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36\"" +
                           " \"" + url + "\"";
     
-    spdlog::info("Exécution de la commande curl : {}", command);
+    SPDLOG_LOGGER_DEBUG(log_, "Exécution de la commande curl : {}", command);
     int result = system(command.c_str());
     
     if (result != 0) {
@@ -1018,9 +1188,9 @@ bool HLSClient::fetchHLSManifestWithCurl(const std::string& url, std::string& co
         return false;
     }
     
-    spdlog::info("Playlist téléchargée avec succès, taille: {} octets", content.size());
-    spdlog::debug("Début du contenu de la playlist: {}", 
-                content.substr(0, std::min(static_cast<size_t>(200), content.size())));
+    SPDLOG_LOGGER_DEBUG(log_, "Playlist téléchargée avec succès, taille: {} octets", content.size());
+    SPDLOG_LOGGER_TRACE(log_, "Début du contenu de la playlist: {}",
+                        content.substr(0, std::min(static_cast<size_t>(200), content.size())));
     
     return true;
 }
@@ -1643,9 +1813,14 @@ void HLSClient::extractSegmentDurations(const std::string& playlistContent) {
     double totalDuration = 0.0;
     int segmentCount = 0;
     
-    spdlog::info("Extraction des durées de segment depuis la playlist");
-    spdlog::debug("Contenu de la playlist pour extraction (premiers 500 caractères): {}", 
-                playlistContent.substr(0, std::min(static_cast<size_t>(500), playlistContent.size())));
+    // Ne conserver que les durées de la fenêtre courante: la playlist d'un flux live glisse
+    // en permanence et les entrées précédentes ne seraient jamais supprimées
+    std::map<int, double> durations;
+    std::set<std::string> uris;
+    
+    SPDLOG_LOGGER_DEBUG(log_, "Extraction des durées de segment depuis la playlist");
+    SPDLOG_LOGGER_TRACE(log_, "Contenu de la playlist pour extraction (premiers 500 caractères): {}",
+                        playlistContent.substr(0, std::min(static_cast<size_t>(500), playlistContent.size())));
     
     while (std::getline(iss, line)) {
         // Supprimer les retours à la ligne
@@ -1653,7 +1828,7 @@ void HLSClient::extractSegmentDurations(const std::string& playlistContent) {
             return c == '\r' || c == '\n'; 
         }), line.end());
         
-        spdlog::debug("Analyse de la ligne pour durée: {}", line);
+        SPDLOG_LOGGER_TRACE(log_, "Analyse de la ligne pour durée: {}", line);
         
         // Rechercher les directives EXTINF (durée)
         if (line.find("#EXTINF:") != std::string::npos) {
@@ -1664,9 +1839,9 @@ void HLSClient::extractSegmentDurations(const std::string& playlistContent) {
             if (std::regex_search(line, duration_match, duration_regex)) {
                 try {
                     currentDuration = std::stod(duration_match[1]);
-                    spdlog::info("Durée extraite avec regex: {:.2f}s", currentDuration);
+                    SPDLOG_LOGGER_TRACE(log_, "Durée extraite avec regex: {:.2f}s", currentDuration);
                 } catch (const std::exception& e) {
-                    spdlog::warn("Impossible de convertir la durée '{}': {}", duration_match[1].str(), e.what());
+                    log_->warn("Impossible de convertir la durée '{}': {}", duration_match[1].str(), e.what());
                     currentDuration = 0.0;
                 }
             } else {
@@ -1685,9 +1860,9 @@ void HLSClient::extractSegmentDurations(const std::string& playlistContent) {
                     
                     try {
                         currentDuration = std::stod(durationStr);
-                        spdlog::info("Durée extraite avec méthode alternative: {:.2f}s", currentDuration);
+                        SPDLOG_LOGGER_TRACE(log_, "Durée extraite avec méthode alternative: {:.2f}s", currentDuration);
                     } catch (const std::exception& e) {
-                        spdlog::warn("Impossible de convertir la durée '{}': {}", durationStr, e.what());
+                        log_->warn("Impossible de convertir la durée '{}': {}", durationStr, e.what());
                         currentDuration = 0.0;
                     }
                 }
@@ -1696,17 +1871,18 @@ void HLSClient::extractSegmentDurations(const std::string& playlistContent) {
         // Rechercher les lignes de segments (non commentaires)
         else if (!line.empty() && line[0] != '#') {
             // C'est une ligne de segment, associer la durée au numéro de séquence
+            uris.insert(line);
             if (currentDuration > 0.0) {
-                segmentDurations_[seqNumber] = currentDuration;
+                durations[seqNumber] = currentDuration;
                 totalDuration += currentDuration;
                 segmentCount++;
                 
-                spdlog::info("Segment {} a une durée de {:.2f}s", seqNumber, currentDuration);
+                SPDLOG_LOGGER_TRACE(log_, "Segment {} a une durée de {:.2f}s", seqNumber, currentDuration);
                 seqNumber++;
             } else {
-                spdlog::warn("Segment sans durée trouvé: {}", line);
+                log_->warn("Segment sans durée trouvé: {}", line);
                 // Associer une durée par défaut pour ne pas bloquer
-                segmentDurations_[seqNumber] = 4.0;
+                durations[seqNumber] = 4.0;
                 totalDuration += 4.0;
                 segmentCount++;
                 seqNumber++;
@@ -1715,45 +1891,54 @@ void HLSClient::extractSegmentDurations(const std::string& playlistContent) {
         }
     }
     
+    std::lock_guard<std::mutex> lock(durationsMutex_);
+    segmentDurations_.swap(durations);
+    
+    // Dater l'apparition du segment le plus récent de la fenêtre (début de sa trace)
+    for (const auto& uri : uris) {
+        if (segmentUris_.count(uri) == 0) {
+            newestSegmentSeenUs_ = hls_to_dvb::SegmentTrace::nowUs();
+            break;
+        }
+    }
+    segmentUris_.swap(uris);
+    
     // Calculer la durée moyenne des segments
     if (segmentCount > 0) {
         averageSegmentDuration_ = totalDuration / segmentCount;
-        spdlog::info("Durée moyenne des segments: {:.2f}s (total: {:.2f}s, count: {})", 
-                   averageSegmentDuration_, totalDuration, segmentCount);
+        SPDLOG_LOGGER_DEBUG(log_, "Durée moyenne des segments: {:.2f}s (total: {:.2f}s, count: {})",
+                            averageSegmentDuration_, totalDuration, segmentCount);
     } else {
         // Valeur par défaut si aucun segment n'a été trouvé
         averageSegmentDuration_ = 4.0;
-        spdlog::warn("Aucune durée de segment extraite, utilisation de la valeur par défaut: {:.2f}s", 
+        log_->warn("Aucune durée de segment extraite, utilisation de la valeur par défaut: {:.2f}s",
                    averageSegmentDuration_);
     }
     
-    // Journaliser les durées de segment extraites
-    spdlog::info("Extrait {} durées de segment", segmentDurations_.size());
-    for (const auto& [seq, duration] : segmentDurations_) {
-        spdlog::debug("  Segment {}: {:.2f}s", seq, duration);
-    }
+    SPDLOG_LOGGER_DEBUG(log_, "Extrait {} durées de segment", segmentDurations_.size());
 }
 
 void HLSClient::fetchThreadFunc() {
-    static int loopCount = 0;
     spdlog::info("Thread de récupération HLS démarré pour l'URL: {}", streamInfo_.url);
     
     if (!formatContext_) {
         throw std::runtime_error("Contexte de format FFmpeg non initialisé");
     }
     
-    // Variables pour la gestion des discontinuités
-    bool previousWasDiscontinuity = false;
+    // Variables pour la gestion des discontinuités (après une relance du client, le
+    // premier segment suit une coupure)
+    bool previousWasDiscontinuity = segmentsProcessed_ > 0;
     int sequenceNumber = 0;
-    
-    // Constante pour la taille maximale de la file d'attente
-    const size_t MAX_QUEUE_SIZE = 3;  // Maximum 3 segments en file d'attente
+    double skippedBefore = 0.0;     // Durée sautée pour rattraper le direct (négative si inconnue)
     
     // Boucle principale de récupération des segments
     while (running_) {
         try {
-            if (++loopCount % 100 == 0) {
-                spdlog::info("HLSClient: fetchThreadFunc() itération {}", loopCount);
+            // Suspendre la récupération tant que le budget mémoire global est dépassé
+            if (BufferAccountant::getInstance().isThrottled()) {
+                SPDLOG_LOGGER_DEBUG(log_, "Budget mémoire dépassé, récupération HLS suspendue pour {}", streamInfo_.url);
+                BufferAccountant::getInstance().waitForCapacity(std::chrono::milliseconds(500));
+                continue;
             }
             
             // Limiter la taille de la file d'attente pour éviter d'utiliser trop de mémoire
@@ -1762,25 +1947,28 @@ void HLSClient::fetchThreadFunc() {
                 
                 if (segmentQueue_.size() >= MAX_QUEUE_SIZE) {
                     // File d'attente suffisamment remplie, attendre un peu
-                    spdlog::debug("File d'attente HLS pleine ({}/{}), attente...", 
-                                segmentQueue_.size(), MAX_QUEUE_SIZE);
+                    [[maybe_unused]] size_t queueSize = segmentQueue_.size();
                     lock.unlock();
+                    SPDLOG_LOGGER_TRACE(log_, "File d'attente HLS pleine ({}/{}), attente...",
+                                        queueSize, MAX_QUEUE_SIZE);
                     std::this_thread::sleep_for(std::chrono::milliseconds(500));
                     continue;
                 }
             }
             
+            // Trop loin du direct: rouvrir la variante à la cible plutôt que lire des segments
+            // aussitôt écartés; la durée sautée n'est pas connue
+            if (jumpToLiveEdgeInternal()) {
+                previousWasDiscontinuity = true;
+                skippedBefore = -1.0;
+                continue;
+            }
+            
             // Lire un paquet
             AVPacket* packet = av_packet_alloc();
             
             int ret = av_read_frame(formatContext_, packet);
 
-            static int packetCount = 0;
-            packetCount++;
-            if (packetCount % 1000 == 0) {
-                spdlog::info("HLS fetch thread processed {} packets so far", packetCount);
-            }
-
             if (ret < 0) {
                 if (ret == AVERROR_EOF) {
                     // Fin du flux, attendre un peu et réessayer
@@ -1789,11 +1977,18 @@ void HLSClient::fetchThreadFunc() {
                     continue;
                 }
                 else {
-                    // Erreur de lecture
+                    // Erreur de lecture (segment absent, coupure de l'origine)
                     char errbuf[AV_ERROR_MAX_STRING_SIZE];
                     av_strerror(ret, errbuf, sizeof(errbuf));
                     spdlog::error("Erreur lors de la lecture du flux HLS: {}", errbuf);
                     
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex_);
+                        if (metrics_) {
+                            metrics_->fetchErrors->increment();
+                        }
+                    }
+                    
                     AlertManager::getInstance().addAlert(
                         AlertLevel::ERROR,
                         "HLSClient",
@@ -1802,17 +1997,36 @@ void HLSClient::fetchThreadFunc() {
                     );
                     
                     av_packet_free(&packet);
-                    break;
+                    
+                    // Rouvrir la variante sur place: la file, la réserve et les étapes
+                    // suivantes sont conservées, seul le segment perdu marque une discontinuité
+                    if (!reopenInputInternal()) {
+                        break;
+                    }
+                    previousWasDiscontinuity = true;
+                    continue;
                 }
             }
             
             // Vérifier si c'est un nouveau segment
             if (packet->flags & AV_PKT_FLAG_KEY && packet->pos == 0) {
                 // C'est probablement le début d'un nouveau segment
-                spdlog::info("Nouveau segment HLS détecté");
+                SPDLOG_LOGGER_DEBUG(log_, "Nouveau segment HLS détecté");
                 
-                // Accumuler les données du segment
-                std::vector<uint8_t> segmentData;
+                // Accumuler les données du segment dans un tampon recyclé, dimensionné
+                // d'après le segment précédent pour éviter les réallocations
+                std::shared_ptr<hls_to_dvb::BufferPool> pool;
+                std::shared_ptr<hls_to_dvb::StreamMetrics> metrics;
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex_);
+                    pool = bufferPool_;
+                    metrics = metrics_;
+                }
+                auto fetchStart = std::chrono::steady_clock::now();
+                hls_to_dvb::SegmentTrace trace;
+                trace.downloadStartUs = hls_to_dvb::SegmentTrace::nowUs();
+                std::vector<uint8_t> segmentData = pool ?
+                    pool->acquire(lastSegmentBytes_ + lastSegmentBytes_ / 4) : std::vector<uint8_t>();
                 bool isDiscontinuity = previousWasDiscontinuity;
                 previousWasDiscontinuity = false;
                 
@@ -1839,6 +2053,10 @@ void HLSClient::fetchThreadFunc() {
                             av_strerror(ret, errbuf, sizeof(errbuf));
                             spdlog::error("Erreur lors de la lecture du flux HLS: {}", errbuf);
                             
+                            if (metrics) {
+                                metrics->fetchErrors->increment();
+                            }
+                            
                             AlertManager::getInstance().addAlert(
                                 AlertLevel::ERROR,
                                 "HLSClient",
@@ -1871,27 +2089,51 @@ void HLSClient::fetchThreadFunc() {
                 
                 // Créer un segment HLS
                 if (!segmentData.empty()) {
-                    // Log pour le débogage
-                    spdlog::info("HLSClient: Création d'un segment - taille: {} octets, séquence: {}", 
-                              segmentData.size(), sequenceNumber);
+                    lastSegmentBytes_ = segmentData.size();
+                    
+                    // Premier segment après une erreur: la récupération est rétablie
+                    if (readBackoff_.isRecovering()) {
+                        double recoverySeconds = readBackoff_.succeed();
+                        if (metrics) {
+                            metrics->fetchRecoverySeconds->observe(recoverySeconds);
+                        }
+                        spdlog::info("Récupération HLS rétablie en {:.0f} ms pour {}",
+                                     recoverySeconds * 1000.0, streamInfo_.url);
+                    }
+                    
+                    if (metrics) {
+                        metrics->fetchSegments->increment();
+                        metrics->fetchBytes->increment(segmentData.size());
+                        metrics->fetchSeconds->observe(std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - fetchStart).count());
+                    }
                     
                     HLSSegment segment;
                     segment.data = std::move(segmentData);
                     segment.discontinuity = isDiscontinuity;
                     segment.sequenceNumber = sequenceNumber;
+                    segment.skippedBefore = skippedBefore;
+                    skippedBefore = 0.0;
                     
                     // Utiliser la durée stockée ou une valeur par défaut
-                    auto it = segmentDurations_.find(sequenceNumber);
-                    if (it != segmentDurations_.end()) {
-                        segment.duration = it->second;
-                        spdlog::debug("Utilisation de la durée extraite pour le segment {}: {:.2f}s", 
-                                   sequenceNumber, segment.duration);
-                    } else {
-                        // Si pas de durée stockée, utiliser la moyenne ou une valeur par défaut
-                        segment.duration = (averageSegmentDuration_ > 0.0) ? 
-                                         averageSegmentDuration_ : 4.0;
-                        spdlog::debug("Utilisation de la durée moyenne pour le segment {}: {:.2f}s", 
-                                   sequenceNumber, segment.duration);
+                    {
+                        std::lock_guard<std::mutex> durationsLock(durationsMutex_);
+                        if (newestSegmentSeenUs_ != 0 && newestSegmentSeenUs_ <= trace.downloadStartUs) {
+                            trace.playlistSeenUs = newestSegmentSeenUs_;
+                        }
+                        
+                        auto it = segmentDurations_.find(sequenceNumber);
+                        if (it != segmentDurations_.end()) {
+                            segment.duration = it->second;
+                            SPDLOG_LOGGER_TRACE(log_, "Utilisation de la durée extraite pour le segment {}: {:.2f}s",
+                                                sequenceNumber, segment.duration);
+                        } else {
+                            // Si pas de durée stockée, utiliser la moyenne ou une valeur par défaut
+                            segment.duration = (averageSegmentDuration_ > 0.0) ? 
+                                             averageSegmentDuration_ : 4.0;
+                            SPDLOG_LOGGER_TRACE(log_, "Utilisation de la durée moyenne pour le segment {}: {:.2f}s",
+                                                sequenceNumber, segment.duration);
+                        }
                     }
                     
                     sequenceNumber++;  // Incrémenter après utilisation
@@ -1900,35 +2142,14 @@ void HLSClient::fetchThreadFunc() {
                         std::chrono::system_clock::now().time_since_epoch()
                     ).count();
                     
-                    // AJOUTER CE LOG AVANT l'ajout à la file
-                    spdlog::info("HLSClient: Tentative d'ajout du segment à la file, taille: {} octets", segment.data.size());
+                    trace.sequenceNumber = segment.sequenceNumber;
+                    trace.discontinuity = segment.discontinuity;
+                    trace.downloadEndUs = hls_to_dvb::SegmentTrace::nowUs();
+                    segment.trace = trace;
                     
-                    // Ajouter le segment à la file d'attente en respectant la taille maximale
-                    {
-                        std::lock_guard<std::mutex> lock(queueMutex_);
-                        
-                        // Limiter la taille de la file d'attente
-                        while (segmentQueue_.size() >= MAX_QUEUE_SIZE) {
-                            // Si la file est pleine, supprimer le segment le plus ancien
-                            spdlog::warn("File d'attente pleine ({}/{}), suppression du segment le plus ancien", 
-                                      segmentQueue_.size(), MAX_QUEUE_SIZE);
-                            segmentQueue_.pop();
-                        }
-                        
-                        segmentQueue_.push(segment);
-                        
-                        // AJOUTER CE LOG APRÈS l'ajout à la file
-                        spdlog::info("HLSClient: Segment ajouté à la file, taille actuelle: {}, séquence: {}", 
-                                  segmentQueue_.size(), segment.sequenceNumber);
-                    }
-                    
-                    // Notifier les threads en attente
-                    queueCondVar_.notify_all();
-                    
-                    spdlog::info("Segment {} ajouté à la file, taille de la file: {}, taille des données: {} octets, durée: {:.2f}s", 
-                               segment.sequenceNumber, segmentQueue_.size(), segment.data.size(), segment.duration);
+                    enqueueSegment(std::move(segment));
                 } else {
-                    spdlog::warn("Segment HLS vide détecté et ignoré");
+                    log_->warn("Segment HLS vide détecté et ignoré");
                 }
             }
             
@@ -1944,15 +2165,768 @@ void HLSClient::fetchThreadFunc() {
                 true
             );
             
-            // Attendre un peu avant de réessayer
-            std::this_thread::sleep_for(std::chrono::seconds(2));
+            // Attendre un peu avant de réessayer, plus longtemps à chaque échec consécutif
+            auto delay = readBackoff_.fail();
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueCondVar_.wait_for(lock, delay, [this] { return !running_; });
         }
     }
     
     spdlog::info("Thread de récupération des segments HLS terminé");
 }
 
+void HLSClient::enqueueSegment(HLSSegment&& segment) {
+    size_t segmentBytes = segment.data.size();
+    [[maybe_unused]] int segmentSequence = segment.sequenceNumber;
+    size_t droppedSegments = 0;
+    
+    // Ajouter le segment à la file d'attente en respectant la taille maximale
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        
+        // Limiter la taille de la file d'attente
+        while (segmentQueue_.size() >= MAX_QUEUE_SIZE) {
+            // Si la file est pleine, supprimer le segment le plus ancien
+            droppedSegments++;
+            size_t droppedBytes = segmentQueue_.front().data.size();
+            queuedBytes_ -= droppedBytes;
+            if (bufferAccount_) {
+                bufferAccount_->release(BufferStage::HLS_QUEUE, droppedBytes);
+            }
+            if (bufferPool_) {
+                bufferPool_->release(std::move(segmentQueue_.front().data));
+            }
+            segmentQueue_.pop();
+        }
+        
+        queuedBytes_ += segmentBytes;
+        if (bufferAccount_) {
+            bufferAccount_->add(BufferStage::HLS_QUEUE, segmentBytes);
+        }
+        segmentQueue_.push(std::move(segment));
+    }
+    
+    // Notifier les threads en attente
+    queueCondVar_.notify_all();
+    
+    // Messages émis hors du verrou de la file
+    if (droppedSegments > 0) {
+        log_->warn("File d'attente pleine ({} max), {} segment(s) le(s) plus ancien(s) supprimé(s)",
+                   MAX_QUEUE_SIZE, droppedSegments);
+    }
+    SPDLOG_LOGGER_DEBUG(log_, "Segment {} ajouté à la file, taille des données: {} octets",
+                        segmentSequence, segmentBytes);
+}
+
+void HLSClient::reportFetchError(const std::string& message) {
+    spdlog::error("Erreur lors de la récupération HLS: {}", message);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (metrics_) {
+            metrics_->fetchErrors->increment();
+        }
+    }
+    
+    AlertManager::getInstance().addAlert(
+        AlertLevel::ERROR,
+        "HLSClient",
+        "Erreur lors de la récupération HLS: " + message,
+        true
+    );
+}
+
+Task<void> HLSClient::fetchCoroutine(IoLoop& loop) {
+    spdlog::info("Coroutine de récupération HLS démarrée pour l'URL: {} ({} origine(s))",
+                 streamInfo_.url, origins_.size());
+    
+    std::shared_ptr<CancelToken> cancel = fetchCancel_;
+    bool previousWasDiscontinuity = segmentsProcessed_ > 0;
+    int sequenceNumber = 0;
+    int64_t nextSequence = -1;
+    double skippedBefore = 0.0;     // Durée sautée pour rattraper le direct, reportée au segment suivant
+    
+    // Dernière playlist de chaque origine: un même numéro de séquence média désigne le
+    // même segment sur toutes les origines
+    std::vector<std::optional<MediaPlaylist>> playlists(origins_.size());
+    
+    // Rechargements dont des playlists sont encore attendues: elles mettent à jour
+    // playlists et les statistiques des origines à leur arrivée
+    std::vector<std::shared_ptr<FetchRace>> lateReloads;
+    
+    // Prise en compte des playlists reçues; la plus avancée, la mieux classée à égalité,
+    // sert de référence
+    int reference = -1;
+    std::string referenceContent;
+    std::string playlistError;
+    auto collectPlaylists = [&](FetchRace& race) {
+        for (auto& attempt : race.attempts) {
+            if (!attempt.done || attempt.recorded) {
+                continue;
+            }
+            attempt.recorded = true;
+            recordOriginResult(attempt.origin, attempt.response, attempt.startUs, false, false, false);
+            if (!attempt.response.ok()) {
+                playlistError = origins_[attempt.origin].url + ": " + describeFailure(attempt.response);
+                continue;
+            }
+            std::string content(attempt.response.body.begin(), attempt.response.body.end());
+            playlists[attempt.origin] = MediaPlaylist::parse(content, origins_[attempt.origin].url);
+            if (reference < 0 ||
+                playlists[attempt.origin]->lastSequence() > playlists[static_cast<size_t>(reference)]->lastSequence()) {
+                reference = static_cast<int>(attempt.origin);
+                referenceContent = std::move(content);
+            }
+        }
+    };
+    
+    while (running_) {
+        // Suspendre la récupération tant que le budget mémoire global est dépassé
+        if (BufferAccountant::getInstance().isThrottled()) {
+            co_await loop.sleepFor(std::chrono::milliseconds(500), cancel);
+            continue;
+        }
+        
+        std::chrono::milliseconds reloadDelay(0);
+        bool failed = false;
+        bool cancelled = false;
+        try {
+            // Playlists des origines en service, en parallèle (toutes si aucune n'est en service)
+            auto playlistLoaded = std::chrono::steady_clock::now();
+            auto deadline = bufferDeadline();
+            reference = -1;
+            referenceContent.clear();
+            playlistError.clear();
+            
+            // Playlists arrivées depuis le rechargement précédent; une origine dont la
+            // requête est encore en cours n'est pas sollicitée de nouveau
+            std::vector<bool> inFlight(playlists.size(), false);
+            for (auto it = lateReloads.begin(); it != lateReloads.end();) {
+                collectPlaylists(**it);
+                for (const auto& attempt : (*it)->attempts) {
+                    inFlight[attempt.origin] = inFlight[attempt.origin] || !attempt.done;
+                }
+                it = (*it)->pending > 0 ? it + 1 : lateReloads.erase(it);
+            }
+            
+            auto reload = std::make_shared<FetchRace>();
+            reload->loop = &loop;
+            reload->firstWins = false;
+            std::vector<size_t> ranked = rankOrigins();
+            {
+                std::lock_guard<std::mutex> lock(originsMutex_);
+                for (size_t origin : ranked) {
+                    const OriginState& state = origins_[origin];
+                    if (!inFlight[origin] && (state.consecutiveErrors == 0 || playlistLoaded >= state.retryAfter)) {
+                        startAttempt(reload, origin, state.url, false, deadline, {});
+                    }
+                }
+                if (reload->attempts.empty()) {
+                    for (size_t origin : ranked) {
+                        if (!inFlight[origin]) {
+                            startAttempt(reload, origin, origins_[origin].url, false, deadline, {});
+                        }
+                    }
+                }
+            }
+            
+            // Toutes les origines ont encore une requête en cours: attendre l'une d'elles
+            if (reload->attempts.empty() && reference < 0) {
+                std::shared_ptr<FetchRace> late = lateReloads.front();
+                bool woken = co_await waitRace(late, cancel, std::chrono::milliseconds(-1));
+                late->wake = nullptr;
+                if (!woken) {
+                    cancelled = true;
+                    break;
+                }
+                continue;
+            }
+            
+            // Poursuivre dès la playlist de l'origine la mieux classée, ou RELOAD_GRACE après
+            // la première reçue: une origine lente ou injoignable ne retarde pas le rechargement
+            std::optional<std::chrono::steady_clock::time_point> graceEnd;
+            while (reload->pending > 0) {
+                const FetchAttempt& best = reload->attempts.front();
+                if (best.done && best.response.ok()) {
+                    break;
+                }
+                auto now = std::chrono::steady_clock::now();
+                if (!graceEnd) {
+                    for (const auto& attempt : reload->attempts) {
+                        if (attempt.done && attempt.response.ok()) {
+                            graceEnd = now + RELOAD_GRACE;
+                            break;
+                        }
+                    }
+                }
+                if (graceEnd && now >= *graceEnd) {
+                    break;
+                }
+                auto timeout = graceEnd ? std::chrono::ceil<std::chrono::milliseconds>(*graceEnd - now) :
+                                          std::chrono::milliseconds(-1);
+                if (!co_await waitRace(reload, cancel, timeout)) {
+                    cancelled = true;
+                    break;
+                }
+            }
+            if (reload->pending > 0) {
+                // Les requêtes restantes s'achèvent en arrière-plan, sans réveiller la coroutine
+                reload->wake = nullptr;
+                lateReloads.push_back(reload);
+            }
+            if (cancelled || !running_) {
+                break;
+            }
+            collectPlaylists(*reload);
+            
+            if (reference < 0) {
+                reportFetchError("playlist " + playlistError);
+                failed = true;
+            } else {
+                extractSegmentDurations(referenceContent);
+                const MediaPlaylist& playlist = *playlists[static_cast<size_t>(reference)];
+                
+                // Départ près du direct, ou reprise si la fenêtre a glissé au-delà du prochain segment
+                int64_t first = playlist.mediaSequence;
+                int64_t last = playlist.lastSequence();
+                if (nextSequence < 0 || nextSequence > last + 1) {
+                    if (nextSequence > last + 1) {
+                        log_->warn("Séquence de la playlist revenue de {} à {}, reprise au direct", nextSequence, last);
+                        previousWasDiscontinuity = true;
+                    }
+                    nextSequence = std::max(first, last - LIVE_START_SEGMENTS + 1);
+                } else if (nextSequence < first) {
+                    log_->warn("{} segment(s) sorti(s) de la fenêtre avant leur téléchargement", first - nextSequence);
+                    previousWasDiscontinuity = true;
+                    nextSequence = first;
+                }
+                
+                bool newSegments = false;
+                for (const auto& entry : playlist.segments) {
+                    if (entry.sequence < nextSequence) {
+                        continue;
+                    }
+                    
+                    // Attendre que l'étape suivante libère la file plutôt que de la faire déborder
+                    while (running_ && queueSize() >= MAX_QUEUE_SIZE) {
+                        co_await loop.sleepFor(std::chrono::milliseconds(100), cancel);
+                    }
+                    if (!running_) {
+                        break;
+                    }
+                    
+                    std::shared_ptr<hls_to_dvb::BufferPool> pool;
+                    std::shared_ptr<hls_to_dvb::StreamMetrics> metrics;
+                    std::shared_ptr<hls_to_dvb::LiveEdgeController> liveEdge;
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex_);
+                        pool = bufferPool_;
+                        metrics = metrics_;
+                        liveEdge = liveEdge_;
+                    }
+                    
+                    // Au-delà de la latence cible, avancer vers le direct moins la cible plutôt que
+                    // de télécharger des segments aussitôt écartés (le plus récent est toujours gardé)
+                    if (liveEdge && entry.sequence < last) {
+                        double entryDuration = entry.duration > 0.0 ? entry.duration :
+                                               (averageSegmentDuration_ > 0.0 ? averageSegmentDuration_ : 4.0);
+                        int64_t entryUs = std::llround(entryDuration * 1e6);
+                        if (liveEdge->fetchExcessUs() >= entryUs) {
+                            SPDLOG_LOGGER_DEBUG(log_, "Segment {} sauté avant téléchargement pour rattraper le direct",
+                                                entry.sequence);
+                            liveEdge->skipBeforeFetch(entryUs, 1);
+                            skippedBefore += entryDuration;
+                            previousWasDiscontinuity = true;
+                            nextSequence = entry.sequence + 1;
+                            continue;
+                        }
+                    }
+                    
+                    auto fetchStart = std::chrono::steady_clock::now();
+                    hls_to_dvb::SegmentTrace trace;
+                    trace.downloadStartUs = hls_to_dvb::SegmentTrace::nowUs();
+                    std::vector<uint8_t> buffer = pool ?
+                        pool->acquire(lastSegmentBytes_ + lastSegmentBytes_ / 4) : std::vector<uint8_t>();
+                    
+                    // Origines qui annoncent ce segment, la plus rapide en service d'abord
+                    std::vector<std::pair<size_t, std::string>> candidates;
+                    for (size_t origin : rankOrigins()) {
+                        const auto& originPlaylist = playlists[origin];
+                        if (originPlaylist && entry.sequence >= originPlaylist->mediaSequence &&
+                            entry.sequence <= originPlaylist->lastSequence()) {
+                            candidates.emplace_back(origin, originPlaylist->segments[
+                                static_cast<size_t>(entry.sequence - originPlaylist->mediaSequence)].url);
+                        }
+                    }
+                    
+                    auto race = std::make_shared<FetchRace>();
+                    race->loop = &loop;
+                    size_t nextCandidate = 0;
+                    deadline = bufferDeadline();
+                    startAttempt(race, candidates[nextCandidate].first, candidates[nextCandidate].second,
+                                 false, deadline, std::move(buffer));
+                    nextCandidate++;
+                    bool hedged = false;
+                    while (true) {
+                        if (race->pending == 0) {
+                            if (race->winner >= 0 || nextCandidate >= candidates.size()) {
+                                break;
+                            }
+                            // Bascule: le segment est demandé à l'origine suivante
+                            log_->warn("Segment {} indisponible sur {}, bascule vers {}", entry.sequence,
+                                       origins_[race->attempts.back().origin].url,
+                                       origins_[candidates[nextCandidate].first].url);
+                            startAttempt(race, candidates[nextCandidate].first, candidates[nextCandidate].second,
+                                         false, deadline, {});
+                            nextCandidate++;
+                            continue;
+                        }
+                        
+                        // Doublement: pas de premier octet dans le délai, l'origine suivante est aussi sollicitée
+                        std::chrono::milliseconds timeout(-1);
+                        const FetchAttempt& current = race->attempts.back();
+                        if (hedgeAfter_.count() > 0 && !hedged && race->winner < 0 &&
+                            nextCandidate < candidates.size() && current.progress->firstByteUs == 0) {
+                            int64_t remainingUs = hedgeAfter_.count() * 1000 -
+                                                  (hls_to_dvb::SegmentTrace::nowUs() - current.startUs);
+                            if (remainingUs <= 0) {
+                                SPDLOG_LOGGER_DEBUG(log_, "Segment {}: pas de réponse de {} après {} ms, doublement vers {}",
+                                                    entry.sequence, origins_[current.origin].url, hedgeAfter_.count(),
+                                                    origins_[candidates[nextCandidate].first].url);
+                                startAttempt(race, candidates[nextCandidate].first, candidates[nextCandidate].second,
+                                             true, deadline, {});
+                                nextCandidate++;
+                                hedged = true;
+                                continue;
+                            }
+                            timeout = std::chrono::milliseconds((remainingUs + 999) / 1000);
+                        }
+                        if (!co_await waitRace(race, cancel, timeout)) {
+                            cancelled = true;
+                            break;
+                        }
+                    }
+                    
+                    std::string segmentError;
+                    for (size_t i = 0; i < race->attempts.size(); ++i) {
+                        FetchAttempt& attempt = race->attempts[i];
+                        bool won = static_cast<int>(i) == race->winner;
+                        recordOriginResult(attempt.origin, attempt.response, attempt.startUs, attempt.hedge, won,
+                                           attempt.abandoned);
+                        if (!won) {
+                            if (!attempt.abandoned) {
+                                segmentError = origins_[attempt.origin].url + ": " + describeFailure(attempt.response);
+                            }
+                            if (pool) {
+                                pool->release(std::move(attempt.response.body));
+                            }
+                        }
+                    }
+                    if (cancelled || !running_) {
+                        break;
+                    }
+                    nextSequence = entry.sequence + 1;
+                    
+                    // Segment perdu sur toutes les origines: le suivant marque une discontinuité
+                    if (race->winner < 0) {
+                        reportFetchError("segment " + std::to_string(entry.sequence) + " (" + segmentError + ")");
+                        failed = true;
+                        break;
+                    }
+                    HttpResponse response = std::move(race->attempts[static_cast<size_t>(race->winner)].response);
+                    if (metrics) {
+                        metrics->fetchQueueSeconds->observe(static_cast<double>(response.queuedUs) / 1e6);
+                    }
+                    newSegments = true;
+                    lastSegmentBytes_ = response.body.size();
+                    
+                    // Premier segment après une erreur: la récupération est rétablie
+                    if (readBackoff_.isRecovering()) {
+                        double recoverySeconds = readBackoff_.succeed();
+                        if (metrics) {
+                            metrics->fetchRecoverySeconds->observe(recoverySeconds);
+                        }
+                        spdlog::info("Récupération HLS rétablie en {:.0f} ms pour {}",
+                                     recoverySeconds * 1000.0, streamInfo_.url);
+                    }
+                    
+                    if (metrics) {
+                        metrics->fetchSegments->increment();
+                        metrics->fetchBytes->increment(response.body.size());
+                        metrics->fetchSeconds->observe(std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - fetchStart).count());
+                    }
+                    
+                    HLSSegment segment;
+                    segment.data = std::move(response.body);
+                    segment.discontinuity = previousWasDiscontinuity || entry.discontinuity;
+                    segment.sequenceNumber = sequenceNumber++;
+                    segment.duration = entry.duration > 0.0 ? entry.duration :
+                                       (averageSegmentDuration_ > 0.0 ? averageSegmentDuration_ : 4.0);
+                    segment.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()
+                    ).count();
+                    segment.skippedBefore = skippedBefore;
+                    previousWasDiscontinuity = false;
+                    skippedBefore = 0.0;
+                    
+                    {
+                        std::lock_guard<std::mutex> durationsLock(durationsMutex_);
+                        if (newestSegmentSeenUs_ != 0 && newestSegmentSeenUs_ <= trace.downloadStartUs) {
+                            trace.playlistSeenUs = newestSegmentSeenUs_;
+                        }
+                    }
+                    trace.sequenceNumber = segment.sequenceNumber;
+                    trace.discontinuity = segment.discontinuity;
+                    trace.downloadEndUs = hls_to_dvb::SegmentTrace::nowUs();
+                    segment.trace = trace;
+                    
+                    enqueueSegment(std::move(segment));
+                }
+                
+                // Rechargement une durée cible après le précédent si la playlist a avancé,
+                // une demi-durée cible sinon (RFC 8216, 6.3.4)
+                double target = playlist.targetDuration > 0.0 ? playlist.targetDuration :
+                                (averageSegmentDuration_ > 0.0 ? averageSegmentDuration_ : 4.0);
+                auto reloadAt = playlistLoaded + std::chrono::milliseconds(
+                    static_cast<int64_t>((newSegments ? target : target / 2.0) * 1000.0));
+                reloadDelay = std::max(std::chrono::milliseconds(0),
+                    std::chrono::duration_cast<std::chrono::milliseconds>(reloadAt - std::chrono::steady_clock::now()));
+            }
+        }
+        catch (const std::exception& e) {
+            reportFetchError(std::string("exception dans la coroutine de récupération: ") + e.what());
+            failed = true;
+        }
+        if (cancelled) {
+            break;
+        }
+        
+        // Une erreur relance la playlist après un délai croissant, sans bloquer de thread
+        if (failed) {
+            previousWasDiscontinuity = true;
+            reloadDelay = readBackoff_.fail();
+            spdlog::warn("Nouvelle tentative de récupération HLS dans {} ms (tentative {}): {}",
+                         reloadDelay.count(), readBackoff_.getAttempts(), streamInfo_.url);
+        }
+        if (running_) {
+            co_await loop.sleepFor(reloadDelay, cancel);
+        }
+    }
+    
+    // Aucune requête de playlist ne survit à la coroutine
+    for (const auto& late : lateReloads) {
+        co_await drainRace(late);
+    }
+    
+    spdlog::info("Coroutine de récupération des segments HLS terminée");
+}
+
+void HLSClient::setupOrigins(bool httpOnly) {
+    std::shared_ptr<hls_to_dvb::StreamMetrics> metrics;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        metrics = metrics_;
+    }
+    
+    std::vector<std::string> urls = {streamInfo_.url};
+    
+    // Chemin de la variante relatif à l'entrée principale, reporté sur chaque origine
+    bool mapped = streamInfo_.url == url_;
+    std::string suffix;
+    if (!mapped) {
+        std::string base = url_.substr(0, url_.find_first_of("?#"));
+        base = base.substr(0, base.rfind('/') + 1);
+        if (streamInfo_.url.compare(0, base.size(), base) == 0) {
+            suffix = streamInfo_.url.substr(base.size());
+            mapped = true;
+        }
+    }
+    for (const auto& input : alternateInputs_) {
+        if (input == url_ || input.empty()) {
+            continue;
+        }
+        if (!mapped) {
+            spdlog::warn("Variante {} hors du répertoire de l'entrée principale, origine ignorée: {}",
+                         streamInfo_.url, input);
+            continue;
+        }
+        std::string url = suffix.empty() ? input : MediaPlaylist::resolve(input, suffix);
+        if (httpOnly && !HttpFetcher::supports(url)) {
+            spdlog::warn("Origine hors http:// ignorée par le runtime d'E/S: {}", url);
+            continue;
+        }
+        if (std::find(urls.begin(), urls.end(), url) == urls.end()) {
+            urls.push_back(url);
+            spdlog::info("Origine équivalente de {}: {}", streamInfo_.url, url);
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(originsMutex_);
+    origins_.clear();
+    activeOrigin_ = 0;
+    for (const auto& url : urls) {
+        OriginState state;
+        state.url = url;
+        if (metrics) {
+            // Étiquette: schéma et hôte de l'origine
+            size_t hostStart = url.find("://");
+            hostStart = hostStart == std::string::npos ? 0 : hostStart + 3;
+            std::string host = url.substr(0, url.find('/', hostStart));
+            const hls_to_dvb::MetricLabels labels = {{"stream", metrics->streamId}, {"origin", host}};
+            auto& registry = hls_to_dvb::MetricsRegistry::getInstance();
+            state.requestsTotal = registry.counter("hls2dvb_origin_requests_total",
+                "Requêtes HLS envoyées à l'origine", labels);
+            state.errorsTotal = registry.counter("hls2dvb_origin_errors_total",
+                "Requêtes HLS en échec auprès de l'origine", labels);
+            state.hedgesTotal = registry.counter("hls2dvb_origin_hedges_total",
+                "Requêtes de segments doublées vers l'origine", labels);
+            state.firstByteSeconds = registry.histogram("hls2dvb_origin_first_byte_seconds",
+                "Délai avant le premier octet des réponses de l'origine",
+                {0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.0}, labels);
+        }
+        origins_.push_back(std::move(state));
+    }
+}
 
+std::vector<size_t> HLSClient::rankOrigins() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(originsMutex_);
+    std::vector<size_t> ranked(origins_.size());
+    for (size_t i = 0; i < ranked.size(); ++i) {
+        ranked[i] = i;
+    }
+    // Origines écartées en dernier; un délai inconnu (0) passe devant pour être mesuré
+    std::stable_sort(ranked.begin(), ranked.end(), [&](size_t a, size_t b) {
+        bool aDown = origins_[a].consecutiveErrors > 0 && now < origins_[a].retryAfter;
+        bool bDown = origins_[b].consecutiveErrors > 0 && now < origins_[b].retryAfter;
+        if (aDown != bDown) {
+            return bDown;
+        }
+        return origins_[a].firstByteMs < origins_[b].firstByteMs;
+    });
+    return ranked;
+}
+
+void HLSClient::recordOriginResult(size_t origin, const HttpResponse& response, int64_t startUs,
+                                   bool hedge, bool won, bool abandoned) {
+    std::lock_guard<std::mutex> lock(originsMutex_);
+    OriginState& state = origins_[origin];
+    state.requests++;
+    if (state.requestsTotal) {
+        state.requestsTotal->increment();
+    }
+    if (hedge) {
+        state.hedges++;
+        if (state.hedgesTotal) {
+            state.hedgesTotal->increment();
+        }
+    }
+    
+    // Délai de premier octet, hors attente d'un créneau de l'origine
+    if (response.firstByteUs > 0) {
+        double firstByteMs = static_cast<double>(response.firstByteUs - startUs - response.queuedUs) / 1000.0;
+        firstByteMs = std::max(firstByteMs, 0.0);
+        state.firstByteMs = state.firstByteMs > 0.0 ? state.firstByteMs * 0.8 + firstByteMs * 0.2 : firstByteMs;
+        if (state.firstByteSeconds) {
+            state.firstByteSeconds->observe(firstByteMs / 1000.0);
+        }
+    }
+    
+    // Une requête annulée au profit d'une autre origine n'est ni un succès ni un échec
+    if (abandoned && !response.ok()) {
+        return;
+    }
+    
+    if (response.ok()) {
+        if (state.consecutiveErrors > 0) {
+            spdlog::info("Origine HLS rétablie: {}", state.url);
+        }
+        state.consecutiveErrors = 0;
+        if (won) {
+            state.wins++;
+            activeOrigin_ = origin;
+        }
+        return;
+    }
+    
+    state.errors++;
+    if (state.errorsTotal) {
+        state.errorsTotal->increment();
+    }
+    state.consecutiveErrors++;
+    auto delay = std::min(ORIGIN_RETRY_DELAY * (1 << std::min(state.consecutiveErrors - 1, 6)), ORIGIN_RETRY_MAX_DELAY);
+    state.retryAfter = std::chrono::steady_clock::now() + delay;
+    if (state.consecutiveErrors == 1) {
+        spdlog::warn("Origine HLS écartée pour {} ms: {} ({})", delay.count(), state.url, describeFailure(response));
+    }
+}
+
+std::string HLSClient::switchOrigin() {
+    std::lock_guard<std::mutex> lock(originsMutex_);
+    if (origins_.size() < 2) {
+        return streamInfo_.url;
+    }
+    
+    OriginState& failing = origins_[activeOrigin_];
+    failing.errors++;
+    failing.consecutiveErrors++;
+    if (failing.errorsTotal) {
+        failing.errorsTotal->increment();
+    }
+    
+    activeOrigin_ = (activeOrigin_ + 1) % origins_.size();
+    OriginState& next = origins_[activeOrigin_];
+    next.requests++;
+    if (next.requestsTotal) {
+        next.requestsTotal->increment();
+    }
+    spdlog::warn("Bascule de la lecture HLS de {} vers {}", failing.url, next.url);
+    return next.url;
+}
+
+void HLSClient::setAlternateInputs(const std::vector<std::string>& inputs) {
+    alternateInputs_ = inputs;
+}
+
+void HLSClient::setHedging(std::chrono::milliseconds hedgeAfter) {
+    hedgeAfter_ = hedgeAfter;
+}
+
+std::vector<HLSOriginStats> HLSClient::getOriginStats() const {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(originsMutex_);
+    std::vector<HLSOriginStats> stats;
+    stats.reserve(origins_.size());
+    for (size_t i = 0; i < origins_.size(); ++i) {
+        const OriginState& state = origins_[i];
+        HLSOriginStats entry;
+        entry.url = state.url;
+        entry.active = i == activeOrigin_;
+        entry.healthy = state.consecutiveErrors == 0 || now >= state.retryAfter;
+        entry.firstByteMs = state.firstByteMs;
+        entry.requests = state.requests;
+        entry.errors = state.errors;
+        entry.hedges = state.hedges;
+        entry.wins = state.wins;
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+std::chrono::steady_clock::time_point HLSClient::bufferDeadline() {
+    // Contenu déjà disponible: segments en file et profondeur du tampon en aval
+    double segmentDuration = averageSegmentDuration_ > 0.0 ? averageSegmentDuration_ : 4.0;
+    auto buffered = std::chrono::milliseconds(static_cast<int64_t>(queueSize() * segmentDuration * 1000.0));
+    if (bufferDepth_) {
+        buffered += std::chrono::milliseconds(bufferDepth_());
+    }
+    return std::chrono::steady_clock::now() + buffered;
+}
+
+size_t HLSClient::queueSize() {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return segmentQueue_.size();
+}
+
+bool HLSClient::reopenInputInternal() {
+    while (running_) {
+        auto delay = readBackoff_.fail();
+        spdlog::warn("Réouverture du flux HLS dans {} ms (tentative {}): {}",
+                     delay.count(), readBackoff_.getAttempts(), streamInfo_.url);
+        {
+            // stop() réveille l'attente: l'arrêt n'attend pas la fin du délai
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            if (queueCondVar_.wait_for(lock, delay, [this] { return !running_.load(); })) {
+                return false;
+            }
+        }
+        
+        if (formatContext_) {
+            avformat_close_input(&formatContext_);
+            formatContext_ = nullptr;
+        }
+        
+        // Avec des origines équivalentes, chaque réouverture passe à la suivante
+        std::string url = switchOrigin();
+        AVDictionary* options = createFFmpegOptions();
+        int ret = avformat_open_input(&formatContext_, url.c_str(), nullptr, &options);
+        av_dict_free(&options);
+        if (ret >= 0) {
+            ret = avformat_find_stream_info(formatContext_, nullptr);
+            if (ret >= 0) {
+                return true;
+            }
+            avformat_close_input(&formatContext_);
+            formatContext_ = nullptr;
+        }
+        
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        spdlog::error("Échec de la réouverture du flux HLS: {}", errbuf);
+    }
+    return false;
+}
+
+
+bool HLSClient::jumpToLiveEdgeInternal() {
+    std::shared_ptr<hls_to_dvb::LiveEdgeController> liveEdge;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        liveEdge = liveEdge_;
+    }
+    int64_t excessUs = liveEdge ? liveEdge->fetchExcessUs() : 0;
+    if (excessUs == 0) {
+        return false;
+    }
+    
+    double segmentSeconds;
+    {
+        std::lock_guard<std::mutex> lock(durationsMutex_);
+        segmentSeconds = averageSegmentDuration_ > 0.0 ? averageSegmentDuration_ : 4.0;
+    }
+    int64_t segmentUs = std::llround(segmentSeconds * 1e6);
+    
+    // Une réouverture coûte une nouvelle analyse du flux: en deçà, le rattrapage se fait après réception
+    if (excessUs < LIVE_JUMP_SEGMENTS * segmentUs) {
+        return false;
+    }
+    
+    // live_start_index compte depuis la fin de la playlist: départ à la latence cible
+    int64_t targetSegments = std::max<int64_t>(1, std::llround(liveEdge->getTargetMs() * 1000.0 / segmentUs));
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(originsMutex_);
+        url = origins_.empty() ? streamInfo_.url : origins_[activeOrigin_].url;
+    }
+    spdlog::info("Latence {} ms au-delà de la cible, réouverture de {} à {} segment(s) du direct",
+                 excessUs / 1000, url, targetSegments);
+    liveEdge->skipBeforeFetch(excessUs, static_cast<uint64_t>(excessUs / segmentUs));
+    
+    if (formatContext_) {
+        avformat_close_input(&formatContext_);
+        formatContext_ = nullptr;
+    }
+    AVDictionary* options = createFFmpegOptions();
+    av_dict_set(&options, "live_start_index", std::to_string(-targetSegments).c_str(), 0);
+    int ret = avformat_open_input(&formatContext_, url.c_str(), nullptr, &options);
+    av_dict_free(&options);
+    if (ret >= 0) {
+        ret = avformat_find_stream_info(formatContext_, nullptr);
+    }
+    if (ret < 0) {
+        if (formatContext_) {
+            avformat_close_input(&formatContext_);
+            formatContext_ = nullptr;
+        }
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        spdlog::error("Échec de la réouverture au direct de {}: {}", url, errbuf);
+        
+        // Même reprise qu'après une erreur de lecture (départ au dernier segment)
+        reopenInputInternal();
+    }
+    return true;
+}
 
 bool HLSClient::refreshPlaylist() {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -1963,7 +2937,12 @@ bool HLSClient::refreshPlaylist() {
     }
     
     try {
-        spdlog::info("Rafraîchissement de la playlist HLS: {}", streamInfo_.url);
+        // La coroutine de récupération recharge elle-même la playlist
+        if (fetchLoop_) {
+            return true;
+        }
+        
+        SPDLOG_LOGGER_DEBUG(log_, "Rafraîchissement de la playlist HLS: {}", streamInfo_.url);
         
         // Récupérer la playlist avec curl (plus fiable que FFmpeg pour ce cas d'usage)
         std::string playlistContent;
@@ -1990,36 +2969,19 @@ bool HLSClient::refreshPlaylist() {
 std::optional<HLSSegment> HLSClient::getNextSegment() {
     std::unique_lock<std::mutex> lock(queueMutex_);
     
-    // Ajoutez ce log pour voir si la méthode est appelée
-    static int callCount = 0;
-    spdlog::info("getNextSegment() appelé ({}), taille de la file: {}, thread running: {}", 
-               ++callCount, segmentQueue_.size(), running_ ? "oui" : "non");
-    
-    static int emptyCount = 0;
-    static auto lastLogTime = std::chrono::steady_clock::now();
-    
     if (segmentQueue_.empty()) {
-        // Ne pas spammer les logs, mais journaliser périodiquement
-        auto now = std::chrono::steady_clock::now();
-        if (++emptyCount % 10 == 0 || 
-            std::chrono::duration_cast<std::chrono::seconds>(now - lastLogTime).count() >= 5) {
-            spdlog::info("File d'attente des segments vide (appel #{}) - Thread running: {}, Segments traités: {}, Discontinuités: {}", 
-                       emptyCount, running_ ? "oui" : "non", segmentsProcessed_, discontinuitiesDetected_.load());
-            lastLogTime = now;
-        }
         return std::nullopt;
     }
-    
-    // Réinitialiser le compteur si un segment est trouvé
-    emptyCount = 0;
-    lastLogTime = std::chrono::steady_clock::now();
 
     // Prendre simplement le premier segment disponible (FIFO)
-    spdlog::info("getNextSegment() - Avant front()");
-    HLSSegment segment = segmentQueue_.front();
-    spdlog::info("getNextSegment() - Après front()");
+    HLSSegment segment = std::move(segmentQueue_.front());
     segmentQueue_.pop();
-    spdlog::info("getNextSegment() - Après pop()");
+    
+    // Le segment quitte la file: ses octets sont désormais comptés par l'étape suivante
+    queuedBytes_ -= segment.data.size();
+    if (bufferAccount_) {
+        bufferAccount_->release(BufferStage::HLS_QUEUE, segment.data.size());
+    }
     
     // Incrémenter le compteur de segments traités
     segmentsProcessed_++;
@@ -2029,9 +2991,10 @@ std::optional<HLSSegment> HLSClient::getNextSegment() {
         discontinuitiesDetected_++;
     }
     
-    spdlog::info("Segment {} récupéré, taille: {} octets, durée: {:.2f}s, discontinuité: {}", 
-               segment.sequenceNumber, segment.data.size(), segment.duration, 
-               segment.discontinuity ? "oui" : "non");
+    lock.unlock();
+    SPDLOG_LOGGER_DEBUG(log_, "Segment {} récupéré, taille: {} octets, durée: {:.2f}s, discontinuité: {}",
+                        segment.sequenceNumber, segment.data.size(), segment.duration,
+                        segment.discontinuity ? "oui" : "non");
     
     return segment;
 }
@@ -2205,16 +3168,138 @@ HLSClient::~HLSClient() {
     if (running_) {
         stop();
     }
+    clearSegmentQueue();
 }
 
-void HLSClient::stop() {
-    if (!running_) {
-        spdlog::warn("Le client HLS n'est pas en cours d'exécution");
-        return;
+void HLSClient::setDiagnostics(bool enabled) {
+    diagnostics_ = enabled;
+}
+
+void HLSClient::setBufferAccount(std::shared_ptr<hls_to_dvb::StreamBufferAccount> account) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    
+    // Transférer les octets déjà en file vers le nouveau compte
+    if (bufferAccount_) {
+        bufferAccount_->release(BufferStage::HLS_QUEUE, queuedBytes_);
+    }
+    bufferAccount_ = std::move(account);
+    if (bufferAccount_) {
+        bufferAccount_->add(BufferStage::HLS_QUEUE, queuedBytes_);
+    }
+}
+
+void HLSClient::setBufferPool(std::shared_ptr<hls_to_dvb::BufferPool> pool) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    bufferPool_ = std::move(pool);
+}
+
+void HLSClient::setMetrics(std::shared_ptr<hls_to_dvb::StreamMetrics> metrics) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    metrics_ = std::move(metrics);
+}
+
+void HLSClient::setLiveEdge(std::shared_ptr<hls_to_dvb::LiveEdgeController> liveEdge) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    liveEdge_ = std::move(liveEdge);
+}
+
+void HLSClient::setRuntime(std::shared_ptr<hls_to_dvb::IoRuntime> runtime) {
+    runtime_ = std::move(runtime);
+}
+
+void HLSClient::setBufferDepth(std::function<int()> depthMs) {
+    bufferDepth_ = std::move(depthMs);
+}
+
+void HLSClient::setRecovery(int initialDelayMs, int maxDelayMs, double jitter) {
+    readBackoff_ = hls_to_dvb::RecoveryBackoff(initialDelayMs, maxDelayMs, jitter);
+}
+
+void HLSClient::clearSegmentQueue() {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    
+    while (!segmentQueue_.empty()) {
+        segmentQueue_.pop();
     }
     
-    spdlog::info("Arrêt du client HLS");
+    if (bufferAccount_) {
+        bufferAccount_->release(BufferStage::HLS_QUEUE, queuedBytes_);
+    }
+    queuedBytes_ = 0;
+}
+
+void HLSClient::startFetchingInternal(bool useRuntime) {
+    running_ = true;
+    if (useRuntime) {
+        auto done = std::make_shared<std::promise<void>>();
+        fetchDone_ = done->get_future();
+        fetchCancel_ = std::make_shared<CancelToken>();
+        fetchLoop_ = &runtime_->nextLoop();
+        fetchLoop_->spawn(fetchCoroutine(*fetchLoop_), [done]() { done->set_value(); });
+        spdlog::info("Récupération de {} confiée au runtime d'E/S", streamInfo_.url);
+    } else {
+        fetchThread_ = std::thread(&HLSClient::fetchThreadFunc, this);
+    }
+}
+
+bool HLSClient::restart() {
+    // Aucune variante retenue: le démarrage complet la choisit
+    if (streamInfo_.url.empty()) {
+        start();
+        return running_;
+    }
     
+    if (running_) {
+        stopFetchingInternal();
+    }
+    spdlog::info("Relance de la récupération HLS sur la variante retenue: {}", streamInfo_.url);
+    
+    // La variante est relue seule: toujours servie, et toujours au format retenu au démarrage
+    std::string variantContent;
+    std::string changed;
+    if (!fetchHLSManifestWithCurl(streamInfo_.url, variantContent)) {
+        changed = "variante illisible";
+    } else {
+        MediaPlaylist variant = MediaPlaylist::parse(variantContent, streamInfo_.url);
+        if (variant.master) {
+            changed = "la variante est devenue une playlist principale";
+        } else if (useRuntime_ && (variant.encrypted || variant.fragmentedMp4 || variant.byteRange)) {
+            changed = "format de la variante modifié";
+        }
+    }
+    
+    // Lecture FFmpeg: même réouverture qu'après une erreur de lecture, puis contrôle de la composition
+    if (changed.empty() && !useRuntime_) {
+        AVDictionary* options = createFFmpegOptions();
+        int ret = avformat_open_input(&formatContext_, streamInfo_.url.c_str(), nullptr, &options);
+        av_dict_free(&options);
+        if (ret >= 0) {
+            ret = avformat_find_stream_info(formatContext_, nullptr);
+        }
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            changed = std::string("réouverture impossible (") + errbuf + ")";
+        } else if (codecLayout(formatContext_) != codecLayout_) {
+            changed = "composition du flux modifiée";
+        }
+        if (!changed.empty() && formatContext_) {
+            avformat_close_input(&formatContext_);
+            formatContext_ = nullptr;
+        }
+    }
+    
+    if (!changed.empty()) {
+        spdlog::warn("Relance de {} par un démarrage complet: {}", streamInfo_.url, changed);
+        start();
+        return running_;
+    }
+    
+    startFetchingInternal(useRuntime_);
+    return true;
+}
+
+void HLSClient::stopFetchingInternal() {
     // Arrêter le thread de récupération
     running_ = false;
     queueCondVar_.notify_all();
@@ -2223,19 +3308,32 @@ void HLSClient::stop() {
         fetchThread_.join();
     }
     
+    // Réveiller la coroutine (attente réseau ou temporisation) et attendre sa fin
+    if (fetchLoop_) {
+        fetchLoop_->cancel(fetchCancel_);
+        fetchDone_.wait();
+        fetchLoop_ = nullptr;
+        fetchCancel_.reset();
+    }
+    
     // Fermer le flux FFmpeg
     if (formatContext_) {
         avformat_close_input(&formatContext_);
         formatContext_ = nullptr;
     }
+}
+
+void HLSClient::stop() {
+    if (!running_) {
+        spdlog::warn("Le client HLS n'est pas en cours d'exécution");
+        return;
+    }
+    
+    spdlog::info("Arrêt du client HLS");
+    stopFetchingInternal();
     
     // Vider la file d'attente des segments
-    {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        while (!segmentQueue_.empty()) {
-            segmentQueue_.pop();
-        }
-    }
+    clearSegmentQueue();
     
     spdlog::info("Client HLS arrêté");
     
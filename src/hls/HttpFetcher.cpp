@@ -0,0 +1,765 @@
+#include "hls/HttpFetcher.h"
+#include "hls/MediaPlaylist.h"
+#include "core/SegmentTrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+  #include <arpa/inet.h>
+  #include <netdb.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <sys/epoll.h>
+  #include <sys/eventfd.h>
+  #include <sys/socket.h>
+  #include <unistd.h>
+#endif
+
+namespace hls_to_dvb {
+
+#ifdef __linux__
+
+namespace {
+    constexpr size_t MAX_HEADER_SIZE = 64 * 1024;   // En-têtes de réponse au-delà: réponse refusée
+    constexpr size_t READ_CHUNK_SIZE = 64 * 1024;   // Lecture d'un corps de longueur inconnue
+    constexpr size_t MAX_BODY_SIZE = 256 * 1024 * 1024; // Corps au-delà (segment ou liste): réponse refusée
+    constexpr int MAX_REDIRECTS = 5;
+
+    // Adresses résolues gardées en cache; les résolutions passent par des threads dédiés
+    constexpr auto DNS_CACHE_TTL = std::chrono::minutes(5);
+    constexpr int RESOLVER_THREADS = 2;
+
+    // Une connexion inactive plus longtemps est fermée plutôt que réutilisée: les serveurs
+    // ferment souvent les leurs au-delà de 15 à 60 s
+    constexpr auto IDLE_CONNECTION_TTL = std::chrono::seconds(10);
+
+    /**
+     * @brief Composants d'une URL http://
+     */
+    struct ParsedUrl {
+        std::string host;       ///< Nom ou adresse de l'origine
+        uint16_t port = 80;     ///< Port de l'origine
+        std::string authority;  ///< Valeur de l'en-tête Host
+        std::string target;     ///< Chemin et requête
+    };
+
+    bool parseUrl(const std::string& url, ParsedUrl& parsed) {
+        if (url.compare(0, 7, "http://") != 0) {
+            return false;
+        }
+        size_t pathStart = url.find_first_of("/?#", 7);
+        parsed.authority = url.substr(7, pathStart == std::string::npos ? std::string::npos : pathStart - 7);
+        parsed.target = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+        parsed.target = parsed.target.substr(0, parsed.target.find('#'));
+        if (parsed.target.empty() || parsed.target[0] != '/') {
+            parsed.target = "/" + parsed.target;
+        }
+
+        std::string hostPort = parsed.authority.substr(parsed.authority.find('@') + 1);
+        size_t colon = hostPort.rfind(':');
+        if (colon != std::string::npos && hostPort.find(']', colon) == std::string::npos) {
+            int port = std::atoi(hostPort.c_str() + colon + 1);
+            if (port <= 0 || port > 65535) {
+                return false;
+            }
+            parsed.port = static_cast<uint16_t>(port);
+            parsed.host = hostPort.substr(0, colon);
+        } else {
+            parsed.host = hostPort;
+        }
+        return !parsed.host.empty();
+    }
+
+    using Deadline = std::chrono::steady_clock::time_point;
+
+    /**
+     * @brief Temps restant avant l'échéance d'une requête (0 si elle est dépassée, -1 sans échéance)
+     */
+    std::chrono::milliseconds remaining(Deadline deadline) {
+        if (deadline == Deadline::max()) {
+            return std::chrono::milliseconds(-1);
+        }
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return std::max(left, std::chrono::milliseconds(0));
+    }
+
+    std::mutex dnsMutex;
+    std::map<std::string, std::pair<struct in_addr, std::chrono::steady_clock::time_point>> dnsCache;
+
+    bool cachedHost(const std::string& host, struct in_addr& address) {
+        std::lock_guard<std::mutex> lock(dnsMutex);
+        auto it = dnsCache.find(host);
+        if (it != dnsCache.end() && std::chrono::steady_clock::now() - it->second.second < DNS_CACHE_TTL) {
+            address = it->second.first;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Résolution partagée entre la coroutine qui l'attend et le thread qui l'exécute
+     *
+     * Le thread de résolution signale la fin sur un eventfd que la coroutine attend sur sa
+     * boucle. Une coroutine qui abandonne (échéance, annulation) laisse la résolution se
+     * terminer : son résultat alimente quand même le cache.
+     */
+    struct Resolution {
+        std::string host;               ///< Nom à résoudre
+        struct in_addr address{};       ///< Adresse obtenue
+        std::string error;              ///< Cause de l'échec
+        std::atomic<bool> done{false};  ///< Résolution terminée (address et error sont prêts)
+        bool resolved = false;          ///< Adresse obtenue
+        int eventFd = -1;               ///< Signalé à la fin de la résolution
+
+        ~Resolution() {
+            if (eventFd >= 0) {
+                close(eventFd);
+            }
+        }
+    };
+
+    /**
+     * @brief Threads de résolution: getaddrinfo() bloque et ne tourne jamais sur une boucle d'E/S
+     */
+    class Resolver {
+    public:
+        static Resolver& instance() {
+            static Resolver resolver;
+            return resolver;
+        }
+
+        void submit(std::shared_ptr<Resolution> resolution) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_.push_back(std::move(resolution));
+            }
+            condition_.notify_one();
+        }
+
+        ~Resolver() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            condition_.notify_all();
+            for (auto& thread : threads_) {
+                thread.join();
+            }
+        }
+
+    private:
+        Resolver() {
+            for (int i = 0; i < RESOLVER_THREADS; ++i) {
+                threads_.emplace_back(&Resolver::run, this);
+            }
+        }
+
+        void run() {
+            while (true) {
+                std::shared_ptr<Resolution> resolution;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    condition_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+                    if (pending_.empty()) {
+                        return;
+                    }
+                    resolution = std::move(pending_.front());
+                    pending_.pop_front();
+                }
+
+                struct addrinfo hints;
+                std::memset(&hints, 0, sizeof(hints));
+                hints.ai_family = AF_INET;
+                hints.ai_socktype = SOCK_STREAM;
+                struct addrinfo* result = nullptr;
+                int status = getaddrinfo(resolution->host.c_str(), nullptr, &hints, &result);
+                if (status != 0 || !result) {
+                    resolution->error = "résolution de " + resolution->host + " impossible: " + gai_strerror(status);
+                } else {
+                    resolution->address = reinterpret_cast<struct sockaddr_in*>(result->ai_addr)->sin_addr;
+                    resolution->resolved = true;
+                    freeaddrinfo(result);
+
+                    std::lock_guard<std::mutex> lock(dnsMutex);
+                    dnsCache[resolution->host] = {resolution->address, std::chrono::steady_clock::now()};
+                }
+                resolution->done.store(true, std::memory_order_release);
+
+                uint64_t one = 1;
+                ssize_t written = write(resolution->eventFd, &one, sizeof(one));
+                (void)written;
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::deque<std::shared_ptr<Resolution>> pending_;   ///< Résolutions en attente d'un thread
+        bool stopping_ = false;
+        std::vector<std::thread> threads_;
+    };
+
+    void forgetHost(const std::string& host) {
+        std::lock_guard<std::mutex> lock(dnsMutex);
+        dnsCache.erase(host);
+    }
+
+    const char* waitError(WaitResult result) {
+        switch (result) {
+            case WaitResult::TIMEOUT: return "délai dépassé";
+            case WaitResult::CANCELLED: return "requête annulée";
+            default: return "socket inutilisable";
+        }
+    }
+
+    /**
+     * @brief Résout le nom d'une origine sans bloquer la boucle (cache, puis thread de résolution)
+     */
+    Task<bool> resolveHost(IoLoop& loop, const std::string& host, struct in_addr& address, Deadline deadline,
+                           std::shared_ptr<CancelToken> cancel, std::string& error) {
+        if (cachedHost(host, address)) {
+            co_return true;
+        }
+
+        auto resolution = std::make_shared<Resolution>();
+        resolution->host = host;
+        resolution->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (resolution->eventFd < 0) {
+            error = std::string("eventfd: ") + strerror(errno);
+            co_return false;
+        }
+        Resolver::instance().submit(resolution);
+
+        WaitResult result = co_await loop.wait(resolution->eventFd, EPOLLIN, remaining(deadline), cancel);
+        if (result != WaitResult::READY || !resolution->done.load(std::memory_order_acquire)) {
+            error = "résolution de " + host + " impossible: " + waitError(result);
+            co_return false;
+        }
+        if (!resolution->resolved) {
+            error = resolution->error;
+            co_return false;
+        }
+        address = resolution->address;
+        co_return true;
+    }
+
+    /**
+     * @brief Socket fermé à la fin de la requête, sauf s'il est rendu à la réserve
+     */
+    struct Connection {
+        int fd = -1;
+        ~Connection() {
+            reset();
+        }
+        void reset() {
+            if (fd >= 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+    };
+
+    /**
+     * @brief Connexions persistantes inactives, par origine
+     */
+    struct IdlePool {
+        struct Idle {
+            int fd;                                         ///< Socket connecté
+            std::chrono::steady_clock::time_point since;    ///< Fin de la dernière réponse
+        };
+
+        std::mutex mutex;
+        std::map<std::string, std::vector<Idle>> idle;     ///< Connexions inactives par origine
+        size_t maxIdle = 8;                                 ///< Connexions gardées par origine
+    };
+
+    IdlePool& idlePool() {
+        static IdlePool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Reprend une connexion inactive encore ouverte vers une origine
+     * @return Socket, ou -1 si aucune connexion n'est disponible
+     */
+    int takeIdle(const std::string& key) {
+        IdlePool& pool = idlePool();
+        auto now = std::chrono::steady_clock::now();
+        std::vector<int> stale;
+        int fd = -1;
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            auto it = pool.idle.find(key);
+            // La plus récente d'abord: c'est la moins susceptible d'avoir été fermée
+            while (it != pool.idle.end() && !it->second.empty() && fd < 0) {
+                IdlePool::Idle candidate = it->second.back();
+                it->second.pop_back();
+
+                // Fermée par le serveur (0) ou données inattendues: inutilisable
+                uint8_t probe;
+                ssize_t count = recv(candidate.fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+                bool open = count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                if (open && now - candidate.since < IDLE_CONNECTION_TTL) {
+                    fd = candidate.fd;
+                } else {
+                    stale.push_back(candidate.fd);
+                }
+            }
+        }
+        for (int staleFd : stale) {
+            close(staleFd);
+        }
+        return fd;
+    }
+
+    /**
+     * @brief Rend une connexion à la réserve de son origine (ou la ferme si elle est pleine)
+     */
+    void giveIdle(const std::string& key, Connection& connection) {
+        IdlePool& pool = idlePool();
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            auto& idle = pool.idle[key];
+            if (idle.size() < pool.maxIdle) {
+                idle.push_back({connection.fd, std::chrono::steady_clock::now()});
+                connection.fd = -1;
+            }
+        }
+        connection.reset();
+    }
+
+    /**
+     * @brief Ouvre une nouvelle connexion TCP non bloquante vers une origine
+     */
+    Task<bool> connectTo(IoLoop& loop, const ParsedUrl& parsed, Connection& connection,
+                         Deadline deadline, std::shared_ptr<CancelToken> cancel, std::string& error) {
+        struct sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(parsed.port);
+        if (!co_await resolveHost(loop, parsed.host, address.sin_addr, deadline, cancel, error)) {
+            co_return false;
+        }
+
+        connection.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (connection.fd < 0) {
+            error = std::string("socket: ") + strerror(errno);
+            co_return false;
+        }
+        int noDelay = 1;
+        setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        // Connexion non bloquante: la fin est signalée par la disponibilité en écriture
+        if (connect(connection.fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+            if (errno != EINPROGRESS) {
+                error = "connexion à " + parsed.authority + " impossible: " + strerror(errno);
+                forgetHost(parsed.host);
+                co_return false;
+            }
+            WaitResult result = co_await loop.wait(connection.fd, EPOLLOUT, remaining(deadline), cancel);
+            int socketError = 0;
+            socklen_t length = sizeof(socketError);
+            getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &socketError, &length);
+            if (result != WaitResult::READY || socketError != 0) {
+                error = "connexion à " + parsed.authority + " impossible: " +
+                        (socketError != 0 ? strerror(socketError) : waitError(result));
+                forgetHost(parsed.host);
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+    /**
+     * @brief Lit des octets disponibles, en attendant le socket sur la boucle si besoin
+     * @return Octets lus, 0 à la fermeture de la connexion, -1 en cas d'erreur
+     */
+    Task<ssize_t> receive(IoLoop& loop, int fd, uint8_t* destination, size_t size,
+                          Deadline deadline, std::shared_ptr<CancelToken> cancel, std::string& error) {
+        while (true) {
+            ssize_t count = recv(fd, destination, size, 0);
+            if (count >= 0) {
+                co_return count;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                error = strerror(errno);
+                co_return -1;
+            }
+            WaitResult result = co_await loop.wait(fd, EPOLLIN, remaining(deadline), cancel);
+            if (result != WaitResult::READY) {
+                error = waitError(result);
+                co_return -1;
+            }
+        }
+    }
+
+    /**
+     * @brief Lit des octets à la suite d'un tampon
+     * @return Octets lus, 0 à la fermeture de la connexion, -1 en cas d'erreur
+     */
+    Task<ssize_t> receiveMore(IoLoop& loop, int fd, std::vector<uint8_t>& buffer,
+                              Deadline deadline, std::shared_ptr<CancelToken> cancel,
+                              std::string& error) {
+        size_t used = buffer.size();
+        buffer.resize(used + READ_CHUNK_SIZE);
+        ssize_t count = co_await receive(loop, fd, buffer.data() + used, READ_CHUNK_SIZE, deadline, cancel, error);
+        buffer.resize(used + static_cast<size_t>(std::max<ssize_t>(count, 0)));
+        co_return count;
+    }
+
+    /**
+     * @brief Envoie une requête complète
+     */
+    Task<bool> sendAll(IoLoop& loop, int fd, const std::string& data, Deadline deadline,
+                       std::shared_ptr<CancelToken> cancel, std::string& error) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (count > 0) {
+                sent += static_cast<size_t>(count);
+                continue;
+            }
+            if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                error = strerror(errno);
+                co_return false;
+            }
+            WaitResult result = co_await loop.wait(fd, EPOLLOUT, remaining(deadline), cancel);
+            if (result != WaitResult::READY) {
+                error = waitError(result);
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+    std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    size_t findPattern(const std::vector<uint8_t>& buffer, size_t from, const char* pattern, size_t length) {
+        if (buffer.size() < length || from > buffer.size() - length) {
+            return std::string::npos;
+        }
+        auto it = std::search(buffer.begin() + static_cast<std::ptrdiff_t>(from), buffer.end(),
+                              pattern, pattern + length);
+        return it == buffer.end() ? std::string::npos : static_cast<size_t>(it - buffer.begin());
+    }
+}
+
+bool HttpFetcher::supports(const std::string& url) {
+    ParsedUrl parsed;
+    return parseUrl(url, parsed);
+}
+
+std::string HttpFetcher::origin(const std::string& url) {
+    ParsedUrl parsed;
+    if (!parseUrl(url, parsed)) {
+        return "";
+    }
+    return parsed.host + ":" + std::to_string(parsed.port);
+}
+
+void HttpFetcher::setIdleConnections(size_t maxIdle) {
+    IdlePool& pool = idlePool();
+    std::vector<int> closed;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.maxIdle = maxIdle;
+        for (auto& [key, idle] : pool.idle) {
+            while (idle.size() > maxIdle) {
+                closed.push_back(idle.back().fd);
+                idle.pop_back();
+            }
+        }
+    }
+    for (int fd : closed) {
+        close(fd);
+    }
+}
+
+Task<HttpResponse> HttpFetcher::get(IoLoop& loop, std::string url, std::chrono::milliseconds timeout,
+                                    std::shared_ptr<CancelToken> cancel, std::vector<uint8_t> buffer,
+                                    std::shared_ptr<HttpProgress> progress) {
+    HttpResponse response;
+    response.body = std::move(buffer);
+
+    // Une seule échéance pour toute la requête: résolution, connexion, en-têtes, corps et redirections
+    Deadline deadline = timeout.count() < 0 ? Deadline::max() : std::chrono::steady_clock::now() + timeout;
+
+    for (int redirects = 0; ; ++redirects) {
+        response.status = 0;
+        response.body.clear();
+
+        ParsedUrl parsed;
+        if (!parseUrl(url, parsed)) {
+            response.error = "URL non prise en charge: " + url;
+            co_return response;
+        }
+
+        std::string key = parsed.host + ":" + std::to_string(parsed.port);
+        bool keepAlive;
+        {
+            std::lock_guard<std::mutex> lock(idlePool().mutex);
+            keepAlive = idlePool().maxIdle > 0;
+        }
+        std::string request = "GET " + parsed.target + " HTTP/1.1\r\n"
+                              "Host: " + parsed.authority + "\r\n"
+                              "User-Agent: hls-to-dvb\r\n"
+                              "Accept: */*\r\n" +
+                              std::string(keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+
+        // Envoi de la requête et premiers octets de la réponse. Une connexion réutilisée a pu
+        // être fermée par le serveur juste après la vérification: une nouvelle la remplace
+        Connection connection;
+        std::vector<uint8_t> input;
+        while (true) {
+            connection.fd = keepAlive ? takeIdle(key) : -1;
+            response.reused = connection.fd >= 0;
+            if (!response.reused &&
+                !co_await connectTo(loop, parsed, connection, deadline, cancel, response.error)) {
+                co_return response;
+            }
+
+            std::string error;
+            if (co_await sendAll(loop, connection.fd, request, deadline, cancel, error)) {
+                ssize_t count = co_await receiveMore(loop, connection.fd, input, deadline, cancel, error);
+                if (count > 0) {
+                    break;
+                }
+                if (count == 0) {
+                    error = "connexion fermée avant la réponse";
+                }
+            }
+            connection.reset();
+            if (!response.reused || (cancel && cancel->cancelled.load(std::memory_order_acquire))) {
+                response.error = error;
+                co_return response;
+            }
+        }
+        response.firstByteUs = SegmentTrace::nowUs();
+        if (progress) {
+            progress->firstByteUs = response.firstByteUs;
+        }
+
+        // En-têtes
+        size_t headerEnd = std::string::npos;
+        while ((headerEnd = findPattern(input, 0, "\r\n\r\n", 4)) == std::string::npos) {
+            if (input.size() > MAX_HEADER_SIZE) {
+                response.error = "en-têtes de réponse trop longs";
+                co_return response;
+            }
+            ssize_t count = co_await receiveMore(loop, connection.fd, input, deadline, cancel, response.error);
+            if (count <= 0) {
+                if (count == 0) {
+                    response.error = "connexion fermée avant la réponse";
+                }
+                co_return response;
+            }
+        }
+
+        std::string header(reinterpret_cast<const char*>(input.data()), headerEnd);
+        size_t lineEnd = header.find("\r\n");
+        std::string statusLine = header.substr(0, lineEnd);
+        size_t space = statusLine.find(' ');
+        if (statusLine.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+            response.error = "réponse HTTP invalide";
+            co_return response;
+        }
+        response.status = std::atoi(statusLine.c_str() + space + 1);
+
+        // HTTP/1.1 garde la connexion ouverte sauf "Connection: close"
+        bool persistent = keepAlive && statusLine.compare(0, 8, "HTTP/1.1") == 0;
+        std::string location;
+        bool chunked = false;
+        long long contentLength = -1;
+        size_t lineStart = lineEnd == std::string::npos ? header.size() : lineEnd + 2;
+        while (lineStart < header.size()) {
+            lineEnd = header.find("\r\n", lineStart);
+            if (lineEnd == std::string::npos) {
+                lineEnd = header.size();
+            }
+            std::string line = header.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 2;
+
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string name = toLower(line.substr(0, colon));
+            std::string value = line.substr(line.find_first_not_of(" \t", colon + 1) == std::string::npos ?
+                                            line.size() : line.find_first_not_of(" \t", colon + 1));
+            if (name == "content-length") {
+                contentLength = std::atoll(value.c_str());
+            } else if (name == "transfer-encoding") {
+                chunked = toLower(value).find("chunked") != std::string::npos;
+            } else if (name == "location") {
+                location = value;
+            } else if (name == "connection") {
+                persistent = persistent && toLower(value).find("close") == std::string::npos;
+            }
+        }
+
+        // Redirections
+        if ((response.status == 301 || response.status == 302 || response.status == 303 ||
+             response.status == 307 || response.status == 308) && !location.empty()) {
+            if (redirects >= MAX_REDIRECTS) {
+                response.error = "trop de redirections";
+                co_return response;
+            }
+            url = MediaPlaylist::resolve(url, location);
+            continue;
+        }
+
+        size_t position = headerEnd + 4;
+        if (response.status == 204 || response.status == 304) {
+            if (persistent && position == input.size()) {
+                giveIdle(key, connection);
+            }
+            co_return response;
+        }
+
+        if (chunked) {
+            // Corps découpé: taille hexadécimale, données, CRLF, jusqu'au bloc de taille nulle
+            while (true) {
+                size_t sizeEnd;
+                while ((sizeEnd = findPattern(input, position, "\r\n", 2)) == std::string::npos) {
+                    ssize_t count = co_await receiveMore(loop, connection.fd, input, deadline, cancel, response.error);
+                    if (count <= 0) {
+                        response.error = response.error.empty() ? "réponse tronquée" : response.error;
+                        co_return response;
+                    }
+                }
+                std::string sizeLine(reinterpret_cast<const char*>(input.data()) + position, sizeEnd - position);
+                char* sizeLast = nullptr;
+                errno = 0;
+                unsigned long long chunkSize = std::strtoull(sizeLine.c_str(), &sizeLast, 16);
+                if (sizeLast == sizeLine.c_str() || errno == ERANGE || chunkSize > MAX_BODY_SIZE ||
+                    response.body.size() + chunkSize > MAX_BODY_SIZE) {
+                    response.body.clear();
+                    response.error = "bloc de réponse invalide ou corps trop volumineux";
+                    co_return response;
+                }
+                position = sizeEnd + 2;
+                if (chunkSize == 0) {
+                    // En-têtes de fin éventuels, jusqu'à la ligne vide
+                    while (true) {
+                        size_t trailerEnd;
+                        while ((trailerEnd = findPattern(input, position, "\r\n", 2)) == std::string::npos) {
+                            ssize_t count = co_await receiveMore(loop, connection.fd, input, deadline, cancel,
+                                                                 response.error);
+                            if (count <= 0) {
+                                response.error = response.error.empty() ? "réponse tronquée" : response.error;
+                                co_return response;
+                            }
+                        }
+                        bool last = trailerEnd == position;
+                        position = trailerEnd + 2;
+                        if (last) {
+                            break;
+                        }
+                    }
+                    break;
+                }
+
+                while (input.size() - position < chunkSize + 2) {
+                    ssize_t count = co_await receiveMore(loop, connection.fd, input, deadline, cancel, response.error);
+                    if (count <= 0) {
+                        response.error = response.error.empty() ? "réponse tronquée" : response.error;
+                        co_return response;
+                    }
+                }
+                response.body.insert(response.body.end(), input.begin() + static_cast<std::ptrdiff_t>(position),
+                                     input.begin() + static_cast<std::ptrdiff_t>(position + chunkSize));
+                position += chunkSize + 2;
+
+                // Oublier les blocs déjà recopiés
+                if (position > READ_CHUNK_SIZE) {
+                    input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(position));
+                    position = 0;
+                }
+            }
+        } else if (contentLength >= 0) {
+            // Longueur connue: lecture directe dans le tampon du corps
+            if (static_cast<unsigned long long>(contentLength) > MAX_BODY_SIZE) {
+                response.error = "corps de réponse trop volumineux (" + std::to_string(contentLength) + " octets)";
+                co_return response;
+            }
+            size_t length = static_cast<size_t>(contentLength);
+            response.body.resize(length);
+            size_t filled = std::min(length, input.size() - position);
+            std::memcpy(response.body.data(), input.data() + position, filled);
+            while (filled < length) {
+                ssize_t count = co_await receive(loop, connection.fd, response.body.data() + filled, length - filled,
+                                                 deadline, cancel, response.error);
+                if (count <= 0) {
+                    response.body.resize(filled);
+                    response.error = response.error.empty() ? "réponse tronquée" : response.error;
+                    co_return response;
+                }
+                filled += static_cast<size_t>(count);
+            }
+            position = std::min(input.size(), position + length);
+        } else {
+            // Longueur inconnue: le corps se termine à la fermeture de la connexion
+            persistent = false;
+            response.body.assign(input.begin() + static_cast<std::ptrdiff_t>(position), input.end());
+            while (true) {
+                ssize_t count = co_await receiveMore(loop, connection.fd, response.body, deadline, cancel,
+                                                     response.error);
+                if (count == 0) {
+                    break;
+                }
+                if (count < 0) {
+                    co_return response;
+                }
+                if (response.body.size() > MAX_BODY_SIZE) {
+                    response.body.clear();
+                    response.error = "corps de réponse trop volumineux";
+                    co_return response;
+                }
+            }
+        }
+
+        // Réponse lue exactement jusqu'à sa fin: la connexion peut servir à la requête suivante
+        if (persistent && position == input.size()) {
+            giveIdle(key, connection);
+        }
+        co_return response;
+    }
+}
+
+#else
+
+bool HttpFetcher::supports(const std::string&) {
+    return false;
+}
+
+std::string HttpFetcher::origin(const std::string&) {
+    return "";
+}
+
+void HttpFetcher::setIdleConnections(size_t) {}
+
+Task<HttpResponse> HttpFetcher::get(IoLoop&, std::string url, std::chrono::milliseconds,
+                                    std::shared_ptr<CancelToken>, std::vector<uint8_t>,
+                                    std::shared_ptr<HttpProgress>) {
+    HttpResponse response;
+    response.error = "client HTTP non pris en charge sur cette plateforme: " + url;
+    co_return response;
+}
+
+#endif
+
+} // namespace hls_to_dvb
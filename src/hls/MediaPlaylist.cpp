@@ -0,0 +1,147 @@
+#include "hls/MediaPlaylist.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace hls_to_dvb {
+
+namespace {
+    bool startsWith(const std::string& text, const char* prefix) {
+        return text.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+    }
+
+    /**
+     * @brief Supprime les segments "." et ".." d'un chemin absolu
+     */
+    std::string removeDotSegments(const std::string& path) {
+        std::vector<std::string> parts;
+        size_t start = 1;
+        while (start <= path.size()) {
+            size_t end = path.find('/', start);
+            if (end == std::string::npos) {
+                end = path.size();
+            }
+            std::string part = path.substr(start, end - start);
+            if (part == "..") {
+                if (!parts.empty()) {
+                    parts.pop_back();
+                }
+                if (end == path.size()) {
+                    parts.push_back("");
+                }
+            } else if (part == ".") {
+                if (end == path.size()) {
+                    parts.push_back("");
+                }
+            } else {
+                parts.push_back(part);
+            }
+            start = end + 1;
+        }
+
+        std::string result;
+        for (const auto& part : parts) {
+            result += "/" + part;
+        }
+        return result.empty() ? "/" : result;
+    }
+}
+
+std::string MediaPlaylist::resolve(const std::string& baseUrl, const std::string& reference) {
+    if (reference.find("://") != std::string::npos) {
+        return reference;
+    }
+
+    size_t schemeEnd = baseUrl.find("://");
+    if (schemeEnd == std::string::npos) {
+        return reference;
+    }
+    if (startsWith(reference, "//")) {
+        return baseUrl.substr(0, schemeEnd + 1) + reference;
+    }
+
+    // Origine (schéma et autorité) et chemin de la base, sans requête ni fragment
+    size_t pathStart = baseUrl.find('/', schemeEnd + 3);
+    std::string origin = pathStart == std::string::npos ? baseUrl : baseUrl.substr(0, pathStart);
+    std::string basePath = pathStart == std::string::npos ? "/" : baseUrl.substr(pathStart);
+    basePath = basePath.substr(0, basePath.find_first_of("?#"));
+
+    if (reference.empty()) {
+        return origin + basePath;
+    }
+    if (reference[0] == '?') {
+        return origin + basePath + reference;
+    }
+
+    // Le chemin de la référence est normalisé, sa requête est conservée telle quelle
+    size_t queryStart = reference.find_first_of("?#");
+    std::string referencePath = reference.substr(0, queryStart);
+    std::string query = queryStart == std::string::npos ? "" : reference.substr(queryStart);
+
+    std::string path = referencePath[0] == '/' ?
+        referencePath : basePath.substr(0, basePath.find_last_of('/') + 1) + referencePath;
+    return origin + removeDotSegments(path) + query;
+}
+
+MediaPlaylist MediaPlaylist::parse(const std::string& content, const std::string& baseUrl) {
+    MediaPlaylist playlist;
+    std::istringstream stream(content);
+    std::string line;
+    double duration = 0.0;
+    bool discontinuity = false;
+    bool sequenceSet = false;
+
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line[0] != '#') {
+            Segment segment;
+            segment.url = resolve(baseUrl, line);
+            segment.duration = duration;
+            segment.sequence = playlist.mediaSequence + static_cast<int64_t>(playlist.segments.size());
+            segment.discontinuity = discontinuity;
+            playlist.segments.push_back(std::move(segment));
+            duration = 0.0;
+            discontinuity = false;
+            continue;
+        }
+
+        try {
+            if (startsWith(line, "#EXTINF:")) {
+                duration = std::stod(line.substr(8, line.find(',') - 8));
+            } else if (startsWith(line, "#EXT-X-MEDIA-SEQUENCE:") && !sequenceSet) {
+                playlist.mediaSequence = std::stoll(line.substr(22));
+                sequenceSet = true;
+            } else if (startsWith(line, "#EXT-X-TARGETDURATION:")) {
+                playlist.targetDuration = std::stod(line.substr(22));
+            } else if (startsWith(line, "#EXT-X-DISCONTINUITY") && !startsWith(line, "#EXT-X-DISCONTINUITY-SEQUENCE")) {
+                discontinuity = true;
+            } else if (startsWith(line, "#EXT-X-ENDLIST")) {
+                playlist.endList = true;
+            } else if (startsWith(line, "#EXT-X-KEY:")) {
+                playlist.encrypted = playlist.encrypted || line.find("METHOD=NONE") == std::string::npos;
+            } else if (startsWith(line, "#EXT-X-MAP:")) {
+                playlist.fragmentedMp4 = true;
+            } else if (startsWith(line, "#EXT-X-BYTERANGE:")) {
+                playlist.byteRange = true;
+            } else if (startsWith(line, "#EXT-X-STREAM-INF:")) {
+                playlist.master = true;
+            }
+        } catch (const std::exception&) {
+            // Valeur illisible: la directive est ignorée
+        }
+    }
+
+    return playlist;
+}
+
+int64_t MediaPlaylist::lastSequence() const {
+    return mediaSequence + static_cast<int64_t>(segments.size()) - 1;
+}
+
+} // namespace hls_to_dvb
@@ -10,6 +10,7 @@
 #include <spdlog/sinks/rotating_file_sink.h>
 
 #include "core/config.h"
+#include "core/Logging.h"
 #include "core/StreamManager.h"
 #include "alerting/AlertManager.h"
 #include "web/WebServer.h"
@@ -177,20 +178,12 @@ bool testHLSUrl(const std::string& url) {
     return isHLS;
 }
 
-// Point d'entrée principal
-int main(int argc, char* argv[]) {
-    // Vérifier les arguments
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <config_file>" << std::endl;
-        return 1;
-    }
-    
-    std::string configFile = argv[1];
-    
-    // Configurer le gestionnaire de signaux
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
-    
+/**
+ * @brief Exécute l'application jusqu'à sa demande d'arrêt
+ * @param configFile Fichier de configuration
+ * @return Code de sortie du processus
+ */
+static int run(const std::string& configFile) {
     try {
         // S'assurer que le répertoire logs existe
         std::filesystem::create_directories("logs");
@@ -232,6 +225,9 @@ int main(int argc, char* argv[]) {
         }
         spdlog::info("Configuration chargée avec succès");
 
+        // Remplacer le logger de démarrage par le logger asynchrone configuré
+        Logging::initialize(config.getLoggingConfig());
+
         // Vérifier les flux configurés
         auto streamConfigs = config.getStreamConfigs();
         if (streamConfigs.empty()) {
@@ -271,17 +267,6 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        const auto& loggingConfig = config.getLoggingConfig();
-        if (loggingConfig.level == "debug") {
-            spdlog::set_level(spdlog::level::debug);
-        } else if (loggingConfig.level == "info") {
-            spdlog::set_level(spdlog::level::info);
-        } else if (loggingConfig.level == "warning") {
-            spdlog::set_level(spdlog::level::warn);
-        } else if (loggingConfig.level == "error") {
-            spdlog::set_level(spdlog::level::err);
-        }
-
         // Initialiser le gestionnaire d'alertes
         const auto& alertsConfig = config.getAlertRetention();
         
@@ -366,4 +351,24 @@ int main(int argc, char* argv[]) {
         std::cerr << "Exception non gérée: " << e.what() << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
+
+// Point d'entrée principal
+int main(int argc, char* argv[]) {
+    // Vérifier les arguments
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <config_file>" << std::endl;
+        return 1;
+    }
+    
+    // Configurer le gestionnaire de signaux
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+    
+    // Les composants sont détruits à la sortie de run(): leurs derniers messages sont déjà
+    // en file. Traiter les alertes restantes puis vider la file du logger asynchrone
+    int result = run(argv[1]);
+    AlertManager::getInstance().flush();
+    spdlog::shutdown();
+    return result;
+}
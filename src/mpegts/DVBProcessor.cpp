@@ -3,6 +3,7 @@
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
 #include <iostream>
 // Utilisation de TSDuck pour manipuler les tables DVB
 #include <tsduck/tsduck.h>
@@ -132,6 +133,40 @@ void DVBProcessor::cleanup() {
     services_.clear();
 }
 
+DVBTableVersions DVBProcessor::getTableVersions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    DVBTableVersions versions;
+    versions.pat = versionPAT_;
+    versions.sdt = versionSDT_;
+    versions.eit = versionEIT_;
+    versions.nit = versionNIT_;
+    versions.pmt = versionPMT_;
+    return versions;
+}
+
+void DVBProcessor::setTableVersions(const DVBTableVersions& versions) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    versionPAT_ = versions.pat % 32;
+    versionSDT_ = versions.sdt % 32;
+    versionEIT_ = versions.eit % 32;
+    versionNIT_ = versions.nit % 32;
+    
+    if (pat_) pat_->version = versionPAT_;
+    if (sdt_) sdt_->version = versionSDT_;
+    if (eit_) eit_->version = versionEIT_;
+    if (nit_) nit_->version = versionNIT_;
+    
+    for (auto& [serviceId, pmt] : pmts_) {
+        auto it = versions.pmt.find(serviceId);
+        if (it != versions.pmt.end()) {
+            versionPMT_[serviceId] = it->second % 32;
+            pmt->version = versionPMT_[serviceId];
+        }
+    }
+}
+
 std::vector<uint8_t> DVBProcessor::updatePSITables(const std::vector<uint8_t>& data, bool discontinuity) {
     try {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -446,6 +481,11 @@ bool DVBProcessor::removeService(uint16_t serviceId) {
     return true;
 }
 
+void DVBProcessor::setBufferPool(std::shared_ptr<hls_to_dvb::BufferPool> pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bufferPool_ = std::move(pool);
+}
+
 std::vector<DVBService> DVBProcessor::getServices() const {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -871,12 +911,9 @@ std::vector<uint8_t> DVBProcessor::insertTables(const std::vector<uint8_t>& data
     }
     
     try {
-        // Utiliser les fonctionnalités de TSDuck pour un traitement plus robuste
-        ts::TSPacketVector packets;
-        
-        // Convertir les données en paquets TS
+        // Les paquets sont recopiés directement dans le tampon de sortie, sans
+        // passer par des vecteurs de paquets intermédiaires
         size_t packetCount = data.size() / ts::PKT_SIZE;
-        packets.reserve(packetCount);
         
         // Identifier les PID des tables à remplacer
         std::set<uint16_t> tablePids;
@@ -884,16 +921,16 @@ std::vector<uint8_t> DVBProcessor::insertTables(const std::vector<uint8_t>& data
             tablePids.insert(pid);
         }
         
-        // Charger les paquets tout en filtrant les tables PSI existantes
+        auto packetPid = [&data](size_t index) -> uint16_t {
+            const uint8_t* packet = &data[index * ts::PKT_SIZE];
+            return static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+        };
+        
+        // Compter les paquets conservés (les PID des tables insérées sont filtrés)
+        size_t keptCount = 0;
         for (size_t i = 0; i < packetCount; ++i) {
-            ts::TSPacket packet;
-            std::memcpy(packet.b, &data[i * ts::PKT_SIZE], ts::PKT_SIZE);
-            
-            uint16_t pid = packet.getPID();
-            
-            // Ne pas ajouter les paquets avec les PID des tables qu'on va insérer
-            if (tablePids.find(pid) == tablePids.end()) {
-                packets.push_back(packet);
+            if (tablePids.find(packetPid(i)) == tablePids.end()) {
+                keptCount++;
             }
         }
         
@@ -901,19 +938,15 @@ std::vector<uint8_t> DVBProcessor::insertTables(const std::vector<uint8_t>& data
         const std::vector<uint16_t> psiOrder = {0x0000, 0x0010, 0x0011, 0x0012};
         
         // Préparer les tables PSI dans le bon ordre
-        ts::TSPacketVector psiPackets;
+        std::vector<const std::vector<uint8_t>*> psiTables;
+        size_t psiPacketCount = 0;
         
         // D'abord ajouter les tables PSI standard
         for (uint16_t pid : psiOrder) {
             auto it = tables.find(pid);
             if (it != tables.end() && !it->second.empty()) {
-                // Convertir ces données en paquets
-                size_t tablePacketCount = it->second.size() / ts::PKT_SIZE;
-                for (size_t i = 0; i < tablePacketCount; ++i) {
-                    ts::TSPacket packet;
-                    std::memcpy(packet.b, &it->second[i * ts::PKT_SIZE], ts::PKT_SIZE);
-                    psiPackets.push_back(packet);
-                }
+                psiTables.push_back(&it->second);
+                psiPacketCount += it->second.size() / ts::PKT_SIZE;
             }
         }
         
@@ -925,62 +958,57 @@ std::vector<uint8_t> DVBProcessor::insertTables(const std::vector<uint8_t>& data
             }
             
             if (!tableData.empty()) {
-                size_t tablePacketCount = tableData.size() / ts::PKT_SIZE;
-                for (size_t i = 0; i < tablePacketCount; ++i) {
-                    ts::TSPacket packet;
-                    std::memcpy(packet.b, &tableData[i * ts::PKT_SIZE], ts::PKT_SIZE);
-                    psiPackets.push_back(packet);
-                }
+                psiTables.push_back(&tableData);
+                psiPacketCount += tableData.size() / ts::PKT_SIZE;
             }
         }
         
-        // Utiliser TSMerger pour intégrer les tables PSI de manière optimale
-        ts::TSPacketVector resultPackets;
-        resultPackets.reserve(packets.size() + psiPackets.size());
-        
-        // Insérer les tables PSI au début du flux
-        resultPackets.insert(resultPackets.end(), psiPackets.begin(), psiPackets.end());
-        
         // Calculer le rapport d'insertion pour répéter les tables
-        size_t insertionRatio = packets.size() / (psiPackets.size() * 2);
+        size_t insertionRatio = keptCount / std::max<size_t>(1, psiPacketCount * 2);
         if (insertionRatio < 50) insertionRatio = 50; // Au moins tous les 50 paquets
         
-        // Ajouter les paquets originaux et répéter les tables PSI selon le ratio
-        for (size_t i = 0; i < packets.size(); ++i) {
-            resultPackets.push_back(packets[i]);
-            
-            // Tous les 'insertionRatio' paquets, ajouter à nouveau les tables importantes
-            if (i > 0 && i % insertionRatio == 0) {
-                // Ajouter seulement PAT et PMT pour ne pas trop surcharger
-                for (uint16_t pid : {(uint16_t)0x0000}) {
-                    auto it = tables.find(pid);
-                    if (it != tables.end() && !it->second.empty()) {
-                        // Ajouter seulement le premier paquet de chaque table
-                        ts::TSPacket packet;
-                        std::memcpy(packet.b, &it->second[0], ts::PKT_SIZE);
-                        resultPackets.push_back(packet);
-                    }
-                }
-                
-                // Ajouter une PMT pour chaque service
-                for (const auto& [serviceId, service] : services_) {
-                    auto it = tables.find(service.pmtPid);
-                    if (it != tables.end() && !it->second.empty()) {
-                        // Ajouter seulement le premier paquet de la PMT
-                        ts::TSPacket packet;
-                        std::memcpy(packet.b, &it->second[0], ts::PKT_SIZE);
-                        resultPackets.push_back(packet);
-                    }
-                }
+        // Paquets répétés: premier paquet de la PAT puis de chaque PMT
+        std::vector<const uint8_t*> repeatedPackets;
+        auto patIt = tables.find(0x0000);
+        if (patIt != tables.end() && patIt->second.size() >= ts::PKT_SIZE) {
+            repeatedPackets.push_back(patIt->second.data());
+        }
+        for (const auto& [serviceId, service] : services_) {
+            auto it = tables.find(service.pmtPid);
+            if (it != tables.end() && it->second.size() >= ts::PKT_SIZE) {
+                repeatedPackets.push_back(it->second.data());
             }
         }
         
-        // Convertir les paquets en vecteur d'octets
-        std::vector<uint8_t> result;
-        result.reserve(resultPackets.size() * ts::PKT_SIZE);
+        // Emprunter un tampon de sortie dimensionné pour l'ensemble du segment
+        size_t repetitions = keptCount / insertionRatio + 1;
+        size_t outputSize = (psiPacketCount + keptCount + repetitions * repeatedPackets.size()) * ts::PKT_SIZE;
+        std::vector<uint8_t> result = bufferPool_ ? bufferPool_->acquire(outputSize) : std::vector<uint8_t>();
+        result.reserve(outputSize);
         
-        for (const auto& packet : resultPackets) {
-            result.insert(result.end(), packet.b, packet.b + ts::PKT_SIZE);
+        // Insérer les tables PSI au début du flux
+        for (const auto* table : psiTables) {
+            size_t tableBytes = (table->size() / ts::PKT_SIZE) * ts::PKT_SIZE;
+            result.insert(result.end(), table->begin(), table->begin() + tableBytes);
+        }
+        
+        // Ajouter les paquets originaux et répéter les tables PSI selon le ratio
+        size_t keptIndex = 0;
+        for (size_t i = 0; i < packetCount; ++i) {
+            if (tablePids.find(packetPid(i)) != tablePids.end()) {
+                continue;
+            }
+            
+            const uint8_t* packet = &data[i * ts::PKT_SIZE];
+            result.insert(result.end(), packet, packet + ts::PKT_SIZE);
+            
+            // Tous les 'insertionRatio' paquets, ajouter à nouveau la PAT et les PMT
+            if (keptIndex > 0 && keptIndex % insertionRatio == 0) {
+                for (const uint8_t* repeated : repeatedPackets) {
+                    result.insert(result.end(), repeated, repeated + ts::PKT_SIZE);
+                }
+            }
+            keptIndex++;
         }
         
         return result;
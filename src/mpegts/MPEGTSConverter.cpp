@@ -2,14 +2,56 @@
 #include "mpegts/DVBProcessor.h"
 #include "alerting/AlertManager.h"  
 #include "spdlog/spdlog.h"
+#include <algorithm>
 
 // Utilisation de TSDuck pour manipuler les paquets MPEG-TS
 #include <tsduck/tsduck.h>
 
 using namespace hls_to_dvb;
 
+namespace {
+
+constexpr uint16_t PID_PAT = 0x0000;
+constexpr uint16_t PID_SDT = 0x0011;
+constexpr uint16_t PID_NULL = 0x1FFF;
+constexpr uint8_t AF_DISCONTINUITY = 0x80;              // discontinuity_indicator du champ d'adaptation
+constexpr uint64_t PCR_MODULO = (1ULL << 33) * 300;    // Rebouclage du PCR (33 bits de base x 300)
+constexpr uint64_t PCR_MAX_GAP = 27000000;              // Écart maximal accepté entre deux PCR (1 s)
+constexpr size_t PID_COUNT = 0x2000;                     // Nombre de PID possibles (13 bits)
+constexpr int PASSTHROUGH_REARM_SEGMENTS = 10;          // Segments conformes consécutifs avant la reprise du passthrough
+
+/**
+ * @brief Calcule le CRC32 MPEG-2 d'une section PSI
+ * @param data Début de la section
+ * @param size Taille couverte par le CRC
+ * @return CRC32 (0 lorsque le CRC final de la section est inclus et correct)
+ */
+uint32_t crc32Mpeg(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint32_t>(data[i]) << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+} // namespace
+
+struct MPEGTSConverter::PassthroughPidState {
+    uint8_t cc = 0;                 ///< Dernier compteur de continuité
+    bool counterKnown = false;      ///< Compteur connu (segment précédent ou paquet précédent)
+    bool duplicateSeen = false;     ///< Paquet dupliqué déjà toléré
+    bool seen = false;              ///< PID déjà rencontré dans le segment
+    bool sectionStart = false;      ///< Une section PSI commence dans le segment
+};
+
 MPEGTSConverter::MPEGTSConverter()
-    : running_(false), lastPcrValue_(0), pcrPid_(0x1FFF) {
+    : running_(false), lastPcrValue_(0), pcrPid_(0x1FFF),
+      passthroughEnabled_(false), passthroughActive_(false), passthroughSegments_(0),
+      passthroughPids_(PID_COUNT),
+      log_(hls_to_dvb::Logging::get("MPEGTSConverter")) {
     
     // Initialiser les compteurs de continuité
     resetContinuityCounters();
@@ -18,13 +60,12 @@ MPEGTSConverter::MPEGTSConverter()
 void MPEGTSConverter::resetContinuityCountersInternal() {
     //std::lock_guard<std::mutex> lock(mutex_);
     continuityCounters_.clear();
-    spdlog::info("**** MPEGTSConverter::resetContinuityCountersInternal() **** Réinitialisation des compteurs de continuité");
+    SPDLOG_LOGGER_DEBUG(log_, "Réinitialisation des compteurs de continuité");
 }
 
 void MPEGTSConverter::resetContinuityCounters() {
     std::lock_guard<std::mutex> lock(mutex_);
     resetContinuityCountersInternal();
-    spdlog::info("**** MPEGTSConverter::resetContinuityCounters() **** Réinitialisation des compteurs de continuité");
 }
 
 void MPEGTSConverter::start() {
@@ -35,20 +76,30 @@ void MPEGTSConverter::start() {
         return;
     }
     
-    spdlog::info("**** MPEGTSConverter::start() **** Démarrage du convertisseur MPEG-TS");
+    spdlog::info("Démarrage du convertisseur MPEG-TS");
     
     try {
         // Initialiser le processeur DVB
         dvbProcessor_ = std::make_unique<DVBProcessor>();
+        dvbProcessor_->setBufferPool(bufferPool_);
         dvbProcessor_->initialize();
-        spdlog::info("**** MPEGTSConverter::start() **** DVBProcessor initialisé avec succès");
         
         // Réinitialiser les variables d'état
         lastPcrValue_ = 0;
         pcrPid_ = 0x1FFF; // Valeur invalide par défaut
-        spdlog::info("**** MPEGTSConverter::start() **** Réinitialisation des variables d'état");
         resetContinuityCountersInternal();
-        spdlog::info("**** MPEGTSConverter::start() **** Réinitialisation des compteurs de continuité");
+        
+        // Reprendre l'état de sortie de l'exécution précédente, s'il a été sauvegardé
+        restoreStateInternal();
+        
+        // Un redémarrage redonne sa chance au mode passthrough
+        pmtPids_.clear();
+        sourceCounters_.clear();
+        passthroughCleanSegments_ = 0;
+        passthroughActive_ = passthroughEnabled_;
+        if (passthroughEnabled_) {
+            spdlog::info("Mode passthrough activé: les segments conformes seront transmis sans réécriture");
+        }
         
         running_ = true;
         
@@ -59,7 +110,7 @@ void MPEGTSConverter::start() {
             false
         );
         
-        spdlog::info("**** MPEGTSConverter::start() **** Convertisseur MPEG-TS démarré avec succès");
+        spdlog::info("Convertisseur MPEG-TS démarré avec succès");
     }
     catch (const ts::Exception& e) {
         spdlog::error("Erreur TSDuck lors du démarrage du convertisseur MPEG-TS: {}", e.what());
@@ -115,24 +166,102 @@ void MPEGTSConverter::stop() {
 
 std::optional<MPEGTSSegment> MPEGTSConverter::convert(const HLSSegment& hlsSegment) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+    return convertInternal(hlsSegment, nullptr);
+}
+
+std::optional<MPEGTSSegment> MPEGTSConverter::convert(HLSSegment&& hlsSegment) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return convertInternal(hlsSegment, &hlsSegment.data);
+}
+
+std::optional<MPEGTSSegment> MPEGTSConverter::convertInternal(const HLSSegment& hlsSegment,
+                                                             std::vector<uint8_t>* movableData) {
     if (!running_ || !dvbProcessor_) {
         spdlog::error("Le convertisseur MPEG-TS n'est pas démarré");
         return std::nullopt;
     }
     
     try {
-        spdlog::debug("Conversion du segment HLS {} en MPEG-TS (discontinuité: {})",
-                    hlsSegment.sequenceNumber, hlsSegment.discontinuity ? "oui" : "non");
+        SPDLOG_LOGGER_DEBUG(log_, "Conversion du segment HLS {} en MPEG-TS (discontinuité: {})",
+                            hlsSegment.sequenceNumber, hlsSegment.discontinuity ? "oui" : "non");
+        
+        // Mode passthrough: un segment déjà conforme est transmis sans réécriture. Après un
+        // repli, les segments restent contrôlés pour reprendre le passthrough
+        bool rearmed = false;
+        bool passthrough = false;
+        if (passthroughEnabled_) {
+            std::string reason;
+            bool valid = validatePassthroughInternal(hlsSegment.data, hlsSegment.discontinuity, reason);
+            if (passthroughActive_ && !valid) {
+                // Anomalie: ce segment et les suivants sont convertis jusqu'à la reprise
+                passthroughActive_ = false;
+                passthroughCleanSegments_ = 0;
+                {
+                    std::lock_guard<std::mutex> reasonLock(reasonMutex_);
+                    passthroughFallbackReason_ = reason;
+                }
+                
+                std::string message = "Passthrough suspendu au segment " + std::to_string(hlsSegment.sequenceNumber) +
+                                      ": " + reason + ", conversion complète jusqu'à " +
+                                      std::to_string(PASSTHROUGH_REARM_SEGMENTS) + " segments conformes";
+                spdlog::warn(message);
+                AlertManager::getInstance().addAlert(AlertLevel::WARNING, "MPEGTSConverter", message, false);
+            } else if (!passthroughActive_ && valid && ++passthroughCleanSegments_ >= PASSTHROUGH_REARM_SEGMENTS) {
+                passthroughActive_ = true;
+                rearmed = true;
+                spdlog::info("Passthrough repris au segment {} après {} segments conformes",
+                             hlsSegment.sequenceNumber, passthroughCleanSegments_);
+            } else if (!valid) {
+                passthroughCleanSegments_ = 0;
+            }
+            passthrough = passthroughActive_ && valid;
+        }
+        
+        if (passthrough) {
+            {
+                MPEGTSSegment mpegtsSegment;
+                if (movableData) {
+                    mpegtsSegment.data = std::move(*movableData);
+                } else {
+                    mpegtsSegment.data = bufferPool_ ? bufferPool_->acquire(hlsSegment.data.size()) : std::vector<uint8_t>();
+                    mpegtsSegment.data.assign(hlsSegment.data.begin(), hlsSegment.data.end());
+                }
+                mpegtsSegment.discontinuity = hlsSegment.discontinuity;
+                mpegtsSegment.sequenceNumber = hlsSegment.sequenceNumber;
+                mpegtsSegment.duration = hlsSegment.duration;
+                mpegtsSegment.timestamp = hlsSegment.timestamp;
+                mpegtsSegment.trace = hlsSegment.trace;
+                
+                // Après une reprise ou une période de conversion complète, les compteurs de la
+                // source ne suivent pas ceux émis jusque-là: l'écart est signalé sur chaque PID
+                if (resumePending_ || rearmed) {
+                    prependResumeMarkersInternal(mpegtsSegment.data);
+                    resumePending_ = false;
+                    continuityCounters_.clear();
+                }
+                for (const auto& [pid, cc] : sourceCounters_) {
+                    continuityCounters_[pid] = cc;
+                }
+                mpegtsSegment.outputState = snapshotStateInternal();
+                
+                passthroughSegments_++;
+                
+                SPDLOG_LOGGER_DEBUG(log_, "Segment {} transmis en passthrough, taille: {} octets",
+                                    mpegtsSegment.sequenceNumber, mpegtsSegment.data.size());
+                
+                return mpegtsSegment;
+            }
+        }
         
         // Si le segment HLS est déjà en MPEG-TS (ce qui est généralement le cas),
         // nous devons traiter le flux MPEG-TS pour assurer sa conformité DVB
         
-        // Extraction des paquets MPEG-TS
-        ts::TSPacketVector packets;
+        // Extraction des paquets MPEG-TS dans le vecteur réutilisé d'un segment à l'autre
+        ts::TSPacketVector& packets = packets_;
+        packets.clear();
         
         if (hlsSegment.data.size() % ts::PKT_SIZE != 0) {
-            spdlog::warn("Taille de données non multiple de la taille d'un paquet TS: {}", hlsSegment.data.size());
+            log_->warn("Taille de données non multiple de la taille d'un paquet TS: {}", hlsSegment.data.size());
             
             // Si la taille est trop petite pour contenir même un seul paquet TS
             if (hlsSegment.data.size() < ts::PKT_SIZE) {
@@ -152,21 +281,18 @@ std::optional<MPEGTSSegment> MPEGTSConverter::convert(const HLSSegment& hlsSegme
             
             // Tronquer aux paquets complets
             size_t validSize = (hlsSegment.data.size() / ts::PKT_SIZE) * ts::PKT_SIZE;
-            size_t truncatedBytes = hlsSegment.data.size() - validSize;
+            [[maybe_unused]] size_t truncatedBytes = hlsSegment.data.size() - validSize;
             
-            spdlog::info("Troncature du segment de {} octets à {} octets (suppression de {} octets de rembourrage)", 
-                    hlsSegment.data.size(), validSize, truncatedBytes);
+            SPDLOG_LOGGER_DEBUG(log_, "Troncature du segment de {} octets à {} octets (suppression de {} octets de rembourrage)",
+                                hlsSegment.data.size(), validSize, truncatedBytes);
             
-            // Créer une copie tronquée des données
-            std::vector<uint8_t> truncatedData(hlsSegment.data.begin(), hlsSegment.data.begin() + validSize);
-            
-            // Charger manuellement les paquets depuis les données tronquées
-            size_t packetCount = truncatedData.size() / ts::PKT_SIZE;
+            // Charger manuellement les paquets complets, sans copier les données tronquées
+            size_t packetCount = validSize / ts::PKT_SIZE;
             packets.reserve(packetCount);
             
             for (size_t i = 0; i < packetCount; ++i) {
                 ts::TSPacket packet;
-                std::memcpy(packet.b, truncatedData.data() + (i * ts::PKT_SIZE), ts::PKT_SIZE);
+                std::memcpy(packet.b, hlsSegment.data.data() + (i * ts::PKT_SIZE), ts::PKT_SIZE);
                 packets.push_back(packet);
             }
         }
@@ -201,29 +327,46 @@ std::optional<MPEGTSSegment> MPEGTSConverter::convert(const HLSSegment& hlsSegme
         // Appliquer les compteurs de continuité et gérer les PCR
         processPackets(packets, hlsSegment.discontinuity);
         
+        // Après une reprise, les tables changent de version comme lors d'une discontinuité
+        bool resumed = resumePending_;
+        bool tablesDiscontinuity = hlsSegment.discontinuity || resumed;
+        resumePending_ = false;
+        
         // Convertir les paquets en vecteur d'octets pour le traitement
-        std::vector<uint8_t> tsData;
-        tsData.reserve(packets.size() * ts::PKT_SIZE);
+        size_t tsSize = packets.size() * ts::PKT_SIZE;
+        std::vector<uint8_t> tsData = bufferPool_ ? bufferPool_->acquire(tsSize) : std::vector<uint8_t>();
+        tsData.resize(tsSize);
         
-        for (const auto& packet : packets) {
-            const uint8_t* packetData = packet.b;
-            tsData.insert(tsData.end(), packetData, packetData + ts::PKT_SIZE);
+        for (size_t i = 0; i < packets.size(); ++i) {
+            std::memcpy(tsData.data() + i * ts::PKT_SIZE, packets[i].b, ts::PKT_SIZE);
         }
         
         // Mettre à jour les tables PSI/SI avec indication de discontinuité
-        std::vector<uint8_t> finalData = dvbProcessor_->updatePSITables(tsData, hlsSegment.discontinuity);
+        std::vector<uint8_t> finalData = dvbProcessor_->updatePSITables(tsData, tablesDiscontinuity);
+        
+        // Le tampon intermédiaire n'est plus utilisé: le rendre à la réserve
+        if (bufferPool_) {
+            bufferPool_->release(std::move(tsData));
+        }
+        
+        // Premier segment après une reprise: chaque PID signale l'écart de ses compteurs
+        if (resumed) {
+            prependResumeMarkersInternal(finalData);
+        }
         
         // Créer le segment MPEG-TS de sortie
         MPEGTSSegment mpegtsSegment;
-        mpegtsSegment.data = finalData;
+        mpegtsSegment.data = std::move(finalData);
         mpegtsSegment.discontinuity = hlsSegment.discontinuity;
         mpegtsSegment.sequenceNumber = hlsSegment.sequenceNumber;
         mpegtsSegment.duration = hlsSegment.duration;
         mpegtsSegment.timestamp = hlsSegment.timestamp;
+        mpegtsSegment.trace = hlsSegment.trace;
+        mpegtsSegment.outputState = snapshotStateInternal();
         
         // Journaliser le succès
-        spdlog::debug("Segment MPEG-TS {} généré avec succès, taille: {} octets",
-                    mpegtsSegment.sequenceNumber, mpegtsSegment.data.size());
+        SPDLOG_LOGGER_DEBUG(log_, "Segment MPEG-TS {} généré avec succès, taille: {} octets",
+                            mpegtsSegment.sequenceNumber, mpegtsSegment.data.size());
         
         return mpegtsSegment;
     }
@@ -259,9 +402,12 @@ void MPEGTSConverter::processPackets(ts::TSPacketVector& packets, bool discontin
         bool firstPcrFound = false;
         std::map<uint16_t, bool> pidHasDiscontinuity;
         
+        // Après une reprise, les compteurs continuent mais la base PCR change
+        bool pcrDiscontinuity = discontinuity || resumePending_;
+        
         // Si c'est une discontinuité, réinitialiser l'état PCR
         if (discontinuity) {
-            spdlog::info("Discontinuité détectée, préparation au traitement des PCR et compteurs de continuité");
+            SPDLOG_LOGGER_DEBUG(log_, "Discontinuité détectée, préparation au traitement des PCR et compteurs de continuité");
             firstPcrFound = false;
             
             // Marquer tous les PID comme ayant une discontinuité
@@ -275,7 +421,7 @@ void MPEGTSConverter::processPackets(ts::TSPacketVector& packets, bool discontin
             for (const auto& packet : packets) {
                 if (packet.hasPCR()) {
                     pcrPid_ = packet.getPID();
-                    spdlog::info("PID PCR principal détecté: 0x{:04X}", pcrPid_);
+                    log_->info("PID PCR principal détecté: 0x{:04X}", pcrPid_);
                     break;
                 }
             }
@@ -311,7 +457,7 @@ void MPEGTSConverter::processPackets(ts::TSPacketVector& packets, bool discontin
                 uint64_t currentPcr = packet.getPCR();
                 
                 // Si c'est une discontinuité et premier PCR rencontré
-                if (discontinuity && !firstPcrFound) {
+                if (pcrDiscontinuity && !firstPcrFound) {
                     // Marquer le paquet avec l'indicateur de discontinuité
                     packet.setDiscontinuityIndicator(true);
                     firstPcrFound = true;
@@ -319,23 +465,23 @@ void MPEGTSConverter::processPackets(ts::TSPacketVector& packets, bool discontin
                     // Enregistrer cette valeur comme nouvelle base PCR
                     lastPcrValue_ = currentPcr;
                     
-                    spdlog::info("Discontinuité PCR appliquée sur le PID 0x{:04X}, PCR: {}", pid, currentPcr);
+                    log_->info("Discontinuité PCR appliquée sur le PID 0x{:04X}, PCR: {}", pid, currentPcr);
                 } 
-                else if (discontinuity && firstPcrFound && pid == pcrPid_) {
+                else if (pcrDiscontinuity && firstPcrFound && pid == pcrPid_) {
                     // Si c'est toujours une discontinuité mais pas le premier PCR,
                     // ajustement basé sur la nouvelle base PCR
-                    uint64_t expectedPcr = lastPcrValue_ + 27000000 * 0.04; // 40ms d'incrément typique
+                    [[maybe_unused]] uint64_t expectedPcr = lastPcrValue_ + 27000000 * 0.04; // 40ms d'incrément typique
                     
                     // Mise à jour de la dernière valeur PCR connue
                     lastPcrValue_ = currentPcr;
                     
-                    spdlog::debug("PCR suivant dans la discontinuité, PID 0x{:04X}, PCR: {}, attendu: {}", 
-                               pid, currentPcr, expectedPcr);
+                    SPDLOG_LOGGER_TRACE(log_, "PCR suivant dans la discontinuité, PID 0x{:04X}, PCR: {}, attendu: {}",
+                                        pid, currentPcr, expectedPcr);
                 }
                 else {
                     // PCR normal, vérifier qu'il est cohérent
                     if (lastPcrValue_ > 0 && currentPcr < lastPcrValue_) {
-                        spdlog::warn("PCR non monotone détecté: {} -> {}", lastPcrValue_, currentPcr);
+                        log_->warn("PCR non monotone détecté: {} -> {}", lastPcrValue_, currentPcr);
                     }
                     
                     // Mise à jour de la dernière valeur PCR
@@ -354,10 +500,349 @@ void MPEGTSConverter::processPackets(ts::TSPacketVector& packets, bool discontin
     }
 }
 
+bool MPEGTSConverter::validatePassthroughInternal(const std::vector<uint8_t>& data, bool discontinuity,
+                                                  std::string& reason) {
+    if (data.empty() || data.size() % ts::PKT_SIZE != 0) {
+        reason = "taille de segment non multiple de 188 octets (" + std::to_string(data.size()) + ")";
+        return false;
+    }
+    
+    // L'état par PID tient dans un tableau indexé par PID, gardé d'un segment à l'autre:
+    // seuls les PID touchés par le segment précédent sont remis à zéro
+    std::vector<PassthroughPidState>& pids = passthroughPids_;
+    for (uint16_t pid : passthroughTouched_) {
+        pids[pid] = PassthroughPidState();
+    }
+    passthroughTouched_.clear();
+    
+    // Les compteurs de la source ne sont repris qu'une fois le segment validé; oubliés si
+    // le segment est refusé, le suivant n'est comparé qu'à lui-même
+    for (const auto& [pid, cc] : sourceCounters_) {
+        pids[pid & (PID_COUNT - 1)].cc = cc;
+        pids[pid & (PID_COUNT - 1)].counterKnown = true;
+        passthroughTouched_.push_back(pid & (PID_COUNT - 1));
+    }
+    bool valid = false;
+    struct ForgetOnFailure {
+        std::map<uint16_t, uint8_t>& counters;
+        const bool& valid;
+        ~ForgetOnFailure() {
+            if (!valid) {
+                counters.clear();
+            }
+        }
+    } forgetOnFailure{sourceCounters_, valid};
+    
+    std::vector<uint16_t> pmtPids = pmtPids_;
+    bool patFound = false;
+    bool sdtFound = false;
+    uint16_t pcrPid = pcrPid_;
+    uint64_t lastPcr = lastPcrValue_;
+    bool pcrKnown = lastPcrValue_ > 0 && !resumePending_;
+    
+    size_t packetCount = data.size() / ts::PKT_SIZE;
+    for (size_t i = 0; i < packetCount; ++i) {
+        const uint8_t* b = data.data() + i * ts::PKT_SIZE;
+        
+        if (b[0] != 0x47) {
+            reason = "octet de synchronisation absent au paquet " + std::to_string(i);
+            return false;
+        }
+        if (b[1] & 0x80) {
+            reason = "indicateur d'erreur de transport au paquet " + std::to_string(i);
+            return false;
+        }
+        
+        uint16_t pid = static_cast<uint16_t>(((b[1] & 0x1F) << 8) | b[2]);
+        if (pid == PID_NULL) {
+            continue;
+        }
+        
+        bool payloadStart = (b[1] & 0x40) != 0;
+        uint8_t afc = (b[3] >> 4) & 0x03;
+        uint8_t cc = b[3] & 0x0F;
+        bool hasPayload = (afc & 0x01) != 0;
+        bool hasAF = (afc & 0x02) != 0;
+        
+        if (afc == 0) {
+            reason = "adaptation_field_control réservé sur le PID " + std::to_string(pid);
+            return false;
+        }
+        
+        size_t afLength = hasAF ? b[4] : 0;
+        if (hasAF && afLength > (hasPayload ? 182u : 183u)) {
+            reason = "champ d'adaptation invalide sur le PID " + std::to_string(pid);
+            return false;
+        }
+        
+        bool discontinuityIndicator = hasAF && afLength > 0 && (b[5] & 0x80);
+        
+        // Une discontinuité HLS doit être signalée dans le flux lui-même
+        PassthroughPidState& state = pids[pid];
+        bool firstInSegment = !state.seen;
+        if (firstInSegment) {
+            state.seen = true;
+            passthroughTouched_.push_back(pid);
+        }
+        
+        if (state.counterKnown && !discontinuityIndicator) {
+            uint8_t expected = hasPayload ? ((state.cc + 1) & 0x0F) : state.cc;
+            
+            if (cc == expected) {
+                state.duplicateSeen = false;
+            } else if (hasPayload && cc == state.cc && !state.duplicateSeen) {
+                // Un paquet dupliqué unique est autorisé par la norme
+                state.duplicateSeen = true;
+            } else if (discontinuity && firstInSegment) {
+                reason = "discontinuité HLS non signalée sur le PID " + std::to_string(pid);
+                return false;
+            } else {
+                reason = "rupture de compteur de continuité sur le PID " + std::to_string(pid) +
+                         " (attendu " + std::to_string(expected) + ", reçu " + std::to_string(cc) + ")";
+                return false;
+            }
+        }
+        state.cc = cc;
+        state.counterKnown = true;
+        
+        // PCR: doit progresser sauf discontinuité signalée
+        if (hasAF && afLength >= 7 && (b[5] & 0x10)) {
+            uint64_t base = (static_cast<uint64_t>(b[6]) << 25) | (static_cast<uint64_t>(b[7]) << 17) |
+                            (static_cast<uint64_t>(b[8]) << 9) | (static_cast<uint64_t>(b[9]) << 1) |
+                            (static_cast<uint64_t>(b[10]) >> 7);
+            uint64_t extension = (static_cast<uint64_t>(b[10] & 0x01) << 8) | b[11];
+            uint64_t pcr = base * 300 + extension;
+            
+            if (pcrPid == PID_NULL) {
+                pcrPid = pid;
+            }
+            
+            if (pid == pcrPid) {
+                if (pcrKnown && !discontinuityIndicator) {
+                    uint64_t delta = (pcr + PCR_MODULO - lastPcr) % PCR_MODULO;
+                    // Un PCR qui recule apparaît comme un écart proche du rebouclage
+                    if (delta > PCR_MAX_GAP) {
+                        reason = "PCR non monotone sur le PID " + std::to_string(pid) + " (" +
+                                 std::to_string(lastPcr) + " -> " + std::to_string(pcr) + ")";
+                        return false;
+                    }
+                }
+                lastPcr = pcr;
+                pcrKnown = true;
+            }
+        }
+        
+        // Tables PSI/SI: seules les sections qui commencent dans le paquet sont examinées
+        if (!payloadStart || !hasPayload) {
+            continue;
+        }
+        state.sectionStart = true;
+        
+        size_t payloadOffset = 4 + (hasAF ? 1 + afLength : 0);
+        if (payloadOffset >= ts::PKT_SIZE) {
+            continue;
+        }
+        
+        if (pid == PID_PAT) {
+            size_t sectionOffset = payloadOffset + 1 + b[payloadOffset];
+            if (sectionOffset + 3 > ts::PKT_SIZE || b[sectionOffset] != 0x00) {
+                reason = "PAT illisible";
+                return false;
+            }
+            
+            const uint8_t* section = b + sectionOffset;
+            size_t sectionLength = static_cast<size_t>(((section[1] & 0x0F) << 8) | section[2]);
+            if (sectionLength < 9 || sectionOffset + 3 + sectionLength > ts::PKT_SIZE) {
+                // PAT sur plusieurs paquets: se contenter de sa présence
+                patFound = true;
+                continue;
+            }
+            
+            if (crc32Mpeg(section, 3 + sectionLength) != 0) {
+                reason = "CRC32 du PAT invalide";
+                return false;
+            }
+            
+            pmtPids.clear();
+            for (size_t offset = 8; offset + 4 <= 3 + sectionLength - 4; offset += 4) {
+                uint16_t programNumber = static_cast<uint16_t>((section[offset] << 8) | section[offset + 1]);
+                uint16_t programPid = static_cast<uint16_t>(((section[offset + 2] & 0x1F) << 8) | section[offset + 3]);
+                if (programNumber != 0) {
+                    pmtPids.push_back(programPid);
+                }
+            }
+            patFound = true;
+        } else if (pid == PID_SDT) {
+            sdtFound = true;
+        }
+    }
+    
+    if (!patFound) {
+        reason = "PAT absent du segment";
+        return false;
+    }
+    if (pmtPids.empty()) {
+        reason = "aucun programme annoncé par le PAT";
+        return false;
+    }
+    for (uint16_t pmtPid : pmtPids) {
+        if (!pids[pmtPid & (PID_COUNT - 1)].sectionStart) {
+            reason = "PMT absente du segment (PID " + std::to_string(pmtPid) + ")";
+            return false;
+        }
+    }
+    if (!sdtFound) {
+        reason = "SDT absente du segment";
+        return false;
+    }
+    
+    // Segment conforme: reprendre les compteurs de la source et l'état des PCR
+    for (uint16_t pid : passthroughTouched_) {
+        if (pids[pid].seen) {
+            sourceCounters_[pid] = pids[pid].cc;
+        }
+    }
+    pmtPids_ = std::move(pmtPids);
+    pcrPid_ = pcrPid;
+    lastPcrValue_ = lastPcr;
+    
+    valid = true;
+    return true;
+}
+
+void MPEGTSConverter::setStateFile(std::shared_ptr<hls_to_dvb::StreamStateFile> stateFile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    stateFile_ = std::move(stateFile);
+}
+
+void MPEGTSConverter::restoreStateInternal() {
+    resumePending_ = false;
+    
+    hls_to_dvb::StreamOutputState state;
+    if (!stateFile_ || !stateFile_->load(state)) {
+        return;
+    }
+    
+    continuityCounters_ = state.continuityCounters;
+    pcrPid_ = state.pcrPid;
+    lastPcrValue_ = state.lastPcr;
+    
+    if (dvbProcessor_) {
+        DVBTableVersions versions;
+        versions.pat = state.versionPAT;
+        versions.sdt = state.versionSDT;
+        versions.eit = state.versionEIT;
+        versions.nit = state.versionNIT;
+        versions.pmt = state.versionPMT;
+        dvbProcessor_->setTableVersions(versions);
+    }
+    
+    resumePending_ = true;
+    
+    spdlog::info("État de sortie repris depuis {}: {} compteurs de continuité, PID PCR 0x{:04X}, version PAT {}",
+                 stateFile_->getPath(), continuityCounters_.size(), pcrPid_, state.versionPAT);
+}
+
+std::shared_ptr<const hls_to_dvb::StreamOutputState> MPEGTSConverter::snapshotStateInternal() const {
+    if (!stateFile_) {
+        return nullptr;
+    }
+    
+    auto state = std::make_shared<hls_to_dvb::StreamOutputState>();
+    state->continuityCounters = continuityCounters_;
+    state->pcrPid = pcrPid_;
+    state->lastPcr = lastPcrValue_;
+    if (dvbProcessor_) {
+        DVBTableVersions versions = dvbProcessor_->getTableVersions();
+        state->versionPAT = versions.pat;
+        state->versionSDT = versions.sdt;
+        state->versionEIT = versions.eit;
+        state->versionNIT = versions.nit;
+        state->versionPMT = std::move(versions.pmt);
+    }
+    return state;
+}
+
+void MPEGTSConverter::prependResumeMarkersInternal(std::vector<uint8_t>& data) {
+    // Compteur du premier paquet de chaque PID: un paquet sans charge utile ne
+    // l'incrémente pas, le paquet de discontinuité porte donc le compteur précédent
+    std::vector<bool> seen(PID_COUNT, false);
+    std::vector<std::pair<uint16_t, uint8_t>> markers;
+    size_t packetCount = data.size() / ts::PKT_SIZE;
+    for (size_t i = 0; i < packetCount; ++i) {
+        const uint8_t* b = data.data() + i * ts::PKT_SIZE;
+        uint16_t pid = static_cast<uint16_t>(((b[1] & 0x1F) << 8) | b[2]);
+        if (pid == PID_NULL || seen[pid]) {
+            continue;
+        }
+        seen[pid] = true;
+        bool hasPayload = (b[3] & 0x10) != 0;
+        uint8_t cc = b[3] & 0x0F;
+        markers.emplace_back(pid, hasPayload ? static_cast<uint8_t>((cc + 0x0F) & 0x0F) : cc);
+    }
+    
+    size_t markersSize = markers.size() * ts::PKT_SIZE;
+    std::vector<uint8_t> output = bufferPool_ ? bufferPool_->acquire(markersSize + data.size()) : std::vector<uint8_t>();
+    output.resize(markersSize + data.size());
+    uint8_t* p = output.data();
+    for (const auto& [pid, cc] : markers) {
+        p[0] = 0x47;
+        p[1] = static_cast<uint8_t>((pid >> 8) & 0x1F);
+        p[2] = static_cast<uint8_t>(pid & 0xFF);
+        p[3] = static_cast<uint8_t>(0x20 | cc);     // Champ d'adaptation seul
+        p[4] = static_cast<uint8_t>(ts::PKT_SIZE - 5);
+        p[5] = AF_DISCONTINUITY;
+        std::memset(p + 6, 0xFF, ts::PKT_SIZE - 6);
+        p += ts::PKT_SIZE;
+    }
+    std::memcpy(p, data.data(), data.size());
+    
+    if (bufferPool_) {
+        bufferPool_->release(std::move(data));
+    }
+    data = std::move(output);
+    
+    log_->info("Reprise de l'état de sortie: discontinuité signalée sur {} PID", markers.size());
+}
+
 bool MPEGTSConverter::isRunning() const {
     return running_;
 }
 
+void MPEGTSConverter::setBufferPool(std::shared_ptr<hls_to_dvb::BufferPool> pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    bufferPool_ = std::move(pool);
+    if (dvbProcessor_) {
+        dvbProcessor_->setBufferPool(bufferPool_);
+    }
+}
+
+void MPEGTSConverter::setPassthrough(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    passthroughEnabled_ = enabled;
+    passthroughActive_ = enabled && running_;
+    passthroughCleanSegments_ = 0;
+    sourceCounters_.clear();
+    std::lock_guard<std::mutex> reasonLock(reasonMutex_);
+    passthroughFallbackReason_.clear();
+}
+
+bool MPEGTSConverter::isPassthroughActive() const {
+    return passthroughActive_;
+}
+
+uint64_t MPEGTSConverter::getPassthroughSegments() const {
+    return passthroughSegments_;
+}
+
+std::string MPEGTSConverter::getPassthroughFallbackReason() const {
+    std::lock_guard<std::mutex> lock(reasonMutex_);
+    return passthroughFallbackReason_;
+}
+
 MPEGTSConverter::~MPEGTSConverter() {
     if (running_) {
         stop();
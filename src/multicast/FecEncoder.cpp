@@ -0,0 +1,159 @@
+#include "multicast/FecEncoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+#endif
+
+namespace hls_to_dvb {
+
+namespace {
+    constexpr size_t RTP_HEADER_SIZE = 12;
+    constexpr size_t FEC_HEADER_SIZE = 16;
+    constexpr size_t PAYLOAD_OFFSET = RTP_HEADER_SIZE + FEC_HEADER_SIZE;
+
+    // Charge utile maximale protégée (en-tête RTP exclu)
+    constexpr size_t MAX_PAYLOAD_SIZE = 1500;
+
+    // Type de charge utile dynamique des flux FEC
+    constexpr uint8_t FEC_PAYLOAD_TYPE = 96;
+
+    /**
+     * @brief OU exclusif d'un bloc d'octets dans un autre, 16 octets à la fois
+     */
+    void xorInto(uint8_t* destination, const uint8_t* source, size_t size) {
+        size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 16 <= size; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_xor_si128(a, b));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 16 <= size; i += 16) {
+            vst1q_u8(destination + i, veorq_u8(vld1q_u8(destination + i), vld1q_u8(source + i)));
+        }
+#endif
+        for (; i < size; ++i) {
+            destination[i] ^= source[i];
+        }
+    }
+}
+
+bool FecEncoder::isValid(int columns, int rows) {
+    return columns >= 1 && columns <= 20 && rows >= 4 && rows <= 20 && columns * rows <= 100;
+}
+
+FecEncoder::FecEncoder(int columns, int rows)
+    : columns_(columns), rows_(rows), columnFec_(columns) {
+    for (auto& accumulator : columnFec_) {
+        accumulator.buffer.assign(PAYLOAD_OFFSET + MAX_PAYLOAD_SIZE, 0);
+    }
+    rowFec_.buffer.assign(PAYLOAD_OFFSET + MAX_PAYLOAD_SIZE, 0);
+    ready_.reserve(2);
+
+    std::random_device random;
+    columnSequence_ = static_cast<uint16_t>(random());
+    rowSequence_ = static_cast<uint16_t>(random());
+}
+
+void FecEncoder::reset(Accumulator& accumulator, uint16_t snBase) {
+    std::memset(accumulator.buffer.data() + PAYLOAD_OFFSET, 0, accumulator.payloadSize);
+    accumulator.payloadSize = 0;
+    accumulator.snBase = snBase;
+    accumulator.lengthRecovery = 0;
+    accumulator.ptRecovery = 0;
+    accumulator.tsRecovery = 0;
+}
+
+void FecEncoder::accumulate(Accumulator& accumulator, const uint8_t* rtpPacket, size_t size) {
+    size_t payloadSize = std::min(size - RTP_HEADER_SIZE, MAX_PAYLOAD_SIZE);
+    uint32_t timestamp = (uint32_t(rtpPacket[4]) << 24) | (uint32_t(rtpPacket[5]) << 16) |
+                         (uint32_t(rtpPacket[6]) << 8) | rtpPacket[7];
+
+    xorInto(accumulator.buffer.data() + PAYLOAD_OFFSET, rtpPacket + RTP_HEADER_SIZE, payloadSize);
+    accumulator.payloadSize = std::max(accumulator.payloadSize, payloadSize);
+    accumulator.lengthRecovery ^= static_cast<uint16_t>(payloadSize);
+    accumulator.ptRecovery ^= rtpPacket[1] & 0x7F;
+    accumulator.tsRecovery ^= timestamp;
+}
+
+FecEncoder::Packet FecEncoder::finish(Accumulator& accumulator, Direction direction, uint32_t timestamp) {
+    uint8_t* header = accumulator.buffer.data();
+    bool column = direction == Direction::COLUMN;
+    uint16_t sequence = column ? columnSequence_++ : rowSequence_++;
+
+    // En-tête RTP du flux FEC
+    header[0] = 0x80;
+    header[1] = FEC_PAYLOAD_TYPE;
+    header[2] = static_cast<uint8_t>(sequence >> 8);
+    header[3] = static_cast<uint8_t>(sequence);
+    header[4] = static_cast<uint8_t>(timestamp >> 24);
+    header[5] = static_cast<uint8_t>(timestamp >> 16);
+    header[6] = static_cast<uint8_t>(timestamp >> 8);
+    header[7] = static_cast<uint8_t>(timestamp);
+    std::memset(header + 8, 0, 4);  // SSRC nul (SMPTE 2022-1)
+
+    // En-tête FEC: SNBase, Length/PT/TS recovery, D (ligne), type XOR, Offset et NA
+    uint8_t* fec = header + RTP_HEADER_SIZE;
+    fec[0] = static_cast<uint8_t>(accumulator.snBase >> 8);
+    fec[1] = static_cast<uint8_t>(accumulator.snBase);
+    fec[2] = static_cast<uint8_t>(accumulator.lengthRecovery >> 8);
+    fec[3] = static_cast<uint8_t>(accumulator.lengthRecovery);
+    fec[4] = 0x80 | accumulator.ptRecovery;     // E = 1
+    fec[5] = 0;                                 // Mask (inutilisé)
+    fec[6] = 0;
+    fec[7] = 0;
+    fec[8] = static_cast<uint8_t>(accumulator.tsRecovery >> 24);
+    fec[9] = static_cast<uint8_t>(accumulator.tsRecovery >> 16);
+    fec[10] = static_cast<uint8_t>(accumulator.tsRecovery >> 8);
+    fec[11] = static_cast<uint8_t>(accumulator.tsRecovery);
+    fec[12] = column ? 0x00 : 0x40;             // X = 0, D, type 0 (XOR), index 0
+    fec[13] = static_cast<uint8_t>(column ? columns_ : 1);
+    fec[14] = static_cast<uint8_t>(column ? rows_ : columns_);
+    fec[15] = 0;                                // Bits de poids fort de SNBase
+
+    return Packet{direction, header, PAYLOAD_OFFSET + accumulator.payloadSize};
+}
+
+const std::vector<FecEncoder::Packet>& FecEncoder::protect(const uint8_t* rtpPacket, size_t size) {
+    ready_.clear();
+    if (size <= RTP_HEADER_SIZE) {
+        return ready_;
+    }
+
+    uint16_t sequence = static_cast<uint16_t>((rtpPacket[2] << 8) | rtpPacket[3]);
+    uint32_t timestamp = (uint32_t(rtpPacket[4]) << 24) | (uint32_t(rtpPacket[5]) << 16) |
+                         (uint32_t(rtpPacket[6]) << 8) | rtpPacket[7];
+    int column = position_ % columns_;
+    int row = position_ / columns_;
+
+    Accumulator& columnFec = columnFec_[column];
+    if (row == 0) {
+        reset(columnFec, sequence);
+    }
+    if (column == 0) {
+        reset(rowFec_, sequence);
+    }
+    accumulate(columnFec, rtpPacket, size);
+    accumulate(rowFec_, rtpPacket, size);
+
+    // La dernière ligne complète chaque colonne : les paquets de colonne sont
+    // ainsi étalés sur toute une ligne plutôt qu'émis en rafale
+    if (row == rows_ - 1) {
+        ready_.push_back(finish(columnFec, Direction::COLUMN, timestamp));
+    }
+    if (column == columns_ - 1) {
+        ready_.push_back(finish(rowFec_, Direction::ROW, timestamp));
+    }
+
+    position_ = (position_ + 1) % (columns_ * rows_);
+    return ready_;
+}
+
+} // namespace hls_to_dvb
@@ -1,4 +1,8 @@
 #include "multicast/MulticastSender.h"
+#include "multicast/FecEncoder.h"
+#include "multicast/PacketTxRing.h"
+#include "multicast/RtpPacketizer.h"
+#include "multicast/UringTransmitter.h"
 #include "alerting/AlertManager.h"
 #include <spdlog/spdlog.h>
 
@@ -33,10 +37,155 @@
 
 namespace hls_to_dvb {
 
+namespace {
+    // Taille maximum d'un datagramme UDP (pour éviter la fragmentation)
+    constexpr size_t MAX_PACKET_SIZE = 1316; // 7 paquets MPEG-TS (7*188=1316)
+
+    // Trames écrites dans l'anneau AF_PACKET avant de les remettre au noyau, sans attendre
+    // la fin du segment: l'anneau partagé par l'interface ne se remplit pas d'un seul flux
+    constexpr int RING_FLUSH_FRAMES = 64;
+
+    /**
+     * @brief Adresse d'un flux FEC: même destination que le média, port décalé
+     */
+    struct sockaddr_in fecDestination(const struct sockaddr_in& media, int portOffset) {
+        struct sockaddr_in destination = media;
+        destination.sin_port = htons(static_cast<uint16_t>(ntohs(media.sin_port) + portOffset));
+        return destination;
+    }
+
+    /**
+     * @brief Émet des paquets FEC vers les ports de colonne et de ligne d'une destination
+     * @return Nombre de paquets FEC non envoyés
+     */
+    int sendFec(SOCKET socket, const std::vector<FecEncoder::Packet>& packets,
+                const struct sockaddr_in& columnDestination, const struct sockaddr_in& rowDestination) {
+        int failures = 0;
+        for (const auto& packet : packets) {
+            const struct sockaddr_in& destination =
+                packet.direction == FecEncoder::Direction::COLUMN ? columnDestination : rowDestination;
+            if (sendto(socket, reinterpret_cast<const char*>(packet.data), static_cast<int>(packet.size), 0,
+                       reinterpret_cast<const struct sockaddr*>(&destination), sizeof(destination)) == SOCKET_ERROR) {
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    /**
+     * @brief Enregistre l'état de sortie d'un segment envoyé, horodaté à l'enregistrement
+     */
+    void saveOutputState(StreamStateFile& stateFile, const StreamOutputState& outputState) {
+        StreamOutputState state = outputState;
+        state.savedAtUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        stateFile.save(state);
+    }
+
+    /**
+     * @brief Crée le codeur FEC d'une sortie RTP si ses dimensions sont admises
+     */
+    std::unique_ptr<FecEncoder> createFecEncoder(const std::string& destination, int columns, int rows) {
+        if (columns <= 0 && rows <= 0) {
+            return nullptr;
+        }
+        if (!FecEncoder::isValid(columns, rows)) {
+            spdlog::error("FEC {}x{} non conforme à SMPTE 2022-1 pour {} (L de 1 à 20, D de 4 à 20, L×D ≤ 100), "
+                          "FEC désactivée", columns, rows, destination);
+            return nullptr;
+        }
+        spdlog::info("FEC SMPTE 2022-1 {}x{} pour {} (colonnes: port +{}, lignes: port +{})",
+                     columns, rows, destination, FecEncoder::COLUMN_PORT_OFFSET, FecEncoder::ROW_PORT_OFFSET);
+        return std::make_unique<FecEncoder>(columns, rows);
+    }
+
+    /**
+     * @brief Ouvre le socket d'une destination supplémentaire
+     * @param output Configuration de la destination
+     * @param ttl TTL des paquets multicast
+     * @param destination Adresse de destination renseignée
+     * @return Socket ouvert ou INVALID_SOCKET
+     */
+    SOCKET openOutputSocket(const OutputConfig& output, int ttl, struct sockaddr_in& destination) {
+        std::memset(&destination, 0, sizeof(destination));
+        destination.sin_family = AF_INET;
+        destination.sin_port = htons(output.port);
+        if (inet_pton(AF_INET, output.address.c_str(), &destination.sin_addr) != 1) {
+            spdlog::error("Adresse de sortie invalide: {}", output.address);
+            return INVALID_SOCKET;
+        }
+
+        SOCKET outputSocket = socket(AF_INET, SOCK_DGRAM, 0);
+        if (outputSocket == INVALID_SOCKET) {
+            spdlog::error("Impossible de créer le socket de la sortie {}:{}", output.address, output.port);
+            return INVALID_SOCKET;
+        }
+
+        // Les options multicast ne concernent que les groupes (224.0.0.0 à 239.255.255.255)
+        bool multicast = (ntohl(destination.sin_addr.s_addr) & 0xF0000000) == 0xE0000000;
+        if (multicast) {
+            setsockopt(outputSocket, IPPROTO_IP, IP_MULTICAST_TTL,
+                       reinterpret_cast<const char*>(&ttl), sizeof(ttl));
+
+            if (!output.interface.empty()) {
+                struct in_addr localInterface;
+                localInterface.s_addr = htonl(INADDR_ANY);
+#ifndef _WIN32
+                if (isalpha(static_cast<unsigned char>(output.interface[0]))) {
+                    // Nom d'interface (comme "eth1"): utiliser son adresse IPv4
+                    struct ifreq ifr;
+                    std::memset(&ifr, 0, sizeof(ifr));
+                    strncpy(ifr.ifr_name, output.interface.c_str(), IFNAMSIZ - 1);
+                    if (ioctl(outputSocket, SIOCGIFADDR, &ifr) == 0) {
+                        localInterface = reinterpret_cast<struct sockaddr_in*>(&ifr.ifr_addr)->sin_addr;
+                    } else {
+                        spdlog::warn("Interface {} introuvable pour la sortie {}:{}, interface par défaut utilisée",
+                                     output.interface, output.address, output.port);
+                    }
+                } else
+#endif
+                if (inet_pton(AF_INET, output.interface.c_str(), &localInterface) != 1) {
+                    spdlog::warn("Interface {} invalide pour la sortie {}:{}, interface par défaut utilisée",
+                                 output.interface, output.address, output.port);
+                    localInterface.s_addr = htonl(INADDR_ANY);
+                }
+
+                if (setsockopt(outputSocket, IPPROTO_IP, IP_MULTICAST_IF,
+                               reinterpret_cast<const char*>(&localInterface), sizeof(localInterface)) < 0) {
+                    spdlog::error("Impossible de choisir l'interface {} pour la sortie {}:{}",
+                                  output.interface, output.address, output.port);
+                    closesocket(outputSocket);
+                    return INVALID_SOCKET;
+                }
+            }
+        }
+
+        int sendBufSize = 1024 * 1024; // 1 MB
+        setsockopt(outputSocket, SOL_SOCKET, SO_SNDBUF,
+                   reinterpret_cast<const char*>(&sendBufSize), sizeof(sendBufSize));
+        return outputSocket;
+    }
+}
+
+/**
+ * @brief Destination supplémentaire d'un émetteur
+ */
+struct MulticastSender::Output {
+    OutputConfig config;                    ///< Configuration de la destination
+    SOCKET socket = INVALID_SOCKET;         ///< Socket d'émission
+    struct sockaddr_in destination;         ///< Adresse de destination
+    std::unique_ptr<RtpPacketizer> rtp;     ///< Encapsulation RTP (nullptr = UDP brut)
+    std::unique_ptr<FecEncoder> fec;        ///< FEC SMPTE 2022-1 (nullptr = sans FEC)
+    struct sockaddr_in columnFec;           ///< Destination des paquets FEC de colonne
+    struct sockaddr_in rowFec;              ///< Destination des paquets FEC de ligne
+    bool failing = false;                   ///< Le dernier envoi a échoué (journalisation des transitions)
+};
+
 MulticastSender::MulticastSender(const std::string& groupAddress, int port, 
                               const std::string& interface, int ttl)
     : groupAddress_(groupAddress), port_(port), ttl_(ttl),
-      running_(false), bitrateKbps_(0), socket_(INVALID_SOCKET) {
+      running_(false), bitrateKbps_(0), socket_(INVALID_SOCKET),
+      log_(Logging::get("MulticastSender")) {
     
     // Déterminer l'interface à utiliser
     if (interface.empty()) {
@@ -52,12 +201,245 @@ MulticastSender::MulticastSender(const std::string& groupAddress, int port,
     }
     
     // Initialiser l'horodatage de dernier envoi
-    stats_.lastSendTime = std::chrono::system_clock::now();
+    resetStats();
 }
 
 MulticastSender::~MulticastSender() {
     stop();
     closeSocket();
+    for (const auto& output : outputs_) {
+        closesocket(output->socket);
+    }
+    if (redundant_) {
+        closesocket(redundant_->socket);
+    }
+    
+    // Restituer au budget mémoire les données qui n'ont pas été envoyées
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    releaseQueuedBytesInternal(queuedBytes_);
+}
+
+void MulticastSender::setBufferAccount(std::shared_ptr<StreamBufferAccount> account) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    
+    // Transférer les octets déjà en file vers le nouveau compte
+    if (bufferAccount_) {
+        bufferAccount_->release(BufferStage::MULTICAST_QUEUE, queuedBytes_);
+    }
+    bufferAccount_ = std::move(account);
+    if (bufferAccount_) {
+        bufferAccount_->add(BufferStage::MULTICAST_QUEUE, queuedBytes_);
+    }
+}
+
+bool MulticastSender::addOutput(const OutputConfig& config) {
+    if (running_) {
+        spdlog::warn("Sortie {}:{} ignorée: l'émetteur est déjà démarré", config.address, config.port);
+        return false;
+    }
+    
+    auto output = std::make_unique<Output>();
+    output->config = config;
+    output->socket = openOutputSocket(config, ttl_, output->destination);
+    if (output->socket == INVALID_SOCKET) {
+        return false;
+    }
+    
+    if (config.protocol == "rtp") {
+        std::string destination = config.address + ":" + std::to_string(config.port);
+        output->rtp = std::make_unique<RtpPacketizer>();
+        output->fec = createFecEncoder(destination, config.fecColumns, config.fecRows);
+        output->columnFec = fecDestination(output->destination, FecEncoder::COLUMN_PORT_OFFSET);
+        output->rowFec = fecDestination(output->destination, FecEncoder::ROW_PORT_OFFSET);
+    }
+    
+    spdlog::info("Sortie supplémentaire {}:{} ({}) ajoutée à l'émetteur {}:{}",
+                 config.address, config.port, output->rtp ? "RTP" : "UDP", groupAddress_, port_);
+    outputs_.push_back(std::move(output));
+    return true;
+}
+
+void MulticastSender::sendToOutputs(const uint8_t* payload, size_t size) {
+    uint8_t packet[RtpPacketizer::HEADER_SIZE + MAX_PACKET_SIZE];
+    
+    for (const auto& output : outputs_) {
+        const uint8_t* datagram = payload;
+        size_t datagramSize = size;
+        
+        if (output->rtp) {
+            datagramSize = output->rtp->packetize(payload, size, packet);
+            datagram = packet;
+        }
+        
+        sendToOutput(*output, datagram, datagramSize);
+        
+        // Le paquet est protégé même s'il n'a pas pu être envoyé: la FEC peut le reconstituer
+        if (output->fec) {
+            int fecFailures = sendFec(output->socket, output->fec->protect(datagram, datagramSize),
+                                      output->columnFec, output->rowFec);
+            outputErrors_.fetch_add(fecFailures, std::memory_order_relaxed);
+        }
+    }
+}
+
+void MulticastSender::sendToOutput(Output& output, const uint8_t* datagram, size_t size) {
+    int sendResult = sendto(output.socket,
+                            reinterpret_cast<const char*>(datagram),
+                            static_cast<int>(size),
+                            0,
+                            reinterpret_cast<struct sockaddr*>(&output.destination),
+                            sizeof(output.destination));
+    
+    // Une sortie en échec ne ralentit pas les autres: seules les transitions sont journalisées
+    if (sendResult == SOCKET_ERROR) {
+        outputErrors_.fetch_add(1, std::memory_order_relaxed);
+        if (!output.failing) {
+            output.failing = true;
+            log_->error("Échec d'envoi vers la sortie {}:{}", output.config.address, output.config.port);
+        }
+    } else if (output.failing) {
+        output.failing = false;
+        log_->info("Envoi vers la sortie {}:{} rétabli", output.config.address, output.config.port);
+    }
+}
+
+void MulticastSender::flushUring(UringTransmitter& uring, const std::shared_ptr<StreamMetrics>& metrics) {
+    UringTransmitter::Result result = uring.flush();
+    
+    // Les datagrammes comptés comme envoyés à leur mise en lot sont reclassés en erreurs
+    if (result.primaryFailures > 0) {
+        stats_.packetsSent.fetch_sub(result.primaryFailures, std::memory_order_relaxed);
+        stats_.errors.fetch_add(result.primaryFailures, std::memory_order_relaxed);
+        if (metrics) {
+            metrics->sendErrors->increment(result.primaryFailures);
+        }
+    }
+    updatePrimaryState(result.primaryFailures, result.error);
+    
+    // Seule la copie redondante passe par le lot en plus de la sortie principale
+    if (result.otherFailures > 0) {
+        outputErrors_.fetch_add(result.otherFailures, std::memory_order_relaxed);
+    }
+    if (redundant_) {
+        if (result.otherFailures > 0 && !redundant_->failing) {
+            redundant_->failing = true;
+            log_->error("Échec d'envoi vers la sortie {}:{}", redundant_->config.address, redundant_->config.port);
+        } else if (result.otherFailures == 0 && redundant_->failing) {
+            redundant_->failing = false;
+            log_->info("Envoi vers la sortie {}:{} rétabli", redundant_->config.address, redundant_->config.port);
+        }
+    }
+}
+
+void MulticastSender::updatePrimaryState(uint64_t failures, int error) {
+    if (failures > 0) {
+        primaryFailureCount_ += failures;
+        if (!primaryFailing_) {
+            primaryFailing_ = true;
+            #ifdef _WIN32
+            std::string message = "Échec d'envoi multicast vers " + groupAddress_ + ":" + std::to_string(port_) +
+                                  " (WSA error=" + std::to_string(error) + ")";
+            #else
+            std::string message = "Échec d'envoi multicast vers " + groupAddress_ + ":" + std::to_string(port_) +
+                                  ": " + strerror(error) + " (errno=" + std::to_string(error) + ")";
+            #endif
+            log_->error(message);
+            AlertManager::getInstance().addAlert(AlertLevel::ERROR, "MulticastSender", message, false);
+        }
+    } else if (primaryFailing_) {
+        primaryFailing_ = false;
+        std::string message = "Envoi multicast vers " + groupAddress_ + ":" + std::to_string(port_) +
+                              " rétabli après " + std::to_string(primaryFailureCount_) + " paquets perdus";
+        primaryFailureCount_ = 0;
+        log_->info(message);
+        AlertManager::getInstance().addAlert(AlertLevel::INFO, "MulticastSender", message, false);
+    }
+}
+
+bool MulticastSender::setRedundantOutput(const OutputConfig& config) {
+    if (running_) {
+        spdlog::warn("Copie redondante {}:{} ignorée: l'émetteur est déjà démarré", config.address, config.port);
+        return false;
+    }
+    
+    auto output = std::make_unique<Output>();
+    output->config = config;
+    output->socket = openOutputSocket(config, ttl_, output->destination);
+    if (output->socket == INVALID_SOCKET) {
+        return false;
+    }
+    output->columnFec = fecDestination(output->destination, FecEncoder::COLUMN_PORT_OFFSET);
+    output->rowFec = fecDestination(output->destination, FecEncoder::ROW_PORT_OFFSET);
+    
+    if (!rtp_) {
+        spdlog::warn("Copie redondante {}:{} sans RTP: les récepteurs SMPTE 2022-7 ne pourront pas "
+                     "fusionner les deux chemins", config.address, config.port);
+    }
+    spdlog::info("Copie redondante SMPTE 2022-7 de {}:{} vers {}:{}{}", groupAddress_, port_,
+                 config.address, config.port, config.interface.empty() ? "" : " via " + config.interface);
+    
+    if (redundant_) {
+        closesocket(redundant_->socket);
+    }
+    redundant_ = std::move(output);
+    return true;
+}
+
+void MulticastSender::setPacketRing(std::shared_ptr<PacketTxRing> ring) {
+    if (running_) {
+        spdlog::warn("Anneau d'émission de {}:{} inchangé: l'émetteur est déjà démarré", groupAddress_, port_);
+        return;
+    }
+    ring_ = std::move(ring);
+    if (ring_) {
+        spdlog::info("Émission de {}:{} par l'anneau AF_PACKET de {}", groupAddress_, port_, ring_->getInterface());
+    }
+}
+
+void MulticastSender::setUring(unsigned entries) {
+    if (running_) {
+        spdlog::warn("Émission io_uring de {}:{} inchangée: l'émetteur est déjà démarré", groupAddress_, port_);
+        return;
+    }
+    uringEntries_ = entries;
+    if (entries > 0) {
+        spdlog::info("Émission de {}:{} par lots io_uring de {} datagrammes", groupAddress_, port_, entries);
+    }
+}
+
+void MulticastSender::setRtp(bool enabled, int fecColumns, int fecRows) {
+    if (running_) {
+        spdlog::warn("Encapsulation de {}:{} inchangée: l'émetteur est déjà démarré", groupAddress_, port_);
+        return;
+    }
+    
+    rtp_.reset();
+    fec_.reset();
+    if (!enabled) {
+        return;
+    }
+    
+    std::string destination = groupAddress_ + ":" + std::to_string(port_);
+    rtp_ = std::make_unique<RtpPacketizer>();
+    fec_ = createFecEncoder(destination, fecColumns, fecRows);
+    spdlog::info("Encapsulation RTP (RFC 2250) pour {}", destination);
+}
+
+void MulticastSender::setDiagnostics(bool enabled) {
+    diagnostics_ = enabled;
+}
+
+void MulticastSender::setBufferPool(std::shared_ptr<BufferPool> pool) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    bufferPool_ = std::move(pool);
+}
+
+void MulticastSender::releaseQueuedBytesInternal(size_t bytes) {
+    bytes = std::min(bytes, queuedBytes_);
+    queuedBytes_ -= bytes;
+    if (bufferAccount_) {
+        bufferAccount_->release(BufferStage::MULTICAST_QUEUE, bytes);
+    }
 }
 
 bool MulticastSender::initialize() {
@@ -99,13 +481,10 @@ bool MulticastSender::initialize() {
 }
 
 bool MulticastSender::start() {
-        spdlog::error("*** [M1] DÉBUT DE MulticastSender::start() ***");
-
     if (running_) {
         spdlog::warn("MulticastSender already running");
         return false;
     }
-    spdlog::error("*** [M2] APRÈS VÉRIFICATION running_ ***");
 
     // Vérifier si le socket est initialisé
     if (socket_ == INVALID_SOCKET) {
@@ -115,37 +494,28 @@ bool MulticastSender::start() {
             spdlog::error("Automatic initialization failed: Cannot start MulticastSender");
             return false;
         }
-        spdlog::error("*** [M5] APRÈS initialize() ***");
     }
-    spdlog::error("*** [M6] AVANT reset() ***");
+
     // Réinitialiser les statistiques
-    stats_.reset();
-    spdlog::error("*** [M7] APRÈS reset() ***");
-    // IMPORTANT: Trace de débogage supplémentaire
-    spdlog::info("MulticastSender starting thread and setting running=true");
+    resetStats();
     running_ = true;
-    spdlog::error("*** [M8] AVANT sendTestPacket() ***");
-    // Envoyer un paquet de test pour vérifier la configuration
-    spdlog::info("Sending test packet before starting sender thread");
-    if (sendTestPacket()) {
-        spdlog::info("Test packet sent successfully, socket configuration is working");
-    } else {
+
+    // En mode diagnostic, envoyer un paquet de test pour vérifier la configuration
+    if (diagnostics_ && !sendTestPacket()) {
         spdlog::error("Failed to send test packet, socket configuration may be incorrect");
         // Ne pas retourner false, continuer malgré l'échec
     }
-    spdlog::error("*** [M9] APRÈS sendTestPacket() ***");
+
     // IMPORTANT: Utiliser try/catch pour détecter les problèmes de démarrage de thread
     try {
         // Démarrer le thread d'envoi
         senderThread_ = std::thread(&MulticastSender::senderLoop, this);
-        spdlog::error("*** [M11] THREAD CRÉÉ AVEC SUCCÈS ***");
-        spdlog::info("MulticastSender thread started successfully");
     } catch (const std::exception& e) {
         spdlog::error("Failed to start MulticastSender thread: {}", e.what());
         running_ = false;
         return false;
     }
-    spdlog::error("*** [M13] FIN DE MulticastSender::start() ***");
+
     spdlog::info("MulticastSender started for group {}:{}", groupAddress_, port_);
     return true;
 }
@@ -231,54 +601,90 @@ bool MulticastSender::sendTestPacket() {
 
 
 bool MulticastSender::send(const std::vector<uint8_t>& data, bool discontinuity) {
+    return send(std::vector<uint8_t>(data), discontinuity);
+}
+
+bool MulticastSender::send(std::vector<uint8_t>&& data, bool discontinuity) {
+    return send(std::move(data), discontinuity, SegmentTrace());
+}
+
+bool MulticastSender::send(std::vector<uint8_t>&& data, bool discontinuity, const SegmentTrace& trace,
+                           std::shared_ptr<const StreamOutputState> outputState) {
+    size_t size = data.size();
+    return enqueue(QueuedSegment{std::move(data), discontinuity, trace, nullptr, size, std::move(outputState)});
+}
+
+bool MulticastSender::send(std::shared_ptr<const std::vector<uint8_t>> data, bool discontinuity,
+                           const SegmentTrace& trace, size_t sharers,
+                           std::shared_ptr<const StreamOutputState> outputState) {
+    if (!data) {
+        return false;
+    }
+    size_t charge = data->size() / std::max<size_t>(sharers, 1);
+    return enqueue(QueuedSegment{{}, discontinuity, trace, std::move(data), charge, std::move(outputState)});
+}
+
+bool MulticastSender::enqueue(QueuedSegment&& segment) {
     if (!running_) {
         spdlog::warn("MulticastSender not running");
         return false;
     }
     
     // Ajouter les données à la file d'attente avec l'indicateur de discontinuité
+    bool discontinuity = segment.discontinuity;
+    [[maybe_unused]] size_t dataSize = segment.payload().size();
+    size_t charge = segment.charge;
     {
         std::lock_guard<std::mutex> lock(queueMutex_);
         
         // Si c'est une discontinuité, ajouter un marqueur spécial dans la file
         if (discontinuity) {
-            spdlog::info("Discontinuité détectée, ajout d'un marqueur dans la file d'attente multicast");
+            SPDLOG_LOGGER_DEBUG(log_, "Discontinuité détectée, ajout d'un marqueur dans la file d'attente multicast");
             
             // On peut ajouter un traitement spécial si nécessaire
             // Par exemple, vider partiellement la file pour éviter des délais importants
             if (dataQueue_.size() > 10) {
-                spdlog::info("File d'attente volumineuse lors d'une discontinuité, conservation des 5 derniers segments uniquement");
+                log_->info("File d'attente volumineuse lors d'une discontinuité, conservation des 5 derniers segments uniquement");
                 
                 // Créer une file temporaire avec les éléments à conserver dans le bon ordre
-                std::vector<std::pair<std::vector<uint8_t>, bool>> lastItems;
+                std::vector<QueuedSegment> lastItems;
                 
                 // Récupérer tous les éléments de la file
                 while (!dataQueue_.empty()) {
-                    lastItems.push_back(dataQueue_.front());
+                    lastItems.push_back(std::move(dataQueue_.front()));
                     dataQueue_.pop();
                 }
                 
                 // Ne garder que les 5 derniers éléments
                 if (lastItems.size() > 5) {
                     // Supprimer tous les éléments sauf les 5 derniers
+                    for (auto it = lastItems.begin(); it != lastItems.end() - 5; ++it) {
+                        releaseQueuedBytesInternal(it->charge);
+                    }
                     lastItems.erase(lastItems.begin(), lastItems.end() - 5);
                 }
                 
                 // Remettre les éléments conservés dans la file
-                for (const auto& item : lastItems) {
-                    dataQueue_.push(item);
+                for (auto& item : lastItems) {
+                    dataQueue_.push(std::move(item));
                 }
                 
-                spdlog::info("File d'attente redimensionnée à {} éléments pour la nouvelle discontinuité", dataQueue_.size());
+                log_->info("File d'attente redimensionnée à {} éléments pour la nouvelle discontinuité", dataQueue_.size());
             }
         }
         
         // Ajouter les données avec l'indicateur de discontinuité
-        dataQueue_.push(std::make_pair(data, discontinuity));
-        // Log pour suivre les données ajoutées à la file multicast
-        spdlog::info("Segment ajouté à la file multicast, taille: {} octets, discontinuité: {}", data.size(), discontinuity ? "oui" : "non");
+        dataQueue_.push(std::move(segment));
+        queuedBytes_ += charge;
+        if (bufferAccount_) {
+            bufferAccount_->add(BufferStage::MULTICAST_QUEUE, charge);
+        }
     }
     
+    // Message formaté hors du verrou de la file, et seulement dans les builds Debug
+    SPDLOG_LOGGER_TRACE(log_, "Segment ajouté à la file multicast, taille: {} octets, discontinuité: {}",
+                        dataSize, discontinuity ? "oui" : "non");
+    
     // Notifier le thread d'envoi
     queueCond_.notify_one();
     
@@ -290,8 +696,41 @@ void MulticastSender::setBitrate(uint32_t bitrateKbps) {
     spdlog::info("MulticastSender bitrate set to {} kbps", bitrateKbps);
 }
 
-const MulticastStats& MulticastSender::getStats() const {
-    return stats_;
+MulticastStats MulticastSender::getStats() const {
+    MulticastStats stats;
+    stats.packetsSent = stats_.packetsSent.load(std::memory_order_relaxed);
+    stats.bytesSent = stats_.bytesSent.load(std::memory_order_relaxed);
+    stats.errors = stats_.errors.load(std::memory_order_relaxed);
+    stats.bitrate = stats_.bitrate.load(std::memory_order_relaxed);
+    stats.instantBitrate = stats_.instantBitrate.load(std::memory_order_relaxed);
+    stats.lastSendTime = std::chrono::system_clock::time_point(
+        std::chrono::microseconds(stats_.lastSendTimeUs.load(std::memory_order_relaxed)));
+    stats.outputs = 1 + outputs_.size() + (redundant_ ? 1 : 0);
+    stats.outputErrors = outputErrors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MulticastSender::resetStats() {
+    stats_.packetsSent = 0;
+    stats_.bytesSent = 0;
+    stats_.errors = 0;
+    outputErrors_ = 0;
+    stats_.bitrate = 0.0;
+    stats_.instantBitrate = 0.0;
+    stats_.lastSendTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    lastSegmentSent_ = std::chrono::steady_clock::now();
+}
+
+void MulticastSender::setMetrics(std::shared_ptr<StreamMetrics> metrics) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    metrics_ = std::move(metrics);
+}
+
+void MulticastSender::setStateFile(std::shared_ptr<StreamStateFile> stateFile, int intervalMs) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stateFile_ = std::move(stateFile);
+    stateInterval_ = std::chrono::milliseconds(std::max(intervalMs, 0));
 }
 
 std::string MulticastSender::getGroupAddress() const {
@@ -342,14 +781,13 @@ std::string MulticastSender::detectActiveInterface() {
 }
 
 void MulticastSender::senderLoop() {
-    spdlog::info("MulticastSender::senderLoop STARTED for group {}:{}", groupAddress_, port_);
+    SPDLOG_LOGGER_DEBUG(log_, "Thread d'envoi multicast démarré pour {}:{} (socket {})", groupAddress_, port_, socket_);
     
     // Vérification immédiate du socket
     if (socket_ == INVALID_SOCKET) {
         spdlog::error("Socket invalid at start of senderLoop for {}:{}", groupAddress_, port_);
-    } else {
-        spdlog::info("Socket valid at start of senderLoop: {}", socket_);
-    }    
+    }
+    
     // Structure pour l'adresse de destination
     struct sockaddr_in destAddr;
     std::memset(&destAddr, 0, sizeof(destAddr));
@@ -364,27 +802,39 @@ void MulticastSender::senderLoop() {
     
     destAddr.sin_port = htons(port_);
     
+    // Destinations des paquets FEC de la sortie principale et paquet RTP en cours
+    struct sockaddr_in columnFecAddr = fecDestination(destAddr, FecEncoder::COLUMN_PORT_OFFSET);
+    struct sockaddr_in rowFecAddr = fecDestination(destAddr, FecEncoder::ROW_PORT_OFFSET);
+    uint8_t rtpPacket[RtpPacketizer::HEADER_SIZE + MAX_PACKET_SIZE];
+    
+    // Anneau d'émission partagé de l'interface (nullptr = socket UDP seul)
+    std::shared_ptr<PacketTxRing> ring = ring_;
+    bool ringFallbackLogged = false;
+    
+    // Anneau io_uring propre au thread d'envoi (nullptr = sendto())
+    std::unique_ptr<UringTransmitter> uring;
+    if (uringEntries_ > 0) {
+        uring = UringTransmitter::create(uringEntries_);
+    }
+    
     // Imprimer l'adresse formatée pour le débogage
     char addrStr[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &(destAddr.sin_addr), addrStr, INET_ADDRSTRLEN);
     spdlog::info("Adresse de destination configurée: {}:{}", addrStr, ntohs(destAddr.sin_port));
     
-    // Taille maximum d'un datagramme UDP (pour éviter la fragmentation)
-    const size_t MAX_PACKET_SIZE = 1316; // 7 paquets MPEG-TS (7*188=1316)
-    
     // Timers pour le contrôle de débit
     auto lastSendTime = std::chrono::steady_clock::now();
     size_t bytesSent = 0;
     
     // Vérifier périodiquement si le socket est toujours valide
     int retryCount = 0;
-    int packetsSentTotal = 0;
+    
+    // État de sortie du dernier segment envoyé, pas encore enregistré
+    std::shared_ptr<const StreamOutputState> unsavedState;
+    std::shared_ptr<StreamStateFile> stateFile;
+    auto lastStateSave = std::chrono::steady_clock::now();
     
     while (running_) {
-        static int loopCount = 0;
-        if (++loopCount % 1000 == 0) {
-            spdlog::info("MulticastSender::senderLoop est actif, itération {}, socket={}, queue_size={}", loopCount, socket_, dataQueue_.size());
-        }
         // Vérifier si le socket est valide
         if (socket_ == INVALID_SOCKET) {
             retryCount++;
@@ -401,8 +851,14 @@ void MulticastSender::senderLoop() {
             }
         }
         
-        std::vector<uint8_t> data;
-        bool isDiscontinuity = false;
+        std::vector<uint8_t> ownedData;
+        std::shared_ptr<const std::vector<uint8_t>> sharedData;
+        size_t charge = 0;
+        [[maybe_unused]] bool isDiscontinuity = false;
+        SegmentTrace trace;
+        std::shared_ptr<StreamMetrics> metrics;
+        std::shared_ptr<const StreamOutputState> outputState;
+        std::chrono::milliseconds stateInterval(0);
         
         // Attendre des données à envoyer
         {
@@ -422,18 +878,28 @@ void MulticastSender::senderLoop() {
             }
             
             // Récupérer les données et l'indicateur de discontinuité
-            auto dataPair = std::move(dataQueue_.front());
+            QueuedSegment queued = std::move(dataQueue_.front());
             dataQueue_.pop();
             
-            data = std::move(dataPair.first);
-            isDiscontinuity = dataPair.second;
-            
-            spdlog::info("Données extraites de la file d'attente, taille: {} octets, discontinuité: {}", 
-                      data.size(), isDiscontinuity ? "oui" : "non");
+            ownedData = std::move(queued.data);
+            sharedData = std::move(queued.shared);
+            charge = queued.charge;
+            isDiscontinuity = queued.discontinuity;
+            trace = queued.trace;
+            outputState = std::move(queued.outputState);
+            metrics = metrics_;
+            stateFile = stateFile_;
+            stateInterval = stateInterval_;
         }
         
+        // Un segment partagé avec d'autres sorties est lu sans être copié
+        const std::vector<uint8_t>& data = sharedData ? *sharedData : ownedData;
+        
+        SPDLOG_LOGGER_TRACE(log_, "Données extraites de la file d'attente, taille: {} octets, discontinuité: {}",
+                            data.size(), isDiscontinuity ? "oui" : "non");
+        
         if (data.empty()) {
-            spdlog::warn("Données extraites de la file d'attente vides, ignorées");
+            log_->warn("Données extraites de la file d'attente vides, ignorées");
             continue;
         }
         
@@ -462,95 +928,228 @@ void MulticastSender::senderLoop() {
         // Envoyer les données par paquets pour éviter la fragmentation
         int successPackets = 0;
         int failedPackets = 0;
+        int ringPending = 0;    // Trames écrites dans l'anneau et pas encore remises au noyau
         
         for (size_t offset = 0; offset < data.size(); offset += MAX_PACKET_SIZE) {
             // Calculer la taille du paquet actuel
             size_t packetSize = std::min(MAX_PACKET_SIZE, data.size() - offset);
             
-            spdlog::debug("Tentative d'envoi multicast: {} octets vers {}:{} (offset={})",
-                       packetSize, groupAddress_, port_, offset);
+            SPDLOG_LOGGER_TRACE(log_, "Tentative d'envoi multicast: {} octets vers {}:{} (offset={})",
+                                packetSize, groupAddress_, port_, offset);
+            
+            // Un lot complet est soumis avant d'y ajouter le datagramme et sa copie redondante
+            if (uring && !uring->hasRoom(redundant_ ? 2 : 1)) {
+                flushUring(*uring, metrics);
+            }
+            
+            // Encapsuler dans RTP si demandé (sur place dans le lot io_uring, qui n'est soumis que plus tard)
+            const uint8_t* datagram = data.data() + offset;
+            size_t datagramSize = packetSize;
+            if (rtp_) {
+                uint8_t* packet = uring ? uring->slot() : rtpPacket;
+                datagramSize = rtp_->packetize(datagram, packetSize, packet);
+                datagram = packet;
+            }
             
-            // Envoyer le paquet
-            int sendResult = sendto(socket_, 
-                                  reinterpret_cast<const char*>(data.data() + offset), 
-                                  static_cast<int>(packetSize), 
+            // Envoyer le paquet: dans le lot io_uring, par l'anneau d'émission s'il est disponible
+            // et a de la place, sinon par le socket
+            int sendResult;
+            if (uring) {
+                uring->queue(socket_, destAddr, datagram, datagramSize, true);
+                sendResult = static_cast<int>(datagramSize);
+            } else if (ring && ring->send(destAddr.sin_addr.s_addr, destAddr.sin_port, htons(static_cast<uint16_t>(port_)),
+                                   static_cast<uint8_t>(ttl_), datagram, datagramSize)) {
+                sendResult = static_cast<int>(datagramSize);
+                if (++ringPending >= RING_FLUSH_FRAMES) {
+                    ring->flush();
+                    ringPending = 0;
+                }
+            } else {
+                if (ring && !ringFallbackLogged) {
+                    ringFallbackLogged = true;
+                    log_->warn("Anneau d'émission {} plein, repli sur le socket UDP pour {}:{}",
+                               ring->getInterface(), groupAddress_, port_);
+                }
+                // Les trames précédentes du segment partent d'abord: le datagramme envoyé par
+                // le socket ne doit pas les devancer (rupture de continuité chez les récepteurs)
+                if (ringPending > 0) {
+                    ring->flush();
+                    ringPending = 0;
+                }
+                sendResult = sendto(socket_, 
+                                  reinterpret_cast<const char*>(datagram), 
+                                  static_cast<int>(datagramSize), 
                                   0, 
                                   reinterpret_cast<struct sockaddr*>(&destAddr), 
                                   sizeof(destAddr));
-            if (sendResult != SOCKET_ERROR) {
-                // Log détaillé toutes les 100 paquets pour éviter de surcharger les logs
-                static int packetLogCount = 0;
-                if (++packetLogCount % 100 == 0) {
-                    spdlog::debug("Paquet multicast #{} envoyé avec succès: {} octets vers {}:{} (offset={})",
-                                packetLogCount, packetSize, groupAddress_, port_, offset);
+            }
+            
+            // Avec une copie redondante, chaque trame part aussitôt pour rester alignée sur sa copie
+            if (ringPending > 0 && redundant_) {
+                ring->flush();
+                ringPending = 0;
+            }
+            #ifdef _WIN32
+            int sendError = sendResult == SOCKET_ERROR ? WSAGetLastError() : 0;
+            #else
+            int sendError = sendResult == SOCKET_ERROR ? errno : 0;
+            #endif
+            
+            // Copie SMPTE 2022-7: le même datagramme, aussitôt, sur le second chemin
+            if (redundant_) {
+                if (uring) {
+                    uring->queue(static_cast<int>(redundant_->socket), redundant_->destination,
+                                 datagram, datagramSize, false);
+                } else {
+                    sendToOutput(*redundant_, datagram, datagramSize);
                 }
             }
+            
+            // Le paquet est protégé même s'il n'a pas pu être envoyé: la FEC peut le reconstituer
+            if (fec_) {
+                const auto& fecPackets = fec_->protect(datagram, datagramSize);
+                int fecFailures = sendFec(socket_, fecPackets, columnFecAddr, rowFecAddr);
+                stats_.errors.fetch_add(fecFailures, std::memory_order_relaxed);
+                if (redundant_) {
+                    fecFailures = sendFec(redundant_->socket, fecPackets, redundant_->columnFec, redundant_->rowFec);
+                    outputErrors_.fetch_add(fecFailures, std::memory_order_relaxed);
+                }
+            }
+            
+            // Les sorties supplémentaires reçoivent ensuite le même datagramme: elles ne
+            // retardent pas la sortie principale
+            if (!outputs_.empty()) {
+                sendToOutputs(data.data() + offset, packetSize);
+            }
+            
             if (sendResult == SOCKET_ERROR) {
                 failedPackets++;
-                stats_.errors++;
-                
-                #ifdef _WIN32
-                spdlog::error("Error sending multicast packet: {} (WSA error={})", WSAGetLastError(), WSAGetLastError());
-                #else
-                spdlog::error("Error sending multicast packet: {} (errno={})", strerror(errno), errno);
-                #endif
-                
-                AlertManager::getInstance().addAlert(
-                    AlertLevel::ERROR,
-                    "MulticastSender",
-                    "Error sending multicast packet",
-                    false
-                );
+                stats_.errors.fetch_add(1, std::memory_order_relaxed);
+                if (metrics) {
+                    metrics->sendErrors->increment();
+                }
                 
-                // Attendre un peu avant de réessayer
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                // Le datagramme est perdu, les suivants partent sans attendre
+                updatePrimaryState(1, sendError);
                 continue;
             }
             
+            // Avec io_uring, le résultat n'est connu qu'à la soumission du lot (flushUring)
+            if (!uring) {
+                updatePrimaryState(0, 0);
+            }
+            
             // Succès
+            if (successPackets == 0) {
+                trace.firstDatagramUs = SegmentTrace::nowUs();
+                
+                // Premier datagramme depuis la demande de démarrage du flux
+                int64_t requestedUs = metrics ? metrics->startRequestedUs.exchange(0, std::memory_order_relaxed) : 0;
+                if (requestedUs != 0) {
+                    double startupSeconds = (trace.firstDatagramUs - requestedUs) / 1e6;
+                    metrics->startupSeconds->set(startupSeconds);
+                    log_->info("Premier paquet multicast vers {}:{} émis {:.0f} ms après la demande de démarrage",
+                               groupAddress_, port_, startupSeconds * 1000.0);
+                }
+            }
             successPackets++;
-            packetsSentTotal++;
             
             // Mettre à jour les statistiques
-            stats_.packetsSent++;
-            stats_.bytesSent += packetSize;
+            stats_.packetsSent.fetch_add(1, std::memory_order_relaxed);
+            stats_.bytesSent.fetch_add(packetSize, std::memory_order_relaxed);
             bytesSent += packetSize;
-            
-            if (packetsSentTotal % 100 == 0) {
-                spdlog::info("Multicast: {} paquets envoyés avec succès jusqu'à présent", packetsSentTotal);
-                spdlog::info("Multicast: paquets envoyés {} ({}KB), état socket: {}, destination: {}:{}",
-                   packetsSentTotal, stats_.bytesSent/1024, socket_ != INVALID_SOCKET ? "valide" : "invalide",
-                   groupAddress_, port_);
+            if (metrics) {
+                metrics->sendPackets->increment();
+                metrics->sendBytes->increment(packetSize);
             }
             
             if (bitrateKbps_ > 0) {
+                // Remettre les trames de l'anneau ou le lot io_uring à chaque pas du lissage
+                if (ringPending > 0) {
+                    ring->flush();
+                    ringPending = 0;
+                }
+                if (uring && uring->hasPending()) {
+                    flushUring(*uring, metrics);
+                }
+                
                 // Ajouter un léger délai entre les paquets pour lisser le débit
                 std::this_thread::sleep_for(std::chrono::microseconds(100));
             }
         }
         
-        spdlog::info("Segment multicast envoyé: {} paquets réussis, {} paquets échoués", 
-                   successPackets, failedPackets);
+        // Sans lissage, les trames du segment sont remises au noyau en un seul appel (un par lot io_uring)
+        if (ringPending > 0) {
+            ring->flush();
+            ringPending = 0;
+        }
+        if (uring && uring->hasPending()) {
+            flushUring(*uring, metrics);
+        }
+        
+        SPDLOG_LOGGER_DEBUG(log_, "Segment multicast envoyé: {} paquets réussis, {} paquets échoués",
+                            successPackets, failedPackets);
+        
+        // Le segment est sorti: son état de sortie est celui que les récepteurs ont vu
+        if (outputState && stateFile && successPackets > 0) {
+            unsavedState = std::move(outputState);
+            if (std::chrono::steady_clock::now() - lastStateSave >= stateInterval) {
+                saveOutputState(*stateFile, *unsavedState);
+                unsavedState.reset();
+                lastStateSave = std::chrono::steady_clock::now();
+            }
+        }
+        
+        // Clore la trace du segment (les segments sans trace, comme les paquets de test, sont ignorés)
+        if (successPackets > 0 && trace.bufferDequeueUs != 0 && metrics && metrics->tracer) {
+            trace.lastDatagramUs = SegmentTrace::nowUs();
+            trace.bytes = data.size();
+            metrics->tracer->record(trace);
+        }
         
         // Mettre à jour le débit instantané
-        auto now = std::chrono::system_clock::now();
-        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - stats_.lastSendTime).count();
+        auto now = std::chrono::steady_clock::now();
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSegmentSent_).count();
         
         if (elapsedMs > 0) {
-            stats_.instantBitrate = (data.size() * 8.0) / (elapsedMs / 1000.0);
+            double instantBitrate = (data.size() * 8.0) / (elapsedMs / 1000.0);
+            double bitrate = stats_.bitrate.load(std::memory_order_relaxed);
             
             // Mise à jour du débit moyen (moyenne mobile)
-            if (stats_.bitrate == 0.0) {
-                stats_.bitrate = stats_.instantBitrate;
-            } else {
-                stats_.bitrate = stats_.bitrate * 0.9 + stats_.instantBitrate * 0.1;
+            bitrate = bitrate == 0.0 ? instantBitrate : bitrate * 0.9 + instantBitrate * 0.1;
+            
+            stats_.instantBitrate.store(instantBitrate, std::memory_order_relaxed);
+            stats_.bitrate.store(bitrate, std::memory_order_relaxed);
+            if (metrics) {
+                metrics->sendBitrate->set(instantBitrate);
             }
         }
         
-        stats_.lastSendTime = now;
+        lastSegmentSent_ = now;
+        stats_.lastSendTimeUs.store(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        
+        // Le segment est entièrement envoyé: libérer sa place dans le budget mémoire
+        // et rendre son tampon à la réserve (un tampon partagé y retourne avec la
+        // dernière sortie qui l'abandonne)
+        std::shared_ptr<BufferPool> pool;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            releaseQueuedBytesInternal(charge);
+            pool = bufferPool_;
+        }
+        if (sharedData) {
+            sharedData.reset();
+        } else if (pool) {
+            pool->release(std::move(ownedData));
+        }
+    }
+    // Dernier état envoyé, pour la reprise au prochain démarrage
+    if (unsavedState && stateFile) {
+        saveOutputState(*stateFile, *unsavedState);
     }
-    spdlog::info("Sortie de la boucle principale du MulticastSender, stats: packets={}, bytes={}, errors={}", stats_.packetsSent, stats_.bytesSent, stats_.errors);
+    spdlog::info("Sortie de la boucle principale du MulticastSender, stats: packets={}, bytes={}, errors={}",
+                 stats_.packetsSent.load(), stats_.bytesSent.load(), stats_.errors.load());
     spdlog::info("Thread d'envoi multicast terminé pour {}:{}", groupAddress_, port_);
 }
 
@@ -558,7 +1157,7 @@ void MulticastSender::senderLoop() {
 bool MulticastSender::createSocket() {
     // Fermer le socket existant si nécessaire
     closeSocket();
-    spdlog::info("createSocket() appelé");
+    SPDLOG_LOGGER_DEBUG(log_, "Création du socket multicast pour {}:{}", groupAddress_, port_);
     
 #ifdef __APPLE__
     // Vérifier l'état actuel du firewall
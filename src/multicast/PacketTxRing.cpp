@@ -0,0 +1,260 @@
+#include "multicast/PacketTxRing.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+
+#ifdef __linux__
+  #include <arpa/inet.h>
+  #include <linux/if_packet.h>
+  #include <net/ethernet.h>
+  #include <net/if.h>
+  #include <netinet/in.h>
+  #include <sys/ioctl.h>
+  #include <sys/mman.h>
+  #include <sys/socket.h>
+  #include <unistd.h>
+#endif
+
+namespace hls_to_dvb {
+
+namespace {
+    constexpr size_t ETHERNET_HEADER_SIZE = 14;
+    constexpr size_t IP_HEADER_SIZE = 20;
+    constexpr size_t UDP_HEADER_SIZE = 8;
+    constexpr size_t FRAME_HEADERS_SIZE = ETHERNET_HEADER_SIZE + IP_HEADER_SIZE + UDP_HEADER_SIZE;
+
+    // Trames de 2 Kio regroupées en blocs de 64 Kio (multiples de la taille de page)
+    constexpr size_t FRAME_SIZE = 2048;
+    constexpr size_t BLOCK_SIZE = 65536;
+
+    /**
+     * @brief Somme de contrôle de l'en-tête IPv4
+     */
+    uint16_t ipChecksum(const uint8_t* header) {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < IP_HEADER_SIZE; i += 2) {
+            sum += (uint32_t(header[i]) << 8) | header[i + 1];
+        }
+        while (sum >> 16) {
+            sum = (sum & 0xFFFF) + (sum >> 16);
+        }
+        return static_cast<uint16_t>(~sum);
+    }
+
+#ifdef __linux__
+    /**
+     * @brief Position des données dans une trame TPACKET_V2
+     */
+    constexpr size_t FRAME_DATA_OFFSET = TPACKET_ALIGN(sizeof(struct tpacket2_hdr));
+#endif
+}
+
+std::shared_ptr<PacketTxRing> PacketTxRing::acquire(const std::string& interface, int frames) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<PacketTxRing>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto existing = registry[interface].lock()) {
+        return existing;
+    }
+
+#ifndef __linux__
+    spdlog::warn("Anneau d'émission AF_PACKET non pris en charge sur cette plateforme, interface {}", interface);
+    return nullptr;
+#else
+    unsigned int ifindex = if_nametoindex(interface.c_str());
+    if (ifindex == 0) {
+        spdlog::warn("Anneau d'émission: interface {} introuvable", interface);
+        return nullptr;
+    }
+
+    // Protocole 0: la socket n'émet que, elle ne reçoit aucune trame
+    int fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (fd < 0) {
+        spdlog::warn("Anneau d'émission: socket AF_PACKET refusée sur {} ({}), CAP_NET_RAW requis",
+                     interface, strerror(errno));
+        return nullptr;
+    }
+
+    // Adresses MAC et IPv4 de l'interface, utilisées comme source des trames
+    struct ifreq ifr;
+    std::memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interface.c_str(), IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFHWADDR, &ifr) < 0) {
+        spdlog::warn("Anneau d'émission: adresse MAC de {} illisible ({})", interface, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    uint8_t sourceMac[6];
+    std::memcpy(sourceMac, ifr.ifr_hwaddr.sa_data, sizeof(sourceMac));
+
+    std::memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interface.c_str(), IFNAMSIZ - 1);
+    ifr.ifr_addr.sa_family = AF_INET;
+    if (ioctl(fd, SIOCGIFADDR, &ifr) < 0) {
+        spdlog::warn("Anneau d'émission: {} n'a pas d'adresse IPv4 ({})", interface, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    uint32_t sourceIp = reinterpret_cast<struct sockaddr_in*>(&ifr.ifr_addr)->sin_addr.s_addr;
+
+    int version = TPACKET_V2;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        spdlog::warn("Anneau d'émission: TPACKET_V2 indisponible ({})", strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    size_t framesPerBlock = BLOCK_SIZE / FRAME_SIZE;
+    size_t blocks = (static_cast<size_t>(std::max(frames, 1)) + framesPerBlock - 1) / framesPerBlock;
+    struct tpacket_req request;
+    std::memset(&request, 0, sizeof(request));
+    request.tp_block_size = BLOCK_SIZE;
+    request.tp_block_nr = static_cast<unsigned int>(blocks);
+    request.tp_frame_size = FRAME_SIZE;
+    request.tp_frame_nr = static_cast<unsigned int>(blocks * framesPerBlock);
+    if (setsockopt(fd, SOL_PACKET, PACKET_TX_RING, &request, sizeof(request)) < 0) {
+        spdlog::warn("Anneau d'émission: PACKET_TX_RING refusé sur {} ({})", interface, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    struct sockaddr_ll address;
+    std::memset(&address, 0, sizeof(address));
+    address.sll_family = AF_PACKET;
+    address.sll_protocol = htons(ETH_P_IP);
+    address.sll_ifindex = static_cast<int>(ifindex);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+        spdlog::warn("Anneau d'émission: liaison à {} impossible ({})", interface, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    size_t ringSize = blocks * BLOCK_SIZE;
+    void* mapping = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::warn("Anneau d'émission: projection impossible sur {} ({})", interface, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    std::shared_ptr<PacketTxRing> ring(new PacketTxRing(interface, fd, static_cast<uint8_t*>(mapping), ringSize,
+                                                        FRAME_SIZE, request.tp_frame_nr, sourceMac, sourceIp));
+    registry[interface] = ring;
+    spdlog::info("Anneau d'émission AF_PACKET ouvert sur {} ({} trames)", interface, request.tp_frame_nr);
+    return ring;
+#endif
+}
+
+PacketTxRing::PacketTxRing(const std::string& interface, int fd, uint8_t* ring, size_t ringSize,
+                           size_t frameSize, size_t frameCount, const uint8_t* sourceMac, uint32_t sourceIp)
+    : interface_(interface), fd_(fd), ring_(ring), ringSize_(ringSize), frameSize_(frameSize),
+      frameCount_(frameCount), sourceIp_(sourceIp) {
+    std::memcpy(sourceMac_, sourceMac, sizeof(sourceMac_));
+}
+
+PacketTxRing::~PacketTxRing() {
+#ifdef __linux__
+    // Envoi bloquant: les trames en attente partent avant la libération de l'anneau
+    ::send(fd_, nullptr, 0, 0);
+    munmap(ring_, ringSize_);
+    close(fd_);
+#endif
+}
+
+bool PacketTxRing::send(uint32_t destinationIp, uint16_t destinationPort, uint16_t sourcePort, uint8_t ttl,
+                        const uint8_t* payload, size_t size) {
+#ifndef __linux__
+    return false;
+#else
+    uint32_t group = ntohl(destinationIp);
+    if ((group & 0xF0000000) != 0xE0000000 || FRAME_DATA_OFFSET + FRAME_HEADERS_SIZE + size > frameSize_) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint8_t* frame = ring_ + next_ * frameSize_;
+    auto* header = reinterpret_cast<struct tpacket2_hdr*>(frame);
+    uint32_t status = __atomic_load_n(&header->tp_status, __ATOMIC_ACQUIRE);
+    if (status != TP_STATUS_AVAILABLE && status != TP_STATUS_WRONG_FORMAT) {
+        return false;   // Anneau plein: le noyau n'a pas encore émis cette trame
+    }
+
+    uint8_t* data = frame + FRAME_DATA_OFFSET;
+
+    // Ethernet: MAC multicast 01:00:5e + 23 bits de poids faible du groupe
+    data[0] = 0x01;
+    data[1] = 0x00;
+    data[2] = 0x5E;
+    data[3] = static_cast<uint8_t>((group >> 16) & 0x7F);
+    data[4] = static_cast<uint8_t>(group >> 8);
+    data[5] = static_cast<uint8_t>(group);
+    std::memcpy(data + 6, sourceMac_, 6);
+    data[12] = 0x08;
+    data[13] = 0x00;
+
+    // IPv4 sans options
+    uint8_t* ip = data + ETHERNET_HEADER_SIZE;
+    uint16_t totalLength = static_cast<uint16_t>(IP_HEADER_SIZE + UDP_HEADER_SIZE + size);
+    uint16_t id = ipId_++;
+    ip[0] = 0x45;
+    ip[1] = 0;
+    ip[2] = static_cast<uint8_t>(totalLength >> 8);
+    ip[3] = static_cast<uint8_t>(totalLength);
+    ip[4] = static_cast<uint8_t>(id >> 8);
+    ip[5] = static_cast<uint8_t>(id);
+    ip[6] = 0x40;   // Ne pas fragmenter
+    ip[7] = 0;
+    ip[8] = ttl;
+    ip[9] = IPPROTO_UDP;
+    ip[10] = 0;
+    ip[11] = 0;
+    std::memcpy(ip + 12, &sourceIp_, 4);
+    std::memcpy(ip + 16, &destinationIp, 4);
+    uint16_t checksum = ipChecksum(ip);
+    ip[10] = static_cast<uint8_t>(checksum >> 8);
+    ip[11] = static_cast<uint8_t>(checksum);
+
+    // UDP sans somme de contrôle (facultative en IPv4)
+    uint8_t* udp = ip + IP_HEADER_SIZE;
+    uint16_t udpLength = static_cast<uint16_t>(UDP_HEADER_SIZE + size);
+    std::memcpy(udp, &sourcePort, 2);
+    std::memcpy(udp + 2, &destinationPort, 2);
+    udp[4] = static_cast<uint8_t>(udpLength >> 8);
+    udp[5] = static_cast<uint8_t>(udpLength);
+    udp[6] = 0;
+    udp[7] = 0;
+    std::memcpy(udp + UDP_HEADER_SIZE, payload, size);
+
+    header->tp_len = static_cast<uint32_t>(FRAME_HEADERS_SIZE + size);
+    __atomic_store_n(&header->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+    next_ = (next_ + 1) % frameCount_;
+    framesSent_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+#endif
+}
+
+void PacketTxRing::flush() {
+#ifdef __linux__
+    // Un seul appel remet au noyau toutes les trames en attente, sans attendre leur émission
+    if (::send(fd_, nullptr, 0, MSG_DONTWAIT) < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        spdlog::warn("Anneau d'émission {}: remise des trames impossible ({})", interface_, strerror(errno));
+    }
+#endif
+}
+
+const std::string& PacketTxRing::getInterface() const {
+    return interface_;
+}
+
+uint64_t PacketTxRing::getFramesSent() const {
+    return framesSent_.load(std::memory_order_relaxed);
+}
+
+} // namespace hls_to_dvb
@@ -0,0 +1,98 @@
+#include "multicast/RtpPacketizer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace hls_to_dvb {
+
+namespace {
+    constexpr size_t TS_PACKET_SIZE = 188;
+
+    // Les PCR sont comptés sur 33 bits à 90 kHz
+    constexpr uint64_t PCR_BASE_MASK = (uint64_t(1) << 33) - 1;
+
+    // Écart au-delà duquel deux PCR successifs sont considérés comme discontinus (1 s)
+    constexpr uint64_t MAX_PCR_GAP = 90000;
+
+    /**
+     * @brief Horloge locale à 90 kHz
+     */
+    uint32_t localTimestamp() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count() * 9 / 100);
+    }
+}
+
+RtpPacketizer::RtpPacketizer() {
+    std::random_device random;
+    sequence_ = static_cast<uint16_t>(random());
+    ssrc_ = random();
+}
+
+uint32_t RtpPacketizer::timestampFor(const uint8_t* payload, size_t size) {
+    for (size_t offset = 0; offset + TS_PACKET_SIZE <= size; offset += TS_PACKET_SIZE) {
+        const uint8_t* packet = payload + offset;
+
+        // Champ d'adaptation présent, assez long pour un PCR, indicateur PCR positionné
+        if (packet[0] != 0x47 || !(packet[3] & 0x20) || packet[4] < 7 || !(packet[5] & 0x10)) {
+            continue;
+        }
+
+        uint16_t pid = static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+        if (hasPcr_ && pid != pcrPid_) {
+            continue;
+        }
+
+        uint64_t pcr = (uint64_t(packet[6]) << 25) | (uint64_t(packet[7]) << 17) |
+                       (uint64_t(packet[8]) << 9) | (uint64_t(packet[9]) << 1) | (packet[10] >> 7);
+        uint64_t position = bytes_ + offset;
+
+        // Débit entre deux PCR consécutifs; une rupture laisse l'ancien débit en place
+        if (hasPcr_ && position > lastPcrByte_) {
+            uint64_t gap = (pcr - lastPcr_) & PCR_BASE_MASK;
+            if (gap > 0 && gap < MAX_PCR_GAP) {
+                ticksPerByte_ = static_cast<double>(gap) / static_cast<double>(position - lastPcrByte_);
+            }
+        }
+
+        hasPcr_ = true;
+        pcrPid_ = pid;
+        lastPcr_ = pcr;
+        lastPcrByte_ = position;
+    }
+
+    if (!hasPcr_) {
+        return localTimestamp();
+    }
+
+    // Prolonger (ou remonter, si le PCR est dans ce datagramme) jusqu'au premier octet
+    double distance = static_cast<double>(bytes_) - static_cast<double>(lastPcrByte_);
+    int64_t ticks = static_cast<int64_t>(lastPcr_) + std::llround(distance * ticksPerByte_);
+    return static_cast<uint32_t>(ticks);
+}
+
+size_t RtpPacketizer::packetize(const uint8_t* payload, size_t size, uint8_t* packet) {
+    uint32_t timestamp = timestampFor(payload, size);
+    uint16_t sequence = sequence_++;
+
+    packet[0] = 0x80;   // Version 2, sans bourrage, extension ni CSRC
+    packet[1] = PAYLOAD_TYPE_MP2T;
+    packet[2] = static_cast<uint8_t>(sequence >> 8);
+    packet[3] = static_cast<uint8_t>(sequence);
+    packet[4] = static_cast<uint8_t>(timestamp >> 24);
+    packet[5] = static_cast<uint8_t>(timestamp >> 16);
+    packet[6] = static_cast<uint8_t>(timestamp >> 8);
+    packet[7] = static_cast<uint8_t>(timestamp);
+    packet[8] = static_cast<uint8_t>(ssrc_ >> 24);
+    packet[9] = static_cast<uint8_t>(ssrc_ >> 16);
+    packet[10] = static_cast<uint8_t>(ssrc_ >> 8);
+    packet[11] = static_cast<uint8_t>(ssrc_);
+    std::memcpy(packet + HEADER_SIZE, payload, size);
+
+    bytes_ += size;
+    return HEADER_SIZE + size;
+}
+
+} // namespace hls_to_dvb
@@ -0,0 +1,293 @@
+#include "multicast/UringTransmitter.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+  #define HLS2DVB_HAVE_IO_URING 1
+  #include <linux/io_uring.h>
+  #include <netinet/in.h>
+  #include <sys/mman.h>
+  #include <sys/socket.h>
+  #include <sys/syscall.h>
+  #include <sys/uio.h>
+  #include <unistd.h>
+  #include <chrono>
+  #include <thread>
+#else
+  #define HLS2DVB_HAVE_IO_URING 0
+  #include <cstdint>
+#endif
+
+namespace hls_to_dvb {
+
+#if HLS2DVB_HAVE_IO_URING
+
+namespace {
+    // Nouvelles tentatives d'un datagramme refusé temporairement (tampon du socket plein)
+    constexpr int MAX_TRANSIENT_RETRIES = 3;
+    constexpr auto TRANSIENT_RETRY_DELAY = std::chrono::microseconds(200);
+
+    bool isTransient(int error) {
+        return error == EAGAIN || error == EWOULDBLOCK || error == EINTR || error == ENOBUFS;
+    }
+
+    int uringSetup(unsigned entries, struct io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    unsigned* at(void* base, unsigned offset) {
+        return reinterpret_cast<unsigned*>(static_cast<uint8_t*>(base) + offset);
+    }
+}
+
+struct UringTransmitter::Entry {
+    struct msghdr message;
+    struct iovec vector;
+    struct sockaddr_in destination;
+    int socket = -1;            ///< Socket d'émission
+    bool primary = false;       ///< Datagramme de la sortie principale
+    int res = 0;                ///< Résultat de la dernière complétion
+    int retries = 0;            ///< Nouvelles tentatives après un refus temporaire
+};
+
+std::unique_ptr<UringTransmitter> UringTransmitter::create(unsigned entries) {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    int fd = uringSetup(entries == 0 ? 1 : entries, &params);
+    if (fd < 0) {
+        spdlog::warn("io_uring indisponible ({}), émission par sendto()", strerror(errno));
+        return nullptr;
+    }
+
+    std::unique_ptr<UringTransmitter> transmitter(new UringTransmitter());
+    transmitter->fd_ = fd;
+    transmitter->entries_ = params.sq_entries;
+
+    // Files de soumission et de complétion (une seule projection si le noyau le permet)
+    transmitter->sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    transmitter->cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        transmitter->sqRingSize_ = std::max(transmitter->sqRingSize_, transmitter->cqRingSize_);
+    }
+
+    void* sqRing = mmap(nullptr, transmitter->sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        spdlog::warn("io_uring: projection de la file de soumission impossible ({})", strerror(errno));
+        return nullptr;
+    }
+    transmitter->sqRing_ = sqRing;
+
+    if (singleMmap) {
+        transmitter->cqRing_ = sqRing;
+        transmitter->cqRingSize_ = 0;
+    } else {
+        void* cqRing = mmap(nullptr, transmitter->cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            spdlog::warn("io_uring: projection de la file de complétion impossible ({})", strerror(errno));
+            transmitter->cqRingSize_ = 0;
+            return nullptr;
+        }
+        transmitter->cqRing_ = cqRing;
+    }
+
+    transmitter->sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, transmitter->sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        spdlog::warn("io_uring: projection des entrées de soumission impossible ({})", strerror(errno));
+        transmitter->sqesSize_ = 0;
+        return nullptr;
+    }
+    transmitter->sqes_ = sqes;
+
+    transmitter->sqTail_ = at(sqRing, params.sq_off.tail);
+    transmitter->sqMask_ = at(sqRing, params.sq_off.ring_mask);
+    transmitter->sqArray_ = at(sqRing, params.sq_off.array);
+    transmitter->cqHead_ = at(transmitter->cqRing_, params.cq_off.head);
+    transmitter->cqTail_ = at(transmitter->cqRing_, params.cq_off.tail);
+    transmitter->cqMask_ = at(transmitter->cqRing_, params.cq_off.ring_mask);
+    transmitter->cqes_ = static_cast<uint8_t*>(transmitter->cqRing_) + params.cq_off.cqes;
+
+    transmitter->entryStates_.resize(params.sq_entries);
+    transmitter->slots_.resize(static_cast<size_t>(params.sq_entries) * SLOT_SIZE);
+
+    spdlog::info("io_uring: lots de {} datagrammes", params.sq_entries);
+    return transmitter;
+}
+
+UringTransmitter::~UringTransmitter() {
+    if (sqes_) {
+        munmap(sqes_, sqesSize_);
+    }
+    if (cqRing_ && cqRing_ != sqRing_) {
+        munmap(cqRing_, cqRingSize_);
+    }
+    if (sqRing_) {
+        munmap(sqRing_, sqRingSize_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool UringTransmitter::hasRoom(unsigned datagrams) const {
+    return pending_ + datagrams <= entries_;
+}
+
+bool UringTransmitter::hasPending() const {
+    return pending_ > 0;
+}
+
+uint8_t* UringTransmitter::slot() {
+    return slots_.data() + static_cast<size_t>(pending_) * SLOT_SIZE;
+}
+
+void UringTransmitter::queue(int socket, const struct sockaddr_in& destination, const uint8_t* data, size_t size,
+                             bool primary) {
+    // Le message, son vecteur et l'adresse doivent survivre jusqu'à la complétion
+    Entry& entry = entryStates_[pending_];
+    entry.socket = socket;
+    entry.primary = primary;
+    entry.res = 0;
+    entry.retries = 0;
+    entry.destination = destination;
+    entry.vector.iov_base = const_cast<uint8_t*>(data);
+    entry.vector.iov_len = size;
+    std::memset(&entry.message, 0, sizeof(entry.message));
+    entry.message.msg_name = &entry.destination;
+    entry.message.msg_namelen = sizeof(entry.destination);
+    entry.message.msg_iov = &entry.vector;
+    entry.message.msg_iovlen = 1;
+
+    pending_++;
+}
+
+void UringTransmitter::countFailure(Result& result, const Entry& entry, int error) {
+    result.error = result.error ? result.error : error;
+    (entry.primary ? result.primaryFailures : result.otherFailures)++;
+}
+
+unsigned UringTransmitter::submitChain(unsigned first, Result& result) {
+    // Entrées chaînées (IOSQE_IO_LINK): le noyau les exécute dans l'ordre, et un échec
+    // annule la suite de la chaîne (-ECANCELED) au lieu de laisser passer les suivantes
+    unsigned tail = *sqTail_;
+    for (unsigned i = first; i < pending_; ++i) {
+        unsigned index = (tail + (i - first)) & *sqMask_;
+        auto* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = entryStates_[i].socket;
+        sqe->addr = reinterpret_cast<uint64_t>(&entryStates_[i].message);
+        sqe->len = 1;
+        sqe->flags = i + 1 < pending_ ? IOSQE_IO_LINK : 0;
+        sqe->user_data = i;
+        sqArray_[index] = index;
+        entryStates_[i].res = -ECANCELED;
+    }
+    __atomic_store_n(sqTail_, tail + (pending_ - first), __ATOMIC_RELEASE);
+
+    // Soumettre et récolter exactement les complétions de la chaîne
+    unsigned count = pending_ - first;
+    unsigned toSubmit = count;
+    unsigned reaped = 0;
+    while (reaped < count) {
+        int submitted = uringEnter(fd_, toSubmit, 1, IORING_ENTER_GETEVENTS);
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            // Anneau inutilisable: seules les entrées jamais soumises sont renvoyées par
+            // sendmsg(); celles soumises sans complétion récoltée ne sont pas comptées
+            result.error = result.error ? result.error : errno;
+            broken_ = true;
+            spdlog::warn("io_uring: soumission impossible ({}), émission par sendmsg()", strerror(errno));
+            return pending_ - toSubmit;
+        }
+        toSubmit -= std::min<unsigned>(toSubmit, static_cast<unsigned>(submitted));
+
+        unsigned head = *cqHead_;
+        unsigned cqTail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        for (; head != cqTail; ++head) {
+            const auto& cqe = static_cast<const struct io_uring_cqe*>(cqes_)[head & *cqMask_];
+            if (cqe.user_data < pending_) {
+                entryStates_[cqe.user_data].res = cqe.res;
+            }
+            reaped++;
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    }
+
+    // Reprendre au premier datagramme annulé ou refusé temporairement, dans l'ordre
+    for (unsigned i = first; i < pending_; ++i) {
+        Entry& entry = entryStates_[i];
+        if (entry.res >= 0) {
+            continue;
+        }
+        if (entry.res == -ECANCELED) {
+            return i;
+        }
+        if (isTransient(-entry.res) && entry.retries < MAX_TRANSIENT_RETRIES) {
+            entry.retries++;
+            std::this_thread::sleep_for(TRANSIENT_RETRY_DELAY);
+            return i;
+        }
+        countFailure(result, entry, -entry.res);
+    }
+    return pending_;
+}
+
+UringTransmitter::Result UringTransmitter::flush() {
+    Result result;
+    unsigned next = 0;
+    while (next < pending_ && !broken_) {
+        next = submitChain(next, result);
+    }
+
+    // Anneau hors service: la fin du lot part par sendmsg(), toujours dans l'ordre
+    for (; next < pending_; ++next) {
+        Entry& entry = entryStates_[next];
+        if (sendmsg(entry.socket, &entry.message, 0) < 0) {
+            countFailure(result, entry, errno);
+        }
+    }
+
+    pending_ = 0;
+    return result;
+}
+
+#else
+
+struct UringTransmitter::Entry {};
+
+std::unique_ptr<UringTransmitter> UringTransmitter::create(unsigned) {
+    spdlog::warn("io_uring non pris en charge sur cette plateforme, émission par sendto()");
+    return nullptr;
+}
+
+UringTransmitter::~UringTransmitter() = default;
+
+bool UringTransmitter::hasRoom(unsigned) const { return false; }
+
+bool UringTransmitter::hasPending() const { return false; }
+
+uint8_t* UringTransmitter::slot() { return nullptr; }
+
+void UringTransmitter::queue(int, const struct sockaddr_in&, const uint8_t*, size_t, bool) {}
+
+UringTransmitter::Result UringTransmitter::flush() { return Result(); }
+
+#endif
+
+} // namespace hls_to_dvb
@@ -0,0 +1,112 @@
+#include "web/EventStream.h"
+
+#include <algorithm>
+
+namespace hls_to_dvb {
+
+EventStream::EventStream(size_t historySize)
+    : historySize_(std::max<size_t>(1, historySize)) {
+}
+
+void EventStream::publish(const std::string& event, const std::string& data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastId_++;
+
+        std::string text;
+        text.reserve(event.size() + data.size() + 32);
+        text += "id: ";
+        text += std::to_string(lastId_);
+        text += "\nevent: ";
+        text += event;
+        text += "\ndata: ";
+        text += data;
+        text += "\n\n";
+
+        history_.push_back({lastId_, std::move(text)});
+        while (history_.size() > historySize_) {
+            history_.pop_front();
+        }
+    }
+    cond_.notify_all();
+}
+
+void EventStream::setSnapshot(const std::string& data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot_ = data;
+    }
+    cond_.notify_all();
+}
+
+bool EventStream::subscribe(size_t maxSubscribers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || subscribers_ >= maxSubscribers) {
+        return false;
+    }
+    subscribers_++;
+    return true;
+}
+
+void EventStream::unsubscribe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (subscribers_ > 0) {
+        subscribers_--;
+    }
+}
+
+size_t EventStream::getSubscriberCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_;
+}
+
+bool EventStream::waitForEvents(uint64_t& cursor, std::string& out, std::chrono::milliseconds timeout) {
+    out.clear();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait_for(lock, timeout, [this, cursor] {
+        return closed_ || (cursor == 0 ? !snapshot_.empty() : lastId_ > cursor);
+    });
+    if (closed_) {
+        return false;
+    }
+    if (cursor == 0 ? snapshot_.empty() : lastId_ <= cursor) {
+        return true;
+    }
+
+    // Nouveau client ou client en retard: l'état complet remplace les événements manqués
+    bool missedEvents = !history_.empty() && history_.front().id > cursor + 1;
+    if (cursor == 0 || missedEvents) {
+        out += "id: ";
+        out += std::to_string(lastId_);
+        out += "\nevent: snapshot\ndata: ";
+        out += snapshot_;
+        out += "\n\n";
+        // L'état complet inclut déjà le premier événement s'il n'est pas encore publié
+        cursor = std::max<uint64_t>(lastId_, 1);
+        return true;
+    }
+
+    for (const auto& event : history_) {
+        if (event.id > cursor) {
+            out += event.text;
+        }
+    }
+    cursor = lastId_;
+    return true;
+}
+
+void EventStream::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cond_.notify_all();
+}
+
+void EventStream::reopen() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+}
+
+} // namespace hls_to_dvb
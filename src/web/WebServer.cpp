@@ -3,9 +3,13 @@
 #include <nlohmann/json.hpp>
 #include <thread>
 #include <chrono>
+#include <map>
 #include <fstream>  // Ajout pour std::ifstream
 #include <algorithm> // Pour std::transform, std::replace, etc.
 #include "alerting/AlertManager.h" // Ajout de l'include pour AlertManager
+#include "core/BufferAccountant.h"
+#include "core/Logging.h"
+#include "core/MetricsRegistry.h"
 #include <cerrno> // Pour strerror
 #include <filesystem>
 
@@ -30,9 +34,37 @@
 
 namespace hls_to_dvb {
 
+namespace {
+    // Chaque client SSE occupe un thread du serveur pendant toute sa connexion: la réserve
+    // est agrandie et le nombre de clients limité pour laisser des threads à l'API
+    constexpr size_t SERVER_THREADS = 16;
+    constexpr size_t MAX_EVENT_SUBSCRIBERS = 8;
+    constexpr auto EVENTS_PERIOD = std::chrono::seconds(1);
+    constexpr auto EVENTS_KEEPALIVE = std::chrono::seconds(15);
+
+    // Origines HLS d'un flux, dans l'ordre de la configuration
+    nlohmann::json originsToJson(const std::vector<HLSOriginStats>& origins) {
+        nlohmann::json json = nlohmann::json::array();
+        for (const auto& origin : origins) {
+            json.push_back({
+                {"url", origin.url},
+                {"active", origin.active},
+                {"healthy", origin.healthy},
+                {"firstByteMs", origin.firstByteMs},
+                {"requests", origin.requests},
+                {"errors", origin.errors},
+                {"hedges", origin.hedges},
+                {"wins", origin.wins}
+            });
+        }
+        return json;
+    }
+}
+
 WebServer::WebServer(Config& config, StreamManager& streamManager, const std::string& webRoot)
     : config_(config), streamManager_(streamManager), webRoot_(webRoot), running_(false) {
     server_ = std::make_unique<httplib::Server>();
+    server_->new_task_queue = [] { return new httplib::ThreadPool(SERVER_THREADS); };
 }
 
 WebServer::~WebServer() {
@@ -90,6 +122,8 @@ bool WebServer::start() {
     
     // Démarrer le serveur dans un thread séparé
     running_ = true;
+    events_.reopen();
+    publisherThread_ = std::thread(&WebServer::publisherLoop, this);
     serverThread_ = std::thread([this, serverConfig]() {
         try {
             spdlog::info("Thread du serveur démarré");
@@ -127,6 +161,13 @@ bool WebServer::start() {
         spdlog::info("Serveur web démarré avec succès");
     } else {
         spdlog::error("Échec du démarrage du serveur web");
+        publisherCond_.notify_all();
+        if (publisherThread_.joinable()) {
+            publisherThread_.join();
+        }
+        if (serverThread_.joinable()) {
+            serverThread_.join();
+        }
     }
     
     return running_;
@@ -140,6 +181,17 @@ void WebServer::stop() {
     
     spdlog::info("Arrêt du serveur web");
     
+    // Libérer les connexions SSE, qui bloqueraient l'arrêt du serveur
+    events_.close();
+    {
+        std::lock_guard<std::mutex> lock(publisherMutex_);
+        running_ = false;
+    }
+    publisherCond_.notify_all();
+    if (publisherThread_.joinable()) {
+        publisherThread_.join();
+    }
+    
     // Arrêter le serveur
     server_->stop();
     
@@ -165,6 +217,10 @@ void WebServer::setupRoutes() {
         this->handleGetStreams(req, res);
     });
     
+    server_->Get("/api/events", [this](const httplib::Request& req, httplib::Response& res) {
+        this->handleGetEvents(req, res);
+    });
+    
     server_->Post("/api/streams", [this](const httplib::Request& req, httplib::Response& res) {
         this->handleCreateStream(req, res);
     });
@@ -193,6 +249,18 @@ void WebServer::setupRoutes() {
         this->handleGetStats(req, res);
     });
     
+    server_->Get(R"(/api/streams/([^/]+)/latency)", [this](const httplib::Request& req, httplib::Response& res) {
+        this->handleGetStreamLatency(req, res);
+    });
+    
+    server_->Get("/api/trace", [this](const httplib::Request& req, httplib::Response& res) {
+        this->handleGetTrace(req, res);
+    });
+    
+    server_->Get("/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+        this->handleGetMetrics(req, res);
+    });
+    
     server_->Get("/api/alerts", [this](const httplib::Request& req, httplib::Response& res) {
         this->handleGetAlerts(req, res);
     });
@@ -240,6 +308,10 @@ void WebServer::handleGetStatus([[maybe_unused]] const httplib::Request& req, ht
 }
 
 void WebServer::handleGetStreams([[maybe_unused]] const httplib::Request& req, httplib::Response& res) {
+    res.set_content(buildStreamsJson().dump(), "application/json");
+}
+
+nlohmann::json WebServer::buildStreamsJson() {
     nlohmann::json streamsJson = nlohmann::json::array();
     
     for (const auto& streamConfig : config_.getStreamConfigs()) {
@@ -249,9 +321,20 @@ void WebServer::handleGetStreams([[maybe_unused]] const httplib::Request& req, h
             {"id", streamConfig.id},
             {"name", streamConfig.name},
             {"hlsInput", streamConfig.hlsInput},
+            {"hlsInputs", streamConfig.hlsInputs},
             {"multicastOutput", streamConfig.mcastOutput},
             {"multicastPort", streamConfig.mcastPort},
+            {"mcastProtocol", streamConfig.mcastProtocol},
+            {"fecColumns", streamConfig.fecColumns},
+            {"fecRows", streamConfig.fecRows},
             {"bufferSize", streamConfig.bufferSize},
+            {"bufferMinMs", streamConfig.bufferMinMs},
+            {"bufferMaxMs", streamConfig.bufferMaxMs},
+            {"passthrough", streamConfig.passthrough},
+            {"latencyTargetMs", streamConfig.latencyTargetMs},
+            {"catchUpPolicy", streamConfig.catchUpPolicy},
+            {"outputs", streamConfig.outputs},
+            {"redundantOutput", streamConfig.redundantOutput},
             {"enabled", streamConfig.enabled},
             {"running", isRunning}
         };
@@ -265,12 +348,37 @@ void WebServer::handleGetStreams([[maybe_unused]] const httplib::Request& req, h
                     {"discontinuitiesDetected", stats->discontinuitiesDetected},
                     {"bufferSize", stats->bufferSize},
                     {"bufferCapacity", stats->bufferCapacity},
+                    {"bufferDepthMs", stats->bufferDepthMs},
+                    {"bufferTargetMs", stats->bufferTargetMs},
+                    {"bufferJitterMs", stats->bufferJitterMs},
+                    {"bufferUnderruns", stats->bufferUnderruns},
+                    {"bufferOverruns", stats->bufferOverruns},
+                    {"memoryBytes", stats->memoryBytes},
+                    {"hlsQueueBytes", stats->hlsQueueBytes},
+                    {"segmentBufferBytes", stats->segmentBufferBytes},
+                    {"multicastQueueBytes", stats->multicastQueueBytes},
+                    {"poolHeapAllocations", stats->poolHeapAllocations},
+                    {"poolReuses", stats->poolReuses},
+                    {"poolAllocationsPerSegment", stats->poolAllocationsPerSegment},
+                    {"poolPooledBytes", stats->poolPooledBytes},
+                    {"poolPeakPooledBytes", stats->poolPeakPooledBytes},
+                    {"passthroughActive", stats->passthroughActive},
+                    {"passthroughSegments", stats->passthroughSegments},
+                    {"passthroughFallbackReason", stats->passthroughFallbackReason},
+                    {"liveLatencyMs", stats->liveLatencyMs},
+                    {"catchUpSkips", stats->catchUpSkips},
+                    {"catchingUp", stats->catchingUp},
+                    {"ingestSourceId", stats->ingestSourceId},
+                    {"fanOutOutputs", stats->fanOutOutputs},
+                    {"outputs", stats->outputs},
+                    {"outputErrors", stats->outputErrors},
                     {"packetsTransmitted", stats->packetsTransmitted},
                     {"currentBitrate", stats->currentBitrate},
                     {"width", stats->width},
                     {"height", stats->height},
                     {"bandwidth", stats->bandwidth},
-                    {"codecs", stats->codecs}
+                    {"codecs", stats->codecs},
+                    {"origins", originsToJson(stats->origins)}
                 };
             }
         }
@@ -278,7 +386,120 @@ void WebServer::handleGetStreams([[maybe_unused]] const httplib::Request& req, h
         streamsJson.push_back(streamJson);
     }
     
-    res.set_content(streamsJson.dump(), "application/json");
+    return streamsJson;
+}
+
+void WebServer::handleGetEvents([[maybe_unused]] const httplib::Request& req, httplib::Response& res) {
+    if (!events_.subscribe(MAX_EVENT_SUBSCRIBERS)) {
+        res.status = 503;
+        nlohmann::json response = {
+            {"error", "Nombre maximal de tableaux de bord connectés atteint"}
+        };
+        res.set_content(response.dump(), "application/json");
+        return;
+    }
+    
+    // Réveiller le thread de publication pour que l'état complet soit prêt au plus tôt
+    publisherCond_.notify_all();
+    
+    res.set_header("Cache-Control", "no-cache");
+    res.set_header("X-Accel-Buffering", "no");
+    
+    auto cursor = std::make_shared<uint64_t>(0);
+    res.set_chunked_content_provider("text/event-stream",
+        [this, cursor](size_t, httplib::DataSink& sink) {
+            std::string text;
+            if (!events_.waitForEvents(*cursor, text, EVENTS_KEEPALIVE)) {
+                sink.done();
+                return true;
+            }
+            
+            // Un commentaire périodique maintient la connexion à travers les proxys
+            if (text.empty()) {
+                text = ": keepalive\n\n";
+            }
+            return sink.write(text.data(), text.size());
+        },
+        [this](bool) {
+            events_.unsubscribe();
+        });
+}
+
+void WebServer::publisherLoop() {
+    std::map<std::string, std::string> previousStreams;
+    std::string previousAlerts;
+    
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(publisherMutex_);
+            publisherCond_.wait_for(lock, EVENTS_PERIOD);
+        }
+        if (!running_) {
+            break;
+        }
+        
+        // Aucun client: ne rien construire, et repartir d'un état vierge au prochain
+        if (events_.getSubscriberCount() == 0) {
+            if (!previousStreams.empty() || !previousAlerts.empty()) {
+                previousStreams.clear();
+                previousAlerts.clear();
+                events_.setSnapshot("");
+            }
+            continue;
+        }
+        
+        try {
+            nlohmann::json streams = buildStreamsJson();
+            nlohmann::json alerts = buildAlertsJson();
+            nlohmann::json stats = buildStatsJson();
+            
+            // Ne transmettre que les flux modifiés ou supprimés depuis la période précédente
+            std::map<std::string, std::string> currentStreams;
+            nlohmann::json updated = nlohmann::json::array();
+            for (const auto& stream : streams) {
+                std::string id = stream["id"].get<std::string>();
+                std::string text = stream.dump();
+                auto previous = previousStreams.find(id);
+                if (previous == previousStreams.end() || previous->second != text) {
+                    updated.push_back(stream);
+                }
+                currentStreams.emplace(std::move(id), std::move(text));
+            }
+            
+            nlohmann::json removed = nlohmann::json::array();
+            for (const auto& [id, text] : previousStreams) {
+                if (currentStreams.find(id) == currentStreams.end()) {
+                    removed.push_back(id);
+                }
+            }
+            
+            std::string alertsText = alerts.dump();
+            
+            nlohmann::json snapshot = {
+                {"streams", streams},
+                {"alerts", alerts},
+                {"stats", stats}
+            };
+            events_.setSnapshot(snapshot.dump());
+            
+            if (!updated.empty() || !removed.empty()) {
+                nlohmann::json delta = {
+                    {"updated", updated},
+                    {"removed", removed}
+                };
+                events_.publish("streams", delta.dump());
+            }
+            if (alertsText != previousAlerts) {
+                events_.publish("alerts", alertsText);
+            }
+            events_.publish("stats", stats.dump());
+            
+            previousStreams.swap(currentStreams);
+            previousAlerts.swap(alertsText);
+        } catch (const std::exception& e) {
+            spdlog::error("Erreur lors de la publication des événements: {}", e.what());
+        }
+    }
 }
 
 // Implémentation des autres méthodes de gestionnaire
@@ -290,9 +511,23 @@ void WebServer::handleCreateStream(const httplib::Request& req, httplib::Respons
         StreamConfig config;
         config.name = json.value("name", "");
         config.hlsInput = json.value("hlsInput", "");
+        config.hlsInputs = json.value("hlsInputs", config.hlsInputs);
+        if (config.hlsInput.empty() && !config.hlsInputs.empty()) {
+            config.hlsInput = config.hlsInputs.front();
+        }
         config.mcastOutput = json.value("multicastOutput", "");
         config.mcastPort = json.value("multicastPort", 1234);
+        config.mcastProtocol = json.value("mcastProtocol", config.mcastProtocol);
+        config.fecColumns = json.value("fecColumns", config.fecColumns);
+        config.fecRows = json.value("fecRows", config.fecRows);
         config.bufferSize = json.value("bufferSize", 3);
+        config.bufferMinMs = json.value("bufferMinMs", config.bufferMinMs);
+        config.bufferMaxMs = json.value("bufferMaxMs", config.bufferMaxMs);
+        config.passthrough = json.value("passthrough", config.passthrough);
+        config.latencyTargetMs = json.value("latencyTargetMs", config.latencyTargetMs);
+        config.catchUpPolicy = json.value("catchUpPolicy", config.catchUpPolicy);
+        config.outputs = json.value("outputs", config.outputs);
+        config.redundantOutput = json.value("redundantOutput", config.redundantOutput);
         config.enabled = json.value("enabled", true);
         
         // Générer un ID si non fourni
@@ -323,9 +558,20 @@ void WebServer::handleCreateStream(const httplib::Request& req, httplib::Respons
             {"id", config.id},
             {"name", config.name},
             {"hlsInput", config.hlsInput},
+            {"hlsInputs", config.hlsInputs},
             {"multicastOutput", config.mcastOutput},
             {"multicastPort", config.mcastPort},
+            {"mcastProtocol", config.mcastProtocol},
+            {"fecColumns", config.fecColumns},
+            {"fecRows", config.fecRows},
             {"bufferSize", config.bufferSize},
+            {"bufferMinMs", config.bufferMinMs},
+            {"bufferMaxMs", config.bufferMaxMs},
+            {"passthrough", config.passthrough},
+            {"latencyTargetMs", config.latencyTargetMs},
+            {"catchUpPolicy", config.catchUpPolicy},
+            {"outputs", config.outputs},
+            {"redundantOutput", config.redundantOutput},
             {"enabled", config.enabled},
             {"running", false}
         };
@@ -365,9 +611,20 @@ void WebServer::handleGetStream(const httplib::Request& req, httplib::Response&
         {"id", streamConfig->id},
         {"name", streamConfig->name},
         {"hlsInput", streamConfig->hlsInput},
+        {"hlsInputs", streamConfig->hlsInputs},
         {"multicastOutput", streamConfig->mcastOutput},
         {"multicastPort", streamConfig->mcastPort},
+        {"mcastProtocol", streamConfig->mcastProtocol},
+        {"fecColumns", streamConfig->fecColumns},
+        {"fecRows", streamConfig->fecRows},
         {"bufferSize", streamConfig->bufferSize},
+        {"bufferMinMs", streamConfig->bufferMinMs},
+        {"bufferMaxMs", streamConfig->bufferMaxMs},
+        {"passthrough", streamConfig->passthrough},
+        {"latencyTargetMs", streamConfig->latencyTargetMs},
+        {"catchUpPolicy", streamConfig->catchUpPolicy},
+        {"outputs", streamConfig->outputs},
+        {"redundantOutput", streamConfig->redundantOutput},
         {"enabled", streamConfig->enabled},
         {"running", isRunning}
     };
@@ -381,12 +638,37 @@ void WebServer::handleGetStream(const httplib::Request& req, httplib::Response&
                 {"discontinuitiesDetected", stats->discontinuitiesDetected},
                 {"bufferSize", stats->bufferSize},
                 {"bufferCapacity", stats->bufferCapacity},
+                {"bufferDepthMs", stats->bufferDepthMs},
+                {"bufferTargetMs", stats->bufferTargetMs},
+                {"bufferJitterMs", stats->bufferJitterMs},
+                {"bufferUnderruns", stats->bufferUnderruns},
+                {"bufferOverruns", stats->bufferOverruns},
+                {"memoryBytes", stats->memoryBytes},
+                {"hlsQueueBytes", stats->hlsQueueBytes},
+                {"segmentBufferBytes", stats->segmentBufferBytes},
+                {"multicastQueueBytes", stats->multicastQueueBytes},
+                {"poolHeapAllocations", stats->poolHeapAllocations},
+                {"poolReuses", stats->poolReuses},
+                {"poolAllocationsPerSegment", stats->poolAllocationsPerSegment},
+                {"poolPooledBytes", stats->poolPooledBytes},
+                {"poolPeakPooledBytes", stats->poolPeakPooledBytes},
+                {"passthroughActive", stats->passthroughActive},
+                {"passthroughSegments", stats->passthroughSegments},
+                {"passthroughFallbackReason", stats->passthroughFallbackReason},
+                {"liveLatencyMs", stats->liveLatencyMs},
+                {"catchUpSkips", stats->catchUpSkips},
+                {"catchingUp", stats->catchingUp},
+                {"ingestSourceId", stats->ingestSourceId},
+                {"fanOutOutputs", stats->fanOutOutputs},
+                {"outputs", stats->outputs},
+                {"outputErrors", stats->outputErrors},
                 {"packetsTransmitted", stats->packetsTransmitted},
                 {"currentBitrate", stats->currentBitrate},
                 {"width", stats->width},
                 {"height", stats->height},
                 {"bandwidth", stats->bandwidth},
-                {"codecs", stats->codecs}
+                {"codecs", stats->codecs},
+                {"origins", originsToJson(stats->origins)}
             };
         }
     }
@@ -418,9 +700,20 @@ void WebServer::handleUpdateStream(const httplib::Request& req, httplib::Respons
         // Mettre à jour les champs fournis
         if (json.contains("name")) config.name = json["name"];
         if (json.contains("hlsInput")) config.hlsInput = json["hlsInput"];
+        if (json.contains("hlsInputs")) config.hlsInputs = json["hlsInputs"].get<std::vector<std::string>>();
         if (json.contains("multicastOutput")) config.mcastOutput = json["multicastOutput"];
         if (json.contains("multicastPort")) config.mcastPort = json["multicastPort"];
+        if (json.contains("mcastProtocol")) config.mcastProtocol = json["mcastProtocol"];
+        if (json.contains("fecColumns")) config.fecColumns = json["fecColumns"];
+        if (json.contains("fecRows")) config.fecRows = json["fecRows"];
         if (json.contains("bufferSize")) config.bufferSize = json["bufferSize"];
+        if (json.contains("bufferMinMs")) config.bufferMinMs = json["bufferMinMs"];
+        if (json.contains("bufferMaxMs")) config.bufferMaxMs = json["bufferMaxMs"];
+        if (json.contains("passthrough")) config.passthrough = json["passthrough"];
+        if (json.contains("latencyTargetMs")) config.latencyTargetMs = json["latencyTargetMs"];
+        if (json.contains("catchUpPolicy")) config.catchUpPolicy = json["catchUpPolicy"];
+        if (json.contains("outputs")) config.outputs = json["outputs"].get<std::vector<OutputConfig>>();
+        if (json.contains("redundantOutput")) config.redundantOutput = json["redundantOutput"].get<OutputConfig>();
         if (json.contains("enabled")) config.enabled = json["enabled"];
         
         // Mettre à jour la configuration
@@ -441,9 +734,20 @@ void WebServer::handleUpdateStream(const httplib::Request& req, httplib::Respons
             {"id", config.id},
             {"name", config.name},
             {"hlsInput", config.hlsInput},
+            {"hlsInputs", config.hlsInputs},
             {"multicastOutput", config.mcastOutput},
             {"multicastPort", config.mcastPort},
+            {"mcastProtocol", config.mcastProtocol},
+            {"fecColumns", config.fecColumns},
+            {"fecRows", config.fecRows},
             {"bufferSize", config.bufferSize},
+            {"bufferMinMs", config.bufferMinMs},
+            {"bufferMaxMs", config.bufferMaxMs},
+            {"passthrough", config.passthrough},
+            {"latencyTargetMs", config.latencyTargetMs},
+            {"catchUpPolicy", config.catchUpPolicy},
+            {"outputs", config.outputs},
+            {"redundantOutput", config.redundantOutput},
             {"enabled", config.enabled},
             {"running", isRunning}
         };
@@ -570,6 +874,10 @@ void WebServer::handleStopStream(const httplib::Request& req, httplib::Response&
 }
 
 void WebServer::handleGetStats([[maybe_unused]] const httplib::Request& req, httplib::Response& res) {
+    res.set_content(buildStatsJson().dump(), "application/json");
+}
+
+nlohmann::json WebServer::buildStatsJson() {
     // Compter les flux en cours d'exécution
     int runningStreams = 0;
     for (const auto& config : config_.getStreamConfigs()) {
@@ -578,21 +886,182 @@ void WebServer::handleGetStats([[maybe_unused]] const httplib::Request& req, htt
         }
     }
 
+    // Consommation des tampons par rapport au budget mémoire global
+    auto memory = hls_to_dvb::BufferAccountant::getInstance().getSnapshot();
+    nlohmann::json memoryStreams = nlohmann::json::object();
+    for (const auto& [streamId, stages] : memory.streams) {
+        nlohmann::json stagesJson = nlohmann::json::object();
+        for (size_t i = 0; i < hls_to_dvb::BUFFER_STAGE_COUNT; ++i) {
+            stagesJson[hls_to_dvb::bufferStageName(static_cast<hls_to_dvb::BufferStage>(i))] = stages[i];
+        }
+        memoryStreams[streamId] = stagesJson;
+    }
+
+    auto usage = hls_to_dvb::MetricsRegistry::getInstance().sampleProcessUsage();
+
     nlohmann::json stats = {
         {"streams", {
             {"total", config_.getStreamConfigs().size()},
             {"running", runningStreams}
         }},
+        {"memory", {
+            {"budgetBytes", memory.budgetBytes},
+            {"bufferedBytes", memory.totalBytes},
+            {"peakBytes", memory.peakBytes},
+            {"throttled", memory.throttled},
+            {"throttleEvents", memory.throttleEvents},
+            {"streams", memoryStreams}
+        }},
         {"system", {
-            {"cpuUsage", 0.0},  // À implémenter
-            {"memoryUsage", 0.0}  // À implémenter
+            {"cpuUsage", usage.cpuUsage * 100.0},
+            {"memoryUsage", usage.residentBytes},
+            {"cpuSeconds", usage.cpuSeconds},
+            {"threads", usage.threads}
         }}
     };
     
-    res.set_content(stats.dump(), "application/json");
+    return stats;
+}
+
+void WebServer::handleGetMetrics([[maybe_unused]] const httplib::Request& req, httplib::Response& res) {
+    // L'export ne lit que des compteurs atomiques: aucun verrou du pipeline n'est pris
+    hls_to_dvb::Logging::updateMetrics();
+    res.set_content(hls_to_dvb::MetricsRegistry::getInstance().renderPrometheus(),
+                    "text/plain; version=0.0.4; charset=utf-8");
+}
+
+void WebServer::handleGetStreamLatency(const httplib::Request& req, httplib::Response& res) {
+    std::string streamId = req.matches[1];
+    
+    auto tracers = streamManager_.getSegmentTracers();
+    auto it = tracers.find(streamId);
+    if (it == tracers.end()) {
+        res.status = 404;
+        nlohmann::json response = {
+            {"error", "Flux non trouvé ou arrêté"}
+        };
+        res.set_content(response.dump(), "application/json");
+        return;
+    }
+    
+    auto summaries = it->second->getStageSummaries();
+    nlohmann::json stages = nlohmann::json::object();
+    for (size_t i = 0; i < hls_to_dvb::TRACE_STAGE_COUNT; ++i) {
+        const auto& summary = summaries[i];
+        stages[hls_to_dvb::traceStageName(static_cast<hls_to_dvb::TraceStage>(i))] = {
+            {"count", summary.count},
+            {"meanMs", summary.meanMs},
+            {"p50Ms", summary.p50Ms},
+            {"p90Ms", summary.p90Ms},
+            {"p99Ms", summary.p99Ms},
+            {"p999Ms", summary.p999Ms},
+            {"maxMs", summary.maxMs}
+        };
+    }
+    
+    nlohmann::json response = {
+        {"id", streamId},
+        {"stages", stages}
+    };
+    res.set_content(response.dump(), "application/json");
+}
+
+void WebServer::handleGetTrace(const httplib::Request& req, httplib::Response& res) {
+    // Paramètres: stream (optionnel, tous les flux par défaut) et limit (segments par flux)
+    size_t limit = 64;
+    if (req.has_param("limit")) {
+        try {
+            limit = static_cast<size_t>(std::max(1, std::stoi(req.get_param_value("limit"))));
+        } catch (const std::exception&) {
+            res.status = 400;
+            nlohmann::json response = {
+                {"error", "Paramètre limit invalide"}
+            };
+            res.set_content(response.dump(), "application/json");
+            return;
+        }
+    }
+    std::string streamFilter = req.has_param("stream") ? req.get_param_value("stream") : "";
+    
+    auto tracers = streamManager_.getSegmentTracers();
+    if (!streamFilter.empty() && tracers.find(streamFilter) == tracers.end()) {
+        res.status = 404;
+        nlohmann::json response = {
+            {"error", "Flux non trouvé ou arrêté"}
+        };
+        res.set_content(response.dump(), "application/json");
+        return;
+    }
+    
+    // Format Chrome trace-event: un processus par flux, une ligne (thread) par étape,
+    // un événement complet ("X") par segment et par étape
+    struct StageSpan {
+        const char* name;
+        int64_t hls_to_dvb::SegmentTrace::*start;
+        int64_t hls_to_dvb::SegmentTrace::*end;
+    };
+    static const StageSpan spans[] = {
+        {"playlistWait", &hls_to_dvb::SegmentTrace::playlistSeenUs, &hls_to_dvb::SegmentTrace::downloadStartUs},
+        {"download", &hls_to_dvb::SegmentTrace::downloadStartUs, &hls_to_dvb::SegmentTrace::downloadEndUs},
+        {"fetchQueue", &hls_to_dvb::SegmentTrace::downloadEndUs, &hls_to_dvb::SegmentTrace::convertStartUs},
+        {"convert", &hls_to_dvb::SegmentTrace::convertStartUs, &hls_to_dvb::SegmentTrace::convertEndUs},
+        {"buffer", &hls_to_dvb::SegmentTrace::bufferEnqueueUs, &hls_to_dvb::SegmentTrace::bufferDequeueUs},
+        {"sendQueue", &hls_to_dvb::SegmentTrace::bufferDequeueUs, &hls_to_dvb::SegmentTrace::firstDatagramUs},
+        {"send", &hls_to_dvb::SegmentTrace::firstDatagramUs, &hls_to_dvb::SegmentTrace::lastDatagramUs}
+    };
+    
+    nlohmann::json events = nlohmann::json::array();
+    int pid = 0;
+    for (const auto& [streamId, tracer] : tracers) {
+        if (!streamFilter.empty() && streamId != streamFilter) {
+            continue;
+        }
+        pid++;
+        
+        events.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", pid}, {"args", {{"name", streamId}}}});
+        for (size_t tid = 0; tid < std::size(spans); ++tid) {
+            events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", tid},
+                              {"args", {{"name", spans[tid].name}}}});
+        }
+        
+        for (const auto& trace : tracer->getRecentTraces(limit)) {
+            for (size_t tid = 0; tid < std::size(spans); ++tid) {
+                int64_t start = trace.*spans[tid].start;
+                int64_t end = trace.*spans[tid].end;
+                if (start == 0 || end == 0) {
+                    continue;
+                }
+                events.push_back({
+                    {"name", "segment " + std::to_string(trace.sequenceNumber)},
+                    {"cat", spans[tid].name},
+                    {"ph", "X"},
+                    {"ts", start},
+                    {"dur", std::max<int64_t>(0, end - start)},
+                    {"pid", pid},
+                    {"tid", tid},
+                    {"args", {
+                        {"sequence", trace.sequenceNumber},
+                        {"bytes", trace.bytes},
+                        {"discontinuity", trace.discontinuity}
+                    }}
+                });
+            }
+        }
+    }
+    
+    nlohmann::json response = {
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"}
+    };
+    res.set_header("Content-Disposition", "attachment; filename=\"segment-trace.json\"");
+    res.set_content(response.dump(), "application/json");
 }
 
 void WebServer::handleGetAlerts([[maybe_unused]] const httplib::Request& req, httplib::Response& res) {
+    res.set_content(buildAlertsJson().dump(), "application/json");
+}
+
+nlohmann::json WebServer::buildAlertsJson() {
     nlohmann::json alertsJson = nlohmann::json::array();
     
     // Récupérer les alertes depuis AlertManager
@@ -605,13 +1074,15 @@ void WebServer::handleGetAlerts([[maybe_unused]] const httplib::Request& req, ht
             {"message", alert.message},
             {"component", alert.component},
             {"timestamp", std::chrono::system_clock::to_time_t(alert.timestamp)},
+            {"firstSeen", std::chrono::system_clock::to_time_t(alert.firstSeen)},
+            {"count", alert.count},
             {"persistent", alert.persistent}
         };
         
         alertsJson.push_back(alertJson);
     }
     
-    res.set_content(alertsJson.dump(), "application/json");
+    return alertsJson;
 }
 
 void WebServer::handleResolveAlert(const httplib::Request& req, httplib::Response& res) {
@@ -645,6 +1116,8 @@ void WebServer::handleExportAlerts([[maybe_unused]] const httplib::Request& req,
             {"message", alert.message},
             {"component", alert.component},
             {"timestamp", std::chrono::system_clock::to_time_t(alert.timestamp)},
+            {"firstSeen", std::chrono::system_clock::to_time_t(alert.firstSeen)},
+            {"count", alert.count},
             {"persistent", alert.persistent}
         };
         
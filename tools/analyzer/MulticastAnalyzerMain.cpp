@@ -0,0 +1,193 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+#include "MulticastCapture.h"
+#include "OutputAnalyzer.h"
+
+using namespace hls_to_dvb::tools;
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void signalHandler(int) {
+    stopRequested = true;
+}
+
+/**
+ * @struct AnalyzerOptions
+ * @brief Options de la ligne de commande
+ */
+struct AnalyzerOptions {
+    std::vector<std::pair<std::string, int>> streams;   ///< Groupes à analyser (adresse, port)
+    std::string interface = "0.0.0.0";                   ///< Interface de réception
+    int durationSeconds = 0;                             ///< Durée de l'analyse (0 = jusqu'à interruption)
+    int intervalSeconds = 5;                             ///< Période de l'affichage intermédiaire (0 = aucun)
+    std::string jsonPath;                                ///< Fichier du rapport JSON
+    std::string logLevel = "info";                       ///< Niveau de journalisation
+};
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s --stream GROUPE:PORT [--stream GROUPE:PORT ...] [options]\n"
+                "  --stream GROUPE:PORT    Groupe multicast à analyser (répétable)\n"
+                "  --interface IP          Interface de réception (défaut: toutes)\n"
+                "  --duration S            Durée de l'analyse (défaut: jusqu'à Ctrl+C)\n"
+                "  --interval S            Période de l'affichage intermédiaire (défaut: 5, 0 = aucun)\n"
+                "  --json FICHIER          Écrire le rapport au format JSON\n"
+                "  --log-level NIVEAU      Niveau de journalisation (défaut: info)\n",
+                program);
+}
+
+bool parseArguments(int argc, char* argv[], AnalyzerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Valeur manquante pour %s\n", arg.c_str());
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--stream") {
+            std::string stream = value();
+            size_t colon = stream.rfind(':');
+            if (colon == std::string::npos) {
+                std::fprintf(stderr, "Flux invalide (GROUPE:PORT attendu): %s\n", stream.c_str());
+                return false;
+            }
+            options.streams.emplace_back(stream.substr(0, colon), std::atoi(stream.c_str() + colon + 1));
+        } else if (arg == "--interface") {
+            options.interface = value();
+        } else if (arg == "--duration") {
+            options.durationSeconds = std::max(0, std::atoi(value()));
+        } else if (arg == "--interval") {
+            options.intervalSeconds = std::max(0, std::atoi(value()));
+        } else if (arg == "--json") {
+            options.jsonPath = value();
+        } else if (arg == "--log-level") {
+            options.logLevel = value();
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else {
+            std::fprintf(stderr, "Option inconnue: %s\n", arg.c_str());
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.streams.empty()) {
+        printUsage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    AnalyzerOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    spdlog::set_level(spdlog::level::from_str(options.logLevel));
+
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    std::vector<std::unique_ptr<OutputAnalyzer>> analyzers;
+    std::vector<std::unique_ptr<MulticastCapture>> captures;
+
+    for (const auto& [group, port] : options.streams) {
+        auto analyzer = std::make_unique<OutputAnalyzer>(group + ":" + std::to_string(port));
+        auto capture = std::make_unique<MulticastCapture>(group, port, options.interface);
+
+        OutputAnalyzer* target = analyzer.get();
+        capture->setDatagramHandler([target](const uint8_t* data, size_t size,
+                                             std::chrono::steady_clock::time_point arrival) {
+            target->process(data, size, arrival);
+        });
+
+        if (!capture->start()) {
+            return 1;
+        }
+        if (!capture->hasKernelTimestamps()) {
+            spdlog::warn("{}:{}: horodatage noyau indisponible, les intervalles incluent la latence de lecture",
+                         group, port);
+        }
+
+        analyzers.push_back(std::move(analyzer));
+        captures.push_back(std::move(capture));
+    }
+
+    spdlog::info("Analyse de {} flux sur l'interface {}", options.streams.size(), options.interface);
+
+    auto start = std::chrono::steady_clock::now();
+    auto nextReport = start + std::chrono::seconds(options.intervalSeconds);
+
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto now = std::chrono::steady_clock::now();
+
+        if (options.durationSeconds > 0 && now - start >= std::chrono::seconds(options.durationSeconds)) {
+            break;
+        }
+
+        if (options.intervalSeconds > 0 && now >= nextReport) {
+            for (const auto& analyzer : analyzers) {
+                std::printf("%s\n", analyzer->summaryLine().c_str());
+            }
+            std::fflush(stdout);
+            nextReport = now + std::chrono::seconds(options.intervalSeconds);
+        }
+    }
+
+    for (auto& capture : captures) {
+        capture->stop();
+    }
+
+    nlohmann::json report;
+    report["interface"] = options.interface;
+    report["streams"] = nlohmann::json::array();
+
+    bool clean = true;
+    for (size_t i = 0; i < analyzers.size(); ++i) {
+        nlohmann::json entry = analyzers[i]->report();
+        CaptureStats stats = captures[i]->getStats();
+        entry["kernelDrops"] = stats.kernelDrops;
+        entry["kernelTimestamps"] = captures[i]->hasKernelTimestamps();
+
+        std::printf("%s, rejets noyau %lu\n", analyzers[i]->summaryLine().c_str(),
+                    static_cast<unsigned long>(stats.kernelDrops));
+
+        if (entry["datagrams"].get<uint64_t>() == 0 || entry["continuity"]["ccErrors"].get<uint64_t>() > 0 ||
+            entry["syncErrors"].get<uint64_t>() > 0 || stats.kernelDrops > 0) {
+            clean = false;
+        }
+        report["streams"].push_back(entry);
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream file(options.jsonPath);
+        if (!file) {
+            std::fprintf(stderr, "Impossible d'écrire le rapport %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+    }
+
+    return clean ? 0 : 2;
+}
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+#include "AllocationCounter.h"
+#include "StageStats.h"
+#include "SyntheticTS.h"
+#include "core/BufferPool.h"
+#include "core/SegmentBuffer.h"
+#include "mpegts/DVBProcessor.h"
+#include "mpegts/MPEGTSConverter.h"
+#include "mpegts/TSQualityMonitor.h"
+#include "multicast/MulticastSender.h"
+
+using namespace hls_to_dvb;
+using namespace hls_to_dvb::tools;
+
+namespace {
+
+/**
+ * @struct BenchmarkOptions
+ * @brief Options de la ligne de commande
+ */
+struct BenchmarkOptions {
+    int segments = 100;                     ///< Segments mesurés par étape
+    int warmup = 5;                         ///< Segments de chauffe non mesurés
+    SyntheticTSOptions stream;              ///< Paramètres du flux synthétique
+    std::string inputFile;                  ///< Fichier TS enregistré (remplace le flux synthétique)
+    bool multicast = true;                  ///< Mesurer l'émission multicast
+    std::string group = "239.255.42.42";    ///< Groupe multicast de l'étape d'émission
+    int port = 5500;                        ///< Port de l'étape d'émission
+    std::string interface = "127.0.0.1";    ///< Interface de l'étape d'émission (boucle locale)
+    std::string jsonPath;                   ///< Fichier du rapport JSON
+    std::string logLevel = "warn";          ///< Niveau de journalisation pendant les mesures
+};
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s [options]\n"
+                "  --segments N        Segments mesurés par étape (défaut: 100)\n"
+                "  --warmup N          Segments de chauffe (défaut: 5)\n"
+                "  --bitrate KBPS      Débit du flux synthétique (défaut: 8000)\n"
+                "  --duration MS       Durée d'un segment synthétique (défaut: 2000)\n"
+                "  --input FICHIER.ts  Utiliser un enregistrement au lieu du flux synthétique\n"
+                "  --no-multicast      Ne pas mesurer l'émission multicast\n"
+                "  --group ADRESSE     Groupe multicast (défaut: 239.255.42.42)\n"
+                "  --port PORT         Port multicast (défaut: 5500)\n"
+                "  --interface IF      Interface d'émission (défaut: 127.0.0.1)\n"
+                "  --json FICHIER      Écrire le rapport au format JSON\n"
+                "  --log-level NIVEAU  Niveau de journalisation (défaut: warn)\n",
+                program);
+}
+
+bool parseArguments(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Valeur manquante pour %s\n", arg.c_str());
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--segments") {
+            options.segments = std::max(1, std::atoi(value()));
+        } else if (arg == "--warmup") {
+            options.warmup = std::max(0, std::atoi(value()));
+        } else if (arg == "--bitrate") {
+            options.stream.bitrateKbps = static_cast<uint32_t>(std::max(100, std::atoi(value())));
+        } else if (arg == "--duration") {
+            options.stream.segmentDurationMs = std::max(100, std::atoi(value()));
+        } else if (arg == "--input") {
+            options.inputFile = value();
+        } else if (arg == "--no-multicast") {
+            options.multicast = false;
+        } else if (arg == "--group") {
+            options.group = value();
+        } else if (arg == "--port") {
+            options.port = std::atoi(value());
+        } else if (arg == "--interface") {
+            options.interface = value();
+        } else if (arg == "--json") {
+            options.jsonPath = value();
+        } else if (arg == "--log-level") {
+            options.logLevel = value();
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else {
+            std::fprintf(stderr, "Option inconnue: %s\n", arg.c_str());
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @class SegmentSource
+ * @brief Fournit les segments d'entrée: flux synthétique continu ou enregistrement rejoué en boucle
+ */
+class SegmentSource {
+public:
+    explicit SegmentSource(const BenchmarkOptions& options)
+        : generator_(options.stream), sequence_(0), duration_(options.stream.segmentDurationMs / 1000.0) {
+        if (!options.inputFile.empty()) {
+            size_t segmentBytes = static_cast<size_t>(options.stream.bitrateKbps) * 1000 / 8 *
+                                  options.stream.segmentDurationMs / 1000;
+            recorded_ = SyntheticTSGenerator::loadSegmentsFromFile(options.inputFile, segmentBytes);
+        }
+    }
+
+    bool usesRecording() const {
+        return !recorded_.empty();
+    }
+
+    size_t recordedSegments() const {
+        return recorded_.size();
+    }
+
+    HLSSegment next() {
+        if (recorded_.empty()) {
+            return generator_.nextHLSSegment();
+        }
+
+        // Chaque tour de l'enregistrement est annoncé comme une discontinuité
+        size_t index = sequence_ % recorded_.size();
+        HLSSegment segment;
+        segment.data = recorded_[index];
+        segment.discontinuity = index == 0 && sequence_ > 0;
+        segment.sequenceNumber = static_cast<int>(sequence_++);
+        segment.duration = duration_;
+        segment.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return segment;
+    }
+
+private:
+    SyntheticTSGenerator generator_;
+    std::vector<std::vector<uint8_t>> recorded_;
+    size_t sequence_;
+    double duration_;
+};
+
+/**
+ * @brief Mesure une étape sur une série de segments
+ * @param name Nom de l'étape
+ * @param options Options du banc
+ * @param prepare Prépare l'entrée de l'itération (non mesuré), retourne les octets traités
+ * @param run Appel mesuré
+ * @return Résumé de l'étape
+ */
+StageStats::Summary measureStage(const std::string& name, const BenchmarkOptions& options,
+                                 const std::function<size_t()>& prepare, const std::function<void()>& run) {
+    StageStats stats(name);
+
+    for (int i = 0; i < options.warmup + options.segments; ++i) {
+        size_t bytes = prepare();
+
+        AllocationSnapshot before = allocationSnapshot();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        AllocationSnapshot after = allocationSnapshot();
+
+        if (i >= options.warmup) {
+            stats.record(std::chrono::duration<double, std::micro>(end - start).count(), bytes,
+                         after.count - before.count, after.bytes - before.bytes);
+        }
+    }
+
+    return stats.summarize();
+}
+
+void printSummary(const StageStats::Summary& summary) {
+    std::printf("%-22s %8zu %10.1f %12.0f %10.1f %10.1f %10.1f %10.1f %12.0f\n",
+                summary.name.c_str(), summary.iterations, summary.megabytesPerSecond, summary.packetsPerSecond,
+                summary.p50Us, summary.p99Us, summary.maxUs, summary.allocationsPerOp,
+                summary.allocatedBytesPerOp);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    // Les étapes journalisent chaque segment au niveau info: les faire taire pour ne
+    // mesurer que le traitement
+    spdlog::set_level(spdlog::level::from_str(options.logLevel));
+
+    SegmentSource source(options);
+    if (!options.inputFile.empty() && !source.usesRecording()) {
+        std::fprintf(stderr, "Impossible de lire des paquets TS depuis %s\n", options.inputFile.c_str());
+        return 1;
+    }
+
+    std::printf("Entrée: %s, %d segments mesurés (+%d de chauffe)\n",
+                source.usesRecording() ? options.inputFile.c_str() : "flux synthétique",
+                options.segments, options.warmup);
+    if (!source.usesRecording()) {
+        std::printf("Flux synthétique: %u kbit/s, segments de %d ms\n",
+                    options.stream.bitrateKbps, options.stream.segmentDurationMs);
+    } else {
+        std::printf("Enregistrement découpé en %zu segments\n", source.recordedSegments());
+    }
+
+    std::vector<StageStats::Summary> summaries;
+    HLSSegment input;
+    nlohmann::json details = nlohmann::json::object();
+
+    // 1. Conversion complète (réécriture des CC et régénération PSI/SI)
+    {
+        auto pool = std::make_shared<BufferPool>();
+        MPEGTSConverter converter;
+        converter.setBufferPool(pool);
+        converter.start();
+        summaries.push_back(measureStage("convert", options,
+            [&] { input = source.next(); return input.data.size(); },
+            [&] {
+                auto output = converter.convert(std::move(input));
+                if (output) {
+                    pool->release(std::move(output->data));
+                }
+            }));
+        converter.stop();
+    }
+
+    // 2. Conversion en mode passthrough
+    {
+        auto pool = std::make_shared<BufferPool>();
+        MPEGTSConverter converter;
+        converter.setBufferPool(pool);
+        converter.setPassthrough(true);
+        converter.start();
+        summaries.push_back(measureStage("convert-passthrough", options,
+            [&] { input = source.next(); return input.data.size(); },
+            [&] {
+                auto output = converter.convert(std::move(input));
+                if (output) {
+                    pool->release(std::move(output->data));
+                }
+            }));
+
+        details["passthroughSegments"] = converter.getPassthroughSegments();
+        details["passthroughFallbackReason"] = converter.getPassthroughFallbackReason();
+        converter.stop();
+    }
+
+    // 3. Régénération des tables PSI/SI seule
+    {
+        auto pool = std::make_shared<BufferPool>();
+        DVBProcessor processor;
+        processor.setBufferPool(pool);
+        processor.initialize();
+        summaries.push_back(measureStage("updatePSITables", options,
+            [&] { input = source.next(); return input.data.size(); },
+            [&] { pool->release(processor.updatePSITables(input.data, input.discontinuity)); }));
+        processor.cleanup();
+    }
+
+    // 4. Analyse de qualité
+    {
+        TSQualityMonitor monitor;
+        summaries.push_back(measureStage("analyze", options,
+            [&] { input = source.next(); return input.data.size(); },
+            [&] { monitor.analyze(input.data); }));
+    }
+
+    // 5. Passage par le tampon de gigue (dépôt puis retrait)
+    {
+        SegmentBuffer buffer;
+        MPEGTSSegment segment;
+        MPEGTSSegment output;
+        summaries.push_back(measureStage("segmentBuffer", options,
+            [&] {
+                input = source.next();
+                segment.data = std::move(input.data);
+                segment.discontinuity = input.discontinuity;
+                segment.sequenceNumber = input.sequenceNumber;
+                segment.duration = input.duration;
+                segment.timestamp = input.timestamp;
+                return segment.data.size();
+            },
+            [&] {
+                buffer.pushSegment(std::move(segment));
+                buffer.getSegment(output, 0);
+            }));
+    }
+
+    // 6. Émission multicast sur la boucle locale, jusqu'au dernier datagramme envoyé
+    if (options.multicast) {
+        auto pool = std::make_shared<BufferPool>();
+        MulticastSender sender(options.group, options.port, options.interface, 1);
+        sender.setBufferPool(pool);
+        if (sender.start()) {
+            uint64_t expectedBytes = 0;
+            summaries.push_back(measureStage("multicast", options,
+                [&] {
+                    input = source.next();
+                    expectedBytes = sender.getStats().bytesSent + input.data.size();
+                    return input.data.size();
+                },
+                [&] {
+                    uint64_t errorsBefore = sender.getStats().errors;
+                    sender.send(std::move(input.data), input.discontinuity);
+
+                    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                    while (sender.getStats().bytesSent < expectedBytes &&
+                           sender.getStats().errors == errorsBefore &&
+                           std::chrono::steady_clock::now() < deadline) {
+                        std::this_thread::yield();
+                    }
+                }));
+
+            details["multicastErrors"] = sender.getStats().errors;
+            sender.stop();
+        } else {
+            std::fprintf(stderr, "Impossible de démarrer l'émission multicast vers %s:%d, étape ignorée\n",
+                         options.group.c_str(), options.port);
+        }
+    }
+
+    std::printf("\n%-22s %8s %10s %12s %10s %10s %10s %10s %12s\n",
+                "Étape", "Segments", "Mo/s", "Paquets/s", "p50 µs", "p99 µs", "max µs", "Alloc/op", "Octets/op");
+    for (const auto& summary : summaries) {
+        printSummary(summary);
+    }
+
+    if (details.contains("passthroughFallbackReason") &&
+        !details["passthroughFallbackReason"].get<std::string>().empty()) {
+        std::printf("\nPassthrough abandonné: %s\n", details["passthroughFallbackReason"].get<std::string>().c_str());
+    }
+
+    if (!options.jsonPath.empty()) {
+        nlohmann::json report;
+        report["input"] = source.usesRecording() ? options.inputFile : "synthetic";
+        report["bitrateKbps"] = options.stream.bitrateKbps;
+        report["segmentDurationMs"] = options.stream.segmentDurationMs;
+        report["segments"] = options.segments;
+        report["details"] = details;
+        report["stages"] = nlohmann::json::array();
+        for (const auto& summary : summaries) {
+            report["stages"].push_back(StageStats::toJson(summary));
+        }
+
+        std::ofstream file(options.jsonPath);
+        if (!file) {
+            std::fprintf(stderr, "Impossible d'écrire le rapport %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+        std::printf("\nRapport écrit dans %s\n", options.jsonPath.c_str());
+    }
+
+    return 0;
+}
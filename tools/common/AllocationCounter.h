@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hls_to_dvb {
+namespace tools {
+
+/**
+ * @struct AllocationSnapshot
+ * @brief Compteurs cumulés des allocations sur le tas depuis le démarrage du processus
+ */
+struct AllocationSnapshot {
+    uint64_t count = 0;     ///< Nombre d'appels à operator new
+    uint64_t bytes = 0;     ///< Octets demandés à operator new
+};
+
+/**
+ * @brief Lit les compteurs d'allocations
+ *
+ * Les outils qui appellent cette fonction remplacent les operator new/delete globaux
+ * par des versions instrumentées (définies dans AllocationCounter.cpp).
+ *
+ * @return Compteurs cumulés
+ */
+AllocationSnapshot allocationSnapshot();
+
+} // namespace tools
+} // namespace hls_to_dvb
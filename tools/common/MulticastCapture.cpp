@@ -0,0 +1,264 @@
+#include "MulticastCapture.h"
+
+#include <spdlog/spdlog.h>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace hls_to_dvb {
+namespace tools {
+
+namespace {
+
+constexpr size_t PACKET_SIZE = 188;
+constexpr uint16_t PID_NULL = 0x1FFF;
+constexpr size_t MAX_DATAGRAM_SIZE = 65536;
+
+} // namespace
+
+MulticastCapture::MulticastCapture(const std::string& group, int port, const std::string& interfaceAddress)
+    : group_(group),
+      port_(port),
+      interfaceAddress_(interfaceAddress),
+      socket_(-1),
+      running_(false),
+      kernelTimestamps_(false),
+      hasLastArrival_(false),
+      lastDropCounter_(0) {
+}
+
+MulticastCapture::~MulticastCapture() {
+    stop();
+}
+
+void MulticastCapture::setDatagramHandler(DatagramHandler handler) {
+    handler_ = std::move(handler);
+}
+
+bool MulticastCapture::start() {
+    if (running_) {
+        return true;
+    }
+
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0) {
+        spdlog::error("Capture {}:{}: création du socket impossible: {}", group_, port_, strerror(errno));
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Un tampon de réception large évite de compter comme perdus les datagrammes
+    // que le thread n'a pas encore lus
+    int receiveBuffer = 8 * 1024 * 1024;
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+    // Horodatage par le noyau, pour mesurer les intervalles sans la latence d'ordonnancement
+    // du thread, et compteur des datagrammes rejetés faute de place dans le tampon
+    int enable = 1;
+    kernelTimestamps_ = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+#ifdef SO_RXQ_OVFL
+    setsockopt(socket_, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+#endif
+
+    // Se lier à l'adresse du groupe pour ne recevoir que ce groupe sur ce port
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port_));
+    if (inet_pton(AF_INET, group_.c_str(), &address.sin_addr) != 1) {
+        spdlog::error("Capture: adresse de groupe invalide: {}", group_);
+        ::close(socket_);
+        socket_ = -1;
+        return false;
+    }
+
+    if (bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        spdlog::error("Capture {}:{}: bind impossible: {}", group_, port_, strerror(errno));
+        ::close(socket_);
+        socket_ = -1;
+        return false;
+    }
+
+    ip_mreq membership;
+    std::memset(&membership, 0, sizeof(membership));
+    membership.imr_multiaddr = address.sin_addr;
+    if (inet_pton(AF_INET, interfaceAddress_.c_str(), &membership.imr_interface) != 1) {
+        membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    }
+
+    if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+        spdlog::error("Capture {}:{}: impossible de rejoindre le groupe: {}", group_, port_, strerror(errno));
+        ::close(socket_);
+        socket_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&MulticastCapture::receiveLoop, this);
+
+    return true;
+}
+
+void MulticastCapture::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    ::close(socket_);
+    socket_ = -1;
+}
+
+void MulticastCapture::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = CaptureStats();
+    hasLastArrival_ = false;
+}
+
+CaptureStats MulticastCapture::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+const std::string& MulticastCapture::getGroup() const {
+    return group_;
+}
+
+int MulticastCapture::getPort() const {
+    return port_;
+}
+
+void MulticastCapture::receiveLoop() {
+    std::vector<uint8_t> buffer(MAX_DATAGRAM_SIZE);
+    alignas(cmsghdr) uint8_t control[256];
+
+    while (running_) {
+        pollfd descriptor{socket_, POLLIN, 0};
+        int ready = poll(&descriptor, 1, 100);
+        if (ready <= 0) {
+            continue;
+        }
+
+        iovec vector{buffer.data(), buffer.size()};
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t received = recvmsg(socket_, &message, 0);
+        auto arrival = std::chrono::steady_clock::now();
+        if (received <= 0) {
+            continue;
+        }
+
+        bool hasDropCounter = false;
+        uint32_t dropCounter = 0;
+
+        for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level != SOL_SOCKET) {
+                continue;
+            }
+
+            if (header->cmsg_type == SCM_TIMESTAMPNS) {
+                // Ramener l'horodatage noyau (horloge temps réel) sur l'horloge monotone
+                timespec kernelTime;
+                std::memcpy(&kernelTime, CMSG_DATA(header), sizeof(kernelTime));
+                timespec now;
+                clock_gettime(CLOCK_REALTIME, &now);
+                auto age = std::chrono::seconds(now.tv_sec - kernelTime.tv_sec) +
+                           std::chrono::nanoseconds(now.tv_nsec - kernelTime.tv_nsec);
+                if (age.count() >= 0) {
+                    arrival -= std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+                }
+            }
+#ifdef SO_RXQ_OVFL
+            else if (header->cmsg_type == SO_RXQ_OVFL) {
+                std::memcpy(&dropCounter, CMSG_DATA(header), sizeof(dropCounter));
+                hasDropCounter = true;
+            }
+#endif
+        }
+
+        if (hasDropCounter) {
+            // Le compteur cumule les rejets depuis l'ouverture du socket
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.kernelDrops += static_cast<uint32_t>(dropCounter - lastDropCounter_);
+            lastDropCounter_ = dropCounter;
+        }
+
+        processDatagram(buffer.data(), static_cast<size_t>(received), arrival);
+
+        if (handler_) {
+            handler_(buffer.data(), static_cast<size_t>(received), arrival);
+        }
+    }
+}
+
+bool MulticastCapture::hasKernelTimestamps() const {
+    return kernelTimestamps_;
+}
+
+void MulticastCapture::processDatagram(const uint8_t* data, size_t size,
+                                       std::chrono::steady_clock::time_point arrival) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    stats_.datagrams++;
+    stats_.bytes += size;
+
+    if (hasLastArrival_) {
+        double gapMs = std::chrono::duration<double, std::milli>(arrival - lastArrival_).count();
+        if (gapMs > stats_.maxGapMs) {
+            stats_.maxGapMs = gapMs;
+        }
+    }
+    lastArrival_ = arrival;
+    hasLastArrival_ = true;
+
+    for (size_t offset = 0; offset + PACKET_SIZE <= size; offset += PACKET_SIZE) {
+        const uint8_t* b = data + offset;
+        stats_.tsPackets++;
+
+        if (b[0] != 0x47) {
+            stats_.syncErrors++;
+            continue;
+        }
+
+        uint16_t pid = static_cast<uint16_t>(((b[1] & 0x1F) << 8) | b[2]);
+        if (pid == PID_NULL) {
+            continue;
+        }
+
+        uint8_t afc = (b[3] >> 4) & 0x03;
+        uint8_t cc = b[3] & 0x0F;
+        bool hasPayload = (afc & 0x01) != 0;
+        bool discontinuityIndicator = (afc & 0x02) && b[4] > 0 && (b[5] & 0x80);
+
+        auto last = lastCC_.find(pid);
+        if (last != lastCC_.end() && !discontinuityIndicator) {
+            uint8_t expected = hasPayload ? ((last->second + 1) & 0x0F) : last->second;
+            if (cc != expected && !(hasPayload && cc == last->second)) {
+                stats_.ccErrors++;
+            }
+        }
+        lastCC_[pid] = cc;
+    }
+}
+
+} // namespace tools
+} // namespace hls_to_dvb
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace hls_to_dvb {
+namespace tools {
+
+/**
+ * @struct CaptureStats
+ * @brief Statistiques d'une capture multicast
+ */
+struct CaptureStats {
+    uint64_t datagrams = 0;         ///< Datagrammes reçus
+    uint64_t bytes = 0;             ///< Octets reçus
+    uint64_t tsPackets = 0;         ///< Paquets TS reçus
+    uint64_t syncErrors = 0;        ///< Paquets sans octet de synchronisation
+    uint64_t ccErrors = 0;          ///< Ruptures de compteur de continuité
+    uint64_t kernelDrops = 0;       ///< Datagrammes rejetés par le noyau (tampon de réception plein)
+    double maxGapMs = 0.0;          ///< Plus grand intervalle entre deux datagrammes (ms)
+};
+
+/**
+ * @class MulticastCapture
+ * @brief Rejoint un groupe multicast et vérifie la continuité du flux TS reçu
+ *
+ * La réception se fait dans un thread dédié. Chaque datagramme est horodaté par le
+ * noyau à sa réception (SO_TIMESTAMPNS) quand c'est possible ; les compteurs de continuité sont vérifiés PID par PID. Un gestionnaire
+ * optionnel reçoit les datagrammes bruts pour des analyses plus poussées.
+ */
+class MulticastCapture {
+public:
+    /**
+     * @brief Gestionnaire appelé pour chaque datagramme reçu (depuis le thread de réception)
+     */
+    using DatagramHandler = std::function<void(const uint8_t* data, size_t size,
+                                               std::chrono::steady_clock::time_point arrival)>;
+
+    /**
+     * @brief Constructeur
+     * @param group Adresse du groupe multicast
+     * @param port Port UDP
+     * @param interfaceAddress Adresse IPv4 de l'interface de réception
+     */
+    MulticastCapture(const std::string& group, int port, const std::string& interfaceAddress);
+
+    /**
+     * @brief Destructeur, arrête la capture
+     */
+    ~MulticastCapture();
+
+    MulticastCapture(const MulticastCapture&) = delete;
+    MulticastCapture& operator=(const MulticastCapture&) = delete;
+
+    /**
+     * @brief Définit le gestionnaire des datagrammes bruts (à appeler avant start())
+     * @param handler Gestionnaire
+     */
+    void setDatagramHandler(DatagramHandler handler);
+
+    /**
+     * @brief Rejoint le groupe et démarre la réception
+     * @return true si la capture a démarré
+     */
+    bool start();
+
+    /**
+     * @brief Quitte le groupe et arrête la réception
+     */
+    void stop();
+
+    /**
+     * @brief Remet les statistiques à zéro (par exemple après une période de chauffe)
+     */
+    void resetStats();
+
+    /**
+     * @brief Récupère les statistiques de la capture
+     * @return Statistiques
+     */
+    CaptureStats getStats() const;
+
+    /**
+     * @brief Récupère l'adresse du groupe capturé
+     * @return Adresse du groupe
+     */
+    const std::string& getGroup() const;
+
+    /**
+     * @brief Récupère le port capturé
+     * @return Port
+     */
+    int getPort() const;
+
+    /**
+     * @brief Indique si les datagrammes sont horodatés par le noyau
+     * @return true si SO_TIMESTAMPNS est actif, false si l'horodatage est fait à la lecture
+     */
+    bool hasKernelTimestamps() const;
+
+private:
+    /**
+     * @brief Boucle du thread de réception
+     */
+    void receiveLoop();
+
+    /**
+     * @brief Met à jour les statistiques avec un datagramme reçu
+     * @param data Datagramme
+     * @param size Taille
+     * @param arrival Instant de réception
+     */
+    void processDatagram(const uint8_t* data, size_t size, std::chrono::steady_clock::time_point arrival);
+
+    std::string group_;                             ///< Groupe multicast
+    int port_;                                      ///< Port UDP
+    std::string interfaceAddress_;                  ///< Interface de réception
+    int socket_;                                    ///< Socket de réception
+    std::thread thread_;                            ///< Thread de réception
+    std::atomic<bool> running_;                     ///< Capture en cours
+    bool kernelTimestamps_;                         ///< Horodatage noyau actif
+    DatagramHandler handler_;                       ///< Gestionnaire des datagrammes bruts
+
+    mutable std::mutex mutex_;                      ///< Protège les statistiques
+    CaptureStats stats_;                            ///< Statistiques
+    std::map<uint16_t, uint8_t> lastCC_;            ///< Dernier compteur de continuité par PID
+    std::chrono::steady_clock::time_point lastArrival_; ///< Réception du datagramme précédent
+    bool hasLastArrival_;                           ///< lastArrival_ est renseigné
+    uint32_t lastDropCounter_;                      ///< Dernière valeur du compteur SO_RXQ_OVFL
+};
+
+} // namespace tools
+} // namespace hls_to_dvb
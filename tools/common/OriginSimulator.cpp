@@ -0,0 +1,310 @@
+#include "OriginSimulator.h"
+#include "SyntheticTS.h"
+
+#include <httplib.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <unistd.h>
+
+namespace hls_to_dvb {
+namespace tools {
+
+OriginSimulator::OriginSimulator(const OriginOptions& options)
+    : options_(options),
+      running_(false),
+      port_(options.port),
+      ownsDirectory_(false),
+      random_(std::random_device{}()),
+      playlistRequests_(0),
+      segmentRequests_(0),
+      injectedErrors_(0),
+      bytesServed_(0) {
+    options_.channels = std::max(1, options_.channels);
+    options_.segmentDurationMs = std::max(100, options_.segmentDurationMs);
+    options_.windowSegments = std::max(3, options_.windowSegments);
+    options_.poolSegments = std::max(options_.windowSegments * 2, options_.poolSegments);
+}
+
+OriginSimulator::~OriginSimulator() {
+    stop();
+}
+
+bool OriginSimulator::start() {
+    if (running_) {
+        return true;
+    }
+
+    if (!prepareSegments()) {
+        return false;
+    }
+
+    server_ = std::make_unique<httplib::Server>();
+
+    server_->Get(R"(/ch(\d+)/master\.m3u8)", [this](const httplib::Request& req, httplib::Response& res) {
+        applyLatency();
+        playlistRequests_++;
+
+        int channel = std::stoi(req.matches[1].str());
+        if (channel >= options_.channels) {
+            res.status = 404;
+            return;
+        }
+
+        std::ostringstream playlist;
+        playlist << "#EXTM3U\n"
+                 << "#EXT-X-VERSION:3\n"
+                 << "#EXT-X-STREAM-INF:BANDWIDTH=" << options_.bitrateKbps * 1000
+                 << ",RESOLUTION=1280x720,CODECS=\"avc1.64001f,mp4a.40.2\"\n"
+                 << "media.m3u8\n";
+        res.set_content(playlist.str(), "application/vnd.apple.mpegurl");
+    });
+
+    server_->Get(R"(/ch(\d+)/media\.m3u8)", [this](const httplib::Request& req, httplib::Response& res) {
+        applyLatency();
+        playlistRequests_++;
+
+        int channel = std::stoi(req.matches[1].str());
+        if (channel >= options_.channels) {
+            res.status = 404;
+            return;
+        }
+
+        res.set_content(buildMediaPlaylist(), "application/vnd.apple.mpegurl");
+    });
+
+    server_->Get(R"(/ch(\d+)/seg_(\d+)\.ts)", [this](const httplib::Request& req, httplib::Response& res) {
+        applyLatency();
+
+        int channel = std::stoi(req.matches[1].str());
+        int64_t sequence = std::stoll(req.matches[2].str());
+        int64_t current = currentSequence();
+
+        // Un segment sorti depuis longtemps de la fenêtre, ou pas encore publié, n'existe pas
+        if (channel >= options_.channels || sequence > current ||
+            sequence < current - 2 * options_.windowSegments) {
+            res.status = 404;
+            return;
+        }
+
+        if (injectError()) {
+            injectedErrors_++;
+            res.status = 503;
+            return;
+        }
+
+        std::ifstream file(segmentPath(channel, static_cast<int>(sequence % options_.poolSegments)),
+                           std::ios::binary);
+        if (!file) {
+            res.status = 500;
+            return;
+        }
+
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        segmentRequests_++;
+        bytesServed_ += data.size();
+        res.set_content(data, "video/mp2t");
+    });
+
+    if (port_ == 0) {
+        port_ = server_->bind_to_any_port(options_.address);
+        if (port_ <= 0) {
+            spdlog::error("Origine simulée: impossible d'ouvrir un port sur {}", options_.address);
+            return false;
+        }
+    } else if (!server_->bind_to_port(options_.address, port_)) {
+        spdlog::error("Origine simulée: impossible d'écouter sur {}:{}", options_.address, port_);
+        return false;
+    }
+
+    epoch_ = std::chrono::steady_clock::now();
+    running_ = true;
+    serverThread_ = std::thread([this]() {
+        server_->listen_after_bind();
+    });
+    server_->wait_until_ready();
+
+    spdlog::info("Origine simulée démarrée sur http://{}:{}/ ({} chaînes, segments de {} ms)",
+                 options_.address, port_, options_.channels, options_.segmentDurationMs);
+    return true;
+}
+
+void OriginSimulator::stop() {
+    if (!running_) {
+        return;
+    }
+
+    server_->stop();
+    if (serverThread_.joinable()) {
+        serverThread_.join();
+    }
+    running_ = false;
+
+    if (ownsDirectory_) {
+        std::error_code error;
+        std::filesystem::remove_all(options_.directory, error);
+    }
+}
+
+int OriginSimulator::getPort() const {
+    return port_;
+}
+
+std::string OriginSimulator::getMasterUrl(int channel) const {
+    return "http://" + options_.address + ":" + std::to_string(port_) + "/ch" + std::to_string(channel) +
+           "/master.m3u8";
+}
+
+OriginSimulator::Stats OriginSimulator::getStats() const {
+    Stats stats;
+    stats.playlistRequests = playlistRequests_;
+    stats.segmentRequests = segmentRequests_;
+    stats.injectedErrors = injectedErrors_;
+    stats.bytesServed = bytesServed_;
+    return stats;
+}
+
+bool OriginSimulator::prepareSegments() {
+    namespace fs = std::filesystem;
+
+    if (options_.directory.empty()) {
+        options_.directory = (fs::temp_directory_path() /
+                              ("hls-origin-" + std::to_string(::getpid()) + "-" + std::to_string(random_()))).string();
+        ownsDirectory_ = true;
+    }
+
+    std::vector<std::vector<uint8_t>> recorded;
+    if (!options_.sourceFile.empty()) {
+        size_t segmentBytes = static_cast<size_t>(options_.bitrateKbps) * 1000 / 8 * options_.segmentDurationMs / 1000;
+        recorded = SyntheticTSGenerator::loadSegmentsFromFile(options_.sourceFile, segmentBytes);
+        if (recorded.empty()) {
+            spdlog::error("Origine simulée: aucun paquet TS lisible dans {}", options_.sourceFile);
+            return false;
+        }
+        options_.poolSegments = static_cast<int>(recorded.size());
+    }
+
+    for (int channel = 0; channel < options_.channels; ++channel) {
+        std::error_code error;
+        fs::create_directories(fs::path(options_.directory) / ("ch" + std::to_string(channel)), error);
+        if (error) {
+            spdlog::error("Origine simulée: impossible de créer {}: {}", options_.directory, error.message());
+            return false;
+        }
+
+        SyntheticTSOptions streamOptions;
+        streamOptions.bitrateKbps = options_.bitrateKbps;
+        streamOptions.segmentDurationMs = options_.segmentDurationMs;
+        streamOptions.serviceId = static_cast<uint16_t>(channel + 1);
+        streamOptions.serviceName = "Canal " + std::to_string(channel);
+        SyntheticTSGenerator generator(streamOptions);
+
+        for (int index = 0; index < options_.poolSegments; ++index) {
+            std::vector<uint8_t> data = recorded.empty() ? generator.nextSegment(index == 0 || isDiscontinuity(index))
+                                                         : recorded[index];
+
+            std::ofstream file(segmentPath(channel, index), std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                spdlog::error("Origine simulée: écriture impossible de {}", segmentPath(channel, index));
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+std::string OriginSimulator::buildMediaPlaylist() const {
+    const int64_t last = currentSequence();
+    const int64_t first = std::max<int64_t>(0, last - options_.windowSegments + 1);
+
+    // Nombre de discontinuités antérieures à la fenêtre: un bouclage de la réserve
+    // par cycle, plus les discontinuités périodiques
+    int64_t discontinuitySequence = 0;
+    if (first > 1) {
+        const int64_t pool = options_.poolSegments;
+        const int64_t every = options_.discontinuityEvery;
+        const int64_t perCycle = every > 0 ? (pool - 1) / every + 1 : 1;
+        const int64_t span = first - 1;
+        discontinuitySequence = (span / pool) * perCycle + (every > 0 ? (span % pool) / every : 0);
+    }
+
+    std::ostringstream playlist;
+    playlist << "#EXTM3U\n"
+             << "#EXT-X-VERSION:3\n"
+             << "#EXT-X-TARGETDURATION:" << static_cast<int>(std::ceil(options_.segmentDurationMs / 1000.0)) << "\n"
+             << "#EXT-X-MEDIA-SEQUENCE:" << first << "\n"
+             << "#EXT-X-DISCONTINUITY-SEQUENCE:" << discontinuitySequence << "\n";
+
+    char duration[32];
+    std::snprintf(duration, sizeof(duration), "%.3f", options_.segmentDurationMs / 1000.0);
+
+    for (int64_t sequence = first; sequence <= last; ++sequence) {
+        if (isDiscontinuity(sequence)) {
+            playlist << "#EXT-X-DISCONTINUITY\n";
+        }
+        playlist << "#EXTINF:" << duration << ",\n"
+                 << "seg_" << sequence << ".ts\n";
+    }
+
+    return playlist.str();
+}
+
+int64_t OriginSimulator::currentSequence() const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - epoch_).count();
+
+    // La fenêtre est pleine dès le démarrage, comme sur une origine déjà en service
+    return elapsed / options_.segmentDurationMs + options_.windowSegments - 1;
+}
+
+bool OriginSimulator::isDiscontinuity(int64_t sequence) const {
+    if (sequence <= 0) {
+        return false;
+    }
+
+    int64_t index = sequence % options_.poolSegments;
+    return index == 0 || (options_.discontinuityEvery > 0 && index % options_.discontinuityEvery == 0);
+}
+
+void OriginSimulator::applyLatency() {
+    if (options_.latencyMs <= 0 && options_.jitterMs <= 0) {
+        return;
+    }
+
+    int delayMs = options_.latencyMs;
+    if (options_.jitterMs > 0) {
+        std::lock_guard<std::mutex> lock(randomMutex_);
+        std::uniform_int_distribution<int> jitter(-options_.jitterMs, options_.jitterMs);
+        delayMs += jitter(random_);
+    }
+
+    if (delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+}
+
+bool OriginSimulator::injectError() {
+    if (options_.errorRate <= 0.0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(randomMutex_);
+    std::uniform_real_distribution<double> draw(0.0, 1.0);
+    return draw(random_) < options_.errorRate;
+}
+
+std::string OriginSimulator::segmentPath(int channel, int poolIndex) const {
+    return (std::filesystem::path(options_.directory) / ("ch" + std::to_string(channel)) /
+            ("seg_" + std::to_string(poolIndex) + ".ts")).string();
+}
+
+} // namespace tools
+} // namespace hls_to_dvb
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace httplib {
+    class Server;
+}
+
+namespace hls_to_dvb {
+namespace tools {
+
+/**
+ * @struct OriginOptions
+ * @brief Paramètres de l'origine HLS simulée
+ */
+struct OriginOptions {
+    std::string address = "127.0.0.1";     ///< Adresse d'écoute
+    int port = 0;                           ///< Port d'écoute (0 = port libre choisi par le système)
+    int channels = 1;                       ///< Nombre de chaînes servies (/ch0 ... /chN-1)
+    int segmentDurationMs = 2000;           ///< Durée d'un segment
+    int windowSegments = 6;                 ///< Segments annoncés dans la playlist glissante
+    int poolSegments = 30;                  ///< Segments distincts écrits sur disque par chaîne
+    uint32_t bitrateKbps = 4000;            ///< Débit des segments synthétiques
+    int latencyMs = 0;                      ///< Latence ajoutée à chaque réponse
+    int jitterMs = 0;                       ///< Variation aléatoire de la latence (±)
+    double errorRate = 0.0;                 ///< Proportion de requêtes de segment répondues en 503
+    int discontinuityEvery = 0;             ///< Discontinuité tous les N segments (0 = aucune hors bouclage)
+    std::string directory;                  ///< Répertoire des segments (vide = répertoire temporaire)
+    std::string sourceFile;                 ///< Enregistrement TS à découper au lieu du flux synthétique
+};
+
+/**
+ * @class OriginSimulator
+ * @brief Serveur HTTP local qui simule une origine HLS en direct
+ *
+ * Chaque chaîne expose une playlist maître (/chN/master.m3u8), une playlist média
+ * glissante (/chN/media.m3u8) et des segments (/chN/seg_<séquence>.ts). Les segments
+ * sont écrits une fois sur disque puis servis en boucle ; le numéro de séquence média
+ * avance avec l'horloge, comme sur une origine en direct. Latence, gigue, erreurs et
+ * discontinuités sont configurables pour rendre les essais de charge reproductibles.
+ */
+class OriginSimulator {
+public:
+    /**
+     * @brief Constructeur
+     * @param options Paramètres de l'origine
+     */
+    explicit OriginSimulator(const OriginOptions& options);
+
+    /**
+     * @brief Destructeur, arrête le serveur
+     */
+    ~OriginSimulator();
+
+    OriginSimulator(const OriginSimulator&) = delete;
+    OriginSimulator& operator=(const OriginSimulator&) = delete;
+
+    /**
+     * @brief Prépare les segments sur disque et démarre le serveur
+     * @return true si le serveur écoute
+     */
+    bool start();
+
+    /**
+     * @brief Arrête le serveur
+     */
+    void stop();
+
+    /**
+     * @brief Récupère le port d'écoute effectif
+     * @return Port
+     */
+    int getPort() const;
+
+    /**
+     * @brief Construit l'URL de la playlist maître d'une chaîne
+     * @param channel Indice de la chaîne
+     * @return URL
+     */
+    std::string getMasterUrl(int channel) const;
+
+    /**
+     * @brief Statistiques de l'origine
+     */
+    struct Stats {
+        uint64_t playlistRequests = 0;  ///< Playlists servies
+        uint64_t segmentRequests = 0;   ///< Segments servis
+        uint64_t injectedErrors = 0;    ///< Erreurs 503 injectées
+        uint64_t bytesServed = 0;       ///< Octets de segments servis
+    };
+
+    /**
+     * @brief Récupère les statistiques de l'origine
+     * @return Statistiques
+     */
+    Stats getStats() const;
+
+private:
+    /**
+     * @brief Écrit les segments de chaque chaîne dans le répertoire de travail
+     * @return true si les segments sont prêts
+     */
+    bool prepareSegments();
+
+    /**
+     * @brief Construit la playlist média glissante d'une chaîne à l'instant présent
+     * @return Contenu de la playlist
+     */
+    std::string buildMediaPlaylist() const;
+
+    /**
+     * @brief Numéro de séquence du segment le plus récent publié
+     * @return Numéro de séquence
+     */
+    int64_t currentSequence() const;
+
+    /**
+     * @brief Indique si un segment suit une discontinuité
+     * @param sequence Numéro de séquence
+     * @return true si une balise EXT-X-DISCONTINUITY le précède
+     */
+    bool isDiscontinuity(int64_t sequence) const;
+
+    /**
+     * @brief Applique la latence et la gigue configurées
+     */
+    void applyLatency();
+
+    /**
+     * @brief Tire au sort l'injection d'une erreur
+     * @return true si la requête doit échouer
+     */
+    bool injectError();
+
+    /**
+     * @brief Chemin du fichier d'un segment
+     * @param channel Indice de la chaîne
+     * @param poolIndex Indice du segment dans la réserve de la chaîne
+     * @return Chemin
+     */
+    std::string segmentPath(int channel, int poolIndex) const;
+
+    OriginOptions options_;                         ///< Paramètres de l'origine
+    std::unique_ptr<httplib::Server> server_;       ///< Serveur HTTP
+    std::thread serverThread_;                      ///< Thread d'écoute
+    std::atomic<bool> running_;                     ///< Serveur démarré
+    int port_;                                      ///< Port effectif
+    bool ownsDirectory_;                            ///< Le répertoire temporaire est à supprimer
+    std::chrono::steady_clock::time_point epoch_;   ///< Début de la diffusion simulée
+
+    mutable std::mutex randomMutex_;                ///< Protège le générateur aléatoire
+    std::mt19937 random_;                           ///< Générateur pour la gigue et les erreurs
+
+    std::atomic<uint64_t> playlistRequests_;        ///< Playlists servies
+    std::atomic<uint64_t> segmentRequests_;         ///< Segments servis
+    std::atomic<uint64_t> injectedErrors_;          ///< Erreurs injectées
+    std::atomic<uint64_t> bytesServed_;             ///< Octets servis
+};
+
+} // namespace tools
+} // namespace hls_to_dvb
@@ -0,0 +1,335 @@
+#include "OutputAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace hls_to_dvb {
+namespace tools {
+
+namespace {
+
+constexpr size_t PACKET_SIZE = 188;
+constexpr uint16_t PID_NULL = 0x1FFF;
+constexpr uint64_t PCR_MODULO = (1ULL << 33) * 300;
+constexpr int64_t PCR_TICKS_PER_MS = 27000;
+
+// Limites supérieures des classes de l'histogramme des intervalles d'arrivée (µs)
+constexpr double IAT_BOUNDS_US[] = {100, 250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 500000};
+
+/**
+ * @brief Écart signé entre deux PCR, en tenant compte du rebouclage à 2^33 x 300
+ */
+int64_t pcrDelta(uint64_t from, uint64_t to) {
+    int64_t delta = static_cast<int64_t>((to + PCR_MODULO - from) % PCR_MODULO);
+    if (delta > static_cast<int64_t>(PCR_MODULO / 2)) {
+        delta -= static_cast<int64_t>(PCR_MODULO);
+    }
+    return delta;
+}
+
+/**
+ * @brief Centile d'un échantillon déjà trié
+ */
+double percentile(const std::vector<uint32_t>& sorted, double ratio) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(ratio * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+} // namespace
+
+OutputAnalyzer::OutputAnalyzer(const std::string& name)
+    : name_(name),
+      datagrams_(0),
+      bytes_(0),
+      tsPackets_(0),
+      syncErrors_(0),
+      malformedDatagrams_(0),
+      packetIndex_(0),
+      iatHistogram_{},
+      iatCount_(0),
+      iatMaxUs_(0.0),
+      windowBytes_(0),
+      minBitrateKbps_(0.0),
+      maxBitrateKbps_(0.0) {
+}
+
+void OutputAnalyzer::process(const uint8_t* data, size_t size, std::chrono::steady_clock::time_point arrival) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (datagrams_ == 0) {
+        firstArrival_ = arrival;
+        windowStart_ = arrival;
+    } else {
+        double iatUs = std::chrono::duration<double, std::micro>(arrival - lastArrival_).count();
+        iatUs = std::max(0.0, iatUs);
+
+        size_t bucket = 0;
+        while (bucket < IAT_BUCKETS - 1 && iatUs > IAT_BOUNDS_US[bucket]) {
+            bucket++;
+        }
+        iatHistogram_[bucket]++;
+        
+        // Au-delà de IAT_MAX_SAMPLES, échantillonnage par réservoir: la mémoire reste bornée
+        // sur une longue capture et l'échantillon reste uniforme
+        uint32_t sample = static_cast<uint32_t>(std::min(iatUs, 4e9));
+        iatCount_++;
+        if (iatSamplesUs_.size() < IAT_MAX_SAMPLES) {
+            iatSamplesUs_.push_back(sample);
+        } else {
+            uint64_t slot = std::uniform_int_distribution<uint64_t>(0, iatCount_ - 1)(iatRandom_);
+            if (slot < IAT_MAX_SAMPLES) {
+                iatSamplesUs_[slot] = sample;
+            }
+        }
+        iatMaxUs_ = std::max(iatMaxUs_, iatUs);
+    }
+    lastArrival_ = arrival;
+
+    // Débit sur des fenêtres d'une seconde: une émission en rafales le fait osciller
+    double windowSeconds = std::chrono::duration<double>(arrival - windowStart_).count();
+    if (windowSeconds >= 1.0) {
+        double kbps = windowBytes_ * 8.0 / windowSeconds / 1000.0;
+        minBitrateKbps_ = minBitrateKbps_ == 0.0 ? kbps : std::min(minBitrateKbps_, kbps);
+        maxBitrateKbps_ = std::max(maxBitrateKbps_, kbps);
+        windowStart_ = arrival;
+        windowBytes_ = 0;
+    }
+    windowBytes_ += size;
+
+    datagrams_++;
+    bytes_ += size;
+
+    if (size % PACKET_SIZE != 0) {
+        malformedDatagrams_++;
+    }
+
+    for (size_t offset = 0; offset + PACKET_SIZE <= size; offset += PACKET_SIZE) {
+        processPacket(data + offset, arrival);
+    }
+}
+
+void OutputAnalyzer::processPacket(const uint8_t* packet, std::chrono::steady_clock::time_point arrival) {
+    tsPackets_++;
+    const uint64_t index = packetIndex_++;
+
+    if (packet[0] != 0x47) {
+        syncErrors_++;
+        return;
+    }
+
+    uint16_t pid = static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+    if (pid == PID_NULL) {
+        return;
+    }
+
+    PidState& state = pids_[pid];
+    state.report.packets++;
+
+    uint8_t afc = (packet[3] >> 4) & 0x03;
+    int cc = packet[3] & 0x0F;
+    bool hasPayload = (afc & 0x01) != 0;
+    bool hasAdaptation = (afc & 0x02) != 0 && packet[4] > 0;
+    bool discontinuity = hasAdaptation && (packet[5] & 0x80);
+
+    if (discontinuity || state.lastCC < 0) {
+        state.lastCC = cc;
+    } else if (hasPayload) {
+        int expected = (state.lastCC + 1) & 0x0F;
+        int jump = (cc - expected) & 0x0F;
+
+        if (cc == expected) {
+            state.lastCC = cc;
+        } else if (cc == state.lastCC) {
+            state.report.duplicates++;
+        } else if (jump >= 13) {
+            // Compteur en retrait de un à trois: paquet arrivé après son successeur,
+            // compté à tort comme perdu lors du saut précédent
+            state.report.reordered++;
+            state.report.ccErrors++;
+            if (state.report.lostPackets > 0) {
+                state.report.lostPackets--;
+            }
+        } else {
+            state.report.ccErrors++;
+            state.report.lostPackets += static_cast<uint64_t>(jump);
+            state.lastCC = cc;
+        }
+    }
+
+    if (hasAdaptation && packet[4] >= 7 && (packet[5] & 0x10)) {
+        uint64_t base = (static_cast<uint64_t>(packet[6]) << 25) |
+                        (static_cast<uint64_t>(packet[7]) << 17) |
+                        (static_cast<uint64_t>(packet[8]) << 9) |
+                        (static_cast<uint64_t>(packet[9]) << 1) |
+                        (static_cast<uint64_t>(packet[10]) >> 7);
+        uint64_t extension = (static_cast<uint64_t>(packet[10] & 0x01) << 8) | packet[11];
+        uint64_t pcr = base * 300 + extension;
+
+        processPcr(state, pcr, discontinuity, arrival);
+        state.lastPcrPacket = index;
+    }
+}
+
+void OutputAnalyzer::processPcr(PidState& state, uint64_t pcr, bool discontinuity,
+                                std::chrono::steady_clock::time_point arrival) {
+    PidReport& report = state.report;
+    report.pcrCount++;
+
+    if (!state.hasPcr || discontinuity) {
+        state.hasPcr = true;
+        state.lastPcr = pcr;
+        state.lastPcrArrival = arrival;
+        state.pcrRate = 0.0;
+        return;
+    }
+
+    int64_t delta = pcrDelta(state.lastPcr, pcr);
+    double arrivalMs = std::chrono::duration<double, std::milli>(arrival - state.lastPcrArrival).count();
+    const uint64_t packets = packetIndex_ - 1 - state.lastPcrPacket;
+
+    report.pcrMaxIntervalMs = std::max(report.pcrMaxIntervalMs, arrivalMs);
+    if (arrivalMs > 40.0) {
+        report.pcrIntervalErrors++;
+    }
+
+    if (delta <= 0 || delta > 100 * PCR_TICKS_PER_MS) {
+        // Saut de PCR non signalé: la base de temps du flux est rompue
+        report.pcrDiscontinuities++;
+        state.pcrRate = 0.0;
+    } else {
+        // Précision: écart entre la PCR reçue et celle attendue à débit constant,
+        // d'après le débit observé sur l'intervalle précédent
+        if (state.pcrRate > 0.0 && packets > 0) {
+            double predicted = state.pcrRate * static_cast<double>(packets);
+            double errorNs = std::fabs(static_cast<double>(delta) - predicted) * 1000.0 / 27.0;
+            report.pcrAccuracyMaxNs = std::max(report.pcrAccuracyMaxNs, errorNs);
+            if (errorNs > 500.0) {
+                report.pcrAccuracyErrors++;
+            }
+        }
+        state.pcrRate = packets > 0 ? static_cast<double>(delta) / static_cast<double>(packets) : 0.0;
+
+        // Gigue: l'intervalle d'arrivée devrait suivre l'intervalle des valeurs de PCR
+        double jitterUs = std::fabs(arrivalMs * 1000.0 - static_cast<double>(delta) / 27.0);
+        report.pcrJitterMaxUs = std::max(report.pcrJitterMaxUs, jitterUs);
+    }
+
+    state.lastPcr = pcr;
+    state.lastPcrArrival = arrival;
+}
+
+nlohmann::json OutputAnalyzer::report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    double durationS = datagrams_ > 1 ? std::chrono::duration<double>(lastArrival_ - firstArrival_).count() : 0.0;
+
+    nlohmann::json histogram = nlohmann::json::array();
+    for (size_t i = 0; i < IAT_BUCKETS; ++i) {
+        nlohmann::json bucket;
+        bucket["upToUs"] = i < IAT_BUCKETS - 1 ? nlohmann::json(IAT_BOUNDS_US[i]) : nlohmann::json(nullptr);
+        bucket["count"] = iatHistogram_[i];
+        histogram.push_back(bucket);
+    }
+
+    double meanUs = iatCount_ == 0 ? 0.0 : durationS * 1e6 / static_cast<double>(iatCount_);
+
+    std::vector<uint32_t> sortedIat = iatSamplesUs_;
+    std::sort(sortedIat.begin(), sortedIat.end());
+
+    nlohmann::json pids = nlohmann::json::object();
+    uint64_t ccErrors = 0, lostPackets = 0, reordered = 0, duplicates = 0;
+
+    for (const auto& [pid, state] : pids_) {
+        const PidReport& r = state.report;
+        char key[8];
+        std::snprintf(key, sizeof(key), "0x%04X", pid);
+
+        nlohmann::json entry = {
+            {"packets", r.packets},
+            {"ccErrors", r.ccErrors},
+            {"lostPackets", r.lostPackets},
+            {"duplicates", r.duplicates},
+            {"reordered", r.reordered}
+        };
+        if (r.pcrCount > 0) {
+            entry["pcr"] = {
+                {"count", r.pcrCount},
+                {"maxIntervalMs", r.pcrMaxIntervalMs},
+                {"intervalErrors", r.pcrIntervalErrors},
+                {"discontinuities", r.pcrDiscontinuities},
+                {"accuracyMaxNs", r.pcrAccuracyMaxNs},
+                {"accuracyErrors", r.pcrAccuracyErrors},
+                {"jitterMaxUs", r.pcrJitterMaxUs}
+            };
+        }
+        pids[key] = entry;
+
+        ccErrors += r.ccErrors;
+        lostPackets += r.lostPackets;
+        reordered += r.reordered;
+        duplicates += r.duplicates;
+    }
+
+    return {
+        {"stream", name_},
+        {"durationS", durationS},
+        {"datagrams", datagrams_},
+        {"bytes", bytes_},
+        {"tsPackets", tsPackets_},
+        {"syncErrors", syncErrors_},
+        {"malformedDatagrams", malformedDatagrams_},
+        {"bitrateKbps", {
+            {"average", durationS > 0.0 ? bytes_ * 8.0 / durationS / 1000.0 : 0.0},
+            {"min", minBitrateKbps_},
+            {"max", maxBitrateKbps_}
+        }},
+        {"iat", {
+            {"meanUs", meanUs},
+            {"p50Us", percentile(sortedIat, 0.50)},
+            {"p99Us", percentile(sortedIat, 0.99)},
+            {"p999Us", percentile(sortedIat, 0.999)},
+            {"maxUs", iatMaxUs_},
+            {"histogram", histogram}
+        }},
+        {"continuity", {
+            {"ccErrors", ccErrors},
+            {"lostPackets", lostPackets},
+            {"reordered", reordered},
+            {"duplicates", duplicates}
+        }},
+        {"pids", pids}
+    };
+}
+
+std::string OutputAnalyzer::summaryLine() const {
+    nlohmann::json r = report();
+
+    double pcrJitterMaxUs = 0.0;
+    for (const auto& [pid, entry] : r["pids"].items()) {
+        if (entry.contains("pcr")) {
+            pcrJitterMaxUs = std::max(pcrJitterMaxUs, entry["pcr"]["jitterMaxUs"].get<double>());
+        }
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%s: %lu datagrammes, %.0f kbit/s, IAT p99 %.0f µs max %.0f µs, CC %lu, perdus %lu, "
+                  "désordre %lu, gigue PCR max %.0f µs",
+                  name_.c_str(),
+                  static_cast<unsigned long>(r["datagrams"].get<uint64_t>()),
+                  r["bitrateKbps"]["average"].get<double>(),
+                  r["iat"]["p99Us"].get<double>(),
+                  r["iat"]["maxUs"].get<double>(),
+                  static_cast<unsigned long>(r["continuity"]["ccErrors"].get<uint64_t>()),
+                  static_cast<unsigned long>(r["continuity"]["lostPackets"].get<uint64_t>()),
+                  static_cast<unsigned long>(r["continuity"]["reordered"].get<uint64_t>()),
+                  pcrJitterMaxUs);
+    return line;
+}
+
+} // namespace tools
+} // namespace hls_to_dvb
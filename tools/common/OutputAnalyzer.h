@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace hls_to_dvb {
+namespace tools {
+
+/**
+ * @struct PidReport
+ * @brief Mesures relevées sur un PID de la sortie
+ */
+struct PidReport {
+    uint64_t packets = 0;           ///< Paquets reçus
+    uint64_t ccErrors = 0;          ///< Ruptures de compteur de continuité
+    uint64_t lostPackets = 0;       ///< Paquets manquants déduits des sauts de compteur
+    uint64_t duplicates = 0;        ///< Paquets dupliqués (compteur répété)
+    uint64_t reordered = 0;         ///< Paquets arrivés après un successeur (compteur qui recule)
+    uint64_t pcrCount = 0;          ///< PCR reçues
+    double pcrMaxIntervalMs = 0.0;  ///< Plus long intervalle entre deux PCR (ETR 290: 40 ms)
+    uint64_t pcrIntervalErrors = 0; ///< Intervalles entre PCR supérieurs à 40 ms
+    uint64_t pcrDiscontinuities = 0;///< Sauts de PCR supérieurs à 100 ms sans indicateur
+    double pcrAccuracyMaxNs = 0.0;  ///< Plus grand écart de PCR par rapport au débit constant
+    uint64_t pcrAccuracyErrors = 0; ///< Écarts de PCR supérieurs à ±500 ns
+    double pcrJitterMaxUs = 0.0;    ///< Plus grand écart entre intervalle d'arrivée et intervalle de valeur de deux PCR
+};
+
+/**
+ * @class OutputAnalyzer
+ * @brief Analyse d'un flux TS reçu sur le réseau, datagramme par datagramme
+ *
+ * Contrairement à TSQualityMonitor, qui inspecte les segments avant leur émission,
+ * cette analyse porte sur ce que reçoit un récepteur : intervalles d'arrivée des
+ * datagrammes (rafales de l'émetteur), pertes et désordres déduits des compteurs de
+ * continuité, précision des PCR et écart entre l'horloge des PCR et l'heure d'arrivée.
+ */
+class OutputAnalyzer {
+public:
+    /**
+     * @brief Constructeur
+     * @param name Nom du flux analysé (groupe:port)
+     */
+    explicit OutputAnalyzer(const std::string& name);
+
+    /**
+     * @brief Analyse un datagramme reçu
+     * @param data Contenu du datagramme
+     * @param size Taille en octets
+     * @param arrival Instant de réception
+     */
+    void process(const uint8_t* data, size_t size, std::chrono::steady_clock::time_point arrival);
+
+    /**
+     * @brief Produit le rapport des mesures
+     * @return Rapport JSON
+     */
+    nlohmann::json report() const;
+
+    /**
+     * @brief Résumé d'une ligne pour l'affichage périodique
+     * @return Texte du résumé
+     */
+    std::string summaryLine() const;
+
+private:
+    /**
+     * @brief État de suivi d'un PID
+     */
+    struct PidState {
+        PidReport report;                                   ///< Mesures publiées
+        int lastCC = -1;                                    ///< Dernier compteur de continuité
+        bool hasPcr = false;                                ///< Une PCR a déjà été reçue
+        uint64_t lastPcr = 0;                               ///< Dernière PCR (27 MHz)
+        uint64_t lastPcrPacket = 0;                         ///< Rang du paquet de la dernière PCR
+        std::chrono::steady_clock::time_point lastPcrArrival; ///< Arrivée de la dernière PCR
+        double pcrRate = 0.0;                               ///< Ticks de PCR par paquet sur l'intervalle précédent
+    };
+
+    /**
+     * @brief Analyse un paquet TS
+     * @param packet Paquet de 188 octets
+     * @param arrival Instant de réception du datagramme
+     */
+    void processPacket(const uint8_t* packet, std::chrono::steady_clock::time_point arrival);
+
+    /**
+     * @brief Analyse une PCR
+     * @param state État du PID porteur
+     * @param pcr Valeur de la PCR (27 MHz)
+     * @param discontinuity Indicateur de discontinuité du paquet
+     * @param arrival Instant de réception
+     */
+    void processPcr(PidState& state, uint64_t pcr, bool discontinuity,
+                    std::chrono::steady_clock::time_point arrival);
+
+    static constexpr size_t IAT_BUCKETS = 12;              ///< Classes de l'histogramme des intervalles
+    static constexpr size_t IAT_MAX_SAMPLES = 1 << 20;      ///< Échantillons gardés pour les centiles
+
+    std::string name_;                                      ///< Nom du flux
+    mutable std::mutex mutex_;                              ///< Protège les mesures
+
+    uint64_t datagrams_;                                    ///< Datagrammes reçus
+    uint64_t bytes_;                                        ///< Octets reçus
+    uint64_t tsPackets_;                                    ///< Paquets TS reçus
+    uint64_t syncErrors_;                                   ///< Paquets sans octet de synchronisation
+    uint64_t malformedDatagrams_;                           ///< Datagrammes de taille non multiple de 188
+    uint64_t packetIndex_;                                  ///< Rang du paquet courant dans le flux
+
+    std::chrono::steady_clock::time_point firstArrival_;    ///< Premier datagramme
+    std::chrono::steady_clock::time_point lastArrival_;     ///< Datagramme précédent
+    std::array<uint64_t, IAT_BUCKETS> iatHistogram_;        ///< Histogramme des intervalles d'arrivée
+    std::vector<uint32_t> iatSamplesUs_;                    ///< Échantillon uniforme des intervalles d'arrivée (µs), pour les centiles
+    uint64_t iatCount_;                                     ///< Intervalles d'arrivée mesurés
+    std::minstd_rand iatRandom_;                            ///< Tirage de l'échantillonnage par réservoir
+    double iatMaxUs_;                                       ///< Plus grand intervalle d'arrivée
+
+    std::chrono::steady_clock::time_point windowStart_;     ///< Début de la fenêtre de débit courante
+    uint64_t windowBytes_;                                  ///< Octets reçus dans la fenêtre courante
+    double minBitrateKbps_;                                 ///< Plus faible débit sur une fenêtre d'une seconde
+    double maxBitrateKbps_;                                 ///< Plus fort débit sur une fenêtre d'une seconde
+
+    std::map<uint16_t, PidState> pids_;                     ///< Suivi par PID
+};
+
+} // namespace tools
+} // namespace hls_to_dvb
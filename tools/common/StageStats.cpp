@@ -0,0 +1,77 @@
+#include "StageStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hls_to_dvb {
+namespace tools {
+
+namespace {
+
+constexpr double TS_PACKET_SIZE = 188.0;
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, index > 0 ? index - 1 : 0)];
+}
+
+} // namespace
+
+StageStats::StageStats(const std::string& name)
+    : name_(name), totalUs_(0.0), totalBytes_(0), totalAllocations_(0), totalAllocatedBytes_(0) {
+}
+
+void StageStats::record(double durationUs, size_t bytes, uint64_t allocations, uint64_t allocatedBytes) {
+    durationsUs_.push_back(durationUs);
+    totalUs_ += durationUs;
+    totalBytes_ += bytes;
+    totalAllocations_ += allocations;
+    totalAllocatedBytes_ += allocatedBytes;
+}
+
+StageStats::Summary StageStats::summarize() const {
+    Summary summary;
+    summary.name = name_;
+    summary.iterations = durationsUs_.size();
+
+    if (durationsUs_.empty()) {
+        return summary;
+    }
+
+    std::vector<double> sorted = durationsUs_;
+    std::sort(sorted.begin(), sorted.end());
+
+    summary.p50Us = percentile(sorted, 0.50);
+    summary.p99Us = percentile(sorted, 0.99);
+    summary.maxUs = sorted.back();
+
+    if (totalUs_ > 0.0) {
+        summary.megabytesPerSecond = totalBytes_ / totalUs_;
+        summary.packetsPerSecond = (totalBytes_ / TS_PACKET_SIZE) / (totalUs_ / 1e6);
+    }
+
+    summary.allocationsPerOp = static_cast<double>(totalAllocations_) / summary.iterations;
+    summary.allocatedBytesPerOp = static_cast<double>(totalAllocatedBytes_) / summary.iterations;
+
+    return summary;
+}
+
+nlohmann::json StageStats::toJson(const Summary& summary) {
+    return {
+        {"name", summary.name},
+        {"iterations", summary.iterations},
+        {"megabytesPerSecond", summary.megabytesPerSecond},
+        {"packetsPerSecond", summary.packetsPerSecond},
+        {"p50Us", summary.p50Us},
+        {"p99Us", summary.p99Us},
+        {"maxUs", summary.maxUs},
+        {"allocationsPerOp", summary.allocationsPerOp},
+        {"allocatedBytesPerOp", summary.allocatedBytesPerOp}
+    };
+}
+
+} // namespace tools
+} // namespace hls_to_dvb
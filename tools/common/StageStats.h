@@ -0,0 +1,73 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hls_to_dvb {
+namespace tools {
+
+/**
+ * @class StageStats
+ * @brief Accumule les mesures d'une étape du pipeline et en calcule le résumé
+ */
+class StageStats {
+public:
+    /**
+     * @struct Summary
+     * @brief Résumé des mesures d'une étape
+     */
+    struct Summary {
+        std::string name;                   ///< Nom de l'étape
+        size_t iterations = 0;              ///< Nombre de mesures
+        double megabytesPerSecond = 0.0;    ///< Débit traité (Mo/s, 10^6 octets)
+        double packetsPerSecond = 0.0;      ///< Paquets TS traités par seconde
+        double p50Us = 0.0;                 ///< Latence médiane (µs)
+        double p99Us = 0.0;                 ///< Latence au 99e centile (µs)
+        double maxUs = 0.0;                 ///< Latence maximale (µs)
+        double allocationsPerOp = 0.0;      ///< Allocations sur le tas par appel
+        double allocatedBytesPerOp = 0.0;   ///< Octets alloués par appel
+    };
+
+    /**
+     * @brief Constructeur
+     * @param name Nom de l'étape
+     */
+    explicit StageStats(const std::string& name);
+
+    /**
+     * @brief Enregistre une mesure
+     * @param durationUs Durée de l'appel (µs)
+     * @param bytes Octets traités
+     * @param allocations Allocations effectuées pendant l'appel
+     * @param allocatedBytes Octets alloués pendant l'appel
+     */
+    void record(double durationUs, size_t bytes, uint64_t allocations, uint64_t allocatedBytes);
+
+    /**
+     * @brief Calcule le résumé des mesures
+     * @return Résumé
+     */
+    Summary summarize() const;
+
+    /**
+     * @brief Convertit un résumé en JSON
+     * @param summary Résumé
+     * @return Objet JSON
+     */
+    static nlohmann::json toJson(const Summary& summary);
+
+private:
+    std::string name_;                  ///< Nom de l'étape
+    std::vector<double> durationsUs_;   ///< Durées mesurées (µs)
+    double totalUs_;                    ///< Durée cumulée (µs)
+    uint64_t totalBytes_;               ///< Octets traités
+    uint64_t totalAllocations_;         ///< Allocations cumulées
+    uint64_t totalAllocatedBytes_;      ///< Octets alloués cumulés
+};
+
+} // namespace tools
+} // namespace hls_to_dvb
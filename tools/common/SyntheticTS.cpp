@@ -0,0 +1,315 @@
+#include "SyntheticTS.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace hls_to_dvb {
+namespace tools {
+
+namespace {
+
+constexpr size_t PACKET_SIZE = 188;
+constexpr uint16_t PID_PAT = 0x0000;
+constexpr uint16_t PID_SDT = 0x0011;
+constexpr uint64_t PCR_MODULO = (1ULL << 33) * 300;
+constexpr uint64_t DISCONTINUITY_JUMP = 27000000ULL * 3600;    // Saut d'une heure de base de temps
+
+} // namespace
+
+SyntheticTSGenerator::SyntheticTSGenerator(const SyntheticTSOptions& options)
+    : options_(options), clock27MHz_(27000000ULL * 10), sequenceNumber_(0) {
+    pat_ = buildPAT();
+    pmt_ = buildPMT();
+    sdt_ = buildSDT();
+}
+
+std::vector<uint8_t> SyntheticTSGenerator::nextSegment(bool discontinuity) {
+    const int durationMs = std::max(1, options_.segmentDurationMs);
+    const uint64_t segmentBytes = static_cast<uint64_t>(options_.bitrateKbps) * 1000 / 8 * durationMs / 1000;
+    const size_t packetCount = std::max<size_t>(16, segmentBytes / PACKET_SIZE);
+
+    if (discontinuity) {
+        clock27MHz_ = (clock27MHz_ + DISCONTINUITY_JUMP) % PCR_MODULO;
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(packetCount * PACKET_SIZE);
+
+    int nextPsiMs = 0;
+    int nextPcrMs = 0;
+    int nextFrameMs = 0;
+    size_t pendingPsi = 0;
+    bool pendingDiscontinuity = discontinuity;
+
+    for (size_t i = 0; i < packetCount; ++i) {
+        const double slotMs = static_cast<double>(i) * durationMs / packetCount;
+        const uint64_t slotClock = (clock27MHz_ + static_cast<uint64_t>(slotMs * 27000.0)) % PCR_MODULO;
+
+        if (slotMs >= nextPsiMs) {
+            pendingPsi = 3;
+            nextPsiMs += std::max(1, options_.psiIntervalMs);
+        }
+
+        if (pendingPsi > 0) {
+            // Ordre PAT, PMT, SDT
+            switch (pendingPsi--) {
+                case 3:
+                    writeSectionPacket(out, PID_PAT, pat_);
+                    break;
+                case 2:
+                    writeSectionPacket(out, options_.pmtPid, pmt_);
+                    break;
+                default:
+                    writeSectionPacket(out, PID_SDT, sdt_);
+                    break;
+            }
+            continue;
+        }
+
+        const uint64_t pts = slotClock / 300 + 90 * 100;   // PTS 100 ms après le PCR
+
+        if (i % 10 == 5) {
+            writeElementaryPacket(out, options_.audioPid, i % 40 == 5, -1, false, pts);
+            continue;
+        }
+
+        bool withPcr = slotMs >= nextPcrMs;
+        if (withPcr) {
+            nextPcrMs += std::max(1, options_.pcrIntervalMs);
+        }
+
+        bool unitStart = slotMs >= nextFrameMs;
+        if (unitStart) {
+            nextFrameMs += std::max(1, options_.frameIntervalMs);
+        }
+
+        writeElementaryPacket(out, options_.videoPid, unitStart, withPcr ? static_cast<int64_t>(slotClock) : -1,
+                              pendingDiscontinuity && withPcr, pts);
+        if (withPcr) {
+            pendingDiscontinuity = false;
+        }
+    }
+
+    clock27MHz_ = (clock27MHz_ + static_cast<uint64_t>(durationMs) * 27000) % PCR_MODULO;
+    sequenceNumber_++;
+
+    return out;
+}
+
+HLSSegment SyntheticTSGenerator::nextHLSSegment(bool discontinuity) {
+    HLSSegment segment;
+    segment.sequenceNumber = sequenceNumber_;
+    segment.data = nextSegment(discontinuity);
+    segment.discontinuity = discontinuity;
+    segment.duration = options_.segmentDurationMs / 1000.0;
+    segment.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return segment;
+}
+
+const SyntheticTSOptions& SyntheticTSGenerator::getOptions() const {
+    return options_;
+}
+
+std::vector<std::vector<uint8_t>> SyntheticTSGenerator::loadSegmentsFromFile(const std::string& path,
+                                                                             size_t segmentBytes) {
+    std::vector<std::vector<uint8_t>> segments;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return segments;
+    }
+
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Se caler sur le premier octet de synchronisation suivi d'un second un paquet plus loin
+    size_t offset = 0;
+    while (offset + PACKET_SIZE < content.size() &&
+           !(content[offset] == 0x47 && content[offset + PACKET_SIZE] == 0x47)) {
+        offset++;
+    }
+    if (offset + PACKET_SIZE >= content.size()) {
+        return segments;
+    }
+
+    size_t chunk = std::max<size_t>(1, segmentBytes / PACKET_SIZE) * PACKET_SIZE;
+    while (offset + PACKET_SIZE <= content.size()) {
+        size_t available = (content.size() - offset) / PACKET_SIZE * PACKET_SIZE;
+        size_t size = std::min(chunk, available);
+        segments.emplace_back(content.begin() + offset, content.begin() + offset + size);
+        offset += size;
+    }
+
+    return segments;
+}
+
+uint32_t SyntheticTSGenerator::crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint32_t>(data[i]) << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+std::vector<uint8_t> SyntheticTSGenerator::buildSection(uint8_t tableId, bool reservedFutureUse,
+                                                        uint16_t tableIdExtension,
+                                                        const std::vector<uint8_t>& body) const {
+    const size_t sectionLength = 5 + body.size() + 4;
+
+    std::vector<uint8_t> section;
+    section.reserve(3 + sectionLength);
+    section.push_back(tableId);
+    section.push_back(static_cast<uint8_t>(0x80 | (reservedFutureUse ? 0x40 : 0x00) | 0x30 |
+                                           ((sectionLength >> 8) & 0x0F)));
+    section.push_back(static_cast<uint8_t>(sectionLength & 0xFF));
+    section.push_back(static_cast<uint8_t>(tableIdExtension >> 8));
+    section.push_back(static_cast<uint8_t>(tableIdExtension & 0xFF));
+    section.push_back(0xC1);    // version 0, current_next_indicator = 1
+    section.push_back(0x00);    // section_number
+    section.push_back(0x00);    // last_section_number
+    section.insert(section.end(), body.begin(), body.end());
+
+    uint32_t crc = crc32(section.data(), section.size());
+    section.push_back(static_cast<uint8_t>(crc >> 24));
+    section.push_back(static_cast<uint8_t>(crc >> 16));
+    section.push_back(static_cast<uint8_t>(crc >> 8));
+    section.push_back(static_cast<uint8_t>(crc));
+
+    return section;
+}
+
+std::vector<uint8_t> SyntheticTSGenerator::buildPAT() const {
+    std::vector<uint8_t> body = {
+        static_cast<uint8_t>(options_.serviceId >> 8),
+        static_cast<uint8_t>(options_.serviceId & 0xFF),
+        static_cast<uint8_t>(0xE0 | (options_.pmtPid >> 8)),
+        static_cast<uint8_t>(options_.pmtPid & 0xFF),
+    };
+    return buildSection(0x00, false, options_.transportStreamId, body);
+}
+
+std::vector<uint8_t> SyntheticTSGenerator::buildPMT() const {
+    std::vector<uint8_t> body = {
+        static_cast<uint8_t>(0xE0 | (options_.videoPid >> 8)),  // PCR_PID
+        static_cast<uint8_t>(options_.videoPid & 0xFF),
+        0xF0, 0x00,                                             // program_info_length
+        0x1B,                                                   // H.264
+        static_cast<uint8_t>(0xE0 | (options_.videoPid >> 8)),
+        static_cast<uint8_t>(options_.videoPid & 0xFF),
+        0xF0, 0x00,
+        0x0F,                                                   // AAC ADTS
+        static_cast<uint8_t>(0xE0 | (options_.audioPid >> 8)),
+        static_cast<uint8_t>(options_.audioPid & 0xFF),
+        0xF0, 0x00,
+    };
+    return buildSection(0x02, false, options_.serviceId, body);
+}
+
+std::vector<uint8_t> SyntheticTSGenerator::buildSDT() const {
+    std::vector<uint8_t> descriptor;
+    descriptor.push_back(0x01);     // Service de télévision numérique
+    descriptor.push_back(static_cast<uint8_t>(options_.providerName.size()));
+    descriptor.insert(descriptor.end(), options_.providerName.begin(), options_.providerName.end());
+    descriptor.push_back(static_cast<uint8_t>(options_.serviceName.size()));
+    descriptor.insert(descriptor.end(), options_.serviceName.begin(), options_.serviceName.end());
+
+    const size_t loopLength = 2 + descriptor.size();
+
+    std::vector<uint8_t> body = {
+        static_cast<uint8_t>(options_.originalNetworkId >> 8),
+        static_cast<uint8_t>(options_.originalNetworkId & 0xFF),
+        0xFF,                                                   // reserved_future_use
+        static_cast<uint8_t>(options_.serviceId >> 8),
+        static_cast<uint8_t>(options_.serviceId & 0xFF),
+        0xFC,                                                   // Pas d'EIT
+        static_cast<uint8_t>(0x80 | ((loopLength >> 8) & 0x0F)),  // running_status = 4 (en cours)
+        static_cast<uint8_t>(loopLength & 0xFF),
+        0x48,                                                   // service_descriptor
+        static_cast<uint8_t>(descriptor.size()),
+    };
+    body.insert(body.end(), descriptor.begin(), descriptor.end());
+
+    return buildSection(0x42, true, options_.transportStreamId, body);
+}
+
+void SyntheticTSGenerator::writeSectionPacket(std::vector<uint8_t>& out, uint16_t pid,
+                                              const std::vector<uint8_t>& section) {
+    size_t start = out.size();
+    out.resize(start + PACKET_SIZE, 0xFF);
+    uint8_t* b = out.data() + start;
+
+    b[0] = 0x47;
+    b[1] = static_cast<uint8_t>(0x40 | (pid >> 8));
+    b[2] = static_cast<uint8_t>(pid & 0xFF);
+    b[3] = static_cast<uint8_t>(0x10 | nextCC(pid));
+    b[4] = 0x00;    // pointer_field
+    std::memcpy(b + 5, section.data(), std::min(section.size(), PACKET_SIZE - 5));
+}
+
+void SyntheticTSGenerator::writeElementaryPacket(std::vector<uint8_t>& out, uint16_t pid, bool unitStart,
+                                                 int64_t pcr, bool discontinuity, uint64_t ptsTicks) {
+    size_t start = out.size();
+    out.resize(start + PACKET_SIZE, 0xAA);
+    uint8_t* b = out.data() + start;
+
+    b[0] = 0x47;
+    b[1] = static_cast<uint8_t>((unitStart ? 0x40 : 0x00) | (pid >> 8));
+    b[2] = static_cast<uint8_t>(pid & 0xFF);
+
+    size_t offset = 4;
+    if (pcr >= 0 || discontinuity) {
+        b[3] = static_cast<uint8_t>(0x30 | nextCC(pid));
+        b[5] = static_cast<uint8_t>((discontinuity ? 0x80 : 0x00) | (pcr >= 0 ? 0x10 : 0x00));
+        size_t afLength = 1;
+
+        if (pcr >= 0) {
+            uint64_t base = static_cast<uint64_t>(pcr) / 300;
+            uint64_t extension = static_cast<uint64_t>(pcr) % 300;
+            b[6] = static_cast<uint8_t>(base >> 25);
+            b[7] = static_cast<uint8_t>(base >> 17);
+            b[8] = static_cast<uint8_t>(base >> 9);
+            b[9] = static_cast<uint8_t>(base >> 1);
+            b[10] = static_cast<uint8_t>(((base & 0x01) << 7) | 0x7E | (extension >> 8));
+            b[11] = static_cast<uint8_t>(extension & 0xFF);
+            afLength += 6;
+        }
+
+        b[4] = static_cast<uint8_t>(afLength);
+        offset = 5 + afLength;
+    } else {
+        b[3] = static_cast<uint8_t>(0x10 | nextCC(pid));
+    }
+
+    if (unitStart) {
+        // En-tête PES minimal avec PTS, longueur non bornée
+        const uint8_t streamId = pid == options_.audioPid ? 0xC0 : 0xE0;
+        uint8_t pes[14] = {
+            0x00, 0x00, 0x01, streamId, 0x00, 0x00, 0x80, 0x80, 0x05,
+            static_cast<uint8_t>(0x21 | ((ptsTicks >> 29) & 0x0E)),
+            static_cast<uint8_t>(ptsTicks >> 22),
+            static_cast<uint8_t>(0x01 | ((ptsTicks >> 14) & 0xFE)),
+            static_cast<uint8_t>(ptsTicks >> 7),
+            static_cast<uint8_t>(0x01 | ((ptsTicks << 1) & 0xFE)),
+        };
+        std::memcpy(b + offset, pes, sizeof(pes));
+    }
+}
+
+uint8_t SyntheticTSGenerator::nextCC(uint16_t pid) {
+    auto it = counters_.find(pid);
+    if (it == counters_.end()) {
+        counters_[pid] = 0;
+        return 0;
+    }
+    it->second = (it->second + 1) & 0x0F;
+    return it->second;
+}
+
+} // namespace tools
+} // namespace hls_to_dvb
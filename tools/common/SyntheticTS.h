@@ -0,0 +1,140 @@
+#pragma once
+
+#include "hls/HLSClient.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hls_to_dvb {
+namespace tools {
+
+/**
+ * @struct SyntheticTSOptions
+ * @brief Paramètres du flux MPEG-TS synthétique
+ */
+struct SyntheticTSOptions {
+    uint32_t bitrateKbps = 8000;        ///< Débit total du flux (kbit/s)
+    int segmentDurationMs = 2000;       ///< Durée d'un segment (ms)
+    uint16_t transportStreamId = 1;     ///< Identifiant du multiplex
+    uint16_t originalNetworkId = 1;     ///< Identifiant du réseau d'origine
+    uint16_t serviceId = 1;             ///< Identifiant du service
+    uint16_t pmtPid = 0x1000;           ///< PID de la PMT
+    uint16_t videoPid = 0x0100;         ///< PID vidéo (porte aussi les PCR)
+    uint16_t audioPid = 0x0101;         ///< PID audio
+    int psiIntervalMs = 100;            ///< Intervalle de répétition PAT/PMT/SDT (ms)
+    int pcrIntervalMs = 40;             ///< Intervalle entre deux PCR (ms)
+    int frameIntervalMs = 40;           ///< Intervalle entre deux débuts de PES vidéo (ms)
+    std::string serviceName = "Synthetic";  ///< Nom du service annoncé dans la SDT
+    std::string providerName = "hls-to-dvb"; ///< Nom du fournisseur annoncé dans la SDT
+};
+
+/**
+ * @class SyntheticTSGenerator
+ * @brief Génère des segments MPEG-TS conformes et enchaînés pour les mesures de performance
+ *
+ * Les segments produits contiennent un service avec PAT, PMT et SDT répétées, une
+ * composante vidéo portant les PCR et une composante audio. Les compteurs de continuité
+ * et les PCR se suivent d'un segment à l'autre ; une discontinuité décale la base de
+ * temps et la signale dans le champ d'adaptation, comme le ferait une source conforme.
+ */
+class SyntheticTSGenerator {
+public:
+    /**
+     * @brief Constructeur
+     * @param options Paramètres du flux
+     */
+    explicit SyntheticTSGenerator(const SyntheticTSOptions& options = SyntheticTSOptions());
+
+    /**
+     * @brief Génère le segment suivant
+     * @param discontinuity true pour introduire une discontinuité en début de segment
+     * @return Données MPEG-TS du segment
+     */
+    std::vector<uint8_t> nextSegment(bool discontinuity = false);
+
+    /**
+     * @brief Génère le segment suivant sous forme de segment HLS
+     * @param discontinuity true pour introduire une discontinuité en début de segment
+     * @return Segment HLS (numéro de séquence, durée et horodatage renseignés)
+     */
+    HLSSegment nextHLSSegment(bool discontinuity = false);
+
+    /**
+     * @brief Récupère les paramètres du flux
+     * @return Paramètres
+     */
+    const SyntheticTSOptions& getOptions() const;
+
+    /**
+     * @brief Découpe un fichier MPEG-TS enregistré en segments de taille fixe
+     * @param path Chemin du fichier
+     * @param segmentBytes Taille visée d'un segment (arrondie au paquet inférieur)
+     * @return Segments lus (vide si le fichier est illisible ou ne contient pas de TS)
+     */
+    static std::vector<std::vector<uint8_t>> loadSegmentsFromFile(const std::string& path, size_t segmentBytes);
+
+    /**
+     * @brief Calcule le CRC32 MPEG-2 d'un bloc d'octets
+     * @param data Données
+     * @param size Taille
+     * @return CRC32
+     */
+    static uint32_t crc32(const uint8_t* data, size_t size);
+
+private:
+    /**
+     * @brief Construit une section PSI/SI longue avec son CRC
+     * @param tableId Identifiant de table
+     * @param reservedFutureUse Valeur du bit reserved_future_use (1 pour les tables DVB)
+     * @param tableIdExtension Extension d'identifiant (transport_stream_id, program_number, ...)
+     * @param body Corps de la section (après last_section_number)
+     * @return Section complète
+     */
+    std::vector<uint8_t> buildSection(uint8_t tableId, bool reservedFutureUse, uint16_t tableIdExtension,
+                                      const std::vector<uint8_t>& body) const;
+
+    std::vector<uint8_t> buildPAT() const;  ///< Construit la section PAT
+    std::vector<uint8_t> buildPMT() const;  ///< Construit la section PMT
+    std::vector<uint8_t> buildSDT() const;  ///< Construit la section SDT
+
+    /**
+     * @brief Ajoute une section tenant dans un seul paquet
+     * @param out Tampon de sortie
+     * @param pid PID de la table
+     * @param section Section à émettre
+     */
+    void writeSectionPacket(std::vector<uint8_t>& out, uint16_t pid, const std::vector<uint8_t>& section);
+
+    /**
+     * @brief Ajoute un paquet de composante élémentaire
+     * @param out Tampon de sortie
+     * @param pid PID de la composante
+     * @param unitStart Début d'un PES
+     * @param pcr Valeur PCR à insérer (27 MHz), ou -1 pour aucun PCR
+     * @param discontinuity Positionner l'indicateur de discontinuité
+     * @param ptsTicks Horodatage PTS du PES (90 kHz), utilisé si unitStart
+     */
+    void writeElementaryPacket(std::vector<uint8_t>& out, uint16_t pid, bool unitStart, int64_t pcr,
+                               bool discontinuity, uint64_t ptsTicks);
+
+    /**
+     * @brief Retourne le compteur de continuité suivant d'un PID
+     * @param pid PID
+     * @return Compteur à écrire dans le paquet
+     */
+    uint8_t nextCC(uint16_t pid);
+
+    SyntheticTSOptions options_;                ///< Paramètres du flux
+    std::map<uint16_t, uint8_t> counters_;      ///< Compteurs de continuité par PID
+    uint64_t clock27MHz_;                       ///< Horloge système du début du segment suivant
+    int sequenceNumber_;                        ///< Numéro de séquence du segment suivant
+    std::vector<uint8_t> pat_;                  ///< Section PAT précalculée
+    std::vector<uint8_t> pmt_;                  ///< Section PMT précalculée
+    std::vector<uint8_t> sdt_;                  ///< Section SDT précalculée
+};
+
+} // namespace tools
+} // namespace hls_to_dvb
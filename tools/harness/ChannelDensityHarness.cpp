@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+#include "MulticastCapture.h"
+#include "OriginSimulator.h"
+#include "core/Config.h"
+#include "core/StreamManager.h"
+
+using namespace hls_to_dvb;
+using namespace hls_to_dvb::tools;
+
+namespace {
+
+/**
+ * @struct HarnessOptions
+ * @brief Options de la ligne de commande
+ */
+struct HarnessOptions {
+    OriginOptions origin;                   ///< Paramètres de l'origine simulée
+    int startChannels = 1;                  ///< Nombre de chaînes du premier palier
+    int maxChannels = 32;                   ///< Nombre maximal de chaînes
+    int step = 0;                           ///< Incrément entre paliers (0 = doublement)
+    int warmupSeconds = 20;                 ///< Chauffe avant mesure (démarrage, remplissage des tampons)
+    int measureSeconds = 30;                ///< Durée de mesure par palier
+    int maxGapMs = 0;                       ///< Intervalle maximal toléré en sortie (0 = 1,5 x durée de segment)
+    double minDeliveryRatio = 0.9;          ///< Débit reçu minimal rapporté au débit de la source
+    std::string groupPrefix = "239.255.20."; ///< Préfixe des groupes de sortie
+    int portBase = 7000;                    ///< Port du premier flux de sortie
+    std::string interface = "127.0.0.1";    ///< Interface de sortie et de capture
+    bool passthrough = false;               ///< Activer le mode passthrough sur les flux
+    std::string jsonPath;                   ///< Fichier du rapport JSON
+    std::string logLevel = "warn";          ///< Niveau de journalisation
+};
+
+/**
+ * @struct StepResult
+ * @brief Résultat d'un palier de charge
+ */
+struct StepResult {
+    int channels = 0;                       ///< Chaînes lancées
+    int startedChannels = 0;                ///< Chaînes effectivement démarrées
+    double cpuCores = 0.0;                  ///< Cœurs consommés pendant la mesure
+    double worstGapMs = 0.0;                ///< Pire intervalle entre datagrammes
+    double worstDeliveryRatio = 0.0;        ///< Pire rapport débit reçu / débit source
+    uint64_t ccErrors = 0;                  ///< Ruptures de continuité, tous flux confondus
+    uint64_t syncErrors = 0;                ///< Paquets désynchronisés, tous flux confondus
+    bool gapFree = false;                   ///< Sortie sans trou sur tous les flux
+};
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s [options]\n"
+                "  --start N               Chaînes du premier palier (défaut: 1)\n"
+                "  --max-channels N        Chaînes maximales (défaut: 32)\n"
+                "  --step N                Incrément entre paliers (défaut: doublement)\n"
+                "  --warmup S              Chauffe par palier en secondes (défaut: 20)\n"
+                "  --measure S             Mesure par palier en secondes (défaut: 30)\n"
+                "  --max-gap-ms MS         Intervalle maximal toléré en sortie (défaut: 1,5 x segment)\n"
+                "  --segment-ms MS         Durée des segments de l'origine (défaut: 2000)\n"
+                "  --bitrate KBPS          Débit des segments de l'origine (défaut: 4000)\n"
+                "  --latency-ms MS         Latence de l'origine (défaut: 0)\n"
+                "  --jitter-ms MS          Gigue de l'origine (défaut: 0)\n"
+                "  --error-rate R          Proportion de segments en erreur 503 (défaut: 0)\n"
+                "  --discontinuity-every N Discontinuité tous les N segments (défaut: 0)\n"
+                "  --source FICHIER.ts     Servir un enregistrement au lieu du flux synthétique\n"
+                "  --port-base PORT        Port du premier flux de sortie (défaut: 7000)\n"
+                "  --interface IP          Interface de sortie et de capture (défaut: 127.0.0.1)\n"
+                "  --passthrough           Activer le mode passthrough sur les flux\n"
+                "  --json FICHIER          Écrire le rapport au format JSON\n"
+                "  --log-level NIVEAU      Niveau de journalisation (défaut: warn)\n",
+                program);
+}
+
+bool parseArguments(int argc, char* argv[], HarnessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Valeur manquante pour %s\n", arg.c_str());
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--start") {
+            options.startChannels = std::max(1, std::atoi(value()));
+        } else if (arg == "--max-channels") {
+            options.maxChannels = std::max(1, std::atoi(value()));
+        } else if (arg == "--step") {
+            options.step = std::max(0, std::atoi(value()));
+        } else if (arg == "--warmup") {
+            options.warmupSeconds = std::max(0, std::atoi(value()));
+        } else if (arg == "--measure") {
+            options.measureSeconds = std::max(1, std::atoi(value()));
+        } else if (arg == "--max-gap-ms") {
+            options.maxGapMs = std::max(1, std::atoi(value()));
+        } else if (arg == "--segment-ms") {
+            options.origin.segmentDurationMs = std::max(100, std::atoi(value()));
+        } else if (arg == "--bitrate") {
+            options.origin.bitrateKbps = static_cast<uint32_t>(std::max(100, std::atoi(value())));
+        } else if (arg == "--latency-ms") {
+            options.origin.latencyMs = std::max(0, std::atoi(value()));
+        } else if (arg == "--jitter-ms") {
+            options.origin.jitterMs = std::max(0, std::atoi(value()));
+        } else if (arg == "--error-rate") {
+            options.origin.errorRate = std::clamp(std::atof(value()), 0.0, 1.0);
+        } else if (arg == "--discontinuity-every") {
+            options.origin.discontinuityEvery = std::max(0, std::atoi(value()));
+        } else if (arg == "--source") {
+            options.origin.sourceFile = value();
+        } else if (arg == "--port-base") {
+            options.portBase = std::atoi(value());
+        } else if (arg == "--interface") {
+            options.interface = value();
+        } else if (arg == "--passthrough") {
+            options.passthrough = true;
+        } else if (arg == "--json") {
+            options.jsonPath = value();
+        } else if (arg == "--log-level") {
+            options.logLevel = value();
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else {
+            std::fprintf(stderr, "Option inconnue: %s\n", arg.c_str());
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    options.startChannels = std::min(options.startChannels, options.maxChannels);
+    if (options.maxGapMs == 0) {
+        options.maxGapMs = options.origin.segmentDurationMs * 3 / 2;
+    }
+    return true;
+}
+
+/**
+ * @brief Temps CPU consommé par le processus (utilisateur + système)
+ * @return Temps en secondes
+ */
+double processCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+std::string groupAddress(const HarnessOptions& options, int channel) {
+    return options.groupPrefix + std::to_string(channel % 250 + 1);
+}
+
+/**
+ * @brief Lance un palier de charge et mesure la sortie multicast
+ * @param options Options du banc
+ * @param origin Origine simulée
+ * @param channels Nombre de chaînes du palier
+ * @return Résultat du palier
+ */
+StepResult runStep(const HarnessOptions& options, const OriginSimulator& origin, int channels) {
+    StepResult result;
+    result.channels = channels;
+
+    Config config("");
+    for (int i = 0; i < channels; ++i) {
+        StreamConfig stream;
+        stream.id = "density" + std::to_string(i);
+        stream.name = "Canal de charge " + std::to_string(i);
+        stream.hlsInput = origin.getMasterUrl(i);
+        stream.mcastOutput = groupAddress(options, i);
+        stream.mcastPort = options.portBase + i;
+        stream.mcastInterface = options.interface;
+        stream.passthrough = options.passthrough;
+        config.updateStreamConfig(stream);
+    }
+
+    std::vector<std::unique_ptr<MulticastCapture>> captures;
+    for (int i = 0; i < channels; ++i) {
+        auto capture = std::make_unique<MulticastCapture>(groupAddress(options, i), options.portBase + i,
+                                                          options.interface);
+        if (!capture->start()) {
+            std::fprintf(stderr, "Capture impossible sur %s:%d\n", capture->getGroup().c_str(), capture->getPort());
+        }
+        captures.push_back(std::move(capture));
+    }
+
+    StreamManager manager(&config);
+    manager.start();
+
+    for (int i = 0; i < channels; ++i) {
+        if (manager.isStreamRunning("density" + std::to_string(i))) {
+            result.startedChannels++;
+        }
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.warmupSeconds));
+
+    for (auto& capture : captures) {
+        capture->resetStats();
+    }
+
+    double cpuStart = processCpuSeconds();
+    auto wallStart = std::chrono::steady_clock::now();
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.measureSeconds));
+
+    double cpuEnd = processCpuSeconds();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    const double expectedBytes = options.origin.bitrateKbps * 1000.0 / 8.0 * wallSeconds;
+    result.cpuCores = wallSeconds > 0.0 ? (cpuEnd - cpuStart) / wallSeconds : 0.0;
+    result.worstDeliveryRatio = channels > 0 ? 1e9 : 0.0;
+
+    for (auto& capture : captures) {
+        CaptureStats stats = capture->getStats();
+        result.worstGapMs = std::max(result.worstGapMs, stats.datagrams > 0 ? stats.maxGapMs : wallSeconds * 1000.0);
+        result.worstDeliveryRatio = std::min(result.worstDeliveryRatio,
+                                             expectedBytes > 0.0 ? stats.bytes / expectedBytes : 0.0);
+        result.ccErrors += stats.ccErrors;
+        result.syncErrors += stats.syncErrors;
+    }
+
+    result.gapFree = result.startedChannels == channels &&
+                     result.ccErrors == 0 &&
+                     result.syncErrors == 0 &&
+                     result.worstGapMs <= options.maxGapMs &&
+                     result.worstDeliveryRatio >= options.minDeliveryRatio;
+
+    manager.stop();
+    for (auto& capture : captures) {
+        capture->stop();
+    }
+
+    return result;
+}
+
+nlohmann::json toJson(const StepResult& result) {
+    return {
+        {"channels", result.channels},
+        {"startedChannels", result.startedChannels},
+        {"cpuCores", result.cpuCores},
+        {"worstGapMs", result.worstGapMs},
+        {"worstDeliveryRatio", result.worstDeliveryRatio},
+        {"ccErrors", result.ccErrors},
+        {"syncErrors", result.syncErrors},
+        {"gapFree", result.gapFree}
+    };
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    HarnessOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    spdlog::set_level(spdlog::level::from_str(options.logLevel));
+
+    options.origin.channels = options.maxChannels;
+    OriginSimulator origin(options.origin);
+    if (!origin.start()) {
+        std::fprintf(stderr, "Impossible de démarrer l'origine simulée\n");
+        return 1;
+    }
+
+    std::printf("Origine simulée sur le port %d: %d chaînes, segments de %d ms à %u kbit/s\n",
+                origin.getPort(), options.maxChannels, options.origin.segmentDurationMs, options.origin.bitrateKbps);
+    std::printf("Critère: aucun intervalle > %d ms, aucune rupture CC, débit reçu >= %.0f%%\n",
+                options.maxGapMs, options.minDeliveryRatio * 100.0);
+    std::printf("Le temps CPU mesuré inclut l'origine simulée, qui tourne dans le même processus\n\n");
+    std::printf("%8s %9s %10s %12s %10s %8s %8s\n",
+                "Chaînes", "Démarrées", "Cœurs", "Pire trou ms", "Débit min", "CC", "Sans trou");
+
+    std::vector<StepResult> results;
+    std::optional<size_t> best;     // Indice du dernier palier sans trou (results peut être réalloué)
+
+    for (int channels = options.startChannels; channels <= options.maxChannels;) {
+        results.push_back(runStep(options, origin, channels));
+        const StepResult& result = results.back();
+
+        std::printf("%8d %9d %10.2f %12.1f %9.0f%% %8lu %8s\n",
+                    result.channels, result.startedChannels, result.cpuCores, result.worstGapMs,
+                    result.worstDeliveryRatio * 100.0, static_cast<unsigned long>(result.ccErrors),
+                    result.gapFree ? "oui" : "non");
+        std::fflush(stdout);
+
+        if (!result.gapFree) {
+            break;
+        }
+        best = results.size() - 1;
+
+        if (channels == options.maxChannels) {
+            break;
+        }
+        channels = std::min(options.maxChannels, options.step > 0 ? channels + options.step : channels * 2);
+    }
+
+    double channelsPerCore = 0.0;
+    if (best) {
+        const StepResult& bestResult = results[*best];
+        channelsPerCore = bestResult.cpuCores > 0.0 ? bestResult.channels / bestResult.cpuCores : 0.0;
+        std::printf("\nCapacité sans trou: %d chaînes, %.1f chaînes par cœur (%u cœurs disponibles)\n",
+                    bestResult.channels, channelsPerCore, std::thread::hardware_concurrency());
+    } else {
+        std::printf("\nAucun palier sans trou\n");
+    }
+
+    auto originStats = origin.getStats();
+    origin.stop();
+
+    if (!options.jsonPath.empty()) {
+        nlohmann::json report;
+        report["segmentDurationMs"] = options.origin.segmentDurationMs;
+        report["bitrateKbps"] = options.origin.bitrateKbps;
+        report["latencyMs"] = options.origin.latencyMs;
+        report["jitterMs"] = options.origin.jitterMs;
+        report["errorRate"] = options.origin.errorRate;
+        report["maxGapMs"] = options.maxGapMs;
+        report["hardwareConcurrency"] = std::thread::hardware_concurrency();
+        report["maxGapFreeChannels"] = best ? results[*best].channels : 0;
+        report["channelsPerCore"] = channelsPerCore;
+        report["origin"] = {
+            {"playlistRequests", originStats.playlistRequests},
+            {"segmentRequests", originStats.segmentRequests},
+            {"injectedErrors", originStats.injectedErrors},
+            {"bytesServed", originStats.bytesServed}
+        };
+        report["steps"] = nlohmann::json::array();
+        for (const auto& result : results) {
+            report["steps"].push_back(toJson(result));
+        }
+
+        std::ofstream file(options.jsonPath);
+        if (!file) {
+            std::fprintf(stderr, "Impossible d'écrire le rapport %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+    }
+
+    return best ? 0 : 2;
+}
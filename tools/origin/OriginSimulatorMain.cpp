@@ -0,0 +1,119 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "OriginSimulator.h"
+
+using namespace hls_to_dvb::tools;
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void signalHandler(int) {
+    stopRequested = true;
+}
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s [options]\n"
+                "  --address IP            Adresse d'écoute (défaut: 127.0.0.1)\n"
+                "  --port PORT             Port d'écoute (défaut: 8090)\n"
+                "  --channels N            Nombre de chaînes (défaut: 1)\n"
+                "  --segment-ms MS         Durée des segments (défaut: 2000)\n"
+                "  --window N              Segments annoncés dans la playlist (défaut: 6)\n"
+                "  --bitrate KBPS          Débit des segments synthétiques (défaut: 4000)\n"
+                "  --latency-ms MS         Latence ajoutée à chaque réponse (défaut: 0)\n"
+                "  --jitter-ms MS          Gigue de la latence (défaut: 0)\n"
+                "  --error-rate R          Proportion de segments en erreur 503 (défaut: 0)\n"
+                "  --discontinuity-every N Discontinuité tous les N segments (défaut: 0)\n"
+                "  --directory DIR         Répertoire des segments (défaut: temporaire)\n"
+                "  --source FICHIER.ts     Servir un enregistrement au lieu du flux synthétique\n"
+                "  --log-level NIVEAU      Niveau de journalisation (défaut: info)\n",
+                program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    OriginOptions options;
+    options.port = 8090;
+    std::string logLevel = "info";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Valeur manquante pour %s\n", arg.c_str());
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--address") {
+            options.address = value();
+        } else if (arg == "--port") {
+            options.port = std::atoi(value());
+        } else if (arg == "--channels") {
+            options.channels = std::atoi(value());
+        } else if (arg == "--segment-ms") {
+            options.segmentDurationMs = std::atoi(value());
+        } else if (arg == "--window") {
+            options.windowSegments = std::atoi(value());
+        } else if (arg == "--bitrate") {
+            options.bitrateKbps = static_cast<uint32_t>(std::atoi(value()));
+        } else if (arg == "--latency-ms") {
+            options.latencyMs = std::atoi(value());
+        } else if (arg == "--jitter-ms") {
+            options.jitterMs = std::atoi(value());
+        } else if (arg == "--error-rate") {
+            options.errorRate = std::atof(value());
+        } else if (arg == "--discontinuity-every") {
+            options.discontinuityEvery = std::atoi(value());
+        } else if (arg == "--directory") {
+            options.directory = value();
+        } else if (arg == "--source") {
+            options.sourceFile = value();
+        } else if (arg == "--log-level") {
+            logLevel = value();
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::fprintf(stderr, "Option inconnue: %s\n", arg.c_str());
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    spdlog::set_level(spdlog::level::from_str(logLevel));
+
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    OriginSimulator origin(options);
+    if (!origin.start()) {
+        return 1;
+    }
+
+    for (int channel = 0; channel < options.channels; ++channel) {
+        std::printf("%s\n", origin.getMasterUrl(channel).c_str());
+    }
+    std::fflush(stdout);
+
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    auto stats = origin.getStats();
+    origin.stop();
+
+    spdlog::info("Origine arrêtée: {} playlists, {} segments, {} erreurs injectées, {} octets",
+                 stats.playlistRequests, stats.segmentRequests, stats.injectedErrors, stats.bytesServed);
+    return 0;
+}
@@ -9,154 +9,209 @@ document.addEventListener('DOMContentLoaded', function() {
     const streamDetailsModal = new bootstrap.Modal(document.getElementById('streamDetailsModal'));
     const streamDetails = document.getElementById('streamDetails');
 
-    // Initialisation
-    loadStreams();
-    loadAlerts();
-    loadSystemStatus();
+    // État courant des flux, indexé par ID (l'ordre d'insertion est celui de la configuration)
+    let streamsById = new Map();
 
-    // Actualisation périodique
-    setInterval(loadStreams, 5000);
-    setInterval(loadAlerts, 5000);
-    setInterval(loadSystemStatus, 5000);
+    // Initialisation: le serveur pousse l'état puis ses modifications (Server-Sent Events)
+    if (window.EventSource) {
+        connectEvents();
+    } else {
+        // Navigateur sans EventSource: repli sur l'interrogation périodique
+        loadStreams();
+        loadAlerts();
+        loadSystemStatus();
+        setInterval(loadStreams, 5000);
+        setInterval(loadAlerts, 5000);
+        setInterval(loadSystemStatus, 5000);
+    }
 
     // Écouteurs d'événements
     saveStreamBtn.addEventListener('click', saveStream);
 
-    // Fonction pour charger la liste des flux
+    // Fonction pour s'abonner aux événements du serveur
+    function connectEvents() {
+        const events = new EventSource('/api/events');
+
+        events.addEventListener('snapshot', event => {
+            const state = JSON.parse(event.data);
+            streamsById = new Map(state.streams.map(stream => [stream.id, stream]));
+            renderStreams();
+            renderAlerts(state.alerts);
+            renderSystemStatus(state.stats);
+        });
+
+        events.addEventListener('streams', event => {
+            const delta = JSON.parse(event.data);
+            delta.updated.forEach(stream => streamsById.set(stream.id, stream));
+            delta.removed.forEach(id => streamsById.delete(id));
+            renderStreams();
+        });
+
+        events.addEventListener('alerts', event => {
+            renderAlerts(JSON.parse(event.data));
+        });
+
+        events.addEventListener('stats', event => {
+            renderSystemStatus(JSON.parse(event.data));
+        });
+
+        // EventSource se reconnecte seul et reçoit alors un nouvel état complet
+        events.onerror = () => {
+            console.error('Connexion aux événements du serveur interrompue, reconnexion...');
+        };
+    }
+
+    // Fonction pour charger la liste des flux (après une action de l'utilisateur)
     function loadStreams() {
         fetch('/api/streams')
             .then(response => response.json())
             .then(streams => {
-                streamsList.innerHTML = '';
-                streams.forEach(stream => {
-                    const streamItem = document.createElement('div');
-                    streamItem.className = 'list-group-item stream-item';
-                    
-                    const statusClass = stream.running ? 'bg-success' : 'bg-secondary';
-                    const statusText = stream.running ? 'En cours' : 'Arrêté';
-                    
-                    streamItem.innerHTML = `
-                        <div>
-                            <h5>${stream.name}</h5>
-                            <small>${stream.hlsInput}</small>
-                        </div>
-                        <div class="d-flex align-items-center">
-                            <span class="badge ${statusClass} status-badge me-2">${statusText}</span>
-                            <div class="stream-controls">
-                                <button class="btn btn-sm btn-info view-details" data-id="${stream.id}"><i class="bi bi-info-circle"></i> Détails</button>
-                                ${!stream.running ? 
-                                    `<button class="btn btn-sm btn-success start-stream" data-id="${stream.id}"><i class="bi bi-play-fill"></i> Démarrer</button>` : 
-                                    `<button class="btn btn-sm btn-danger stop-stream" data-id="${stream.id}"><i class="bi bi-stop-fill"></i> Arrêter</button>`
-                                }
-                                <button class="btn btn-sm btn-primary edit-stream" data-id="${stream.id}"><i class="bi bi-pencil"></i> Éditer</button>
-                                <button class="btn btn-sm btn-danger delete-stream" data-id="${stream.id}"><i class="bi bi-trash"></i> Supprimer</button>
-                            </div>
-                        </div>
-                    `;
-                    
-                    streamsList.appendChild(streamItem);
-                });
-                
-                // Ajouter les écouteurs d'événements pour les boutons
-                document.querySelectorAll('.start-stream').forEach(btn => {
-                    btn.addEventListener('click', startStream);
-                });
-                
-                document.querySelectorAll('.stop-stream').forEach(btn => {
-                    btn.addEventListener('click', stopStream);
-                });
-                
-                document.querySelectorAll('.edit-stream').forEach(btn => {
-                    btn.addEventListener('click', editStream);
-                });
-                
-                document.querySelectorAll('.delete-stream').forEach(btn => {
-                    btn.addEventListener('click', deleteStream);
-                });
-                
-                document.querySelectorAll('.view-details').forEach(btn => {
-                    btn.addEventListener('click', viewStreamDetails);
-                });
+                streamsById = new Map(streams.map(stream => [stream.id, stream]));
+                renderStreams();
             })
             .catch(error => {
                 console.error('Erreur lors du chargement des flux:', error);
             });
     }
 
+    // Fonction pour afficher la liste des flux
+    function renderStreams() {
+        streamsList.innerHTML = '';
+        streamsById.forEach(stream => {
+            const streamItem = document.createElement('div');
+            streamItem.className = 'list-group-item stream-item';
+            
+            const statusClass = stream.running ? 'bg-success' : 'bg-secondary';
+            const statusText = stream.running ? 'En cours' : 'Arrêté';
+            
+            streamItem.innerHTML = `
+                <div>
+                    <h5>${stream.name}</h5>
+                    <small>${stream.hlsInput}</small>
+                </div>
+                <div class="d-flex align-items-center">
+                    <span class="badge ${statusClass} status-badge me-2">${statusText}</span>
+                    <div class="stream-controls">
+                        <button class="btn btn-sm btn-info view-details" data-id="${stream.id}"><i class="bi bi-info-circle"></i> Détails</button>
+                        ${!stream.running ? 
+                            `<button class="btn btn-sm btn-success start-stream" data-id="${stream.id}"><i class="bi bi-play-fill"></i> Démarrer</button>` : 
+                            `<button class="btn btn-sm btn-danger stop-stream" data-id="${stream.id}"><i class="bi bi-stop-fill"></i> Arrêter</button>`
+                        }
+                        <button class="btn btn-sm btn-primary edit-stream" data-id="${stream.id}"><i class="bi bi-pencil"></i> Éditer</button>
+                        <button class="btn btn-sm btn-danger delete-stream" data-id="${stream.id}"><i class="bi bi-trash"></i> Supprimer</button>
+                    </div>
+                </div>
+            `;
+            
+            streamsList.appendChild(streamItem);
+        });
+        
+        // Ajouter les écouteurs d'événements pour les boutons
+        document.querySelectorAll('.start-stream').forEach(btn => {
+            btn.addEventListener('click', startStream);
+        });
+        
+        document.querySelectorAll('.stop-stream').forEach(btn => {
+            btn.addEventListener('click', stopStream);
+        });
+        
+        document.querySelectorAll('.edit-stream').forEach(btn => {
+            btn.addEventListener('click', editStream);
+        });
+        
+        document.querySelectorAll('.delete-stream').forEach(btn => {
+            btn.addEventListener('click', deleteStream);
+        });
+        
+        document.querySelectorAll('.view-details').forEach(btn => {
+            btn.addEventListener('click', viewStreamDetails);
+        });
+    }
+
     // Fonction pour charger les alertes
     function loadAlerts() {
         fetch('/api/alerts')
             .then(response => response.json())
-            .then(alerts => {
-                alertsList.innerHTML = '';
-                alerts.slice(0, 10).forEach(alert => {
-                    const alertItem = document.createElement('div');
-                    alertItem.className = `list-group-item alert-item alert-${alert.level.toLowerCase()}`;
-                    
-                    alertItem.innerHTML = `
-                        <div class="d-flex justify-content-between">
-                            <strong>${alert.source}</strong>
-                            <span class="badge bg-${getLevelClass(alert.level)}">${alert.level}</span>
-                        </div>
-                        <p class="mb-1">${alert.message}</p>
-                        <small class="timestamp">${alert.timestamp}</small>
-                    `;
-                    
-                    alertsList.appendChild(alertItem);
-                });
-            })
+            .then(renderAlerts)
             .catch(error => {
                 console.error('Erreur lors du chargement des alertes:', error);
             });
     }
 
+    // Fonction pour afficher les alertes
+    function renderAlerts(alerts) {
+        alertsList.innerHTML = '';
+        alerts.slice(0, 10).forEach(alert => {
+            const alertItem = document.createElement('div');
+            alertItem.className = `list-group-item alert-item alert-${alert.level.toLowerCase()}`;
+            
+            alertItem.innerHTML = `
+                <div class="d-flex justify-content-between">
+                    <strong>${alert.source}</strong>
+                    <span class="badge bg-${getLevelClass(alert.level)}">${alert.level}</span>
+                </div>
+                <p class="mb-1">${alert.message}</p>
+                <small class="timestamp">${alert.timestamp}</small>
+            `;
+            
+            alertsList.appendChild(alertItem);
+        });
+    }
+
     // Fonction pour charger l'état du système
     function loadSystemStatus() {
-        fetch('/api/system')
+        fetch('/api/stats')
             .then(response => response.json())
-            .then(status => {
-                systemStatus.innerHTML = `
-                    <div class="system-status-item">
-                        <span>Flux totaux:</span>
-                        <strong>${status.totalStreams}</strong>
-                    </div>
-                    <div class="system-status-item">
-                        <span>Flux actifs:</span>
-                        <strong>${status.runningStreams}</strong>
-                    </div>
-                    <div class="system-status-item">
-                        <span>CPU:</span>
-                        <div class="w-50">
-                            <div class="progress">
-                                <div class="progress-bar" role="progressbar" style="width: ${status.cpuUsage}%"></div>
-                            </div>
-                            <small>${status.cpuUsage.toFixed(1)}%</small>
-                        </div>
-                    </div>
-                    <div class="system-status-item">
-                        <span>Mémoire:</span>
-                        <div class="w-50">
-                            <div class="progress">
-                                <div class="progress-bar" role="progressbar" style="width: ${status.memoryUsage}%"></div>
-                            </div>
-                            <small>${status.memoryUsage.toFixed(1)}%</small>
-                        </div>
-                    </div>
-                    <div class="system-status-item">
-                        <span>Uptime:</span>
-                        <strong>${status.uptime}</strong>
-                    </div>
-                    <div class="system-status-item">
-                        <span>Version:</span>
-                        <strong>${status.version}</strong>
-                    </div>
-                `;
-            })
+            .then(renderSystemStatus)
             .catch(error => {
                 console.error('Erreur lors du chargement de l\'état du système:', error);
             });
     }
 
+    // Fonction pour afficher l'état du système (format de /api/stats)
+    function renderSystemStatus(stats) {
+        const cpuUsage = stats.system.cpuUsage;
+        const memoryRatio = stats.memory.budgetBytes > 0 ?
+            100 * stats.memory.bufferedBytes / stats.memory.budgetBytes : 0;
+
+        systemStatus.innerHTML = `
+            <div class="system-status-item">
+                <span>Flux totaux:</span>
+                <strong>${stats.streams.total}</strong>
+            </div>
+            <div class="system-status-item">
+                <span>Flux actifs:</span>
+                <strong>${stats.streams.running}</strong>
+            </div>
+            <div class="system-status-item">
+                <span>CPU:</span>
+                <div class="w-50">
+                    <div class="progress">
+                        <div class="progress-bar" role="progressbar" style="width: ${Math.min(cpuUsage, 100)}%"></div>
+                    </div>
+                    <small>${cpuUsage.toFixed(1)}%</small>
+                </div>
+            </div>
+            <div class="system-status-item">
+                <span>Tampons:</span>
+                <div class="w-50">
+                    <div class="progress">
+                        <div class="progress-bar" role="progressbar" style="width: ${Math.min(memoryRatio, 100)}%"></div>
+                    </div>
+                    <small>${(stats.memory.bufferedBytes / 1048576).toFixed(1)} Mo (${memoryRatio.toFixed(1)}% du budget)</small>
+                </div>
+            </div>
+            <div class="system-status-item">
+                <span>Mémoire:</span>
+                <strong>${(stats.system.memoryUsage / 1048576).toFixed(1)} Mo</strong>
+            </div>
+            <div class="system-status-item">
+                <span>Threads:</span>
+                <strong>${stats.system.threads}</strong>
+            </div>
+        `;
+    }
+
     // Fonction pour enregistrer un flux
     function saveStream() {
         const formData = new FormData(streamForm);
@@ -356,6 +411,22 @@ document.addEventListener('DOMContentLoaded', function() {
                     <div class="detail-label">État du buffer:</div>
                     <div class="detail-value">${streamStats.bufferSize} / ${streamStats.bufferCapacity} segments</div>
                 </div>
+                <div class="detail-row">
+                    <div class="detail-label">Tampon de gigue:</div>
+                    <div class="detail-value">${streamStats.bufferDepthMs} / ${streamStats.bufferTargetMs} ms (gigue ${Math.round(streamStats.bufferJitterMs)} ms, sous-remplissages ${streamStats.bufferUnderruns}, débordements ${streamStats.bufferOverruns})</div>
+                </div>
+                <div class="detail-row">
+                    <div class="detail-label">Mémoire tampon:</div>
+                    <div class="detail-value">${(streamStats.memoryBytes / 1048576).toFixed(1)} Mo (HLS ${(streamStats.hlsQueueBytes / 1048576).toFixed(1)}, gigue ${(streamStats.segmentBufferBytes / 1048576).toFixed(1)}, multicast ${(streamStats.multicastQueueBytes / 1048576).toFixed(1)})</div>
+                </div>
+                <div class="detail-row">
+                    <div class="detail-label">Réserve de tampons:</div>
+                    <div class="detail-value">${streamStats.poolAllocationsPerSegment.toFixed(2)} allocations/segment (recyclés ${streamStats.poolReuses}, pic ${(streamStats.poolPeakPooledBytes / 1048576).toFixed(1)} Mo)</div>
+                </div>
+                <div class="detail-row">
+                    <div class="detail-label">Passthrough:</div>
+                    <div class="detail-value">${streamStats.passthroughActive ? 'Actif' : 'Inactif'} (${streamStats.passthroughSegments} segments${streamStats.passthroughFallbackReason ? ', repli: ' + streamStats.passthroughFallbackReason : ''})</div>
+                </div>
                 <div class="detail-row">
                     <div class="detail-label">Paquets transmis:</div>
                     <div class="detail-value">${streamStats.packetsTransmitted}</div>
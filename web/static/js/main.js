@@ -43,10 +43,74 @@ function initApp() {
     loadAlerts();
     loadSettings();
     
-    // Configurer des rafraîchissements périodiques
-    setInterval(loadServerStatus, 5000);
-    setInterval(loadStreams, 5000);
-    setInterval(loadAlerts, 5000);
+    // Recevoir les mises à jour poussées par le serveur (Server-Sent Events)
+    if (window.EventSource) {
+        connectEvents();
+    } else {
+        // Navigateur sans EventSource: repli sur l'interrogation périodique
+        setInterval(loadServerStatus, 5000);
+        setInterval(loadStreams, 5000);
+        setInterval(loadAlerts, 5000);
+    }
+}
+
+// S'abonner aux événements du serveur: état complet à la connexion, puis différences
+function connectEvents() {
+    const events = new EventSource('/api/events');
+    
+    const setOnline = online => {
+        appState.serverStatus = online ? 'online' : 'offline';
+        dom.statusIndicator.className = appState.serverStatus;
+        dom.statusText.textContent = online ? 'En ligne' : 'Hors ligne';
+    };
+    
+    // Statistiques du serveur, publiées à chaque période: l'en-tête reste à jour
+    const renderServerStats = stats => {
+        setOnline(true);
+        let summary = `${stats.streams.running}/${stats.streams.total} flux actifs`;
+        if (stats.memory.throttled) {
+            summary += ', budget mémoire atteint';
+            dom.statusText.textContent = 'En ligne (récupérations suspendues)';
+        }
+        dom.statusText.title = summary;
+    };
+    
+    events.addEventListener('snapshot', event => {
+        const state = JSON.parse(event.data);
+        setOnline(true);
+        if (state.stats) {
+            renderServerStats(state.stats);
+        }
+        appState.streams = state.streams;
+        renderStreams();
+        loadAlerts();
+    });
+    
+    events.addEventListener('streams', event => {
+        const delta = JSON.parse(event.data);
+        const removed = new Set(delta.removed);
+        const updated = new Map(delta.updated.map(stream => [stream.id, stream]));
+        
+        appState.streams = appState.streams
+            .filter(stream => !removed.has(stream.id))
+            .map(stream => {
+                const next = updated.get(stream.id);
+                updated.delete(stream.id);
+                return next || stream;
+            })
+            .concat([...updated.values()]);
+        renderStreams();
+    });
+    
+    // Les alertes sont filtrées côté serveur: recharger la vue filtrée quand elles changent
+    events.addEventListener('alerts', () => loadAlerts());
+    
+    events.addEventListener('stats', event => renderServerStats(JSON.parse(event.data)));
+    
+    events.onopen = () => setOnline(true);
+    
+    // EventSource se reconnecte seul et reçoit alors un nouvel état complet
+    events.onerror = () => setOnline(false);
 }
 
 // Attacher tous les gestionnaires d'événements